@@ -1,44 +1,76 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "enclave_u.h"
 #include "sgx_urts.h"
+#include "ecall.h"
+#include "metrics.h"
+#include "reqtrace.h"
+#include "trace.h"
 #include "randombytes.h"
 #include "../include/boundary_types.h"
 
 #define TOKEN_FILENAME "enclave.token"
-#define ENCLAVE_FILENAME "enclave.signed.so"
 #define PLAINTEXT_LEN 32
 
 static sgx_enclave_id_t global_eid = 0;
 
-void ocall_print(char *str, size_t str_len)
+int initialize_enclave(void)
 {
-  for (int i = 0; i < str_len; ++i)
-    printf("%x", (uint8_t) str[i]);
-  printf("\n");
+  if (enclave_create(ENCLAVE_FILENAME, &global_eid) != SGX_SUCCESS)
+    return -1;
+  return 0;
 }
 
-void ocall_print_string(const char *str)
+/*
+ * Print the peak heap use and stack depth of keygen, sign and verify
+ * inside the enclave for every degree, against the limits configured
+ * in enclave.config.xml. keygen includes the expansion of the new key,
+ * sign the expanded key it works on (both as published, see
+ * enclave/keypub.h); sign-sealed is a signature with a sealed tenant
+ * key, expanded for that signature only.
+ */
+static int memstats_report(void)
 {
-    printf("%s", str);
-}
+  static const char *ops[] = { "keygen", "sign", "verify", "sign-sealed" };
 
-int initialize_enclave(void)
-{
-  sgx_status_t r = SGX_ERROR_UNEXPECTED;
-  r = sgx_create_enclave(ENCLAVE_FILENAME, SGX_DEBUG_FLAG, NULL, NULL,
-      &global_eid, NULL);
-  if (r != SGX_SUCCESS)
-    return -1;
+  printf("%-5s %-11s %12s %7s %12s %7s\n", "logn", "op", "heap", "%max",
+      "stack", "%max");
+  for (unsigned logn = 1; logn <= 10; logn++) {
+    for (unsigned op = MEMSTATS_OP_KEYGEN; op <= MEMSTATS_OP_SIGN_SEALED;
+        op++) {
+      sgx_status_t retval;
+      size_t heap = 0, stack = 0;
+      sgx_status_t r = ecall("memstats", trust_falcon_memstats, global_eid,
+          &retval, op, logn, &heap, &stack);
+      if (r != SGX_SUCCESS || retval != SGX_SUCCESS) {
+        fprintf(stderr, "memstats failed for %s at logn=%u: 0x%x\n",
+            ops[op], logn, (unsigned) (r != SGX_SUCCESS ? r : retval));
+        return -1;
+      }
+      printf("%-5u %-11s %12lu %6.1f%% %12lu %6.1f%%\n", logn, ops[op],
+          (unsigned long) heap, 100.0 * heap / ENCLAVE_HEAP_MAX,
+          (unsigned long) stack, 100.0 * stack / ENCLAVE_STACK_MAX);
+    }
+  }
   return 0;
 }
 
 int main(int argc, char **argv)
 {
+  trace_init();
+  metrics_init();
+  reqtrace_init();
   printf("Initializing enclave.\n");
   if (initialize_enclave() < 0)
     return -1;
 
+  if (argc > 1 && strcmp(argv[1], "--memstats") == 0) {
+    int r = memstats_report();
+    sgx_destroy_enclave(global_eid);
+    return r;
+  }
+
   uint8_t plaintext[PLAINTEXT_LEN];
   randombytes(plaintext, PLAINTEXT_LEN);
   printf("Plaintext to sign:\n");
@@ -46,20 +78,45 @@ int main(int argc, char **argv)
   printf("\n");
 
   sgx_status_t retval;
-  trust_falcon_keygen(global_eid, &retval);
+  reqtrace_record(trace_now(), REQTRACE_KEYGEN, 0, DEFAULT_LOGN, 0);
+  ecall("keygen", trust_falcon_keygen, global_eid, &retval, DEFAULT_LOGN);
 
   uint8_t signature[MAX_SIG_LEN];
+  uint8_t nonce[NONCE_LEN];
   size_t sig_size;
   printf("Signature before signing:\n");
   ocall_print((char *) signature, MAX_SIG_LEN);
   printf("\n");
 
-  trust_falcon_sign(global_eid, &retval, (uint8_t *) &signature, &sig_size,
-      (uint8_t *) &plaintext, PLAINTEXT_LEN);
+  reqtrace_record(trace_now(), REQTRACE_SIGN, 0, DEFAULT_LOGN,
+      PLAINTEXT_LEN);
+  ecall("sign", trust_falcon_sign, global_eid, &retval,
+      (uint8_t *) &signature, &sig_size, (uint8_t *) &nonce,
+      (uint8_t *) &plaintext, (size_t) PLAINTEXT_LEN);
 
   printf("Signature after signing:\n");
   ocall_print((char *) signature, sig_size);
   printf("\n");
 
+  printf("Nonce:\n");
+  ocall_print((char *) nonce, NONCE_LEN);
+  printf("\n");
+
+  uint8_t pkey[MAX_PKEY_LEN];
+  size_t pkey_len;
+  ecall("get_pubkey", trust_falcon_get_pubkey, global_eid, &retval,
+      (uint8_t *) &pkey, sizeof pkey, &pkey_len);
+  printf("Public key:\n");
+  ocall_print((char *) pkey, pkey_len);
+  printf("\n");
+
+  int valid = 0;
+  reqtrace_record(trace_now(), REQTRACE_VERIFY, 0, DEFAULT_LOGN,
+      PLAINTEXT_LEN);
+  ecall("verify", trust_falcon_verify, global_eid, &retval,
+      (uint8_t *) &signature, sig_size, (uint8_t *) &nonce,
+      (uint8_t *) &plaintext, (size_t) PLAINTEXT_LEN, &valid);
+  printf("Signature verifies: %s\n", valid == 1 ? "yes" : "no");
+
   sgx_destroy_enclave(global_eid);
 }
@@ -0,0 +1,158 @@
+/*
+ * Asynchronous signing driver.
+ *
+ * Runs many coroutines on one epoll event loop thread, each signing
+ * messages back to back with co_await (see async_sign.h); dispatcher
+ * threads batch their requests into trust_falcon_sign_many() ECALLs.
+ * This is how an asynchronous service would use the enclave, and it
+ * measures what batching buys over one ECALL per signature.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "enclave_u.h"
+#include "sgx_urts.h"
+#include "async_sign.h"
+#include "dispatch.h"
+#include "ecall.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "trace.h"
+#include "../include/boundary_types.h"
+
+typedef std::chrono::steady_clock as_clock;
+
+static sgx_enclave_id_t global_eid = 0;
+
+static struct {
+  as_clock::time_point deadline;
+  struct histogram latency;
+  uint64_t ops, errors;
+  unsigned running;
+  sgx_falcon::event_loop *loop;
+} run;
+
+static sgx_falcon::task client(sgx_falcon::async_signer &signer,
+    std::vector<uint8_t> msg)
+{
+  while (as_clock::now() < run.deadline) {
+    uint64_t start = trace_now();
+    sgx_falcon::sign_result r = co_await signer.sign(&msg[0], msg.size());
+    if (!r.ok) {
+      run.errors++;
+      continue;
+    }
+    run.ops++;
+    hist_record(&run.latency, trace_now() - start);
+    msg[0]++;
+  }
+  if (--run.running == 0)
+    run.loop->stop();
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+"usage: %s [ options ]\n"
+"  -n count      concurrent coroutines (default: 64)\n"
+"  -t threads    dispatcher threads (default: 2, max: %d)\n"
+"  -b count      most signatures per ECALL (default: 16, max: %d)\n"
+"  -d seconds    test duration (default: 10)\n"
+"  -s bytes      message size (default: 32, max: %d)\n"
+"  -l logn       degree of the generated signing key (default: %d)\n",
+      name, MAX_THREADS, SIGN_MANY_MAX, MAX_MSG_LEN, DEFAULT_LOGN);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned clients = 64, threads = 2, batch = 16, logn = DEFAULT_LOGN;
+  double duration = 10.0;
+  size_t msg_len = 32;
+  int c;
+
+  trace_init();
+  metrics_init();
+  while ((c = getopt(argc, argv, "n:t:b:d:s:l:")) != -1) {
+    switch (c) {
+    case 'n':
+      clients = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 't':
+      threads = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'b':
+      batch = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'd':
+      duration = atof(optarg);
+      break;
+    case 's':
+      msg_len = (size_t) strtoul(optarg, NULL, 10);
+      break;
+    case 'l':
+      logn = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (clients < 1 || threads < 1 || threads > MAX_THREADS || batch < 1
+      || batch > SIGN_MANY_MAX || duration <= 0 || msg_len < 1
+      || msg_len > MAX_MSG_LEN || logn < 1 || logn > 10)
+    usage(argv[0]);
+
+  sgx_status_t r = enclave_create(ENCLAVE_FILENAME, &global_eid);
+  if (r != SGX_SUCCESS)
+    return -1;
+  sgx_status_t retval;
+  r = ecall("keygen", trust_falcon_keygen, global_eid, &retval, logn);
+  if (r != SGX_SUCCESS || retval != SGX_SUCCESS) {
+    fprintf(stderr, "enclave keygen failed\n");
+    return -1;
+  }
+  if (dispatch_start(global_eid, threads, batch) != 0) {
+    fprintf(stderr, "could not start the dispatcher\n");
+    return -1;
+  }
+
+  sgx_falcon::event_loop loop;
+  sgx_falcon::async_signer signer(loop);
+  if (!signer.ok()) {
+    fprintf(stderr, "could not watch the dispatcher\n");
+    dispatch_stop();
+    return -1;
+  }
+  std::mt19937_64 rng(0x5eed0000u);
+  hist_init(&run.latency);
+  run.loop = &loop;
+  run.running = clients;
+  as_clock::time_point t0 = as_clock::now();
+  run.deadline = t0 + std::chrono::duration_cast<as_clock::duration>(
+      std::chrono::duration<double>(duration));
+  for (unsigned i = 0; i < clients; i++) {
+    std::vector<uint8_t> msg(msg_len);
+    for (size_t j = 0; j < msg_len; j++)
+      msg[j] = (uint8_t) rng();
+    client(signer, msg);
+  }
+  loop.run();
+  double elapsed = std::chrono::duration<double>(as_clock::now() - t0).count();
+  dispatch_stop();
+
+  printf("%u coroutines, %u dispatcher threads, up to %u signatures per "
+      "ECALL\n", clients, threads, batch);
+  printf("completed %llu signatures (%llu errors) in %.2f s: %.1f sig/s\n",
+      (unsigned long long) run.ops, (unsigned long long) run.errors, elapsed,
+      (double) run.ops / elapsed);
+  printf("latency (us):  ");
+  hist_print_summary(stdout, &run.latency, 1000.0);
+
+  sgx_destroy_enclave(global_eid);
+  return run.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#ifndef _ASYNC_SIGN_H
+#define _ASYNC_SIGN_H
+
+/*
+ * C++20 coroutine interface to the enclave dispatcher (dispatch.h).
+ *
+ *   sgx_falcon::event_loop loop;
+ *   sgx_falcon::async_signer signer(loop);
+ *
+ *   sgx_falcon::task handle(...)
+ *   {
+ *     sgx_falcon::sign_result r = co_await signer.sign(msg, len);
+ *     ...
+ *   }
+ *
+ * co_await suspends the coroutine until the batch holding its request
+ * has left the enclave, then resumes it on the event loop thread (the
+ * executor): the loop watches the dispatcher's eventfd with epoll, next
+ * to any other descriptors the service registers with watch(). No
+ * thread blocks on the enclave except the dispatcher's own.
+ *
+ * Everything here runs on the loop thread; only the dispatcher
+ * threads, behind dispatch_submit() and dispatch_poll(), are
+ * concurrent.
+ */
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <map>
+
+#include "dispatch.h"
+#include "../include/boundary_types.h"
+
+namespace sgx_falcon {
+
+/*
+ * Fire-and-forget coroutine: starts immediately and frees itself when
+ * it returns.
+ */
+struct task {
+  struct promise_type {
+    task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+/*
+ * Single-threaded epoll loop. Callbacks run on the thread calling
+ * run(), until stop().
+ */
+class event_loop {
+ public:
+  event_loop() : epfd_(epoll_create1(EPOLL_CLOEXEC)), running_(false) {}
+  ~event_loop() { close(epfd_); }
+  event_loop(const event_loop &) = delete;
+  event_loop &operator=(const event_loop &) = delete;
+
+  // Call 'cb' whenever 'fd' is readable. Returns false on error.
+  bool watch(int fd, std::function<void()> cb)
+  {
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) < 0)
+      return false;
+    watchers_[fd] = std::move(cb);
+    return true;
+  }
+
+  void unwatch(int fd)
+  {
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, NULL);
+    watchers_.erase(fd);
+  }
+
+  void run()
+  {
+    struct epoll_event evs[16];
+    running_ = true;
+    while (running_) {
+      int n = epoll_wait(epfd_, evs, 16, -1);
+      for (int i = 0; i < n && running_; i++) {
+        auto it = watchers_.find(evs[i].data.fd);
+        if (it != watchers_.end())
+          it->second();
+      }
+    }
+  }
+
+  void stop() { running_ = false; }
+
+ private:
+  int epfd_;
+  bool running_;
+  std::map<int, std::function<void()>> watchers_;
+};
+
+struct sign_result {
+  bool ok;
+  size_t sig_len;
+  uint8_t sig[MAX_SIG_LEN];
+  uint8_t nonce[NONCE_LEN];
+};
+
+/*
+ * Awaitable signing front end. The dispatcher must have been started
+ * (dispatch_start()); one async_signer per event loop. If the loop
+ * cannot watch the dispatcher, ok() is false and every sign() completes
+ * at once with a failed result, rather than never.
+ */
+class async_signer {
+ public:
+  explicit async_signer(event_loop &loop) : loop_(loop)
+  {
+    ok_ = loop_.watch(dispatch_fd(), [] { dispatch_poll(); });
+  }
+  ~async_signer()
+  {
+    if (ok_)
+      loop_.unwatch(dispatch_fd());
+  }
+  async_signer(const async_signer &) = delete;
+  async_signer &operator=(const async_signer &) = delete;
+
+  bool ok() const { return ok_; }
+
+  /*
+   * The request lives in the awaiting coroutine's frame, which stays
+   * put while the coroutine is suspended; the message must stay valid
+   * until the co_await completes.
+   */
+  class awaiter {
+   public:
+    awaiter(const uint8_t *msg, size_t len, bool failed) : failed_(failed)
+    {
+      req_.msg = msg;
+      req_.msg_len = len;
+      req_.sig = result_.sig;
+      req_.nonce = result_.nonce;
+      req_.done = resume;
+      req_.ok = 0;
+      req_.sig_len = 0;
+    }
+
+    // No completion would ever be polled: do not submit.
+    bool await_ready() const noexcept { return failed_; }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept
+    {
+      req_.arg = h.address();
+      dispatch_submit(&req_);
+    }
+
+    sign_result await_resume() noexcept
+    {
+      result_.ok = req_.ok != 0;
+      result_.sig_len = req_.sig_len;
+      return result_;
+    }
+
+   private:
+    // Runs in dispatch_poll(), on the loop thread.
+    static void resume(struct dispatch_req *req)
+    {
+      std::coroutine_handle<>::from_address(req->arg).resume();
+    }
+
+    struct dispatch_req req_;
+    sign_result result_;
+    bool failed_;
+  };
+
+  awaiter sign(const uint8_t *msg, size_t len)
+  {
+    return awaiter(msg, len, !ok_);
+  }
+
+ private:
+  event_loop &loop_;
+  bool ok_;
+};
+
+} // namespace sgx_falcon
+
+#endif // _ASYNC_SIGN_H
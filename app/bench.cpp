@@ -0,0 +1,342 @@
+/*
+ * Enclave-versus-native comparison benchmark.
+ *
+ * The same keygen, sign and verify workloads are run through the
+ * native Falcon library (built without USE_SGX) and through the
+ * enclave ECALLs. Each native operation mirrors the body of the
+ * corresponding ECALL, so that the reported slowdown factor isolates
+ * the SGX overhead (transitions, marshalling, EPC, sgx_read_rand
+ * seeding) from the Falcon compute itself: keygen also expands the new
+ * private key, as its publication does (enclave/keypub.h); sign uses
+ * a fresh context on that expanded key; verify loads the public key
+ * into a fresh context.
+ *
+ * An extra native-only row, "vrfy-hit", times a repeat verification
+ * served by the verification cache (see vrfycache.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "enclave_u.h"
+#include "sgx_urts.h"
+#include "ecall.h"
+#include "metrics.h"
+#include "trace.h"
+#include "randombytes.h"
+#include "vrfycache.h"
+#include "falcon.h"
+#include "../include/boundary_types.h"
+
+static sgx_enclave_id_t global_eid = 0;
+
+struct workload {
+  unsigned logn;
+  uint8_t *msg;
+  size_t msg_len;
+  uint8_t sig[MAX_SIG_LEN];
+  size_t sig_len;
+  uint8_t nonce[NONCE_LEN];
+};
+
+typedef int (*bench_op)(struct workload *w);
+
+/*
+ * Native key material; plays the role of the enclave's published
+ * key_version.
+ */
+static uint8_t native_pkey[MAX_PKEY_LEN];
+static uint8_t native_skey[6000];
+static size_t native_pkey_len = 0;
+static size_t native_skey_len = 0;
+static falcon_expanded_key *native_ek = NULL;
+
+static int native_keygen(struct workload *w)
+{
+  falcon_keygen *fk = falcon_keygen_new(w->logn, 0);
+  if (fk == NULL)
+    return 0;
+  native_skey_len = sizeof native_skey;
+  native_pkey_len = sizeof native_pkey;
+  int r = falcon_keygen_make(fk, FALCON_COMP_STATIC, native_skey,
+      &native_skey_len, native_pkey, &native_pkey_len);
+  falcon_keygen_free(fk);
+  if (r != 1)
+    return 0;
+  falcon_expanded_key_free(native_ek);
+  native_ek = falcon_expanded_key_new(native_skey, native_skey_len);
+  return native_ek != NULL;
+}
+
+static int native_sign(struct workload *w)
+{
+  if (native_ek == NULL)
+    return 0;
+  falcon_sign *fs = falcon_sign_new();
+  if (fs == NULL)
+    return 0;
+  if (!falcon_sign_set_expanded_key(fs, native_ek)
+      || !falcon_sign_start(fs, w->nonce)) {
+    falcon_sign_free(fs);
+    return 0;
+  }
+  falcon_sign_update(fs, w->msg, w->msg_len);
+  w->sig_len = falcon_sign_generate(fs, w->sig, MAX_SIG_LEN,
+      FALCON_COMP_STATIC);
+  falcon_sign_free(fs);
+  return w->sig_len != 0;
+}
+
+static int native_verify(struct workload *w)
+{
+  falcon_vrfy *fv = falcon_vrfy_new();
+  if (fv == NULL)
+    return 0;
+  if (!falcon_vrfy_set_public_key(fv, native_pkey, native_pkey_len)) {
+    falcon_vrfy_free(fv);
+    return 0;
+  }
+  falcon_vrfy_start(fv, w->nonce, NONCE_LEN);
+  falcon_vrfy_update(fv, w->msg, w->msg_len);
+  int r = falcon_vrfy_verify(fv, w->sig, w->sig_len);
+  falcon_vrfy_free(fv);
+  return r == 1;
+}
+
+/*
+ * Verifier context kept across calls, as a gateway would, for the
+ * cached path.
+ */
+static falcon_vrfy *cached_fv = NULL;
+static uint8_t native_key_id[VRFYCACHE_KEY_ID_LEN];
+
+static int native_verify_cached(struct workload *w)
+{
+  return vrfycache_verify(cached_fv, native_key_id, w->nonce, w->sig,
+      w->sig_len, w->msg, w->msg_len) == 1;
+}
+
+static int enclave_keygen(struct workload *w)
+{
+  sgx_status_t retval;
+  sgx_status_t r = ecall("keygen", trust_falcon_keygen, global_eid, &retval,
+      w->logn);
+  return r == SGX_SUCCESS && retval == SGX_SUCCESS;
+}
+
+static int enclave_sign(struct workload *w)
+{
+  sgx_status_t retval;
+  sgx_status_t r = ecall("sign", trust_falcon_sign, global_eid, &retval,
+      w->sig, &w->sig_len, w->nonce, w->msg, w->msg_len);
+  return r == SGX_SUCCESS && retval == SGX_SUCCESS;
+}
+
+static int enclave_verify(struct workload *w)
+{
+  sgx_status_t retval;
+  int valid = 0;
+  sgx_status_t r = ecall("verify", trust_falcon_verify, global_eid, &retval,
+      w->sig, w->sig_len, w->nonce, w->msg, w->msg_len, &valid);
+  return r == SGX_SUCCESS && retval == SGX_SUCCESS && valid == 1;
+}
+
+/*
+ * Run 'op' repeatedly, doubling the iteration count until one round
+ * lasts at least 'min_time' seconds (same approach as speed_falcon()
+ * in sgx-falcon/test_falcon.c). Returns operations per second.
+ */
+static double ops_per_sec(bench_op op, struct workload *w, double min_time)
+{
+  long num = 1;
+  for (;;) {
+    std::chrono::steady_clock::time_point begin, end;
+
+    begin = std::chrono::steady_clock::now();
+    for (long j = 0; j < num; j++) {
+      if (!op(w)) {
+        fprintf(stderr, "benchmark operation failed\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    end = std::chrono::steady_clock::now();
+    double tt = std::chrono::duration<double>(end - begin).count();
+    if (tt < min_time) {
+      num <<= 1;
+      continue;
+    }
+    return (double) num / tt;
+  }
+}
+
+static void compare(const char *name, bench_op native, bench_op enclave,
+    struct workload *w, double min_time)
+{
+  double n = ops_per_sec(native, w, min_time);
+  double e = ops_per_sec(enclave, w, min_time);
+  printf("  %-8s %12.3f %12.3f %9.2fx\n", name, n, e, n / e);
+  fflush(stdout);
+}
+
+static void run(unsigned logn, size_t msg_len, double min_time)
+{
+  struct workload w;
+
+  w.logn = logn;
+  w.msg_len = msg_len;
+  w.msg = (uint8_t *) malloc(msg_len);
+  if (w.msg == NULL) {
+    fprintf(stderr, "memory allocation error\n");
+    exit(EXIT_FAILURE);
+  }
+  randombytes(w.msg, msg_len);
+
+  printf("logn=%u msg=%lu bytes\n", logn, (unsigned long) msg_len);
+  printf("  %-8s %12s %12s %10s\n", "op", "native/s", "enclave/s",
+      "slowdown");
+  compare("keygen", native_keygen, enclave_keygen, &w, min_time);
+
+  /*
+   * Both sides now hold a key of degree 2^logn. Signing and
+   * verification use the same message on each side.
+   */
+  compare("sign", native_sign, enclave_sign, &w, min_time);
+
+  struct workload wn = w, we = w;
+  if (!native_sign(&wn) || !enclave_sign(&we)) {
+    fprintf(stderr, "signature failure\n");
+    exit(EXIT_FAILURE);
+  }
+  double n = ops_per_sec(native_verify, &wn, min_time);
+  double e = ops_per_sec(enclave_verify, &we, min_time);
+  printf("  %-8s %12.3f %12.3f %9.2fx\n", "verify", n, e, n / e);
+
+  cached_fv = falcon_vrfy_new();
+  if (cached_fv == NULL
+      || !falcon_vrfy_set_public_key(cached_fv, native_pkey, native_pkey_len)) {
+    fprintf(stderr, "could not load the public key\n");
+    exit(EXIT_FAILURE);
+  }
+  vrfycache_key_id(native_key_id, native_pkey, native_pkey_len);
+  n = ops_per_sec(native_verify_cached, &wn, min_time);
+  printf("  %-8s %12.3f %12s %10s\n", "vrfy-hit", n, "-", "-");
+  falcon_vrfy_free(cached_fv);
+  falcon_expanded_key_free(native_ek);
+  native_ek = NULL;
+  printf("\n");
+  fflush(stdout);
+
+  free(w.msg);
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+"usage: %s [ -l logn[,logn...] ] [ -m len[,len...] ] [ -t seconds ]\n"
+"          [ -S sampler ]\n"
+"  -l   degree logs to benchmark (default: %d)\n"
+"  -m   message sizes in bytes (default: 32)\n"
+"  -t   minimum duration of each measurement (default: 2.0)\n"
+"  -S   Gaussian sampler backend on both sides: a constant-PRNG backend\n"
+"       name (see falcon.h), or 'auto' to pick the fastest one natively\n",
+      name, DEFAULT_LOGN);
+  exit(EXIT_FAILURE);
+}
+
+/*
+ * Parse a comma-separated list of unsigned values into 'out'.
+ * Returns the number of values, or 0 on a malformed list.
+ */
+static int parse_list(const char *s, unsigned long *out, int max)
+{
+  int n = 0;
+  while (*s != 0 && n < max) {
+    char *end;
+    out[n++] = strtoul(s, &end, 10);
+    if (end == s || (*end != ',' && *end != 0))
+      return 0;
+    s = (*end == ',') ? end + 1 : end;
+  }
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long lognv[10] = { DEFAULT_LOGN };
+  unsigned long msgv[16] = { 32 };
+  int nlogn = 1, nmsg = 1;
+  double min_time = 2.0;
+  const char *sampler = NULL;
+  int c;
+
+  trace_init();
+  metrics_init();
+  vrfycache_init(1024);
+  while ((c = getopt(argc, argv, "l:m:t:S:")) != -1) {
+    switch (c) {
+    case 'l':
+      nlogn = parse_list(optarg, lognv, 10);
+      break;
+    case 'm':
+      nmsg = parse_list(optarg, msgv, 16);
+      break;
+    case 't':
+      min_time = atof(optarg);
+      break;
+    case 'S':
+      sampler = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (nlogn == 0 || nmsg == 0 || min_time <= 0)
+    usage(argv[0]);
+  for (int i = 0; i < nlogn; i++)
+    if (lognv[i] < 1 || lognv[i] > 10)
+      usage(argv[0]);
+  for (int i = 0; i < nmsg; i++)
+    if (msgv[i] < 1 || msgv[i] > MAX_MSG_LEN)
+      usage(argv[0]);
+
+  sgx_status_t r = enclave_create(ENCLAVE_FILENAME, &global_eid);
+  if (r != SGX_SUCCESS)
+    return -1;
+
+  /*
+   * Both sides use the same sampler backend. Autotuning times the
+   * native library; the enclave has no clock and gets the resulting
+   * backend name. The enclave only takes constant-PRNG backends; without
+   * -S, both sides keep their compile-time default.
+   */
+  sgx_status_t retval;
+  if (sampler != NULL) {
+    if (strcmp(sampler, "auto") == 0 || strcmp(sampler, "auto-ct") == 0)
+      sampler = falcon_sampler_autotune();
+    else if (!falcon_sampler_set_default(sampler))
+      sampler = NULL;
+    if (sampler == NULL
+        || ecall("set_sampler", trust_falcon_set_sampler, global_eid,
+        &retval, sampler) != SGX_SUCCESS || retval != SGX_SUCCESS) {
+      fprintf(stderr, "could not select the sampler backend (the enclave"
+          " only accepts constant-PRNG ones)\n");
+      sgx_destroy_enclave(global_eid);
+      return -1;
+    }
+  } else {
+    sampler = falcon_sampler_get_default();
+  }
+  printf("sampler: %s\nnative kernels:", sampler);
+  for (unsigned u = 0; falcon_kernel_name(u) != NULL; u++)
+    printf(" %s=%s", falcon_kernel_name(u), falcon_kernel_variant(u));
+  printf("\n\n");
+
+  for (int i = 0; i < nlogn; i++)
+    for (int j = 0; j < nmsg; j++)
+      run((unsigned) lognv[i], (size_t) msgv[j], min_time);
+
+  sgx_destroy_enclave(global_eid);
+  return 0;
+}
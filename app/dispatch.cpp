@@ -0,0 +1,199 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dispatch.h"
+#include "enclave_u.h"
+#include "ecall.h"
+#include "metrics.h"
+#include "trace.h"
+#include "../include/boundary_types.h"
+
+static sgx_enclave_id_t enclave_id;
+static unsigned batch_max;
+static std::vector<std::thread> threads;
+
+static std::mutex queue_mu;
+static std::condition_variable queue_cv;
+static struct dispatch_req *queue_head, *queue_tail;
+static bool stopping;
+
+static std::mutex done_mu;
+static struct dispatch_req *done_head, *done_tail;
+static int done_fd = -1;
+
+static void complete(struct dispatch_req *first, struct dispatch_req *last)
+{
+  {
+    std::lock_guard<std::mutex> lk(done_mu);
+    if (done_tail != NULL)
+      done_tail->next = first;
+    else
+      done_head = first;
+    done_tail = last;
+    last->next = NULL;
+  }
+  uint64_t one = 1;
+  if (write(done_fd, &one, sizeof one) < 0)
+    perror("dispatch: eventfd write");
+}
+
+/*
+ * Sign 'n' requests (a linked list) with one ECALL. Buffers are reused
+ * from one batch to the next.
+ */
+static void run_batch(struct dispatch_req *reqs, size_t n,
+    std::vector<uint8_t> &msgs, std::vector<uint32_t> &msg_lens,
+    std::vector<uint8_t> &sigs, std::vector<uint32_t> &sig_lens,
+    std::vector<uint8_t> &nonces)
+{
+  msgs.clear();
+  msg_lens.clear();
+  for (struct dispatch_req *q = reqs; q != NULL; q = q->next) {
+    msgs.insert(msgs.end(), q->msg, q->msg + q->msg_len);
+    msg_lens.push_back((uint32_t) q->msg_len);
+  }
+  sigs.resize(n * MAX_SIG_LEN);
+  sig_lens.resize(n);
+  nonces.resize(n * NONCE_LEN);
+
+  sgx_status_t retval;
+  sgx_status_t r = ecall("sign_many", trust_falcon_sign_many, enclave_id,
+      &retval, &msgs[0], msgs.size(), &msg_lens[0], n, &sigs[0], sigs.size(),
+      &sig_lens[0], &nonces[0], nonces.size());
+  int ok = r == SGX_SUCCESS && retval == SGX_SUCCESS;
+  metrics_batch((unsigned) n);
+
+  uint64_t now = trace_now();
+  size_t i = 0;
+  for (struct dispatch_req *q = reqs; q != NULL; q = q->next, i++) {
+    q->ok = ok && sig_lens[i] != 0;
+    q->sig_len = q->ok ? sig_lens[i] : 0;
+    if (q->ok) {
+      memcpy(q->sig, &sigs[i * MAX_SIG_LEN], q->sig_len);
+      memcpy(q->nonce, &nonces[i * NONCE_LEN], NONCE_LEN);
+    }
+    metrics_op(METRICS_SIGN, q->ok, now - q->queued);
+  }
+}
+
+static void dispatcher(void)
+{
+  std::vector<uint8_t> msgs, sigs, nonces;
+  std::vector<uint32_t> msg_lens, sig_lens;
+
+  for (;;) {
+    struct dispatch_req *first, *last;
+    size_t n = 0, bytes = 0;
+    {
+      std::unique_lock<std::mutex> lk(queue_mu);
+      queue_cv.wait(lk, [] { return stopping || queue_head != NULL; });
+      if (queue_head == NULL)
+        return;
+      first = last = queue_head;
+      for (;;) {
+        bytes += last->msg_len;
+        n++;
+        struct dispatch_req *nx = last->next;
+        if (nx == NULL || n == batch_max
+            || bytes + nx->msg_len > MAX_MSG_LEN)
+          break;
+        last = nx;
+      }
+      queue_head = last->next;
+      if (queue_head == NULL)
+        queue_tail = NULL;
+      last->next = NULL;
+    }
+    metrics_queue_add(-(int64_t) n);
+    run_batch(first, n, msgs, msg_lens, sigs, sig_lens, nonces);
+    complete(first, last);
+  }
+}
+
+int dispatch_start(sgx_enclave_id_t eid, unsigned nthreads, unsigned max_batch)
+{
+  if (nthreads < 1 || max_batch < 1 || max_batch > SIGN_MANY_MAX)
+    return -1;
+  done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (done_fd < 0) {
+    perror("dispatch: eventfd");
+    return -1;
+  }
+  enclave_id = eid;
+  batch_max = max_batch;
+  stopping = false;
+  for (unsigned i = 0; i < nthreads; i++)
+    threads.push_back(std::thread(dispatcher));
+  return 0;
+}
+
+void dispatch_submit(struct dispatch_req *req)
+{
+  req->queued = trace_now();
+  req->next = NULL;
+  if (req->msg_len == 0 || req->msg_len > MAX_MSG_LEN) {
+    req->ok = 0;
+    req->sig_len = 0;
+    metrics_op(METRICS_SIGN, 0, 0);
+    complete(req, req);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(queue_mu);
+    if (queue_tail != NULL)
+      queue_tail->next = req;
+    else
+      queue_head = req;
+    queue_tail = req;
+  }
+  metrics_queue_add(1);
+  queue_cv.notify_one();
+}
+
+int dispatch_fd(void)
+{
+  return done_fd;
+}
+
+size_t dispatch_poll(void)
+{
+  uint64_t v;
+  struct dispatch_req *q;
+  size_t n = 0;
+
+  // Reset the eventfd before taking the list, so that a completion
+  // racing with us re-arms it.
+  if (read(done_fd, &v, sizeof v) < 0 && errno != EAGAIN)
+    perror("dispatch: eventfd read");
+  {
+    std::lock_guard<std::mutex> lk(done_mu);
+    q = done_head;
+    done_head = done_tail = NULL;
+  }
+  while (q != NULL) {
+    struct dispatch_req *nx = q->next;
+    q->done(q);
+    q = nx;
+    n++;
+  }
+  return n;
+}
+
+void dispatch_stop(void)
+{
+  {
+    std::lock_guard<std::mutex> lk(queue_mu);
+    stopping = true;
+  }
+  queue_cv.notify_all();
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+  threads.clear();
+}
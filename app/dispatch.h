@@ -0,0 +1,76 @@
+#ifndef _DISPATCH_H
+#define _DISPATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sgx_urts.h"
+#include "../include/boundary_types.h"
+
+/*
+ * Enclave dispatcher: asynchronous signing requests.
+ *
+ * Callers submit requests without blocking. Dispatcher threads drain
+ * the queue: each takes whatever requests are waiting, up to the batch
+ * limit, and signs them all with one trust_falcon_sign_many() ECALL.
+ * Requests therefore batch themselves under load (they pile up while
+ * an ECALL is running) and go alone when the service is idle.
+ *
+ * Completions are not delivered on the dispatcher threads. Finished
+ * requests are queued, and dispatch_fd() (an eventfd) becomes readable;
+ * the owner of the requests, typically an epoll-driven event loop,
+ * then calls dispatch_poll(), which runs the completion callbacks on
+ * its own thread. Callers thus never share data with the dispatcher
+ * threads beyond the request itself.
+ */
+struct dispatch_req;
+typedef void (*dispatch_cb)(struct dispatch_req *req);
+
+struct dispatch_req {
+  // Set by the caller; buffers must stay valid until completion.
+  const uint8_t *msg;
+  size_t msg_len;
+  uint8_t *sig;         // MAX_SIG_LEN bytes
+  uint8_t *nonce;       // NONCE_LEN bytes
+  dispatch_cb done;
+  void *arg;
+
+  // Set on completion.
+  size_t sig_len;
+  int ok;
+
+  // Private to the dispatcher.
+  uint64_t queued;
+  struct dispatch_req *next;
+};
+
+/*
+ * Start 'threads' dispatcher threads for enclave 'eid', issuing at most
+ * 'max_batch' (<= SIGN_MANY_MAX) requests per ECALL. Returns 0 on
+ * success, -1 on error.
+ */
+int dispatch_start(sgx_enclave_id_t eid, unsigned threads, unsigned max_batch);
+
+/*
+ * Queue a request. Thread-safe. Empty messages and messages longer
+ * than MAX_MSG_LEN fail (the callback still runs); a batch carries at
+ * most MAX_MSG_LEN message bytes.
+ */
+void dispatch_submit(struct dispatch_req *req);
+
+// Readable (level-triggered) while completions are pending.
+int dispatch_fd(void);
+
+/*
+ * Run the callbacks of all completed requests on the calling thread.
+ * Returns the number of requests completed. Call from one thread.
+ */
+size_t dispatch_poll(void);
+
+/*
+ * Stop the dispatcher threads once the queue is empty. Completions not
+ * yet polled stay pending.
+ */
+void dispatch_stop(void);
+
+#endif // _DISPATCH_H
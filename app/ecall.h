@@ -0,0 +1,79 @@
+#ifndef _ECALL_H
+#define _ECALL_H
+
+#include <stdio.h>
+#include "sgx_urts.h"
+#include "metrics.h"
+#include "trace.h"
+
+/*
+ * Host-to-enclave calls go through ecall(), which gives one place to
+ * observe every enclave transition:
+ *
+ *   ecall("sign", trust_falcon_sign, eid, &retval, ...);
+ *
+ * Each call is recorded as a span of category "ecall" when tracing is
+ * on (see trace.h) and counted in the ecall metrics (see metrics.h);
+ * 'name' must therefore be a string literal.
+ *
+ * USDT probes, provider "sgx_falcon" (zero cost until a tracer such as
+ * bpftrace or perf attaches to the running process):
+ *
+ *   ecall__entry(name)            before entering the enclave
+ *   ecall__return(name, status)   after leaving it; 'status' is the
+ *                                 sgx_status_t of the transition itself
+ *
+ * e.g. bpftrace -e 'usdt:./sgx_falcon_loadgen:sgx_falcon:ecall__entry
+ *   { @start[tid] = nsecs; } ...'
+ *
+ * Probes are enabled when sys/sdt.h is available; define
+ * SGX_FALCON_USDT to 0 or 1 to override the detection.
+ */
+#ifndef SGX_FALCON_USDT
+#if defined __has_include
+#if __has_include(<sys/sdt.h>)
+#define SGX_FALCON_USDT 1
+#else
+#define SGX_FALCON_USDT 0
+#endif
+#else
+#define SGX_FALCON_USDT 0
+#endif
+#endif
+
+#if SGX_FALCON_USDT
+#include <sys/sdt.h>
+#define SGX_FALCON_PROBE1(name, a) DTRACE_PROBE1(sgx_falcon, name, a)
+#define SGX_FALCON_PROBE2(name, a, b) DTRACE_PROBE2(sgx_falcon, name, a, b)
+#else
+#define SGX_FALCON_PROBE1(name, a) ((void) 0)
+#define SGX_FALCON_PROBE2(name, a, b) ((void) 0)
+#endif
+
+template <typename F, typename... Args>
+inline sgx_status_t ecall(const char *name, F fn, Args... args)
+{
+  trace_span span(name, "ecall");
+  SGX_FALCON_PROBE1(ecall__entry, name);
+  sgx_status_t r = fn(args...);
+  SGX_FALCON_PROBE2(ecall__return, name, (int) r);
+  metrics_ecall(name, r == SGX_SUCCESS);
+  return r;
+}
+
+#define ENCLAVE_FILENAME "enclave.signed.so"
+
+/*
+ * Load an enclave (debug mode, no launch token); reports a failure on
+ * stderr.
+ */
+inline sgx_status_t enclave_create(const char *file, sgx_enclave_id_t *eid)
+{
+  sgx_status_t r = sgx_create_enclave(file, SGX_DEBUG_FLAG, NULL, NULL, eid,
+      NULL);
+  if (r != SGX_SUCCESS)
+    fprintf(stderr, "failed to create enclave: 0x%x\n", (unsigned) r);
+  return r;
+}
+
+#endif // _ECALL_H
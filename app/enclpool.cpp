@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "enclpool.h"
+#include "enclave_u.h"
+#include "ecall.h"
+#include "metrics.h"
+#include "../include/boundary_types.h"
+
+struct pool_enclave {
+  sgx_enclave_id_t eid;
+  int key;              // -1: none yet
+  unsigned inflight;
+  unsigned gen;         // bumped by each restart
+  bool restarting;
+  bool dead;            // restart failed
+};
+
+struct pool_key {
+  std::vector<unsigned> replicas;
+  std::vector<uint8_t> sealed;
+};
+
+static std::string enclave_file;
+static unsigned tcs_max;
+static std::vector<struct pool_enclave> enclaves;
+static std::vector<struct pool_key> keys;
+
+static std::mutex mu;
+static std::condition_variable cv;    // a slot freed or a restart done
+static unsigned waiting;
+static uint64_t restarts;
+
+static sgx_status_t create(sgx_enclave_id_t *eid)
+{
+  return enclave_create(enclave_file.c_str(), eid);
+}
+
+static int import_key(sgx_enclave_id_t eid, std::vector<uint8_t> &blob)
+{
+  sgx_status_t retval;
+  sgx_status_t r = ecall("import_key", trust_falcon_import_key, eid, &retval,
+      &blob[0], blob.size());
+  return r == SGX_SUCCESS && retval == SGX_SUCCESS;
+}
+
+int enclpool_start(const char *file, unsigned n, unsigned tcs)
+{
+  if (n < 1 || tcs < 1)
+    return -1;
+  enclave_file = file;
+  tcs_max = tcs;
+  for (unsigned i = 0; i < n; i++) {
+    struct pool_enclave e;
+    if (create(&e.eid) != SGX_SUCCESS) {
+      enclpool_stop();
+      return -1;
+    }
+    e.key = -1;
+    e.inflight = 0;
+    e.gen = 0;
+    e.restarting = false;
+    e.dead = false;
+    enclaves.push_back(e);
+  }
+  restarts = 0;
+  return 0;
+}
+
+int enclpool_add_key(unsigned logn, unsigned replicas)
+{
+  struct pool_key k;
+  sgx_status_t r, retval;
+
+  for (unsigned i = 0; i < enclaves.size() && k.replicas.size() < replicas;
+      i++)
+    if (enclaves[i].key < 0)
+      k.replicas.push_back(i);
+  if (replicas < 1 || k.replicas.size() < replicas)
+    return -1;
+
+  sgx_enclave_id_t first = enclaves[k.replicas[0]].eid;
+  r = ecall("keygen", trust_falcon_keygen, first, &retval, logn);
+  if (r != SGX_SUCCESS || retval != SGX_SUCCESS)
+    return -1;
+  size_t len = 0;
+  k.sealed.resize(SEALED_KEY_MAX);
+  r = ecall("export_key", trust_falcon_export_key, first, &retval,
+      &k.sealed[0], k.sealed.size(), &len);
+  if (r != SGX_SUCCESS || retval != SGX_SUCCESS)
+    return -1;
+  k.sealed.resize(len);
+  for (size_t i = 1; i < k.replicas.size(); i++)
+    if (!import_key(enclaves[k.replicas[i]].eid, k.sealed))
+      return -1;
+
+  int id = (int) keys.size();
+  for (size_t i = 0; i < k.replicas.size(); i++)
+    enclaves[k.replicas[i]].key = id;
+  keys.push_back(k);
+  return id;
+}
+
+/*
+ * Restart enclave 'idx' after a loss. Called, and returns, with 'lk'
+ * held; drops it while the enclave is rebuilt.
+ */
+static void restart(std::unique_lock<std::mutex> &lk, unsigned idx)
+{
+  struct pool_enclave &e = enclaves[idx];
+
+  e.restarting = true;
+  waiting++;
+  cv.wait(lk, [&e] { return e.inflight == 0; });
+  waiting--;
+  sgx_enclave_id_t old = e.eid;
+  lk.unlock();
+
+  sgx_destroy_enclave(old);
+  sgx_enclave_id_t eid;
+  bool ok = create(&eid) == SGX_SUCCESS;
+  if (ok && !import_key(eid, keys[e.key].sealed)) {
+    sgx_destroy_enclave(eid);
+    ok = false;
+  }
+  if (!ok)
+    fprintf(stderr, "enclave %u could not be restarted\n", idx);
+
+  lk.lock();
+  if (ok)
+    e.eid = eid;
+  else
+    e.dead = true;
+  e.gen++;
+  e.restarting = false;
+  restarts++;
+  cv.notify_all();
+}
+
+sgx_status_t enclpool_call(int key, enclpool_fn fn, void *arg)
+{
+  if (key < 0 || (size_t) key >= keys.size())
+    return SGX_ERROR_INVALID_PARAMETER;
+  const std::vector<unsigned> &replicas = keys[key].replicas;
+  sgx_status_t r = SGX_ERROR_ENCLAVE_LOST;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (attempt > 0)
+      metrics_sign_retry();
+
+    std::unique_lock<std::mutex> lk(mu);
+    int best;
+    for (;;) {
+      bool alive = false;
+      best = -1;
+      for (size_t i = 0; i < replicas.size(); i++) {
+        const struct pool_enclave &e = enclaves[replicas[i]];
+        if (e.dead)
+          continue;
+        alive = true;
+        if (e.restarting || e.inflight >= tcs_max)
+          continue;
+        if (best < 0 || e.inflight < enclaves[best].inflight)
+          best = (int) replicas[i];
+      }
+      if (best >= 0 || !alive)
+        break;
+      waiting++;
+      cv.wait(lk);
+      waiting--;
+    }
+    if (best < 0)
+      return SGX_ERROR_ENCLAVE_LOST;
+    struct pool_enclave &e = enclaves[best];
+    e.inflight++;
+    sgx_enclave_id_t eid = e.eid;
+    unsigned gen = e.gen;
+    lk.unlock();
+
+    r = fn(eid, arg);
+
+    lk.lock();
+    e.inflight--;
+    if (waiting > 0)
+      cv.notify_all();
+    if (r != SGX_ERROR_ENCLAVE_LOST && r != SGX_ERROR_ENCLAVE_CRASHED)
+      return r;
+    // The first caller to see the loss restarts the enclave; the
+    // others only retry.
+    if (e.gen == gen && !e.restarting)
+      restart(lk, (unsigned) best);
+  }
+  return r;
+}
+
+struct sign_args {
+  const uint8_t *msg;
+  size_t msg_len;
+  uint8_t *sig;
+  size_t *sig_len;
+  uint8_t *nonce;
+  sgx_status_t retval;
+};
+
+static sgx_status_t sign_on(sgx_enclave_id_t eid, void *arg)
+{
+  struct sign_args *a = (struct sign_args *) arg;
+  return ecall("sign", trust_falcon_sign, eid, &a->retval, a->sig, a->sig_len,
+      a->nonce, (uint8_t *) a->msg, a->msg_len);
+}
+
+int enclpool_sign(int key, const uint8_t *msg, size_t msg_len, uint8_t *sig,
+    size_t *sig_len, uint8_t *nonce)
+{
+  struct sign_args a = { msg, msg_len, sig, sig_len, nonce, SGX_SUCCESS };
+  sgx_status_t r = enclpool_call(key, sign_on, &a);
+  return r == SGX_SUCCESS && a.retval == SGX_SUCCESS;
+}
+
+unsigned enclpool_size(void)
+{
+  return (unsigned) enclaves.size();
+}
+
+uint64_t enclpool_restarts(void)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  return restarts;
+}
+
+void enclpool_stop(void)
+{
+  for (size_t i = 0; i < enclaves.size(); i++)
+    if (!enclaves[i].dead)
+      sgx_destroy_enclave(enclaves[i].eid);
+  enclaves.clear();
+  keys.clear();
+}
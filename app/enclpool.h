@@ -0,0 +1,66 @@
+#ifndef _ENCLPOOL_H
+#define _ENCLPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sgx_urts.h"
+
+/*
+ * Enclave pool: several instances of the same enclave in one process.
+ *
+ * One enclave caps throughput with its TCS count (concurrent ECALLs)
+ * and its heap; the pool multiplies both. An enclave holds one key
+ * pair, so a key lives on one or more enclaves, its replicas: it is
+ * generated in the first, exported sealed to that enclave build
+ * (trust_falcon_export_key()) and imported into the others. A hot key
+ * gets many replicas; cold keys can get one each.
+ *
+ * Calls for a key go to the replica with the fewest calls in flight,
+ * with at most 'tcs' in flight per enclave; callers wait while all
+ * replicas are full.
+ *
+ * An enclave whose call fails with SGX_ERROR_ENCLAVE_LOST or
+ * SGX_ERROR_ENCLAVE_CRASHED (e.g. after a power transition, which wipes
+ * the EPC) is restarted alone: once its calls in flight have returned,
+ * it is destroyed, created again and given back its key from the sealed
+ * copy kept by the host. Other replicas keep serving meanwhile, and the
+ * failed call is retried once (counted as a sign retry in metrics.h).
+ * An enclave that cannot be restarted is left out from then on.
+ */
+
+/*
+ * Create 'enclaves' instances of the enclave in 'file', each taking at
+ * most 'tcs' concurrent calls (TCSNum in its configuration). Returns 0
+ * on success, -1 on error.
+ */
+int enclpool_start(const char *file, unsigned enclaves, unsigned tcs);
+
+/*
+ * Generate a key of degree 2^logn on 'replicas' enclaves that do not
+ * hold one yet. Returns the key handle (0, 1, ...), or -1 on error.
+ * Call before the first enclpool_call(); not thread-safe.
+ */
+int enclpool_add_key(unsigned logn, unsigned replicas);
+
+/*
+ * Run 'fn' on an enclave holding key 'key'. 'fn' makes the ECALL and
+ * returns the status of the transition; the ECALL's own return value
+ * goes through 'arg'. Returns the status of the last attempt.
+ * Thread-safe.
+ */
+typedef sgx_status_t (*enclpool_fn)(sgx_enclave_id_t eid, void *arg);
+sgx_status_t enclpool_call(int key, enclpool_fn fn, void *arg);
+
+// trust_falcon_sign() with key 'key'; 1 on success, 0 on error.
+int enclpool_sign(int key, const uint8_t *msg, size_t msg_len, uint8_t *sig,
+    size_t *sig_len, uint8_t *nonce);
+
+// Enclaves in the pool, and restarts since enclpool_start().
+unsigned enclpool_size(void);
+uint64_t enclpool_restarts(void);
+
+// Destroy all enclaves; no call may be in progress.
+void enclpool_stop(void);
+
+#endif // _ENCLPOOL_H
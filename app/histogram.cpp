@@ -0,0 +1,132 @@
+#include <string.h>
+
+#include "histogram.h"
+
+#define HIST_HALF (HIST_SUB_BUCKETS / 2)
+
+static unsigned bucket_index(uint64_t v)
+{
+  if (v < HIST_SUB_BUCKETS)
+    return (unsigned) v;
+  if (v >> HIST_MAX_LOG)
+    return HIST_NUM_BUCKETS - 1;
+
+  // Group g >= 1 covers [2^(SUB_BITS+g-1), 2^(SUB_BITS+g)) in steps of 2^g.
+  unsigned e = 63 - __builtin_clzll(v);
+  unsigned g = e - HIST_SUB_BITS + 1;
+  unsigned sub = (unsigned) (v >> g);
+  return HIST_SUB_BUCKETS + (g - 1) * HIST_HALF + (sub - HIST_HALF);
+}
+
+// Highest value that maps to bucket 'i'.
+static uint64_t bucket_value(unsigned i)
+{
+  if (i < HIST_SUB_BUCKETS)
+    return i;
+  unsigned g = (i - HIST_SUB_BUCKETS) / HIST_HALF + 1;
+  uint64_t sub = (i - HIST_SUB_BUCKETS) % HIST_HALF + HIST_HALF;
+  return ((sub + 1) << g) - 1;
+}
+
+void hist_init(struct histogram *h)
+{
+  memset(h->counts, 0, sizeof h->counts);
+  h->total = 0;
+  h->min = UINT64_MAX;
+  h->max = 0;
+  h->sum = 0;
+}
+
+void hist_record(struct histogram *h, uint64_t value)
+{
+  h->counts[bucket_index(value)]++;
+  h->total++;
+  h->sum += (double) value;
+  if (value < h->min)
+    h->min = value;
+  if (value > h->max)
+    h->max = value;
+}
+
+void hist_merge(struct histogram *dst, const struct histogram *src)
+{
+  for (unsigned i = 0; i < HIST_NUM_BUCKETS; i++)
+    dst->counts[i] += src->counts[i];
+  dst->total += src->total;
+  dst->sum += src->sum;
+  if (src->min < dst->min)
+    dst->min = src->min;
+  if (src->max > dst->max)
+    dst->max = src->max;
+}
+
+uint64_t hist_percentile(const struct histogram *h, double pct)
+{
+  if (h->total == 0)
+    return 0;
+  if (pct >= 100.0)
+    return h->max;
+
+  uint64_t rank = (uint64_t) (pct / 100.0 * (double) h->total + 0.5);
+  if (rank == 0)
+    rank = 1;
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < HIST_NUM_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= rank) {
+      uint64_t v = bucket_value(i);
+      return v < h->max ? v : h->max;
+    }
+  }
+  return h->max;
+}
+
+double hist_mean(const struct histogram *h)
+{
+  return h->total == 0 ? 0.0 : h->sum / (double) h->total;
+}
+
+void hist_print_summary(FILE *f, const struct histogram *h, double scale)
+{
+  if (h->total == 0) {
+    fprintf(f, "no samples\n");
+    return;
+  }
+  fprintf(f, "min %.1f  mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  "
+      "p99.9 %.1f  p99.99 %.1f  max %.1f\n",
+      (double) h->min / scale, hist_mean(h) / scale,
+      (double) hist_percentile(h, 50.0) / scale,
+      (double) hist_percentile(h, 90.0) / scale,
+      (double) hist_percentile(h, 99.0) / scale,
+      (double) hist_percentile(h, 99.9) / scale,
+      (double) hist_percentile(h, 99.99) / scale,
+      (double) h->max / scale);
+}
+
+void hist_print_distribution(FILE *f, const struct histogram *h,
+    double scale)
+{
+  fprintf(f, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount",
+      "1/(1-Percentile)");
+
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < HIST_NUM_BUCKETS; i++) {
+    if (h->counts[i] == 0)
+      continue;
+    seen += h->counts[i];
+    double q = (double) seen / (double) h->total;
+    uint64_t v = bucket_value(i);
+    if (v > h->max)
+      v = h->max;
+    if (seen < h->total)
+      fprintf(f, "%12.3f %14.12f %10llu %14.2f\n", (double) v / scale, q,
+          (unsigned long long) seen, 1.0 / (1.0 - q));
+    else
+      fprintf(f, "%12.3f %14.12f %10llu %14s\n", (double) v / scale, q,
+          (unsigned long long) seen, "inf");
+  }
+  fprintf(f, "#[Mean    = %12.3f, StdDeviation   = %12s]\n",
+      hist_mean(h) / scale, "n/a");
+  fprintf(f, "#[Max     = %12.3f, Total count    = %12llu]\n",
+      (double) h->max / scale, (unsigned long long) h->total);
+}
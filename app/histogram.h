@@ -0,0 +1,60 @@
+#ifndef _HISTOGRAM_H
+#define _HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Log-linear latency histogram in the style of HdrHistogram.
+ *
+ * Values below HIST_SUB_BUCKETS are counted exactly. Above that, each
+ * power of two is split into HIST_SUB_BUCKETS/2 linear sub-buckets,
+ * which bounds the relative error of a recorded value to
+ * 2/HIST_SUB_BUCKETS (under 2% with the default settings). Values of
+ * 2^HIST_MAX_LOG and more are clamped into the last bucket.
+ *
+ * A histogram is not thread-safe; record into one histogram per thread
+ * and merge them with hist_merge() once the threads are done.
+ */
+#define HIST_SUB_BITS 7
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_MAX_LOG 40
+#define HIST_NUM_BUCKETS \
+  (HIST_SUB_BUCKETS + (HIST_MAX_LOG - HIST_SUB_BITS) * (HIST_SUB_BUCKETS / 2))
+
+struct histogram {
+  uint64_t counts[HIST_NUM_BUCKETS];
+  uint64_t total;
+  uint64_t min;
+  uint64_t max;
+  double sum;
+};
+
+void hist_init(struct histogram *h);
+void hist_record(struct histogram *h, uint64_t value);
+void hist_merge(struct histogram *dst, const struct histogram *src);
+
+/*
+ * Value at the given percentile (0 to 100). Returns 0 for an empty
+ * histogram.
+ */
+uint64_t hist_percentile(const struct histogram *h, double pct);
+
+double hist_mean(const struct histogram *h);
+
+/*
+ * Print a one-line summary (min, mean, p50, p90, p99, p99.9, p99.99,
+ * max), with values divided by 'scale' (e.g. 1000 for microseconds).
+ */
+void hist_print_summary(FILE *f, const struct histogram *h, double scale);
+
+/*
+ * Print the percentile distribution in the HdrHistogram text format
+ * (Value, Percentile, TotalCount, 1/(1-Percentile)), with values
+ * divided by 'scale'. The output can be fed to the HdrHistogram
+ * plotter.
+ */
+void hist_print_distribution(FILE *f, const struct histogram *h,
+    double scale);
+
+#endif // _HISTOGRAM_H
@@ -0,0 +1,577 @@
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "keystore.h"
+
+/*
+ * File layout, in host byte order (sealed keys only unseal on the CPU
+ * that sealed them anyway):
+ *
+ *   page 0              struct ks_header
+ *   pages 1 ..          index: 'buckets' struct ks_bucket, linear probing
+ *   records_start() ..  records, each a struct ks_record, the sealed pair
+ *                       and the public key, padded to a page multiple
+ */
+#define KS_PAGE 4096
+#define KS_MAGIC "SFKSTOR1"
+#define KS_VERSION 1
+#define KS_REC_MAGIC 0x4b524653u
+#define KS_MIN_BUCKETS 1024
+// Compaction for space only once there are this many dead records.
+#define KS_MIN_DEAD 256
+
+// Bucket offsets below the first record: a free bucket ends a probe,
+// a removed one does not.
+#define KS_FREE 0
+#define KS_REMOVED 1
+
+#define KS_REC_TOMBSTONE 1
+
+struct ks_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t page;
+  uint64_t buckets;     // a power of two
+  uint64_t tail;        // end of the last committed record
+  uint64_t live;        // keys
+  uint64_t dead;        // superseded records and tombstones
+  uint64_t used;        // buckets not free
+};
+
+struct ks_bucket {
+  uint64_t id;
+  uint64_t off;
+};
+
+struct ks_record {
+  uint32_t magic;
+  uint32_t flags;
+  uint64_t id;
+  uint64_t created;     // seconds since the epoch
+  uint32_t logn;
+  uint32_t sealed_len;
+  uint32_t pkey_len;
+  uint32_t crc;         // CRC-32 of the record, with this field 0
+};
+
+static std::mutex mu;
+static std::string store_path;
+static int fd = -1;
+static const uint8_t *map;
+static size_t map_len;
+static struct ks_header hdr;
+
+static uint64_t page_round(uint64_t n)
+{
+  return (n + KS_PAGE - 1) & ~(uint64_t) (KS_PAGE - 1);
+}
+
+static uint64_t records_start(uint64_t buckets)
+{
+  return KS_PAGE + page_round(buckets * sizeof(struct ks_bucket));
+}
+
+static uint64_t record_size(const struct ks_record *r)
+{
+  return page_round(sizeof *r + (uint64_t) r->sealed_len + r->pkey_len);
+}
+
+static uint64_t hash_id(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+static uint32_t crc32(const uint8_t *p, size_t len, uint32_t crc)
+{
+  crc = ~crc;
+  while (len-- > 0) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; k++)
+      crc = (crc >> 1) ^ (0xedb88320u & -(crc & 1));
+  }
+  return ~crc;
+}
+
+static uint32_t record_crc(const uint8_t *rec)
+{
+  struct ks_record r;
+  memcpy(&r, rec, sizeof r);
+  r.crc = 0;
+  uint32_t crc = crc32((const uint8_t *) &r, sizeof r, 0);
+  return crc32(rec + sizeof r, (size_t) r.sealed_len + r.pkey_len, crc);
+}
+
+static int write_at(int f, const void *buf, size_t len, uint64_t off)
+{
+  const uint8_t *p = (const uint8_t *) buf;
+  while (len > 0) {
+    ssize_t n = pwrite(f, p, len, (off_t) off);
+    if (n <= 0)
+      return -1;
+    p += n;
+    len -= (size_t) n;
+    off += (uint64_t) n;
+  }
+  return 0;
+}
+
+static int sync_dir(const std::string &path)
+{
+  std::vector<char> buf(path.begin(), path.end());
+  buf.push_back('\0');
+  int d = open(dirname(&buf[0]), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (d < 0)
+    return -1;
+  int r = fsync(d);
+  close(d);
+  return r;
+}
+
+/*
+ * Map at least the first 'len' bytes. The mapping is made larger than
+ * the file, in powers of two, so that appends seldom need a new one;
+ * only the part below the tail is ever read.
+ */
+static int remap(uint64_t len)
+{
+  if (map != NULL && len <= map_len)
+    return 0;
+  size_t n = 1 << 20;
+  while (n < len)
+    n <<= 1;
+  if (map != NULL)
+    munmap((void *) map, map_len);
+  void *m = mmap(NULL, n, PROT_READ, MAP_SHARED, fd, 0);
+  if (m == MAP_FAILED) {
+    map = NULL;
+    map_len = 0;
+    return -1;
+  }
+  map = (const uint8_t *) m;
+  map_len = n;
+  return 0;
+}
+
+static const struct ks_bucket *bucket(uint64_t i)
+{
+  return (const struct ks_bucket *) (map + KS_PAGE) + i;
+}
+
+/*
+ * Look up 'id': returns its bucket, or -1 if absent; '*slot' is the
+ * bucket where a new entry for 'id' would go.
+ */
+static int64_t find(uint64_t id, uint64_t *slot)
+{
+  uint64_t mask = hdr.buckets - 1;
+  bool have_slot = false;
+
+  for (uint64_t i = hash_id(id) & mask;; i = (i + 1) & mask) {
+    const struct ks_bucket *b = bucket(i);
+    if (b->off == KS_FREE) {
+      if (!have_slot)
+        *slot = i;
+      return -1;
+    }
+    if (b->off == KS_REMOVED) {
+      if (!have_slot) {
+        *slot = i;
+        have_slot = true;
+      }
+    } else if (b->id == id) {
+      *slot = i;
+      return (int64_t) i;
+    }
+  }
+}
+
+static const struct ks_record *lookup(uint64_t id)
+{
+  uint64_t slot;
+  if (fd < 0)
+    return NULL;
+  int64_t i = find(id, &slot);
+  if (i < 0)
+    return NULL;
+  uint64_t off = bucket((uint64_t) i)->off;
+  if (off < records_start(hdr.buckets)
+      || off + sizeof(struct ks_record) > hdr.tail)
+    return NULL;
+  const struct ks_record *r = (const struct ks_record *) (map + off);
+  if (r->magic != KS_REC_MAGIC || r->id != id
+      || off + record_size(r) > hdr.tail)
+    return NULL;
+  return r;
+}
+
+static void close_locked(void)
+{
+  if (map != NULL)
+    munmap((void *) map, map_len);
+  map = NULL;
+  map_len = 0;
+  if (fd >= 0)
+    close(fd);
+  fd = -1;
+}
+
+/*
+ * Append record 'rec' and point bucket 'slot' at 'off' (the record, or
+ * KS_REMOVED), then commit by writing the header 'h'. Each step is
+ * synced before the next one starts: a bucket on disk never points at a
+ * record that is not, and a header never covers one. A crash after the
+ * bucket write leaves a bucket past the tail, which open_locked()
+ * repairs from the records.
+ */
+static int commit(const std::vector<uint8_t> &rec, uint64_t slot,
+    uint64_t id, uint64_t off, struct ks_header *h)
+{
+  struct ks_bucket b = { id, off };
+  h->tail = hdr.tail + rec.size();
+  if (write_at(fd, &rec[0], rec.size(), hdr.tail) != 0
+      || fdatasync(fd) != 0
+      || write_at(fd, &b, sizeof b, KS_PAGE + slot * sizeof b) != 0
+      || fdatasync(fd) != 0 || write_at(fd, h, sizeof *h, 0) != 0
+      || fdatasync(fd) != 0 || remap(h->tail) != 0) {
+    // The index may point past the tail now; reopening recovers.
+    fprintf(stderr, "key store: write failed, store closed\n");
+    close_locked();
+    return -1;
+  }
+  hdr = *h;
+  return 0;
+}
+
+static int open_locked(void);
+
+/*
+ * Rewrite the store with only its live records and an index of
+ * 'buckets' entries, then replace the file.
+ */
+static int compact_locked(uint64_t buckets)
+{
+  std::string tmp = store_path + ".tmp";
+  int t = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (t < 0)
+    return -1;
+
+  struct ks_header h = hdr;
+  h.buckets = buckets;
+  h.tail = records_start(buckets);
+  h.live = h.dead = h.used = 0;
+  std::vector<struct ks_bucket> index(buckets);
+  int r = 0;
+  for (uint64_t i = 0; i < hdr.buckets && r == 0; i++) {
+    const struct ks_bucket *b = bucket(i);
+    if (b->off == KS_FREE || b->off == KS_REMOVED)
+      continue;
+    const struct ks_record *rec = (const struct ks_record *) (map + b->off);
+    uint64_t j = hash_id(b->id) & (buckets - 1);
+    while (index[j].off != KS_FREE)
+      j = (j + 1) & (buckets - 1);
+    index[j].id = b->id;
+    index[j].off = h.tail;
+    r = write_at(t, rec, record_size(rec), h.tail);
+    h.tail += record_size(rec);
+    h.live++;
+    h.used++;
+  }
+  if (r == 0)
+    r = write_at(t, &index[0], buckets * sizeof index[0], KS_PAGE);
+  if (r == 0)
+    r = write_at(t, &h, sizeof h, 0);
+  if (r == 0)
+    r = ftruncate(t, (off_t) h.tail);
+  if (r == 0)
+    r = fsync(t);
+  close(t);
+  if (r != 0 || rename(tmp.c_str(), store_path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return -1;
+  }
+  sync_dir(store_path);
+  close_locked();
+  return open_locked();
+}
+
+/*
+ * A write was interrupted: the file is longer than its header says, or
+ * the index points past the tail. Rebuild the index from the records up
+ * to the first torn one, and cut the file there.
+ */
+static int recover(uint64_t size)
+{
+  std::vector<struct ks_bucket> index(hdr.buckets);
+  uint64_t mask = hdr.buckets - 1;
+  struct ks_header h = hdr;
+  uint64_t off = records_start(hdr.buckets);
+
+  uint64_t records = 0;
+  h.live = h.used = 0;
+  while (off + sizeof(struct ks_record) <= size) {
+    const struct ks_record *r = (const struct ks_record *) (map + off);
+    if (r->magic != KS_REC_MAGIC || r->sealed_len > size
+        || r->pkey_len > size || off + record_size(r) > size
+        || record_crc(map + off) != r->crc)
+      break;
+    uint64_t j = hash_id(r->id) & mask, slot = hdr.buckets;
+    for (; index[j].off != KS_FREE; j = (j + 1) & mask) {
+      if (index[j].off == KS_REMOVED) {
+        if (slot == hdr.buckets)
+          slot = j;
+      } else if (index[j].id == r->id) {
+        break;
+      }
+    }
+    bool present = index[j].off != KS_FREE;
+    if (r->flags & KS_REC_TOMBSTONE) {
+      if (present) {
+        index[j].off = KS_REMOVED;
+        h.live--;
+      }
+    } else if (present) {
+      index[j].off = off;
+    } else {
+      if (slot == hdr.buckets) {
+        if (2 * (h.used + 1) > hdr.buckets)
+          return -1;
+        slot = j;
+        h.used++;
+      }
+      index[slot].id = r->id;
+      index[slot].off = off;
+      h.live++;
+    }
+    records++;
+    off += record_size(r);
+  }
+  h.dead = records - h.live;
+  h.tail = off;
+  fprintf(stderr, "key store: recovered %llu keys, dropped %llu bytes\n",
+      (unsigned long long) h.live, (unsigned long long) (size - off));
+
+  if (write_at(fd, &index[0], index.size() * sizeof index[0], KS_PAGE) != 0
+      || fdatasync(fd) != 0 || write_at(fd, &h, sizeof h, 0) != 0
+      || ftruncate(fd, (off_t) h.tail) != 0 || fsync(fd) != 0)
+    return -1;
+  hdr = h;
+  return 0;
+}
+
+// Whether every bucket in use points at a record below the tail.
+static bool index_in_tail(void)
+{
+  uint64_t start = records_start(hdr.buckets);
+  for (uint64_t i = 0; i < hdr.buckets; i++) {
+    uint64_t off = bucket(i)->off;
+    if (off != KS_FREE && off != KS_REMOVED
+        && (off < start || off + sizeof(struct ks_record) > hdr.tail))
+      return false;
+  }
+  return true;
+}
+
+static int open_locked(void)
+{
+  struct stat st;
+
+  fd = open(store_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    close_locked();
+    return -1;
+  }
+  uint64_t size = (uint64_t) st.st_size;
+  if (size == 0) {
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, KS_MAGIC, sizeof hdr.magic);
+    hdr.version = KS_VERSION;
+    hdr.page = KS_PAGE;
+    hdr.buckets = KS_MIN_BUCKETS;
+    hdr.tail = records_start(hdr.buckets);
+    size = hdr.tail;
+    if (ftruncate(fd, (off_t) size) != 0
+        || write_at(fd, &hdr, sizeof hdr, 0) != 0 || fsync(fd) != 0
+        || sync_dir(store_path) != 0) {
+      close_locked();
+      return -1;
+    }
+  } else if (pread(fd, &hdr, sizeof hdr, 0) != (ssize_t) sizeof hdr
+      || memcmp(hdr.magic, KS_MAGIC, sizeof hdr.magic) != 0
+      || hdr.version != KS_VERSION || hdr.page != KS_PAGE
+      || hdr.buckets < KS_MIN_BUCKETS
+      || (hdr.buckets & (hdr.buckets - 1)) != 0
+      || hdr.tail < records_start(hdr.buckets) || hdr.tail > size) {
+    fprintf(stderr, "key store: '%s' is not a valid store\n",
+        store_path.c_str());
+    close_locked();
+    return -1;
+  }
+  if (remap(size) != 0
+      || ((size != hdr.tail || !index_in_tail()) && recover(size) != 0)) {
+    close_locked();
+    return -1;
+  }
+  return 0;
+}
+
+int keystore_open(const char *path)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  if (fd >= 0)
+    return -1;
+  store_path = path;
+  return open_locked();
+}
+
+// Index size for 'keys' keys: at most a quarter full.
+static uint64_t index_size(uint64_t keys)
+{
+  uint64_t n = KS_MIN_BUCKETS;
+  while (n < 4 * keys)
+    n <<= 1;
+  return n;
+}
+
+// Compact once dead records outnumber live ones; the write that
+// triggers it is committed either way.
+static void reclaim(void)
+{
+  if (hdr.dead > hdr.live && hdr.dead >= KS_MIN_DEAD)
+    compact_locked(index_size(hdr.live));
+}
+
+int keystore_put(uint64_t id, unsigned logn, const uint8_t *sealed,
+    size_t sealed_len, const uint8_t *pkey, size_t pkey_len)
+{
+  if (sealed_len == 0 || pkey_len == 0 || sealed_len > (1u << 30)
+      || pkey_len > (1u << 30))
+    return -1;
+
+  std::lock_guard<std::mutex> lk(mu);
+  if (fd < 0)
+    return -1;
+  if (2 * (hdr.used + 1) > hdr.buckets
+      && compact_locked(index_size(hdr.live + 1)) != 0)
+    return -1;
+
+  struct ks_record r;
+  r.magic = KS_REC_MAGIC;
+  r.flags = 0;
+  r.id = id;
+  r.created = (uint64_t) time(NULL);
+  r.logn = logn;
+  r.sealed_len = (uint32_t) sealed_len;
+  r.pkey_len = (uint32_t) pkey_len;
+  r.crc = 0;
+  std::vector<uint8_t> rec(record_size(&r));
+  memcpy(&rec[sizeof r], sealed, sealed_len);
+  memcpy(&rec[sizeof r + sealed_len], pkey, pkey_len);
+  memcpy(&rec[0], &r, sizeof r);
+  r.crc = record_crc(&rec[0]);
+  memcpy(&rec[0], &r, sizeof r);
+
+  uint64_t slot;
+  bool replace = find(id, &slot) >= 0;
+  struct ks_header h = hdr;
+  if (replace) {
+    h.dead++;
+  } else {
+    h.live++;
+    if (bucket(slot)->off == KS_FREE)
+      h.used++;
+  }
+  if (commit(rec, slot, id, hdr.tail, &h) != 0)
+    return -1;
+  reclaim();
+  return 0;
+}
+
+int keystore_get_sealed(uint64_t id, uint8_t *sealed, size_t max,
+    size_t *len)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  const struct ks_record *r = lookup(id);
+  if (r == NULL || r->sealed_len > max)
+    return 0;
+  memcpy(sealed, r + 1, r->sealed_len);
+  *len = r->sealed_len;
+  return 1;
+}
+
+int keystore_get_pubkey(uint64_t id, uint8_t *pkey, size_t max,
+    size_t *len, unsigned *logn)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  const struct ks_record *r = lookup(id);
+  if (r == NULL || r->pkey_len > max)
+    return 0;
+  memcpy(pkey, (const uint8_t *) (r + 1) + r->sealed_len, r->pkey_len);
+  *len = r->pkey_len;
+  if (logn != NULL)
+    *logn = r->logn;
+  return 1;
+}
+
+int keystore_remove(uint64_t id)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  uint64_t slot;
+  if (fd < 0)
+    return -1;
+  if (find(id, &slot) < 0)
+    return 0;
+
+  struct ks_record r;
+  memset(&r, 0, sizeof r);
+  r.magic = KS_REC_MAGIC;
+  r.flags = KS_REC_TOMBSTONE;
+  r.id = id;
+  r.created = (uint64_t) time(NULL);
+  std::vector<uint8_t> rec(record_size(&r));
+  memcpy(&rec[0], &r, sizeof r);
+  r.crc = record_crc(&rec[0]);
+  memcpy(&rec[0], &r, sizeof r);
+
+  struct ks_header h = hdr;
+  h.live--;
+  h.dead += 2;
+  if (commit(rec, slot, id, KS_REMOVED, &h) != 0)
+    return -1;
+  reclaim();
+  return 1;
+}
+
+int keystore_compact(void)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  if (fd < 0)
+    return -1;
+  return compact_locked(index_size(hdr.live));
+}
+
+void keystore_stats(uint64_t *keys, uint64_t *dead, uint64_t *bytes)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  *keys = hdr.live;
+  *dead = hdr.dead;
+  *bytes = hdr.tail;
+}
+
+void keystore_close(void)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  close_locked();
+}
@@ -0,0 +1,69 @@
+#ifndef _KEYSTORE_H
+#define _KEYSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Key store file: sealed key pairs for many tenants, by 64-bit key ID.
+ *
+ * Each key is a record with the sealed pair from
+ * trust_falcon_keygen_sealed() (only this enclave build can unseal it),
+ * the public key in clear, its degree and creation time. Records start
+ * on page boundaries and are read through a shared read-only mapping of
+ * the file; an open-addressing hash index at the start of the file
+ * leads from a key ID to its record, so opening a store with tens of
+ * thousands of keys reads nothing but the header, and a lookup touches
+ * one index page and the record's pages.
+ *
+ * Writes only append: a changed key gets a new record, a removed key a
+ * tombstone record, and the index entry is repointed. The record, the
+ * index entry and then the header (which holds the end of the last
+ * committed record) are each written and synced in turn; a store found
+ * longer than its header says, or with an index entry past that end,
+ * was interrupted mid-write, and its index is rebuilt from the records,
+ * dropping a torn last one. Superseded records are
+ * dropped by compaction, which writes a new file and renames it over
+ * the old one; it also runs when the index gets half full (growing it)
+ * or when dead records outnumber live ones.
+ *
+ * One store per process. All functions are thread-safe.
+ */
+
+/*
+ * Open the store in 'path', creating it if missing. Returns 0 on
+ * success, -1 on error.
+ */
+int keystore_open(const char *path);
+
+/*
+ * Store the key 'id', replacing any previous one: degree 2^logn,
+ * 'sealed' as returned by trust_falcon_keygen_sealed(), and its public
+ * key. Durable on return. Returns 0 on success, -1 on error.
+ */
+int keystore_put(uint64_t id, unsigned logn, const uint8_t *sealed,
+    size_t sealed_len, const uint8_t *pkey, size_t pkey_len);
+
+/*
+ * Copy out the sealed pair of key 'id' (for trust_falcon_sign_sealed()).
+ * Returns 1 if found, 0 if there is no such key or 'max' is too small.
+ */
+int keystore_get_sealed(uint64_t id, uint8_t *sealed, size_t max,
+    size_t *len);
+
+// Same for the public key and degree of key 'id'.
+int keystore_get_pubkey(uint64_t id, uint8_t *pkey, size_t max,
+    size_t *len, unsigned *logn);
+
+// Remove key 'id'. Returns 1 if removed, 0 if absent, -1 on error.
+int keystore_remove(uint64_t id);
+
+// Drop superseded records now. Returns 0 on success, -1 on error.
+int keystore_compact(void);
+
+// Keys in the store, dead records, and file size in bytes.
+void keystore_stats(uint64_t *keys, uint64_t *dead, uint64_t *bytes);
+
+void keystore_close(void);
+
+#endif // _KEYSTORE_H
@@ -0,0 +1,838 @@
+/*
+ * Load generator for the signing path.
+ *
+ * Worker threads issue sign requests against a target (currently the
+ * trust_falcon_sign ECALL) in one of two modes:
+ *
+ *  - closed loop: each worker sends its next request as soon as the
+ *    previous one completes; the offered load adapts to the service
+ *    rate.
+ *
+ *  - open loop: requests arrive following a Poisson process of the
+ *    requested total rate, independently of completions. Latency is
+ *    measured from the intended send time, not from the moment a
+ *    worker got around to sending, which corrects for coordinated
+ *    omission: a stalled request also charges the requests that
+ *    should have been sent while it was stuck.
+ *
+ * With the batch target (-T batch), workers do not enter the enclave:
+ * they hand their message digest to a batcher thread, which signs the
+ * Merkle root of up to -b digests with one ECALL and returns each
+ * worker its inclusion proof (see falcon_batch_sign()). A batch is
+ * sent when full, or -w microseconds after its first request.
+ *
+ * The enclave targets run on a pool of -E enclaves (see enclpool.h)
+ * holding -K keys, each replicated on an equal share of the enclaves
+ * (the first keys take one more when -E is not a multiple of -K);
+ * every request is for a key drawn at random.
+ *
+ * With the tenant target (-T tenant), every request is for one of -t
+ * tenant keys kept sealed in the key store file -k (see keystore.h),
+ * created and filled first if needed; the host looks the sealed key up
+ * and the enclave unseals it for that one signature.
+ *
+ * With the native target (-T native), the enclave is not used: a key
+ * is generated natively and requests go to a NUMA-aware pool of pinned
+ * signing threads (see signpool.h), of -p workers.
+ *
+ * With -C, a signature cache (see sigcache.h) sits in front of the
+ * target; -u makes workers draw their messages from a small set of
+ * distinct payloads, so that some of them repeat. The cache keeps a
+ * signature and nonce per message, which is not what the batch target
+ * returns (a root signature that only verifies with the message's
+ * index and inclusion proof), so -C is refused with -T batch.
+ *
+ * Message sizes follow a configurable distribution. Latencies are
+ * collected in per-thread log-linear histograms (see histogram.h) and
+ * reported as percentiles, optionally with the full HdrHistogram-style
+ * percentile distribution.
+ */
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "enclave_u.h"
+#include "sgx_urts.h"
+#include "ecall.h"
+#include "metrics.h"
+#include "reqtrace.h"
+#include "trace.h"
+#include "histogram.h"
+#include "enclpool.h"
+#include "keystore.h"
+#include "sigcache.h"
+#include "signpool.h"
+#include "falcon.h"
+#include "../include/boundary_types.h"
+
+#define MAX_ENCLAVES 64
+// Only the batcher enters the enclave with the batch target, and
+// nothing does with the native one.
+#define MAX_BATCH_THREADS 1024
+// Leaves are copied onto the enclave heap too.
+#define MAX_BATCH 4096
+#define DEFAULT_KEYSTORE "tenants.sfks"
+
+typedef std::chrono::steady_clock lg_clock;
+
+// trace_now() also counts steady_clock nanoseconds.
+static uint64_t trace_ns(lg_clock::time_point t)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      t.time_since_epoch()).count();
+}
+
+/*
+ * A signing target. Front ends other than the bare ECALL (e.g. a
+ * daemon socket) plug in here. 'key' is the enclave pool key handle;
+ * targets with a single key ignore it.
+ */
+typedef int (*sign_fn)(int key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce);
+
+static int enclave_sign(int key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce)
+{
+  return enclpool_sign(key, msg, msg_len, sig, sig_len, nonce);
+}
+
+/*
+ * Batch target. Requests wait in 'pending' until the batcher takes
+ * them; the batcher signs the root and fills in each request's copy
+ * of the signature and its proof.
+ */
+struct batch_req {
+  uint8_t leaf[FALCON_BATCH_HASH_LEN];
+  uint8_t root[FALCON_BATCH_HASH_LEN];
+  uint8_t proof[64 * FALCON_BATCH_HASH_LEN];
+  size_t proof_len;
+  uint64_t index, count;
+  uint8_t *sig;
+  size_t *sig_len;
+  uint8_t *nonce;
+  bool done;
+  int ok;
+};
+
+static struct {
+  std::mutex mu;
+  std::condition_variable wake;     // batcher: new request or stop
+  std::condition_variable done;     // workers: batch completed
+  std::vector<struct batch_req *> pending;
+  bool stop;
+  unsigned max;
+  std::chrono::microseconds window;
+  std::mutex vrfy_mu;
+  falcon_batch_vrfy *bv;            // with -V only
+} batcher;
+
+struct batch_args {
+  const std::vector<uint8_t> *leaves;
+  uint8_t *root, *sig, *nonce;
+  size_t *sig_len;
+  sgx_status_t retval;
+};
+
+static sgx_status_t batch_on(sgx_enclave_id_t eid, void *arg)
+{
+  struct batch_args *a = (struct batch_args *) arg;
+  return ecall("sign_batch", trust_falcon_sign_batch, eid, &a->retval,
+      (uint8_t *) &(*a->leaves)[0], a->leaves->size(), a->root, a->sig,
+      a->sig_len, a->nonce);
+}
+
+static void batch_run(std::vector<struct batch_req *> &reqs)
+{
+  size_t n = reqs.size();
+  std::vector<uint8_t> leaves(n * FALCON_BATCH_HASH_LEN);
+  uint8_t root[FALCON_BATCH_HASH_LEN];
+  uint8_t sig[MAX_SIG_LEN];
+  uint8_t nonce[NONCE_LEN];
+  size_t sig_len = 0;
+
+  for (size_t i = 0; i < n; i++)
+    memcpy(&leaves[i * FALCON_BATCH_HASH_LEN], reqs[i]->leaf,
+        FALCON_BATCH_HASH_LEN);
+
+  uint64_t start = trace_now();
+  struct batch_args a = { &leaves, root, sig, nonce, &sig_len, SGX_SUCCESS };
+  sgx_status_t r = enclpool_call(0, batch_on, &a);
+  int ok = r == SGX_SUCCESS && a.retval == SGX_SUCCESS;
+  metrics_batch((unsigned) n);
+
+  falcon_batch_tree *ft = ok ? falcon_batch_tree_new(&leaves[0], n) : NULL;
+  if (ft != NULL) {
+    uint8_t tree_root[FALCON_BATCH_HASH_LEN];
+    falcon_batch_tree_root(ft, tree_root);
+    ok = memcmp(root, tree_root, sizeof root) == 0;
+  } else {
+    ok = 0;
+  }
+  for (size_t i = 0; i < n; i++) {
+    struct batch_req *q = reqs[i];
+    q->ok = ok;
+    if (!ok)
+      continue;
+    q->proof_len = sizeof q->proof;
+    falcon_batch_tree_proof(ft, i, q->proof, &q->proof_len);
+    memcpy(q->root, root, sizeof root);
+    q->index = i;
+    q->count = n;
+    memcpy(q->sig, sig, sig_len);
+    *q->sig_len = sig_len;
+    memcpy(q->nonce, nonce, NONCE_LEN);
+  }
+  falcon_batch_tree_free(ft);
+  if (trace_enabled())
+    trace_span_record("batch", "request", start, trace_now());
+}
+
+struct pubkey_args {
+  uint8_t pk[MAX_PKEY_LEN];
+  size_t pk_len;
+  sgx_status_t retval;
+};
+
+static sgx_status_t pubkey_on(sgx_enclave_id_t eid, void *arg)
+{
+  struct pubkey_args *a = (struct pubkey_args *) arg;
+  return ecall("get_pubkey", trust_falcon_get_pubkey, eid, &a->retval, a->pk,
+      sizeof a->pk, &a->pk_len);
+}
+
+static void batcher_thread()
+{
+  std::unique_lock<std::mutex> lk(batcher.mu);
+  for (;;) {
+    batcher.wake.wait(lk, [] {
+      return batcher.stop || !batcher.pending.empty(); });
+    if (batcher.pending.empty())
+      break;
+    lg_clock::time_point close = lg_clock::now() + batcher.window;
+    batcher.wake.wait_until(lk, close, [] {
+      return batcher.stop || batcher.pending.size() >= batcher.max; });
+
+    size_t n = batcher.pending.size();
+    if (n > batcher.max)
+      n = batcher.max;
+    std::vector<struct batch_req *> reqs(batcher.pending.begin(),
+        batcher.pending.begin() + n);
+    batcher.pending.erase(batcher.pending.begin(),
+        batcher.pending.begin() + n);
+    metrics_queue_add(-(int64_t) n);
+    lk.unlock();
+    batch_run(reqs);
+    lk.lock();
+    for (size_t i = 0; i < n; i++)
+      reqs[i]->done = true;
+    batcher.done.notify_all();
+  }
+}
+
+static int batch_sign(int key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce)
+{
+  struct batch_req q;
+
+  falcon_batch_leaf(q.leaf, msg, msg_len);
+  q.sig = sig;
+  q.sig_len = sig_len;
+  q.nonce = nonce;
+  q.done = false;
+  {
+    std::unique_lock<std::mutex> lk(batcher.mu);
+    batcher.pending.push_back(&q);
+    metrics_queue_add(1);
+    batcher.wake.notify_one();
+    batcher.done.wait(lk, [&q] { return q.done; });
+  }
+  if (!q.ok)
+    return 0;
+
+  // Signing is only meaningful if the proof verifies; after the first
+  // message of a batch, this only costs the proof (the root is cached).
+  if (batcher.bv != NULL) {
+    std::lock_guard<std::mutex> lk(batcher.vrfy_mu);
+    return falcon_batch_vrfy_verify(batcher.bv, msg, msg_len, q.index,
+        q.proof, q.proof_len, q.root, q.count, nonce, sig, *sig_len) == 1;
+  }
+  return 1;
+}
+
+/*
+ * Native target: generate the key outside the enclave and start the
+ * signing pool with it.
+ */
+static int native_setup(unsigned logn, unsigned workers)
+{
+  falcon_keygen *fk = falcon_keygen_new(logn, 0);
+  if (fk == NULL)
+    return -1;
+  std::vector<uint8_t> skey(falcon_keygen_max_privkey_size(fk));
+  std::vector<uint8_t> pkey(falcon_keygen_max_pubkey_size(fk));
+  size_t skey_len = skey.size(), pkey_len = pkey.size();
+  uint64_t start = trace_now();
+  reqtrace_record(start, REQTRACE_KEYSETUP, 0, logn, 0);
+  int ok = falcon_keygen_make(fk, FALCON_COMP_STATIC, &skey[0], &skey_len,
+      &pkey[0], &pkey_len) == 1;
+  metrics_op(METRICS_KEYGEN, ok, trace_now() - start);
+  falcon_keygen_free(fk);
+  if (!ok || signpool_start(&skey[0], skey_len, workers) != 0)
+    return -1;
+  signpool_describe(stdout);
+  return 0;
+}
+
+static int native_sign(int key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce)
+{
+  return signpool_sign(msg, msg_len, sig, sig_len, nonce);
+}
+
+/*
+ * Enclave targets: start the pool and spread the keys over it. The
+ * keys are recorded as requests unless the target signs with other
+ * keys (tenant).
+ */
+static int enclave_setup(unsigned logn, unsigned enclaves, unsigned nkeys,
+    bool record)
+{
+  if (enclpool_start(ENCLAVE_FILENAME, enclaves, MAX_THREADS) != 0)
+    return -1;
+  for (unsigned i = 0; i < nkeys; i++) {
+    uint64_t start = trace_now();
+    if (record)
+      reqtrace_record(start, REQTRACE_KEYSETUP, i, logn, 0);
+    // Enclaves left over by the division go to the first keys.
+    unsigned replicas = enclaves / nkeys + (i < enclaves % nkeys ? 1 : 0);
+    int key = enclpool_add_key(logn, replicas);
+    metrics_op(METRICS_KEYGEN, key >= 0, trace_now() - start);
+    if (key < 0) {
+      fprintf(stderr, "enclave keygen failed\n");
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Tenant target: 'key' is the key ID in the store.
+ */
+struct sealed_args {
+  uint8_t blob[SEALED_KEY_MAX];
+  size_t blob_len;
+  uint8_t pk[MAX_PKEY_LEN];
+  size_t pk_len;
+  unsigned logn;
+  const uint8_t *msg;
+  size_t msg_len;
+  uint8_t *sig;
+  size_t *sig_len;
+  uint8_t *nonce;
+  sgx_status_t retval;
+};
+
+static sgx_status_t keygen_sealed_on(sgx_enclave_id_t eid, void *arg)
+{
+  struct sealed_args *a = (struct sealed_args *) arg;
+  return ecall("keygen_sealed", trust_falcon_keygen_sealed, eid, &a->retval,
+      a->logn, a->blob, sizeof a->blob, &a->blob_len, a->pk, sizeof a->pk,
+      &a->pk_len);
+}
+
+static sgx_status_t sign_sealed_on(sgx_enclave_id_t eid, void *arg)
+{
+  struct sealed_args *a = (struct sealed_args *) arg;
+  return ecall("sign_sealed", trust_falcon_sign_sealed, eid, &a->retval,
+      a->blob, a->blob_len, a->sig, a->sig_len, a->nonce, (uint8_t *) a->msg,
+      a->msg_len);
+}
+
+/*
+ * Open the store and generate the tenant keys it lacks, with IDs 0 to
+ * tenants - 1. Runs after enclave_setup().
+ */
+static int tenant_setup(const char *file, unsigned tenants, unsigned logn)
+{
+  if (keystore_open(file) != 0) {
+    fprintf(stderr, "could not open key store '%s'\n", file);
+    return -1;
+  }
+  struct sealed_args *a = new sealed_args;
+  unsigned created = 0;
+  int r = 0;
+  for (unsigned id = 0; id < tenants && r == 0; id++) {
+    size_t len;
+    unsigned key_logn;
+    if (keystore_get_pubkey(id, a->pk, sizeof a->pk, &len, &key_logn)
+        && key_logn == logn)
+      continue;
+    a->logn = logn;
+    uint64_t start = trace_now();
+    reqtrace_record(start, REQTRACE_KEYSETUP, id, logn, 0);
+    sgx_status_t s = enclpool_call(0, keygen_sealed_on, a);
+    bool ok = s == SGX_SUCCESS && a->retval == SGX_SUCCESS
+        && keystore_put(id, logn, a->blob, a->blob_len, a->pk, a->pk_len) == 0;
+    metrics_op(METRICS_KEYGEN, ok, trace_now() - start);
+    if (!ok) {
+      fprintf(stderr, "tenant keygen failed\n");
+      r = -1;
+    } else {
+      created++;
+    }
+  }
+  delete a;
+  uint64_t keys, dead, bytes;
+  keystore_stats(&keys, &dead, &bytes);
+  printf("key store: %llu keys (%u new), %llu dead records, %.1f MB\n",
+      (unsigned long long) keys, created, (unsigned long long) dead,
+      (double) bytes / (1024 * 1024));
+  return r;
+}
+
+static int tenant_sign(int key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce)
+{
+  struct sealed_args *a = new sealed_args;
+  int ok = 0;
+  if (keystore_get_sealed((uint64_t) key, a->blob, sizeof a->blob,
+      &a->blob_len)) {
+    a->msg = msg;
+    a->msg_len = msg_len;
+    a->sig = sig;
+    a->sig_len = sig_len;
+    a->nonce = nonce;
+    ok = enclpool_call(0, sign_sealed_on, a) == SGX_SUCCESS
+        && a->retval == SGX_SUCCESS;
+  }
+  delete a;
+  return ok;
+}
+
+static const struct {
+  const char *name;
+  sign_fn sign;
+} targets[] = {
+  { "enclave", enclave_sign },
+  { "batch", batch_sign },
+  { "native", native_sign },
+  { "tenant", tenant_sign },
+};
+
+/*
+ * Message size distribution.
+ */
+enum size_kind { SIZE_FIXED, SIZE_UNIFORM, SIZE_EXP };
+
+struct size_dist {
+  enum size_kind kind;
+  size_t a, b;
+};
+
+static int parse_size_dist(const char *s, struct size_dist *d)
+{
+  unsigned long a, b;
+  char tail;
+
+  if (sscanf(s, "fixed:%lu%c", &a, &tail) == 1
+      || sscanf(s, "%lu%c", &a, &tail) == 1) {
+    d->kind = SIZE_FIXED;
+    d->a = d->b = a;
+  } else if (sscanf(s, "uniform:%lu:%lu%c", &a, &b, &tail) == 2) {
+    d->kind = SIZE_UNIFORM;
+    d->a = a;
+    d->b = b;
+  } else if (sscanf(s, "exp:%lu%c", &a, &tail) == 1) {
+    d->kind = SIZE_EXP;
+    d->a = a;
+    d->b = MAX_MSG_LEN;
+  } else {
+    return 0;
+  }
+  return d->a >= 1 && d->a <= d->b && d->b <= MAX_MSG_LEN;
+}
+
+static size_t draw_size(const struct size_dist *d, std::mt19937_64 &rng)
+{
+  switch (d->kind) {
+  case SIZE_UNIFORM:
+    return std::uniform_int_distribution<size_t>(d->a, d->b)(rng);
+  case SIZE_EXP: {
+    double x = std::exponential_distribution<double>(1.0 / d->a)(rng);
+    size_t n = (size_t) x + 1;
+    return n > d->b ? d->b : n;
+  }
+  default:
+    return d->a;
+  }
+}
+
+struct config {
+  sign_fn sign;
+  unsigned threads;
+  double duration;
+  double rate;
+  struct size_dist sizes;
+  unsigned logn;
+  bool cache;
+  unsigned distinct;    // distinct payloads per worker, 0: all distinct
+  unsigned keys;        // enclave pool keys, or tenants
+};
+
+struct worker {
+  struct histogram latency;   // from intended start (open loop)
+  struct histogram service;   // from actual start
+  uint64_t ops;
+  uint64_t errors;
+};
+
+static void run_worker(const struct config *cfg, struct worker *w,
+    unsigned id, lg_clock::time_point t0)
+{
+  std::mt19937_64 rng(0x5eed0000u + id);
+  std::vector<uint8_t> msg(MAX_MSG_LEN);
+  uint8_t sig[MAX_SIG_LEN];
+  uint8_t nonce[NONCE_LEN];
+  size_t sig_len;
+  uint64_t seq = (uint64_t) id << 48;
+
+  for (size_t i = 0; i < msg.size(); i++)
+    msg[i] = (uint8_t) rng();
+
+  hist_init(&w->latency);
+  hist_init(&w->service);
+  w->ops = 0;
+  w->errors = 0;
+
+  lg_clock::time_point deadline = t0
+      + std::chrono::duration_cast<lg_clock::duration>(
+      std::chrono::duration<double>(cfg->duration));
+  bool open_loop = cfg->rate > 0;
+  std::exponential_distribution<double> gap(
+      open_loop ? cfg->rate / cfg->threads : 1.0);
+  lg_clock::time_point intended = t0;
+
+  for (;;) {
+    if (open_loop) {
+      intended += std::chrono::duration_cast<lg_clock::duration>(
+          std::chrono::duration<double>(gap(rng)));
+      if (intended >= deadline)
+        break;
+      std::this_thread::sleep_until(intended);
+    } else if (lg_clock::now() >= deadline) {
+      break;
+    }
+
+    size_t len = draw_size(&cfg->sizes, rng);
+    uint64_t payload = cfg->distinct ? rng() % cfg->distinct : seq++;
+    memcpy(&msg[0], &payload, len < sizeof payload ? len : sizeof payload);
+    int key = cfg->keys > 1 ? (int) (rng() % cfg->keys) : 0;
+    lg_clock::time_point start = lg_clock::now();
+    reqtrace_record(trace_ns(open_loop ? intended : start), REQTRACE_SIGN,
+        key, cfg->logn, len);
+    int ok;
+    bool hit = cfg->cache && sigcache_lookup(key, &msg[0], len, sig,
+        &sig_len, nonce);
+    if (hit) {
+      ok = 1;
+    } else {
+      ok = cfg->sign(key, &msg[0], len, sig, &sig_len, nonce);
+      if (ok && cfg->cache)
+        sigcache_store(key, &msg[0], len, sig, sig_len, nonce);
+    }
+    lg_clock::time_point end = lg_clock::now();
+
+    if (trace_enabled()) {
+      if (open_loop)
+        trace_span_record("queue", "request", trace_ns(intended),
+            trace_ns(start));
+      trace_span_record(hit ? "sigcache" : "sign", "request",
+          trace_ns(start), trace_ns(end));
+    }
+    uint64_t svc = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - start).count();
+    uint64_t lat = open_loop
+        ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - intended).count() : svc;
+    metrics_op(METRICS_SIGN, ok, lat);
+    if (!ok) {
+      w->errors++;
+      continue;
+    }
+    w->ops++;
+    hist_record(&w->service, svc);
+    hist_record(&w->latency, lat);
+  }
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+"usage: %s [ options ]\n"
+"  -c threads    concurrent workers (default: 1, max: %d per enclave)\n"
+"  -d seconds    test duration (default: 10)\n"
+"  -r rate       open loop with Poisson arrivals at 'rate' signatures/s;\n"
+"                without -r, workers run closed loop\n"
+"  -s dist       message sizes: N, fixed:N, uniform:MIN:MAX or exp:MEAN\n"
+"                (default: 32, max: %d)\n"
+"  -l logn       degree of the generated signing key (default: %d)\n"
+"  -E count      enclaves to spread the keys over (default: 1, max: %d)\n"
+"  -K count      enclave target: keys, each on E/K enclaves, one more\n"
+"                for the first E%%K keys (default: 1)\n"
+"  -T target     signing target: enclave, batch, native or tenant\n"
+"                (default: enclave)\n"
+"  -b count      batch target: messages per signature (default: 64,\n"
+"                max: %d); up to %d threads\n"
+"  -w usec       batch target: longest wait for a batch to fill\n"
+"                (default: 1000)\n"
+"  -V            batch target: verify every inclusion proof\n"
+"  -p workers    native target: signing threads (default: one per core)\n"
+"  -k file       tenant target: key store (default: %s)\n"
+"  -t count      tenant target: tenant keys (default: 1000)\n"
+"  -C n[:ms]     cache up to n signatures of identical messages, each\n"
+"                for at most ms milliseconds (default: no expiry);\n"
+"                not with the batch target\n"
+"  -u n          draw messages from n distinct payloads per worker\n"
+"                (default: every message distinct)\n"
+"  -H file       write the latency percentile distribution to 'file'\n",
+      name, MAX_THREADS, MAX_MSG_LEN, DEFAULT_LOGN, MAX_ENCLAVES, MAX_BATCH,
+      MAX_BATCH_THREADS, DEFAULT_KEYSTORE);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+  struct config cfg;
+  const char *hist_file = NULL;
+  bool batch_verify = false;
+  unsigned long cache_entries = 0, cache_ttl = 0;
+  unsigned pool_workers = 0, enclaves = 1, tenants = 1000;
+  const char *keystore_file = DEFAULT_KEYSTORE;
+  int c;
+
+  trace_init();
+  metrics_init();
+  reqtrace_init();
+  cfg.sign = targets[0].sign;
+  cfg.threads = 1;
+  cfg.duration = 10.0;
+  cfg.rate = 0;
+  cfg.sizes.kind = SIZE_FIXED;
+  cfg.sizes.a = cfg.sizes.b = 32;
+  cfg.logn = DEFAULT_LOGN;
+  cfg.cache = false;
+  cfg.distinct = 0;
+  cfg.keys = 1;
+  batcher.max = 64;
+  batcher.window = std::chrono::microseconds(1000);
+
+  while ((c = getopt(argc, argv, "c:d:r:s:l:E:K:T:H:b:w:Vp:k:t:C:u:")) != -1) {
+    switch (c) {
+    case 'c':
+      cfg.threads = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'd':
+      cfg.duration = atof(optarg);
+      break;
+    case 'r':
+      cfg.rate = atof(optarg);
+      break;
+    case 's':
+      if (!parse_size_dist(optarg, &cfg.sizes))
+        usage(argv[0]);
+      break;
+    case 'l':
+      cfg.logn = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'E':
+      enclaves = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'K':
+      cfg.keys = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'T': {
+      size_t i, n = sizeof targets / sizeof targets[0];
+      for (i = 0; i < n; i++)
+        if (strcmp(optarg, targets[i].name) == 0)
+          break;
+      if (i == n)
+        usage(argv[0]);
+      cfg.sign = targets[i].sign;
+      break;
+    }
+    case 'H':
+      hist_file = optarg;
+      break;
+    case 'b':
+      batcher.max = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'w':
+      batcher.window = std::chrono::microseconds(strtoul(optarg, NULL, 10));
+      break;
+    case 'V':
+      batch_verify = true;
+      break;
+    case 'p':
+      pool_workers = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'k':
+      keystore_file = optarg;
+      break;
+    case 't':
+      tenants = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'C': {
+      char tail;
+      if (sscanf(optarg, "%lu:%lu%c", &cache_entries, &cache_ttl, &tail) != 2
+          && sscanf(optarg, "%lu%c", &cache_entries, &tail) != 1)
+        usage(argv[0]);
+      cfg.cache = cache_entries > 0;
+      break;
+    }
+    case 'u':
+      cfg.distinct = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  bool batched = cfg.sign == batch_sign;
+  bool native = cfg.sign == native_sign;
+  bool tenant = cfg.sign == tenant_sign;
+  if (batched || native || tenant)
+    cfg.keys = 1;
+  if (cfg.threads < 1
+      || cfg.threads > (batched || native ? MAX_BATCH_THREADS
+      : MAX_THREADS * enclaves)
+      || enclaves < 1 || enclaves > MAX_ENCLAVES || cfg.keys < 1
+      || cfg.keys > enclaves
+      || cfg.duration <= 0 || cfg.rate < 0 || cfg.logn < 1 || cfg.logn > 10
+      || batcher.max < 1 || batcher.max > MAX_BATCH
+      || (batched && cfg.cache)
+      || (tenant && (tenants < 1 || tenants > INT_MAX)))
+    usage(argv[0]);
+
+  sigcache_init(cache_entries, cache_ttl);
+
+  if (native) {
+    if (native_setup(cfg.logn, pool_workers) != 0) {
+      fprintf(stderr, "native signing pool setup failed\n");
+      return -1;
+    }
+  } else if (enclave_setup(cfg.logn, enclaves, cfg.keys, !tenant) != 0
+      || (tenant && tenant_setup(keystore_file, tenants, cfg.logn) != 0)) {
+    return -1;
+  }
+  if (tenant)
+    cfg.keys = tenants;
+  // New keys: signatures cached under their handles are stale.
+  for (unsigned i = 0; i < cfg.keys; i++)
+    sigcache_invalidate(i);
+
+  std::thread batcher_th;
+  if (batched) {
+    if (batch_verify) {
+      struct pubkey_args a;
+      batcher.bv = falcon_batch_vrfy_new();
+      if (batcher.bv == NULL
+          || enclpool_call(0, pubkey_on, &a) != SGX_SUCCESS
+          || a.retval != SGX_SUCCESS
+          || !falcon_batch_vrfy_set_public_key(batcher.bv, a.pk, a.pk_len)) {
+        fprintf(stderr, "could not set up batch verification\n");
+        return -1;
+      }
+    }
+    batcher_th = std::thread(batcher_thread);
+  }
+
+  std::vector<struct worker> workers(cfg.threads);
+  std::vector<std::thread> threads;
+  lg_clock::time_point t0 = lg_clock::now();
+  for (unsigned i = 0; i < cfg.threads; i++)
+    threads.push_back(std::thread(run_worker, &cfg, &workers[i], i, t0));
+  for (unsigned i = 0; i < cfg.threads; i++)
+    threads[i].join();
+  double elapsed = std::chrono::duration<double>(lg_clock::now() - t0).count();
+  if (batched) {
+    {
+      std::lock_guard<std::mutex> lk(batcher.mu);
+      batcher.stop = true;
+    }
+    batcher.wake.notify_one();
+    batcher_th.join();
+    falcon_batch_vrfy_free(batcher.bv);
+  }
+
+  static struct histogram latency, service;
+  uint64_t ops = 0, errors = 0;
+  hist_init(&latency);
+  hist_init(&service);
+  for (unsigned i = 0; i < cfg.threads; i++) {
+    hist_merge(&latency, &workers[i].latency);
+    hist_merge(&service, &workers[i].service);
+    ops += workers[i].ops;
+    errors += workers[i].errors;
+  }
+
+  if (cfg.rate > 0)
+    printf("open loop, %u threads, target %.1f sig/s\n", cfg.threads,
+        cfg.rate);
+  else
+    printf("closed loop, %u threads\n", cfg.threads);
+  if (!native && (enclaves > 1 || enclpool_restarts() > 0)) {
+    unsigned pool_keys = tenant ? 1 : cfg.keys;
+    if (enclaves % pool_keys == 0)
+      printf("%u enclaves, %u keys x %u replicas, %llu restarts\n",
+          enclaves, pool_keys, enclaves / pool_keys,
+          (unsigned long long) enclpool_restarts());
+    else
+      printf("%u enclaves, %u keys x %u-%u replicas, %llu restarts\n",
+          enclaves, pool_keys, enclaves / pool_keys,
+          enclaves / pool_keys + 1, (unsigned long long) enclpool_restarts());
+  }
+  if (batched)
+    printf("batches of up to %u messages, %lld us window\n", batcher.max,
+        (long long) batcher.window.count());
+  printf("completed %llu signatures (%llu errors) in %.2f s: %.1f sig/s\n",
+      (unsigned long long) ops, (unsigned long long) errors, elapsed,
+      (double) ops / elapsed);
+  if (cfg.cache) {
+    uint64_t hits, misses, evictions;
+    sigcache_stats(&hits, &misses, &evictions);
+    printf("signature cache: %llu hits, %llu misses, %llu evictions\n",
+        (unsigned long long) hits, (unsigned long long) misses,
+        (unsigned long long) evictions);
+  }
+  printf("latency (us):  ");
+  hist_print_summary(stdout, &latency, 1000.0);
+  if (cfg.rate > 0) {
+    printf("service (us):  ");
+    hist_print_summary(stdout, &service, 1000.0);
+  }
+
+  if (hist_file != NULL) {
+    FILE *f = fopen(hist_file, "w");
+    if (f == NULL) {
+      fprintf(stderr, "could not open file '%s'\n", hist_file);
+    } else {
+      hist_print_distribution(f, &latency, 1000.0);
+      fclose(f);
+    }
+  }
+
+  if (native)
+    signpool_stop();
+  else
+    enclpool_stop();
+  keystore_close();
+  return errors == 0 ? 0 : 1;
+}
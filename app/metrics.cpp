@@ -0,0 +1,385 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "metrics.h"
+
+/*
+ * Histograms have fixed upper bounds and one atomic counter per
+ * bucket, non-cumulative; cumulative counts are computed on output.
+ * The last bucket is +Inf. The sum is kept in the unit of the values
+ * recorded (nanoseconds for latencies).
+ */
+#define LATENCY_BUCKETS 14
+#define BATCH_BUCKETS 10
+
+static const double latency_bounds[LATENCY_BUCKETS - 1] = {
+  0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+  0.25, 0.5, 1.0
+};
+
+static const double batch_bounds[BATCH_BUCKETS - 1] = {
+  1, 2, 4, 8, 16, 32, 64, 128, 256
+};
+
+struct histogram_metric {
+  std::atomic<uint64_t> buckets[LATENCY_BUCKETS];
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+};
+
+struct ecall_metric {
+  std::atomic<const char *> name;
+  std::atomic<uint64_t> calls;
+  std::atomic<uint64_t> failures;
+};
+
+#define MAX_ECALLS 16
+
+static const char *op_names[METRICS_NUM_OPS] = { "keygen", "sign", "verify" };
+
+static std::atomic<uint64_t> ops[METRICS_NUM_OPS];
+static std::atomic<uint64_t> op_errors[METRICS_NUM_OPS];
+static struct histogram_metric op_latency[METRICS_NUM_OPS];
+static std::atomic<uint64_t> sign_retries;
+static std::atomic<int64_t> queue_depth;
+static struct histogram_metric batch_sizes;
+static std::atomic<uint64_t> sigcache_lookups[2];    // miss, hit
+static std::atomic<uint64_t> vrfycache_lookups[2];
+static struct ecall_metric ecalls[MAX_ECALLS];
+
+static void hist_add(struct histogram_metric *h, const double *bounds,
+    int nbounds, double v, uint64_t raw)
+{
+  int i = 0;
+  while (i < nbounds && v > bounds[i])
+    i++;
+  h->buckets[i].fetch_add(1, std::memory_order_relaxed);
+  h->count.fetch_add(1, std::memory_order_relaxed);
+  h->sum.fetch_add(raw, std::memory_order_relaxed);
+}
+
+void metrics_op(enum metrics_op op, int ok, uint64_t ns)
+{
+  if (!ok) {
+    op_errors[op].fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ops[op].fetch_add(1, std::memory_order_relaxed);
+  hist_add(&op_latency[op], latency_bounds, LATENCY_BUCKETS - 1, ns / 1e9, ns);
+}
+
+void metrics_sign_retry(void)
+{
+  sign_retries.fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_queue_add(int64_t delta)
+{
+  queue_depth.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void metrics_batch(unsigned size)
+{
+  hist_add(&batch_sizes, batch_bounds, BATCH_BUCKETS - 1, size, size);
+}
+
+void metrics_sigcache(int hit)
+{
+  sigcache_lookups[hit != 0].fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_vrfycache(int hit)
+{
+  vrfycache_lookups[hit != 0].fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_ecall(const char *name, int ok)
+{
+  struct ecall_metric *m = NULL;
+
+  for (int i = 0; i < MAX_ECALLS && m == NULL; i++) {
+    const char *n = ecalls[i].name.load(std::memory_order_acquire);
+    if (n == NULL) {
+      if (ecalls[i].name.compare_exchange_strong(n, name,
+          std::memory_order_acq_rel))
+        m = &ecalls[i];
+      else if (n == name || strcmp(n, name) == 0)
+        m = &ecalls[i];
+    } else if (n == name || strcmp(n, name) == 0) {
+      m = &ecalls[i];
+    }
+  }
+  if (m == NULL)
+    return;
+  m->calls.fetch_add(1, std::memory_order_relaxed);
+  if (!ok)
+    m->failures.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void write_histogram(FILE *f, const char *name, const char *labels,
+    const struct histogram_metric *h, const double *bounds, int nbounds,
+    double sum_scale)
+{
+  uint64_t cum = 0;
+  const char *sep = labels[0] != 0 ? "," : "";
+
+  for (int i = 0; i <= nbounds; i++) {
+    cum += h->buckets[i].load(std::memory_order_relaxed);
+    if (i < nbounds)
+      fprintf(f, "%s_bucket{%s%sle=\"%g\"} %llu\n", name, labels, sep,
+          bounds[i], (unsigned long long) cum);
+    else
+      fprintf(f, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep,
+          (unsigned long long) cum);
+  }
+  if (labels[0] != 0) {
+    fprintf(f, "%s_sum{%s} %.9g\n", name, labels,
+        h->sum.load(std::memory_order_relaxed) * sum_scale);
+    fprintf(f, "%s_count{%s} %llu\n", name, labels,
+        (unsigned long long) h->count.load(std::memory_order_relaxed));
+  } else {
+    fprintf(f, "%s_sum %.9g\n", name,
+        h->sum.load(std::memory_order_relaxed) * sum_scale);
+    fprintf(f, "%s_count %llu\n", name,
+        (unsigned long long) h->count.load(std::memory_order_relaxed));
+  }
+}
+
+void metrics_write(FILE *f)
+{
+  char labels[32];
+
+  fprintf(f, "# HELP sgx_falcon_operations_total Completed operations.\n");
+  fprintf(f, "# TYPE sgx_falcon_operations_total counter\n");
+  for (int i = 0; i < METRICS_NUM_OPS; i++)
+    fprintf(f, "sgx_falcon_operations_total{op=\"%s\"} %llu\n", op_names[i],
+        (unsigned long long) ops[i].load(std::memory_order_relaxed));
+
+  fprintf(f, "# HELP sgx_falcon_operation_errors_total Failed operations.\n");
+  fprintf(f, "# TYPE sgx_falcon_operation_errors_total counter\n");
+  for (int i = 0; i < METRICS_NUM_OPS; i++)
+    fprintf(f, "sgx_falcon_operation_errors_total{op=\"%s\"} %llu\n",
+        op_names[i],
+        (unsigned long long) op_errors[i].load(std::memory_order_relaxed));
+
+  fprintf(f, "# HELP sgx_falcon_operation_latency_seconds "
+      "Request latency.\n");
+  fprintf(f, "# TYPE sgx_falcon_operation_latency_seconds histogram\n");
+  for (int i = 0; i < METRICS_NUM_OPS; i++) {
+    snprintf(labels, sizeof labels, "op=\"%s\"", op_names[i]);
+    write_histogram(f, "sgx_falcon_operation_latency_seconds", labels,
+        &op_latency[i], latency_bounds, LATENCY_BUCKETS - 1, 1e-9);
+  }
+
+  fprintf(f, "# HELP sgx_falcon_sign_retries_total "
+      "Signing requests re-issued by the host.\n");
+  fprintf(f, "# TYPE sgx_falcon_sign_retries_total counter\n");
+  fprintf(f, "sgx_falcon_sign_retries_total %llu\n",
+      (unsigned long long) sign_retries.load(std::memory_order_relaxed));
+
+  fprintf(f, "# HELP sgx_falcon_queue_depth "
+      "Requests accepted but not yet started.\n");
+  fprintf(f, "# TYPE sgx_falcon_queue_depth gauge\n");
+  fprintf(f, "sgx_falcon_queue_depth %lld\n",
+      (long long) queue_depth.load(std::memory_order_relaxed));
+
+  fprintf(f, "# HELP sgx_falcon_batch_size Requests per batch ECALL.\n");
+  fprintf(f, "# TYPE sgx_falcon_batch_size histogram\n");
+  write_histogram(f, "sgx_falcon_batch_size", "", &batch_sizes,
+      batch_bounds, BATCH_BUCKETS - 1, 1.0);
+
+  fprintf(f, "# HELP sgx_falcon_sigcache_lookups_total "
+      "Signature cache lookups.\n");
+  fprintf(f, "# TYPE sgx_falcon_sigcache_lookups_total counter\n");
+  fprintf(f, "sgx_falcon_sigcache_lookups_total{result=\"miss\"} %llu\n",
+      (unsigned long long) sigcache_lookups[0].load(
+      std::memory_order_relaxed));
+  fprintf(f, "sgx_falcon_sigcache_lookups_total{result=\"hit\"} %llu\n",
+      (unsigned long long) sigcache_lookups[1].load(
+      std::memory_order_relaxed));
+
+  fprintf(f, "# HELP sgx_falcon_vrfycache_lookups_total "
+      "Verification cache lookups.\n");
+  fprintf(f, "# TYPE sgx_falcon_vrfycache_lookups_total counter\n");
+  fprintf(f, "sgx_falcon_vrfycache_lookups_total{result=\"miss\"} %llu\n",
+      (unsigned long long) vrfycache_lookups[0].load(
+      std::memory_order_relaxed));
+  fprintf(f, "sgx_falcon_vrfycache_lookups_total{result=\"hit\"} %llu\n",
+      (unsigned long long) vrfycache_lookups[1].load(
+      std::memory_order_relaxed));
+
+  fprintf(f, "# HELP sgx_falcon_ecalls_total Enclave transitions.\n");
+  fprintf(f, "# TYPE sgx_falcon_ecalls_total counter\n");
+  for (int i = 0; i < MAX_ECALLS; i++) {
+    const char *n = ecalls[i].name.load(std::memory_order_acquire);
+    if (n != NULL)
+      fprintf(f, "sgx_falcon_ecalls_total{ecall=\"%s\"} %llu\n", n,
+          (unsigned long long) ecalls[i].calls.load(std::memory_order_relaxed));
+  }
+  fprintf(f, "# HELP sgx_falcon_ecall_failures_total "
+      "Enclave transitions that did not return SGX_SUCCESS.\n");
+  fprintf(f, "# TYPE sgx_falcon_ecall_failures_total counter\n");
+  for (int i = 0; i < MAX_ECALLS; i++) {
+    const char *n = ecalls[i].name.load(std::memory_order_acquire);
+    if (n != NULL)
+      fprintf(f, "sgx_falcon_ecall_failures_total{ecall=\"%s\"} %llu\n", n,
+          (unsigned long long) ecalls[i].failures.load(
+          std::memory_order_relaxed));
+  }
+}
+
+/*
+ * Exporters.
+ */
+static char metrics_path[4096];
+static char metrics_tmp[sizeof metrics_path + 8];
+static std::mutex file_lock;
+
+static void write_file(void)
+{
+  std::lock_guard<std::mutex> guard(file_lock);
+  FILE *f = fopen(metrics_tmp, "w");
+  if (f == NULL)
+    return;
+  metrics_write(f);
+  if (fclose(f) == 0)
+    rename(metrics_tmp, metrics_path);
+  else
+    unlink(metrics_tmp);
+}
+
+static void file_exporter(unsigned interval)
+{
+  for (;;) {
+    write_file();
+    std::this_thread::sleep_for(std::chrono::seconds(interval));
+  }
+}
+
+#define EXPORTER_TIMEOUT_MS 2000
+
+static void socket_exporter(int fd)
+{
+  static const char header[] = "HTTP/1.0 200 OK\r\n"
+      "Content-Type: text/plain; version=0.0.4\r\n\r\n";
+
+  for (;;) {
+    int c = accept(fd, NULL, NULL);
+    if (c < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+
+    /*
+     * Discard the request (any request gets the metrics); render into
+     * memory so that a slow client does not hold anything up. There is
+     * a single exporter thread, so a client that connects and sends
+     * nothing, or stops reading, is dropped after EXPORTER_TIMEOUT_MS
+     * rather than blocking every later scrape.
+     */
+    struct pollfd pfd;
+    pfd.fd = c;
+    pfd.events = POLLIN;
+    int r;
+    do
+      r = poll(&pfd, 1, EXPORTER_TIMEOUT_MS);
+    while (r < 0 && errno == EINTR);
+    if (r <= 0) {
+      close(c);
+      continue;
+    }
+    char req[1024];
+    ssize_t n = read(c, req, sizeof req);
+    (void) n;
+    struct timeval tv;
+    tv.tv_sec = EXPORTER_TIMEOUT_MS / 1000;
+    tv.tv_usec = (EXPORTER_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(c, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *f = open_memstream(&buf, &len);
+    if (f != NULL) {
+      fputs(header, f);
+      metrics_write(f);
+      fclose(f);
+      // MSG_NOSIGNAL: a scraper that hangs up mid-response gets its
+      // connection closed (EPIPE), not the process killed by SIGPIPE.
+      for (size_t off = 0; off < len; ) {
+        ssize_t w = send(c, buf + off, len - off, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR)
+          continue;
+        if (w <= 0)
+          break;
+        off += (size_t) w;
+      }
+      free(buf);
+    }
+    close(c);
+  }
+}
+
+static void unlink_socket(void)
+{
+  unlink(metrics_path);
+}
+
+void metrics_init(void)
+{
+  const char *spec = getenv("SGX_FALCON_METRICS");
+  if (spec == NULL || *spec == 0)
+    return;
+
+  int is_file = strncmp(spec, "file:", 5) == 0;
+  if ((!is_file && strncmp(spec, "unix:", 5) != 0) || spec[5] == 0
+      || strlen(spec + 5) >= sizeof metrics_path) {
+    fprintf(stderr, "SGX_FALCON_METRICS: expected file:PATH or unix:PATH\n");
+    return;
+  }
+  strcpy(metrics_path, spec + 5);
+
+  if (is_file) {
+    const char *iv = getenv("SGX_FALCON_METRICS_INTERVAL");
+    unsigned interval = iv != NULL ? (unsigned) atoi(iv) : 5;
+    if (interval == 0)
+      interval = 5;
+    snprintf(metrics_tmp, sizeof metrics_tmp, "%s.tmp", metrics_path);
+    atexit(write_file);
+    std::thread(file_exporter, interval).detach();
+    return;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("metrics socket");
+    return;
+  }
+  struct sockaddr_un addr;
+  if (strlen(metrics_path) >= sizeof addr.sun_path) {
+    fprintf(stderr, "SGX_FALCON_METRICS: socket path too long\n");
+    close(fd);
+    return;
+  }
+  memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, metrics_path);
+  unlink(metrics_path);
+  if (bind(fd, (struct sockaddr *) &addr, sizeof addr) < 0
+      || listen(fd, 8) < 0) {
+    perror("metrics socket");
+    close(fd);
+    return;
+  }
+  atexit(unlink_socket);
+  std::thread(socket_exporter, fd).detach();
+}
@@ -0,0 +1,68 @@
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+/*
+ * Service metrics in the Prometheus text exposition format.
+ *
+ * All updates are lock-free atomic increments and can be made from any
+ * thread. When the SGX_FALCON_METRICS environment variable is set,
+ * metrics_init() starts a background exporter:
+ *
+ *   SGX_FALCON_METRICS=file:PATH   rewrite PATH (write + rename, so
+ *                                  readers never see a partial file)
+ *                                  every SGX_FALCON_METRICS_INTERVAL
+ *                                  seconds (default 5) and at exit;
+ *                                  suitable for the node_exporter
+ *                                  textfile collector
+ *   SGX_FALCON_METRICS=unix:PATH   answer each connection on the Unix
+ *                                  socket PATH with a fresh snapshot,
+ *                                  as a minimal HTTP/1.0 response
+ *                                  (curl --unix-socket PATH http://x/)
+ *
+ * Exposed series (prefix sgx_falcon_):
+ *   operations_total{op}              completed keygen/sign/verify
+ *   operation_errors_total{op}        failed ones
+ *   operation_latency_seconds{op}     histogram, per request
+ *   sign_retries_total                signing requests re-issued by the
+ *                                     host (e.g. after an enclave loss)
+ *   queue_depth                       requests accepted, not yet started
+ *   batch_size                        histogram, requests per batch ECALL
+ *   sigcache_lookups_total{result}    signature cache hits and misses
+ *   vrfycache_lookups_total{result}   verification cache hits and misses
+ *   ecalls_total{ecall}               enclave transitions, by ECALL
+ *   ecall_failures_total{ecall}       transitions that did not return
+ *                                     SGX_SUCCESS
+ */
+enum metrics_op {
+  METRICS_KEYGEN,
+  METRICS_SIGN,
+  METRICS_VERIFY,
+  METRICS_NUM_OPS
+};
+
+/*
+ * Start the exporter if SGX_FALCON_METRICS is set. Call once from
+ * main().
+ */
+void metrics_init(void);
+
+// One completed (ok != 0) or failed operation, taking 'ns' nanoseconds.
+void metrics_op(enum metrics_op op, int ok, uint64_t ns);
+
+void metrics_sign_retry(void);
+void metrics_queue_add(int64_t delta);
+void metrics_batch(unsigned size);
+void metrics_sigcache(int hit);
+void metrics_vrfycache(int hit);
+
+// Called by ecall() for every transition; 'name' must be a literal.
+void metrics_ecall(const char *name, int ok);
+
+// Write the current values in the text exposition format.
+void metrics_write(FILE *f);
+
+#endif // _METRICS_H
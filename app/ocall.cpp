@@ -0,0 +1,18 @@
+#include <stdio.h>
+
+#include "enclave_u.h"
+#include "trace.h"
+
+void ocall_print(char *str, size_t str_len)
+{
+  trace_span span("print", "ocall");
+  for (size_t i = 0; i < str_len; ++i)
+    printf("%x", (uint8_t) str[i]);
+  printf("\n");
+}
+
+void ocall_print_string(const char *str)
+{
+  trace_span span("print_string", "ocall");
+  printf("%s", str);
+}
@@ -0,0 +1,283 @@
+/*
+ * Request trace replay.
+ *
+ * Re-issues a trace recorded with SGX_FALCON_RECORD (see reqtrace.h)
+ * against the enclave, at the original pace, scaled by a speed factor,
+ * or as fast as possible, and reports throughput and per-operation
+ * latency. Message contents are random; only their lengths come from
+ * the trace.
+ *
+ * Requests are taken in arrival order by a pool of workers. Each is
+ * sent at its scheduled time (or as soon as a worker is free after
+ * that), and latency is measured from the scheduled time, so that
+ * requests delayed behind slow ones are charged for the wait, as they
+ * would have been in production.
+ *
+ * The enclave holds one key pair, so only traces that use a single key
+ * handle (see reqtrace.h) are replayed; its setup records give the
+ * degree of the key generated before the replay starts, and its keygen
+ * records replace it as they did in the recording.
+ *
+ * Verify requests check a reference signature made by each worker
+ * against the current key: the message differs from the signed one, so
+ * the verdict is "invalid", but the work done by the enclave is the
+ * same as for a valid signature.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "enclave_u.h"
+#include "sgx_urts.h"
+#include "ecall.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "reqtrace.h"
+#include "trace.h"
+#include "../include/boundary_types.h"
+
+typedef std::chrono::steady_clock rp_clock;
+
+static sgx_enclave_id_t global_eid = 0;
+
+static const char *op_names[] = { "keygen", "sign", "verify" };
+
+static std::vector<struct reqtrace_entry> requests;
+static std::atomic<size_t> next_request(0);
+
+// Bumped after each replayed keygen, so that verifiers re-sign.
+static std::atomic<unsigned> key_generation(0);
+
+struct worker {
+  struct histogram latency[3];
+  uint64_t ops[3];
+  uint64_t errors[3];
+};
+
+static int do_keygen(unsigned logn)
+{
+  sgx_status_t retval;
+  sgx_status_t r = ecall("keygen", trust_falcon_keygen, global_eid, &retval,
+      logn);
+  if (r != SGX_SUCCESS || retval != SGX_SUCCESS)
+    return 0;
+  key_generation.fetch_add(1);
+  return 1;
+}
+
+static int do_sign(uint8_t *msg, size_t len, uint8_t *sig, size_t *sig_len,
+    uint8_t *nonce)
+{
+  sgx_status_t retval;
+  sgx_status_t r = ecall("sign", trust_falcon_sign, global_eid, &retval, sig,
+      sig_len, nonce, msg, len);
+  return r == SGX_SUCCESS && retval == SGX_SUCCESS;
+}
+
+static int do_verify(uint8_t *msg, size_t len, uint8_t *sig, size_t sig_len,
+    uint8_t *nonce)
+{
+  sgx_status_t retval;
+  int valid = 0;
+  sgx_status_t r = ecall("verify", trust_falcon_verify, global_eid, &retval,
+      sig, sig_len, nonce, msg, len, &valid);
+  return r == SGX_SUCCESS && retval == SGX_SUCCESS;
+}
+
+static void run_worker(struct worker *w, unsigned id, rp_clock::time_point t0,
+    double speed)
+{
+  std::mt19937_64 rng(0x5eed0000u + id);
+  std::vector<uint8_t> msg(MAX_MSG_LEN);
+  uint8_t sig[MAX_SIG_LEN], ref_sig[MAX_SIG_LEN];
+  uint8_t nonce[NONCE_LEN], ref_nonce[NONCE_LEN];
+  size_t sig_len, ref_sig_len = 0;
+  unsigned ref_generation = 0;
+
+  for (size_t i = 0; i < msg.size(); i++)
+    msg[i] = (uint8_t) rng();
+  for (int op = 0; op < 3; op++) {
+    hist_init(&w->latency[op]);
+    w->ops[op] = 0;
+    w->errors[op] = 0;
+  }
+
+  for (;;) {
+    size_t i = next_request.fetch_add(1);
+    if (i >= requests.size())
+      break;
+    const struct reqtrace_entry *e = &requests[i];
+    size_t len = e->len < 1 ? 1 : e->len > MAX_MSG_LEN ? MAX_MSG_LEN : e->len;
+
+    /*
+     * The reference signature is (re)made before waiting for the
+     * scheduled time, so that its cost is not charged to the verify.
+     * A key replaced during the wait leaves it stale, which does not
+     * change the work done by the verify.
+     */
+    if (e->op == REQTRACE_VERIFY) {
+      unsigned g = key_generation.load();
+      if (ref_sig_len == 0 || ref_generation != g) {
+        if (!do_sign(&msg[0], 32, ref_sig, &ref_sig_len, ref_nonce)) {
+          w->errors[e->op]++;
+          continue;
+        }
+        ref_generation = g;
+      }
+    }
+
+    rp_clock::time_point scheduled = t0;
+    if (speed > 0) {
+      scheduled += std::chrono::duration_cast<rp_clock::duration>(
+          std::chrono::duration<double>(e->t / 1e9 / speed));
+      std::this_thread::sleep_until(scheduled);
+    }
+
+    rp_clock::time_point start = rp_clock::now();
+    int ok;
+    switch (e->op) {
+    case REQTRACE_KEYGEN:
+      ok = e->logn >= 1 && e->logn <= 10 && do_keygen(e->logn);
+      break;
+    case REQTRACE_SIGN:
+      ok = do_sign(&msg[0], len, sig, &sig_len, nonce);
+      break;
+    default:
+      ok = do_verify(&msg[0], len, ref_sig, ref_sig_len, ref_nonce);
+      break;
+    }
+    rp_clock::time_point end = rp_clock::now();
+
+    uint64_t lat = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - (speed > 0 ? scheduled : start)).count();
+    metrics_op((enum metrics_op) e->op, ok, lat);
+    if (!ok) {
+      w->errors[e->op]++;
+      continue;
+    }
+    w->ops[e->op]++;
+    hist_record(&w->latency[e->op], lat);
+  }
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+"usage: %s [ options ] trace-file\n"
+"  -x speed      replay speed relative to the recording (default: 1.0);\n"
+"                0 sends every request as soon as a worker is free\n"
+"  -c threads    concurrent workers (default: %d, max: %d)\n"
+"  -H file       write the sign latency percentile distribution to 'file'\n",
+      name, MAX_THREADS, MAX_THREADS);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+  double speed = 1.0;
+  unsigned threads = MAX_THREADS;
+  const char *hist_file = NULL;
+  int c;
+
+  trace_init();
+  metrics_init();
+  while ((c = getopt(argc, argv, "x:c:H:")) != -1) {
+    switch (c) {
+    case 'x':
+      speed = atof(optarg);
+      break;
+    case 'c':
+      threads = (unsigned) strtoul(optarg, NULL, 10);
+      break;
+    case 'H':
+      hist_file = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc - 1 || speed < 0 || threads < 1 || threads > MAX_THREADS)
+    usage(argv[0]);
+
+  if (reqtrace_load(argv[optind], requests) < 0) {
+    fprintf(stderr, "could not read request trace '%s'\n", argv[optind]);
+    return -1;
+  }
+  for (size_t i = 1; i < requests.size(); i++)
+    if (requests[i].key != requests[0].key) {
+      fprintf(stderr, "request trace uses several keys (handles %u and %u); "
+          "only single-key traces can be replayed\n", requests[0].key,
+          requests[i].key);
+      return -1;
+    }
+  // The recording started with a key already in place, of this degree.
+  unsigned logn = requests.empty() ? 0 : requests[0].logn;
+  size_t n = 0;
+  for (size_t i = 0; i < requests.size(); i++)
+    if (requests[i].op != REQTRACE_KEYSETUP)
+      requests[n++] = requests[i];
+  requests.resize(n);
+  if (requests.empty()) {
+    fprintf(stderr, "empty request trace\n");
+    return -1;
+  }
+
+  sgx_status_t r = enclave_create(ENCLAVE_FILENAME, &global_eid);
+  if (r != SGX_SUCCESS)
+    return -1;
+
+  if (logn < 1 || logn > 10 || !do_keygen(logn)) {
+    fprintf(stderr, "could not generate a key of degree 2^%u\n", logn);
+    return -1;
+  }
+
+  std::vector<struct worker> workers(threads);
+  std::vector<std::thread> pool;
+  rp_clock::time_point t0 = rp_clock::now();
+  for (unsigned i = 0; i < threads; i++)
+    pool.push_back(std::thread(run_worker, &workers[i], i, t0, speed));
+  for (unsigned i = 0; i < threads; i++)
+    pool[i].join();
+  double elapsed = std::chrono::duration<double>(rp_clock::now() - t0).count();
+
+  printf("replayed %lu requests spanning %.2f s in %.2f s (%.1f req/s), "
+      "speed %g, %u threads\n", (unsigned long) requests.size(),
+      requests.back().t / 1e9, elapsed, requests.size() / elapsed, speed,
+      threads);
+  int failed = 0;
+  for (int op = 0; op < 3; op++) {
+    static struct histogram h;
+    uint64_t ops = 0, errors = 0;
+    hist_init(&h);
+    for (unsigned i = 0; i < threads; i++) {
+      hist_merge(&h, &workers[i].latency[op]);
+      ops += workers[i].ops[op];
+      errors += workers[i].errors[op];
+    }
+    if (ops + errors == 0)
+      continue;
+    printf("%-6s %llu ok, %llu errors, %.1f/s\n  latency (us):  ",
+        op_names[op], (unsigned long long) ops, (unsigned long long) errors,
+        ops / elapsed);
+    hist_print_summary(stdout, &h, 1000.0);
+    if (op == REQTRACE_SIGN && hist_file != NULL) {
+      FILE *f = fopen(hist_file, "w");
+      if (f == NULL) {
+        fprintf(stderr, "could not open file '%s'\n", hist_file);
+      } else {
+        hist_print_distribution(f, &h, 1000.0);
+        fclose(f);
+      }
+    }
+    failed |= errors != 0;
+  }
+
+  sgx_destroy_enclave(global_eid);
+  return failed;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+
+#include "reqtrace.h"
+
+#define REQTRACE_MAGIC "SFRT"
+#define REQTRACE_VERSION 2
+#define REQTRACE_HEADER_LEN 16
+
+static FILE *record_file = NULL;
+static std::mutex record_lock;
+static bool have_first = false;
+static uint64_t first_arrival;
+static int64_t prev_t;
+
+static void put_varint(FILE *f, uint64_t v)
+{
+  while (v >= 0x80) {
+    putc((int) (v & 0x7f) | 0x80, f);
+    v >>= 7;
+  }
+  putc((int) v, f);
+}
+
+static int get_varint(FILE *f, uint64_t *v)
+{
+  uint64_t r = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = getc(f);
+    if (c == EOF)
+      return 0;
+    r |= (uint64_t) (c & 0x7f) << shift;
+    if ((c & 0x80) == 0) {
+      *v = r;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void close_record(void)
+{
+  std::lock_guard<std::mutex> guard(record_lock);
+  if (record_file != NULL) {
+    fclose(record_file);
+    record_file = NULL;
+  }
+}
+
+void reqtrace_init(void)
+{
+  const char *path = getenv("SGX_FALCON_RECORD");
+  if (path == NULL || *path == 0)
+    return;
+
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    fprintf(stderr, "could not open request trace file '%s'\n", path);
+    return;
+  }
+  unsigned char header[REQTRACE_HEADER_LEN];
+  memset(header, 0, sizeof header);
+  memcpy(header, REQTRACE_MAGIC, 4);
+  header[4] = REQTRACE_VERSION;
+  fwrite(header, 1, sizeof header, f);
+  record_file = f;
+  atexit(close_record);
+}
+
+void reqtrace_record(uint64_t arrival, enum reqtrace_op op, uint32_t key,
+    unsigned logn, size_t len)
+{
+  if (record_file == NULL)
+    return;
+
+  std::lock_guard<std::mutex> guard(record_lock);
+  if (record_file == NULL)
+    return;
+  if (!have_first) {
+    first_arrival = arrival;
+    prev_t = 0;
+    have_first = true;
+  }
+  int64_t t = (int64_t) (arrival - first_arrival);
+  int64_t d = t - prev_t;
+  prev_t = t;
+
+  put_varint(record_file, ((uint64_t) d << 1) ^ (uint64_t) (d >> 63));
+  putc((int) op, record_file);
+  put_varint(record_file, key);
+  putc((int) logn, record_file);
+  put_varint(record_file, len);
+}
+
+static bool earlier(const struct reqtrace_entry &a,
+    const struct reqtrace_entry &b)
+{
+  return a.t < b.t;
+}
+
+int reqtrace_load(const char *path, std::vector<struct reqtrace_entry> &out)
+{
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return -1;
+
+  unsigned char header[REQTRACE_HEADER_LEN];
+  if (fread(header, 1, sizeof header, f) != sizeof header
+      || memcmp(header, REQTRACE_MAGIC, 4) != 0
+      || header[4] < 1 || header[4] > REQTRACE_VERSION) {
+    fclose(f);
+    return -1;
+  }
+  int version = header[4];
+
+  int64_t t = 0;
+  int64_t min_t = 0;
+  out.clear();
+  for (;;) {
+    uint64_t zd, key, len;
+    int c = getc(f), logn;
+    if (c == EOF)
+      break;
+    ungetc(c, f);
+    if (!get_varint(f, &zd) || (c = getc(f)) == EOF
+        || c > (version == 1 ? REQTRACE_VERIFY : REQTRACE_KEYSETUP)
+        || !get_varint(f, &key)
+        || (version > 1 && (logn = getc(f)) == EOF)
+        || !get_varint(f, &len) || key > UINT32_MAX || len > UINT32_MAX) {
+      fclose(f);
+      return -1;
+    }
+    if (version == 1) {
+      logn = key > 255 ? 0 : (int) key;
+      key = 0;
+    }
+    t += (int64_t) (zd >> 1) ^ -(int64_t) (zd & 1);
+    min_t = std::min(min_t, t);
+
+    struct reqtrace_entry e;
+    e.t = (uint64_t) t;
+    e.op = (uint8_t) c;
+    e.logn = (uint8_t) logn;
+    e.key = (uint32_t) key;
+    e.len = (uint32_t) len;
+    out.push_back(e);
+  }
+  fclose(f);
+
+  // A request recorded first may not have been the first to arrive.
+  for (size_t i = 0; i < out.size(); i++)
+    out[i].t = (uint64_t) ((int64_t) out[i].t - min_t);
+  std::stable_sort(out.begin(), out.end(), earlier);
+  return 0;
+}
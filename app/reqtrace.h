@@ -0,0 +1,73 @@
+#ifndef _REQTRACE_H
+#define _REQTRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Request traces: the shape of real traffic, without its content.
+ *
+ * When SGX_FALCON_RECORD names a file, reqtrace_init() opens it and
+ * every request passed to reqtrace_record() is appended to it. Only
+ * the arrival time, operation, key handle, key degree and message
+ * length are stored, never message bytes, nonces or signatures.
+ *
+ * File format (all integers little-endian):
+ *
+ *   header   "SFRT", version byte (2), 11 reserved zero bytes
+ *   record   zigzag varint   arrival time minus the previous record's,
+ *                            in nanoseconds
+ *            byte            operation (REQTRACE_*)
+ *            varint          key handle
+ *            byte            degree (logn) of that key
+ *            varint          message length
+ *
+ * Records are written in the order reqtrace_record() is called, which
+ * for concurrent callers is not quite arrival order; hence the signed
+ * deltas. reqtrace_load() sorts by arrival time.
+ *
+ * The key handle names the key the request ran against, as the
+ * recording program numbers its keys (0 when it has a single one: the
+ * enclave's own key pair; enclave pool keys or tenant IDs in the load
+ * generator). REQTRACE_KEYGEN replaces the key under its handle while
+ * traffic runs; REQTRACE_KEYSETUP records a key made before the
+ * traffic, which a replay provisions rather than re-issues.
+ *
+ * Version 1 files, which stored the degree in place of the key handle
+ * and had no degree byte, still load, as handle 0.
+ */
+enum reqtrace_op {
+  REQTRACE_KEYGEN = 0,
+  REQTRACE_SIGN = 1,
+  REQTRACE_VERIFY = 2,
+  REQTRACE_KEYSETUP = 3
+};
+
+struct reqtrace_entry {
+  uint64_t t;     // nanoseconds since the first request
+  uint8_t op;
+  uint8_t logn;
+  uint32_t key;
+  uint32_t len;
+};
+
+/*
+ * Start recording if SGX_FALCON_RECORD is set. Call once from main().
+ */
+void reqtrace_init(void);
+
+/*
+ * Record one request that arrived at 'arrival' (trace_now() clock).
+ * Thread-safe; does nothing when recording is off.
+ */
+void reqtrace_record(uint64_t arrival, enum reqtrace_op op, uint32_t key,
+    unsigned logn, size_t len);
+
+/*
+ * Read a trace file, sorted by arrival time. Returns 0 on success, -1 on
+ * an unreadable or malformed file.
+ */
+int reqtrace_load(const char *path, std::vector<struct reqtrace_entry> &out);
+
+#endif // _REQTRACE_H
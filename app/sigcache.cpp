@@ -0,0 +1,168 @@
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "sigcache.h"
+#include "metrics.h"
+#include "../include/boundary_types.h"
+#include "../sgx-falcon/shake.h"
+
+#define DIGEST_LEN 32
+
+typedef std::chrono::steady_clock sc_clock;
+
+/*
+ * Entries live in a list in recency order (front: most recently used);
+ * by_id maps a (key, digest) pair to its list node. A 256-bit
+ * digest makes collisions a non-issue, so messages are not kept.
+ */
+struct sc_id {
+  uint32_t key;
+  uint8_t digest[DIGEST_LEN];
+
+  bool operator==(const sc_id &o) const
+  {
+    return key == o.key && memcmp(digest, o.digest, DIGEST_LEN) == 0;
+  }
+};
+
+struct sc_id_hash {
+  size_t operator()(const sc_id &id) const
+  {
+    size_t h;
+    memcpy(&h, id.digest, sizeof h);
+    return h ^ id.key;
+  }
+};
+
+struct sc_entry {
+  sc_id id;
+  sc_clock::time_point stored;
+  size_t sig_len;
+  uint8_t sig[MAX_SIG_LEN];
+  uint8_t nonce[NONCE_LEN];
+};
+
+static std::mutex mu;
+static std::list<sc_entry> lru;
+static std::unordered_map<sc_id, std::list<sc_entry>::iterator, sc_id_hash>
+    by_id;
+/*
+ * Checked before hashing on every lookup and store, so it is read
+ * without the lock; sigcache_init() still writes it under mu.
+ */
+static std::atomic<size_t> max_entries;
+static sc_clock::duration ttl;
+static uint64_t hits, misses, evictions;
+
+static void make_id(sc_id *id, uint32_t key, const uint8_t *msg,
+    size_t msg_len)
+{
+  shake_context sc;
+
+  id->key = key;
+  shake_init(&sc, 512);
+  shake_inject(&sc, msg, msg_len);
+  shake_flip(&sc);
+  shake_extract(&sc, id->digest, DIGEST_LEN);
+}
+
+void sigcache_init(size_t entries, uint64_t ttl_ms)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  max_entries.store(entries, std::memory_order_relaxed);
+  ttl = std::chrono::milliseconds(ttl_ms);
+  by_id.clear();
+  lru.clear();
+}
+
+int sigcache_lookup(uint32_t key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce)
+{
+  if (max_entries.load(std::memory_order_relaxed) == 0)
+    return 0;
+
+  sc_id id;
+  make_id(&id, key, msg, msg_len);
+
+  std::lock_guard<std::mutex> lk(mu);
+  auto it = by_id.find(id);
+  if (it == by_id.end()) {
+    misses++;
+    metrics_sigcache(0);
+    return 0;
+  }
+  std::list<sc_entry>::iterator e = it->second;
+  if (ttl.count() != 0 && sc_clock::now() - e->stored >= ttl) {
+    by_id.erase(it);
+    lru.erase(e);
+    misses++;
+    metrics_sigcache(0);
+    return 0;
+  }
+  lru.splice(lru.begin(), lru, e);
+  memcpy(sig, e->sig, e->sig_len);
+  *sig_len = e->sig_len;
+  memcpy(nonce, e->nonce, NONCE_LEN);
+  hits++;
+  metrics_sigcache(1);
+  return 1;
+}
+
+void sigcache_store(uint32_t key, const uint8_t *msg, size_t msg_len,
+    const uint8_t *sig, size_t sig_len, const uint8_t *nonce)
+{
+  if (max_entries.load(std::memory_order_relaxed) == 0
+      || sig_len > MAX_SIG_LEN)
+    return;
+
+  sc_id id;
+  make_id(&id, key, msg, msg_len);
+
+  std::lock_guard<std::mutex> lk(mu);
+  auto it = by_id.find(id);
+  std::list<sc_entry>::iterator e;
+  if (it != by_id.end()) {
+    // Concurrent misses on the same message: keep the newest pair.
+    e = it->second;
+    lru.splice(lru.begin(), lru, e);
+  } else {
+    if (lru.size() >= max_entries.load(std::memory_order_relaxed)) {
+      by_id.erase(lru.back().id);
+      lru.pop_back();
+      evictions++;
+    }
+    lru.emplace_front();
+    e = lru.begin();
+    e->id = id;
+    by_id[id] = e;
+  }
+  e->stored = sc_clock::now();
+  memcpy(e->sig, sig, sig_len);
+  e->sig_len = sig_len;
+  memcpy(e->nonce, nonce, NONCE_LEN);
+}
+
+void sigcache_invalidate(uint32_t key)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  for (auto e = lru.begin(); e != lru.end(); ) {
+    if (e->id.key == key) {
+      by_id.erase(e->id);
+      e = lru.erase(e);
+    } else {
+      ++e;
+    }
+  }
+}
+
+void sigcache_stats(uint64_t *h, uint64_t *m, uint64_t *ev)
+{
+  std::lock_guard<std::mutex> lk(mu);
+  *h = hits;
+  *m = misses;
+  *ev = evictions;
+}
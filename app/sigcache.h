@@ -0,0 +1,46 @@
+#ifndef _SIGCACHE_H
+#define _SIGCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Signature cache for repeated identical messages.
+ *
+ * Some payloads (health attestations, manifests) are signed over and
+ * over. With the cache enabled, a signing front end first looks up
+ * (key handle, SHAKE-256 digest of the message); on a hit it returns
+ * the signature and nonce produced the first time, which are as valid
+ * as a fresh pair, without entering the enclave.
+ *
+ * The cache holds at most 'max_entries' signatures, evicting the least
+ * recently used, and drops entries older than 'ttl_ms' milliseconds (0:
+ * no expiry). A key handle is whatever identifies the signing key to
+ * the caller (the loadgen uses its enclave pool key handle); after
+ * a key is replaced, sigcache_invalidate() must be called for its
+ * handle, or stale signatures would be served.
+ *
+ * All functions are thread-safe. Until sigcache_init() is called with
+ * a non-zero size, lookups always miss and stores do nothing.
+ */
+void sigcache_init(size_t max_entries, uint64_t ttl_ms);
+
+/*
+ * Look up a signature of 'msg' under key 'key'. On a hit, copies the
+ * signature (at most MAX_SIG_LEN bytes) and nonce (NONCE_LEN bytes)
+ * out and returns 1; returns 0 otherwise.
+ */
+int sigcache_lookup(uint32_t key, const uint8_t *msg, size_t msg_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce);
+
+// Remember a valid signature of 'msg' under key 'key'.
+void sigcache_store(uint32_t key, const uint8_t *msg, size_t msg_len,
+    const uint8_t *sig, size_t sig_len, const uint8_t *nonce);
+
+// Drop all signatures made with key 'key'.
+void sigcache_invalidate(uint32_t key);
+
+// Counters since startup.
+void sigcache_stats(uint64_t *hits, uint64_t *misses, uint64_t *evictions);
+
+#endif // _SIGCACHE_H
@@ -0,0 +1,349 @@
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "signpool.h"
+#include "metrics.h"
+#include "../sgx-falcon/falcon.h"
+#include "../include/boundary_types.h"
+
+#define NODE_DIR "/sys/devices/system/node"
+#define CPU_DIR "/sys/devices/system/cpu"
+
+struct pool_req {
+  const uint8_t *msg;
+  size_t msg_len;
+  uint8_t *sig;
+  size_t *sig_len;
+  uint8_t *nonce;
+  bool done;
+  int ok;
+};
+
+struct node {
+  unsigned id;                      // kernel node number
+  std::vector<int> cpus;            // usable by this process
+  std::vector<int> cores;           // of cpus, one per physical core
+  std::vector<int> siblings;        // of cpus, the other SMT threads
+  std::vector<int> worker_cpus;
+  falcon_expanded_key *key;         // this node's replica
+  std::mutex mu;
+  std::condition_variable wake;     // workers: new request or stop
+  std::condition_variable done;     // callers: request completed
+  std::deque<struct pool_req *> queue;
+};
+
+static std::vector<struct node *> nodes;
+static std::vector<struct node *> active;     // nodes with workers
+static std::vector<struct node *> by_cpu;     // NULL: no local workers
+static std::atomic<unsigned> spill;
+static std::vector<std::thread> threads;
+static bool stopping;
+
+static std::mutex ready_mu;
+static std::condition_variable ready_cv;
+static unsigned ready, failed;
+
+/*
+ * Append the CPUs of a kernel cpulist ("0-3,8-11") that are also in
+ * 'allowed'.
+ */
+static void parse_cpulist(const char *s, const cpu_set_t *allowed,
+    std::vector<int> &cpus)
+{
+  for (;;) {
+    char *end;
+    long a = strtol(s, &end, 10), b;
+    if (end == s)
+      break;
+    b = a;
+    if (*end == '-') {
+      s = end + 1;
+      b = strtol(s, &end, 10);
+    }
+    for (long c = a; c <= b && c < CPU_SETSIZE; c++)
+      if (CPU_ISSET(c, allowed))
+        cpus.push_back((int) c);
+    if (*end != ',')
+      break;
+    s = end + 1;
+  }
+}
+
+static bool node_less(const struct node *a, const struct node *b)
+{
+  return a->id < b->id;
+}
+
+/*
+ * Split a node's CPUs into one per physical core (the lowest usable
+ * thread of each, from thread_siblings_list) and the remaining SMT
+ * siblings. Without topology information, every CPU is a core.
+ */
+static void split_cores(struct node *nd, const cpu_set_t *allowed)
+{
+  for (size_t i = 0; i < nd->cpus.size(); i++) {
+    int c = nd->cpus[i], first = c;
+    char path[96], list[4096];
+    snprintf(path, sizeof path, CPU_DIR "/cpu%d/topology/thread_siblings_list",
+        c);
+    FILE *f = fopen(path, "r");
+    if (f != NULL) {
+      std::vector<int> sibs;
+      if (fgets(list, sizeof list, f) != NULL)
+        parse_cpulist(list, allowed, sibs);
+      fclose(f);
+      if (!sibs.empty())
+        first = *std::min_element(sibs.begin(), sibs.end());
+    }
+    (first == c ? nd->cores : nd->siblings).push_back(c);
+  }
+}
+
+static void read_topology(const cpu_set_t *allowed)
+{
+  DIR *d = opendir(NODE_DIR);
+  struct dirent *de;
+
+  while (d != NULL && (de = readdir(d)) != NULL) {
+    unsigned id;
+    char tail, path[64], list[4096];
+    if (sscanf(de->d_name, "node%u%c", &id, &tail) != 1)
+      continue;
+    snprintf(path, sizeof path, NODE_DIR "/node%u/cpulist", id);
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+      continue;
+    if (fgets(list, sizeof list, f) != NULL) {
+      struct node *nd = new node();
+      nd->id = id;
+      nd->key = NULL;
+      parse_cpulist(list, allowed, nd->cpus);
+      if (nd->cpus.empty())
+        delete nd;
+      else
+        nodes.push_back(nd);
+    }
+    fclose(f);
+  }
+  if (d != NULL)
+    closedir(d);
+  std::sort(nodes.begin(), nodes.end(), node_less);
+
+  if (nodes.empty()) {
+    struct node *nd = new node();
+    nd->id = 0;
+    nd->key = NULL;
+    for (int c = 0; c < CPU_SETSIZE; c++)
+      if (CPU_ISSET(c, allowed))
+        nd->cpus.push_back(c);
+    nodes.push_back(nd);
+  }
+  for (size_t i = 0; i < nodes.size(); i++)
+    split_cores(nodes[i], allowed);
+}
+
+static void pin(const std::vector<int> &cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t i = 0; i < cpus.size(); i++)
+    CPU_SET(cpus[i], &set);
+  int err = pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+  if (err != 0)
+    fprintf(stderr, "signpool: pthread_setaffinity_np: %s\n", strerror(err));
+}
+
+static void build_replica(struct node *nd, const uint8_t *skey,
+    size_t skey_len)
+{
+  pin(nd->cpus);
+  nd->key = falcon_expanded_key_new(skey, skey_len);
+}
+
+static void sign_one(falcon_sign *fs, struct pool_req *q)
+{
+  q->ok = 0;
+  if (!falcon_sign_start(fs, q->nonce))
+    return;
+  falcon_sign_update(fs, q->msg, q->msg_len);
+  *q->sig_len = falcon_sign_generate(fs, q->sig, MAX_SIG_LEN,
+      FALCON_COMP_STATIC);
+  q->ok = *q->sig_len != 0;
+}
+
+static void worker(struct node *nd, int cpu)
+{
+  pin(std::vector<int>(1, cpu));
+  // Scratch space is allocated here, on the worker's node.
+  falcon_sign *fs = falcon_sign_new();
+  bool ok = fs != NULL && falcon_sign_set_expanded_key(fs, nd->key) == 1;
+  {
+    std::lock_guard<std::mutex> lk(ready_mu);
+    ready++;
+    if (!ok)
+      failed++;
+  }
+  ready_cv.notify_one();
+  if (!ok) {
+    falcon_sign_free(fs);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lk(nd->mu);
+  for (;;) {
+    nd->wake.wait(lk, [nd] { return stopping || !nd->queue.empty(); });
+    if (nd->queue.empty())
+      break;
+    struct pool_req *q = nd->queue.front();
+    nd->queue.pop_front();
+    lk.unlock();
+    metrics_queue_add(-1);
+    sign_one(fs, q);
+    lk.lock();
+    q->done = true;
+    nd->done.notify_all();
+  }
+  lk.unlock();
+  falcon_sign_free(fs);
+}
+
+int signpool_start(const uint8_t *skey, size_t skey_len, unsigned workers)
+{
+  cpu_set_t allowed;
+
+  if (sched_getaffinity(0, sizeof allowed, &allowed) != 0) {
+    perror("signpool: sched_getaffinity");
+    return -1;
+  }
+  read_topology(&allowed);
+
+  /*
+   * Interleave nodes so that any prefix of the list is balanced: every
+   * physical core first, then their SMT siblings, which share the
+   * core's floating-point units and are only used when more workers
+   * than cores are asked for.
+   */
+  std::vector<std::pair<struct node *, int> > slots;
+  size_t ncores = 0, ncpus = 0;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    ncores += nodes[i]->cores.size();
+    ncpus += nodes[i]->cpus.size();
+  }
+  for (size_t r = 0; slots.size() < ncores; r++)
+    for (size_t i = 0; i < nodes.size(); i++)
+      if (r < nodes[i]->cores.size())
+        slots.push_back(std::make_pair(nodes[i], nodes[i]->cores[r]));
+  for (size_t r = 0; slots.size() < ncpus; r++)
+    for (size_t i = 0; i < nodes.size(); i++)
+      if (r < nodes[i]->siblings.size())
+        slots.push_back(std::make_pair(nodes[i], nodes[i]->siblings[r]));
+  if (workers == 0)
+    workers = (unsigned) ncores;
+  for (unsigned i = 0; i < workers; i++)
+    slots[i % slots.size()].first->worker_cpus.push_back(
+        slots[i % slots.size()].second);
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    struct node *nd = nodes[i];
+    if (nd->worker_cpus.empty())
+      continue;
+    std::thread(build_replica, nd, skey, skey_len).join();
+    if (nd->key == NULL) {
+      fprintf(stderr, "signpool: invalid private key\n");
+      signpool_stop();
+      return -1;
+    }
+    active.push_back(nd);
+  }
+  for (size_t i = 0; i < active.size(); i++)
+    for (size_t j = 0; j < active[i]->cpus.size(); j++) {
+      size_t c = (size_t) active[i]->cpus[j];
+      if (by_cpu.size() <= c)
+        by_cpu.resize(c + 1);
+      by_cpu[c] = active[i];
+    }
+
+  stopping = false;
+  ready = failed = 0;
+  for (size_t i = 0; i < active.size(); i++)
+    for (size_t j = 0; j < active[i]->worker_cpus.size(); j++)
+      threads.push_back(std::thread(worker, active[i],
+          active[i]->worker_cpus[j]));
+  {
+    std::unique_lock<std::mutex> lk(ready_mu);
+    ready_cv.wait(lk, [workers] { return ready == workers; });
+  }
+  if (failed != 0) {
+    fprintf(stderr, "signpool: could not set up %u workers\n", failed);
+    signpool_stop();
+    return -1;
+  }
+  return 0;
+}
+
+int signpool_sign(const uint8_t *msg, size_t msg_len, uint8_t *sig,
+    size_t *sig_len, uint8_t *nonce)
+{
+  struct pool_req q;
+  int cpu = sched_getcpu();
+  struct node *nd = cpu >= 0 && (size_t) cpu < by_cpu.size()
+      ? by_cpu[cpu] : NULL;
+
+  if (nd == NULL)
+    nd = active[spill++ % active.size()];
+  q.msg = msg;
+  q.msg_len = msg_len;
+  q.sig = sig;
+  q.sig_len = sig_len;
+  q.nonce = nonce;
+  q.done = false;
+  std::unique_lock<std::mutex> lk(nd->mu);
+  nd->queue.push_back(&q);
+  metrics_queue_add(1);
+  nd->wake.notify_one();
+  nd->done.wait(lk, [&q] { return q.done; });
+  return q.ok;
+}
+
+void signpool_describe(FILE *f)
+{
+  fprintf(f, "signing pool: %zu workers on %zu of %zu NUMA nodes\n",
+      threads.size(), active.size(), nodes.size());
+  for (size_t i = 0; i < active.size(); i++) {
+    fprintf(f, "  node %u: cpus", active[i]->id);
+    for (size_t j = 0; j < active[i]->worker_cpus.size(); j++)
+      fprintf(f, "%c%d", j == 0 ? ' ' : ',', active[i]->worker_cpus[j]);
+    fprintf(f, "\n");
+  }
+}
+
+void signpool_stop(void)
+{
+  for (size_t i = 0; i < nodes.size(); i++) {
+    std::lock_guard<std::mutex> lk(nodes[i]->mu);
+    stopping = true;
+  }
+  for (size_t i = 0; i < nodes.size(); i++)
+    nodes[i]->wake.notify_all();
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+  threads.clear();
+  for (size_t i = 0; i < nodes.size(); i++) {
+    falcon_expanded_key_free(nodes[i]->key);
+    delete nodes[i];
+  }
+  nodes.clear();
+  active.clear();
+  by_cpu.clear();
+}
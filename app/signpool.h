@@ -0,0 +1,54 @@
+#ifndef _SIGNPOOL_H
+#define _SIGNPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * NUMA-aware native signing pool.
+ *
+ * Signing walks the whole expanded private key (the ffLDL tree) for
+ * every signature; a worker on one socket reading a key that lives in
+ * the other socket's memory pays an interconnect round trip on most of
+ * those loads. The pool therefore:
+ *
+ *  - pins each worker to one CPU, spreading workers round-robin over
+ *    the NUMA nodes (from /sys/devices/system/node, restricted to the
+ *    CPUs this process may use), one per physical core before any SMT
+ *    sibling (from each CPU's thread_siblings_list);
+ *
+ *  - keeps one falcon_expanded_key replica per node, built by a thread
+ *    pinned to that node, so that under the default first-touch policy
+ *    its pages are node-local; the workers' own signing contexts are
+ *    allocated the same way;
+ *
+ *  - queues each request on the node the calling thread runs on, where
+ *    only that node's workers take it. Callers on a node without
+ *    workers are spread over the others.
+ *
+ * Without NUMA information (or on a single node) this is a plain pinned
+ * worker pool with one shared key.
+ */
+
+/*
+ * Start 'workers' threads signing with the encoded private key 'skey'
+ * (0: one per physical core with a usable CPU). Returns 0 on success, -1 on error.
+ */
+int signpool_start(const uint8_t *skey, size_t skey_len, unsigned workers);
+
+/*
+ * Sign 'msg' on a worker of the caller's node and wait for it. 'sig'
+ * takes MAX_SIG_LEN bytes, 'nonce' NONCE_LEN bytes. Returns 1 on
+ * success, 0 on error. Thread-safe.
+ */
+int signpool_sign(const uint8_t *msg, size_t msg_len, uint8_t *sig,
+    size_t *sig_len, uint8_t *nonce);
+
+// Print the node, CPU and worker layout.
+void signpool_describe(FILE *f);
+
+// Stop the workers once their queues are empty; free the replicas.
+void signpool_stop(void);
+
+#endif // _SIGNPOOL_H
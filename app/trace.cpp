@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <chrono>
+
+#include "trace.h"
+
+std::atomic<bool> trace_on(false);
+
+static const char *trace_path = NULL;
+
+struct trace_event {
+  const char *name;
+  const char *cat;
+  uint64_t start;
+  uint64_t end;
+};
+
+/*
+ * One buffer per recording thread. Only the owning thread writes
+ * 'events' and 'count'; the count is published with release semantics
+ * so that trace_dump() sees complete events. Buffers are linked into a
+ * global list with a CAS push and are never freed.
+ */
+struct trace_buffer {
+  struct trace_buffer *next;
+  long tid;
+  std::atomic<size_t> count;
+  uint64_t dropped;
+  struct trace_event events[TRACE_EVENTS_PER_THREAD];
+};
+
+static std::atomic<struct trace_buffer *> buffers(NULL);
+static thread_local struct trace_buffer *local_buffer = NULL;
+
+static struct trace_buffer *get_buffer(void)
+{
+  struct trace_buffer *b = local_buffer;
+  if (b != NULL)
+    return b;
+
+  b = (struct trace_buffer *) malloc(sizeof *b);
+  if (b == NULL)
+    return NULL;
+  b->tid = (long) syscall(SYS_gettid);
+  b->count.store(0, std::memory_order_relaxed);
+  b->dropped = 0;
+  b->next = buffers.load(std::memory_order_relaxed);
+  while (!buffers.compare_exchange_weak(b->next, b,
+      std::memory_order_release, std::memory_order_relaxed))
+    ;
+  local_buffer = b;
+  return b;
+}
+
+uint64_t trace_now(void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_span_record(const char *name, const char *cat, uint64_t start,
+    uint64_t end)
+{
+  if (!trace_enabled())
+    return;
+  struct trace_buffer *b = get_buffer();
+  if (b == NULL)
+    return;
+
+  size_t n = b->count.load(std::memory_order_relaxed);
+  if (n == TRACE_EVENTS_PER_THREAD) {
+    b->dropped++;
+    return;
+  }
+  b->events[n].name = name;
+  b->events[n].cat = cat;
+  b->events[n].start = start;
+  b->events[n].end = end;
+  b->count.store(n + 1, std::memory_order_release);
+}
+
+int trace_dump(const char *path)
+{
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    fprintf(stderr, "could not open trace file '%s'\n", path);
+    return -1;
+  }
+
+  long pid = (long) getpid();
+  uint64_t dropped = 0;
+  const char *sep = "";
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  for (struct trace_buffer *b = buffers.load(std::memory_order_acquire);
+      b != NULL; b = b->next) {
+    size_t n = b->count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; i++) {
+      const struct trace_event *e = &b->events[i];
+      // Trace-event timestamps are in microseconds.
+      fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+          "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld}",
+          sep, e->name, e->cat, e->start / 1e3, (e->end - e->start) / 1e3,
+          pid, b->tid);
+      sep = ",\n";
+    }
+    dropped += b->dropped;
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+
+  if (dropped != 0)
+    fprintf(stderr, "trace: %llu events dropped (buffer full)\n",
+        (unsigned long long) dropped);
+  return 0;
+}
+
+static void trace_atexit(void)
+{
+  trace_on.store(false);
+  trace_dump(trace_path);
+}
+
+void trace_init(void)
+{
+  const char *path = getenv("SGX_FALCON_TRACE");
+  if (path == NULL || *path == 0)
+    return;
+  trace_path = path;
+  trace_on.store(true);
+  atexit(trace_atexit);
+}
@@ -0,0 +1,77 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdint.h>
+#include <atomic>
+
+/*
+ * Timeline tracing in the Chrome trace-event format.
+ *
+ * When the SGX_FALCON_TRACE environment variable names a file,
+ * trace_init() turns tracing on and the collected spans are written to
+ * that file at exit; load it in chrome://tracing or Perfetto. Without
+ * it, every trace call reduces to one relaxed atomic load.
+ *
+ * Each thread records into its own fixed-size buffer, so recording
+ * takes no lock. Events past TRACE_EVENTS_PER_THREAD are dropped (and
+ * counted). Span names and categories must be string literals, or at
+ * least outlive the process' exit: only the pointers are stored.
+ *
+ * Categories used by the host binaries:
+ *   request   one signing request ("queue" is time spent waiting to be
+ *             sent, for the open-loop load generator)
+ *   ecall     one enclave transition, named after the ECALL
+ *   ocall     one untrusted call made by the enclave
+ */
+#define TRACE_EVENTS_PER_THREAD (1 << 16)
+
+extern std::atomic<bool> trace_on;
+
+/*
+ * Enable tracing if SGX_FALCON_TRACE is set. Call once from main(),
+ * before starting any thread.
+ */
+void trace_init(void);
+
+// Monotonic timestamp in nanoseconds.
+uint64_t trace_now(void);
+
+// Record a complete span [start, end] on the calling thread.
+void trace_span_record(const char *name, const char *cat, uint64_t start,
+    uint64_t end);
+
+/*
+ * Write all recorded spans as a trace-event JSON file. Called
+ * automatically at exit when enabled through trace_init(); all other
+ * threads must have stopped recording by then.
+ */
+int trace_dump(const char *path);
+
+static inline bool trace_enabled(void)
+{
+  return trace_on.load(std::memory_order_relaxed);
+}
+
+/*
+ * Scoped span: records from construction to destruction.
+ */
+class trace_span {
+ public:
+  trace_span(const char *name, const char *cat)
+    : name_(name), cat_(cat), start_(trace_enabled() ? trace_now() : 0) {}
+  ~trace_span()
+  {
+    if (start_ != 0)
+      trace_span_record(name_, cat_, start_, trace_now());
+  }
+
+ private:
+  trace_span(const trace_span &);
+  trace_span &operator=(const trace_span &);
+
+  const char *name_;
+  const char *cat_;
+  uint64_t start_;
+};
+
+#endif // _TRACE_H
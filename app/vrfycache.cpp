@@ -0,0 +1,138 @@
+#include <string.h>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "vrfycache.h"
+#include "metrics.h"
+#include "../include/boundary_types.h"
+#include "../sgx-falcon/shake.h"
+
+#define DIGEST_LEN 32
+
+struct vc_digest {
+  uint8_t d[DIGEST_LEN];
+
+  bool operator==(const vc_digest &o) const
+  {
+    return memcmp(d, o.d, DIGEST_LEN) == 0;
+  }
+};
+
+// The shard index uses the first digest byte; the hash the next ones.
+struct vc_digest_hash {
+  size_t operator()(const vc_digest &k) const
+  {
+    size_t h;
+    memcpy(&h, k.d + 1, sizeof h);
+    return h;
+  }
+};
+
+/*
+ * Entries are in recency order (front: most recently used). Shards are
+ * cache-line aligned so that their locks do not share lines.
+ */
+struct alignas(64) vc_shard {
+  std::mutex mu;
+  std::list<vc_digest> lru;
+  std::unordered_map<vc_digest, std::list<vc_digest>::iterator,
+      vc_digest_hash> by_digest;
+  uint64_t hits, misses, evictions;
+};
+
+static struct vc_shard shards[VRFYCACHE_SHARDS];
+static size_t shard_max;
+
+void vrfycache_init(size_t max_entries)
+{
+  shard_max = (max_entries + VRFYCACHE_SHARDS - 1) / VRFYCACHE_SHARDS;
+  for (int i = 0; i < VRFYCACHE_SHARDS; i++) {
+    std::lock_guard<std::mutex> lk(shards[i].mu);
+    shards[i].by_digest.clear();
+    shards[i].lru.clear();
+    shards[i].by_digest.reserve(shard_max);
+  }
+}
+
+void vrfycache_key_id(uint8_t *key_id, const uint8_t *pk, size_t pk_len)
+{
+  shake_context sc;
+
+  shake_init(&sc, 512);
+  shake_inject(&sc, pk, pk_len);
+  shake_flip(&sc);
+  shake_extract(&sc, key_id, VRFYCACHE_KEY_ID_LEN);
+}
+
+int vrfycache_verify(falcon_vrfy *fv, const uint8_t *key_id,
+    const uint8_t *nonce, const uint8_t *sig, size_t sig_len,
+    const uint8_t *msg, size_t msg_len)
+{
+  if (shard_max == 0) {
+    falcon_vrfy_start(fv, nonce, NONCE_LEN);
+    falcon_vrfy_update(fv, msg, msg_len);
+    return falcon_vrfy_verify(fv, sig, sig_len);
+  }
+
+  /*
+   * The signature length is part of the digest, so that the boundary
+   * between signature and message is unambiguous.
+   */
+  vc_digest k;
+  shake_context sc;
+  uint8_t len[8];
+  for (int i = 0; i < 8; i++)
+    len[i] = (uint8_t) ((uint64_t) sig_len >> (8 * i));
+  shake_init(&sc, 512);
+  shake_inject(&sc, key_id, VRFYCACHE_KEY_ID_LEN);
+  shake_inject(&sc, nonce, NONCE_LEN);
+  shake_inject(&sc, len, sizeof len);
+  shake_inject(&sc, sig, sig_len);
+  shake_inject(&sc, msg, msg_len);
+  shake_flip(&sc);
+  shake_extract(&sc, k.d, DIGEST_LEN);
+
+  struct vc_shard *s = &shards[k.d[0] % VRFYCACHE_SHARDS];
+  {
+    std::lock_guard<std::mutex> lk(s->mu);
+    auto it = s->by_digest.find(k);
+    if (it != s->by_digest.end()) {
+      s->lru.splice(s->lru.begin(), s->lru, it->second);
+      s->hits++;
+      metrics_vrfycache(1);
+      return 1;
+    }
+    s->misses++;
+  }
+  metrics_vrfycache(0);
+
+  falcon_vrfy_start(fv, nonce, NONCE_LEN);
+  falcon_vrfy_update(fv, msg, msg_len);
+  int r = falcon_vrfy_verify(fv, sig, sig_len);
+  if (r != 1)
+    return r;
+
+  std::lock_guard<std::mutex> lk(s->mu);
+  if (s->by_digest.find(k) != s->by_digest.end())
+    return r;
+  if (s->lru.size() >= shard_max) {
+    s->by_digest.erase(s->lru.back());
+    s->lru.pop_back();
+    s->evictions++;
+  }
+  s->lru.push_front(k);
+  s->by_digest[k] = s->lru.begin();
+  return r;
+}
+
+void vrfycache_stats(uint64_t *hits, uint64_t *misses, uint64_t *evictions)
+{
+  *hits = *misses = *evictions = 0;
+  for (int i = 0; i < VRFYCACHE_SHARDS; i++) {
+    std::lock_guard<std::mutex> lk(shards[i].mu);
+    *hits += shards[i].hits;
+    *misses += shards[i].misses;
+    *evictions += shards[i].evictions;
+  }
+}
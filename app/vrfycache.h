@@ -0,0 +1,49 @@
+#ifndef _VRFYCACHE_H
+#define _VRFYCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../sgx-falcon/falcon.h"
+
+/*
+ * Verification result cache.
+ *
+ * Signed objects that fan out through a gateway get verified again and
+ * again. The cache remembers tuples (public key, nonce, signature,
+ * message) that verified, identified by a SHAKE-256 digest of the
+ * whole tuple; a repeat verification then costs that hash and a table
+ * lookup instead of hash-to-point and the NTTs. Only positive results
+ * are stored, so a forged tuple always goes through the full check.
+ *
+ * The table is split into VRFYCACHE_SHARDS shards, chosen by digest,
+ * each with its own lock and least-recently-used eviction, so that
+ * concurrent verifiers rarely contend. Until vrfycache_init() is
+ * called with a non-zero size, every call runs the full verification.
+ */
+#define VRFYCACHE_SHARDS 16
+#define VRFYCACHE_KEY_ID_LEN 32
+
+// Keep at most 'max_entries' results. Call before any verification.
+void vrfycache_init(size_t max_entries);
+
+/*
+ * Compute the identifier of a public key, once per key; it stands for
+ * the key in the tuple digest.
+ */
+void vrfycache_key_id(uint8_t *key_id, const uint8_t *pk, size_t pk_len);
+
+/*
+ * Verify a signature with 'fv', which must hold the public key that
+ * 'key_id' identifies, unless the same tuple verified before. Returns
+ * falcon_vrfy_verify()'s result (1 on success). Thread-safe, as long
+ * as each thread uses its own 'fv'.
+ */
+int vrfycache_verify(falcon_vrfy *fv, const uint8_t *key_id,
+    const uint8_t *nonce, const uint8_t *sig, size_t sig_len,
+    const uint8_t *msg, size_t msg_len);
+
+// Counters since startup, over all shards.
+void vrfycache_stats(uint64_t *hits, uint64_t *misses, uint64_t *evictions);
+
+#endif // _VRFYCACHE_H
@@ -1,5 +1,8 @@
 #include "enclave.h"
 #include "enclave_t.h"
+#include "sgx_tseal.h"
+#include "keypub.h"
+#include "memstats.h"
 #include "../include/boundary_types.h"
 #include "../sgx-falcon/falcon.h"
 
@@ -7,65 +10,611 @@
 extern "C" {
 #endif
 
-uint8_t pkey[3000];
-uint8_t skey[6000];
-static size_t pkey_len = 3000;
-static size_t skey_len = 6000;
+/*
+ * Operation bodies on keys passed in by the caller: the published key
+ * pair (see keypub.h), a sealed tenant pair, or the scratch keys of
+ * trust_falcon_memstats(). Signing with the published key goes through
+ * sign_begin() instead, on its expanded key.
+ */
+static sgx_status_t do_keygen(unsigned logn, uint8_t *sk, size_t *sk_len,
+    uint8_t *pk, size_t *pk_len)
+{
+  falcon_keygen *fk = falcon_keygen_new(logn, 0);
+  if (fk == NULL)
+    return SGX_ERROR_OUT_OF_MEMORY;
 
-sgx_status_t trust_falcon_keygen(void)
+  int r = falcon_keygen_make(fk, FALCON_COMP_STATIC, sk, sk_len, pk, pk_len);
+  falcon_keygen_free(fk);
+  return r == 1 ? SGX_SUCCESS : SGX_ERROR_UNEXPECTED;
+}
+
+/*
+ * One signature with a key that is not kept: dynamic mode, since the
+ * LDL tree would be built for that signature only (see
+ * FALCON_SIGN_DYNAMIC in falcon.h).
+ */
+static sgx_status_t do_sign(const uint8_t *sk, size_t sk_len, uint8_t *sig,
+    size_t *sig_len, uint8_t *nonce, const uint8_t *pt, size_t pt_len)
 {
-  // TODO: Should probably have preprocessor defines for the key settings.
-  falcon_keygen *fk = falcon_keygen_new(9, 0);
-  if (fk == NULL) {
-    ocall_print_string("Failed to allocate keygen context.\n");
+  falcon_sign *fs = falcon_sign_new();
+  if (fs == NULL)
+    return SGX_ERROR_OUT_OF_MEMORY;
+  if (!falcon_sign_set_mode(fs, FALCON_SIGN_DYNAMIC)
+      || !falcon_sign_set_private_key(fs, sk, sk_len)) {
+    falcon_sign_free(fs);
     return SGX_ERROR_UNEXPECTED;
   }
 
-  int r = falcon_keygen_make(fk, FALCON_COMP_STATIC, &skey, &skey_len,
-      &pkey, &pkey_len);
-  if (r != 1) {
-    ocall_print_string("Failed to generate keys.\n");
+  if (!falcon_sign_start(fs, nonce)) {
+    falcon_sign_free(fs);
     return SGX_ERROR_UNEXPECTED;
   }
+  falcon_sign_update(fs, pt, pt_len);
+  size_t size = falcon_sign_generate(fs, sig, MAX_SIG_LEN, FALCON_COMP_STATIC);
+  falcon_sign_free(fs);
+  if (size == 0)
+    return SGX_ERROR_UNEXPECTED;
 
-  falcon_keygen_free(fk);
+  *sig_len = size;
   return SGX_SUCCESS;
 }
 
-sgx_status_t trust_falcon_sign(uint8_t *sig, size_t *sig_len, uint8_t *pt,
-    size_t pt_len)
+/*
+ * Point 'fs' at the published key, which is already expanded. On
+ * success, the caller is inside a read-side section (see keypub.h)
+ * until key_exit(*slot); on failure, the section is already left.
+ */
+static sgx_status_t sign_key(falcon_sign *fs, unsigned *slot)
+{
+  const struct key_version *k = key_enter(slot);
+  sgx_status_t r = SGX_SUCCESS;
+
+  if (k == NULL) {
+    ocall_print_string("Failed: invalid state.\n");
+    r = SGX_ERROR_INVALID_STATE;
+  } else if (!falcon_sign_set_expanded_key(fs, k->ek)) {
+    r = SGX_ERROR_UNEXPECTED;
+  }
+  if (r != SGX_SUCCESS)
+    key_exit(*slot);
+  return r;
+}
+
+/*
+ * Signing context on the published key, inside a read-side section
+ * until sign_end(); on failure, returns NULL with the reason in '*r'.
+ */
+static falcon_sign *sign_begin(unsigned *slot, sgx_status_t *r)
+{
+  falcon_sign *fs = falcon_sign_new();
+
+  if (fs == NULL) {
+    *r = SGX_ERROR_OUT_OF_MEMORY;
+  } else if ((*r = sign_key(fs, slot)) != SGX_SUCCESS) {
+    falcon_sign_free(fs);
+    fs = NULL;
+  }
+  return fs;
+}
+
+static void sign_end(falcon_sign *fs, unsigned slot)
+{
+  falcon_sign_free(fs);
+  key_exit(slot);
+}
+
+// One signature with a context that already has its key.
+static sgx_status_t sign_one(falcon_sign *fs, uint8_t *sig, size_t *sig_len,
+    uint8_t *nonce, const uint8_t *pt, size_t pt_len)
+{
+  size_t size = 0;
+  if (falcon_sign_start(fs, nonce)) {
+    falcon_sign_update(fs, pt, pt_len);
+    size = falcon_sign_generate(fs, sig, MAX_SIG_LEN, FALCON_COMP_STATIC);
+  }
+  if (size == 0)
+    return SGX_ERROR_UNEXPECTED;
+
+  *sig_len = size;
+  return SGX_SUCCESS;
+}
+
+static sgx_status_t do_verify(const uint8_t *pk, size_t pk_len,
+    const uint8_t *sig, size_t sig_len, const uint8_t *nonce,
+    const uint8_t *pt, size_t pt_len, int *result)
+{
+  falcon_vrfy *fv = falcon_vrfy_new();
+  if (fv == NULL)
+    return SGX_ERROR_OUT_OF_MEMORY;
+  if (!falcon_vrfy_set_public_key(fv, pk, pk_len)) {
+    falcon_vrfy_free(fv);
+    return SGX_ERROR_UNEXPECTED;
+  }
+
+  falcon_vrfy_start(fv, nonce, NONCE_LEN);
+  falcon_vrfy_update(fv, pt, pt_len);
+  *result = falcon_vrfy_verify(fv, sig, sig_len);
+  falcon_vrfy_free(fv);
+  return SGX_SUCCESS;
+}
+
+sgx_status_t trust_falcon_keygen(unsigned logn)
+{
+  if (logn < 1 || logn > 10) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+
+  // Signers keep using the previous key until the new one is ready.
+  struct key_version *k = key_version_new();
+  if (k == NULL)
+    return SGX_ERROR_OUT_OF_MEMORY;
+  k->skey_len = sizeof k->skey;
+  k->pkey_len = sizeof k->pkey;
+  sgx_status_t r = do_keygen(logn, k->skey, &k->skey_len, k->pkey,
+      &k->pkey_len);
+  if (r == SGX_SUCCESS)
+    return key_publish(k);
+  key_version_free(k);
+  ocall_print_string("Failed to generate keys.\n");
+  return r;
+}
+
+sgx_status_t trust_falcon_sign(uint8_t *sig, size_t *sig_len, uint8_t *nonce,
+    uint8_t *pt, size_t pt_len)
 {
-  if ((sig == NULL) || (sig_len == NULL) || (pt == NULL) || (pt_len <= 0)) {
+  if ((sig == NULL) || (sig_len == NULL) || (nonce == NULL) || (pt == NULL)
+      || (pt_len <= 0)) {
     ocall_print_string("Failed: invalid parameter.\n");
     return SGX_ERROR_INVALID_PARAMETER;
   }
-  if (skey_len <= 0) {
+
+  unsigned slot;
+  sgx_status_t r;
+  falcon_sign *fs = sign_begin(&slot, &r);
+  if (fs == NULL)
+    return r;
+  r = sign_one(fs, sig, sig_len, nonce, pt, pt_len);
+  sign_end(fs, slot);
+  return r;
+}
+
+sgx_status_t trust_falcon_verify(uint8_t *sig, size_t sig_len, uint8_t *nonce,
+    uint8_t *pt, size_t pt_len, int *result)
+{
+  if ((sig == NULL) || (sig_len <= 0) || (nonce == NULL) || (pt == NULL)
+      || (result == NULL)) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+
+  unsigned slot;
+  const struct key_version *k = key_enter(&slot);
+  sgx_status_t r = SGX_ERROR_INVALID_STATE;
+  if (k != NULL)
+    r = do_verify(k->pkey, k->pkey_len, sig, sig_len, nonce, pt, pt_len,
+        result);
+  key_exit(slot);
+  if (r == SGX_ERROR_INVALID_STATE)
     ocall_print_string("Failed: invalid state.\n");
-    return SGX_ERROR_INVALID_STATE;
+  return r;
+}
+
+sgx_status_t trust_falcon_get_pubkey(uint8_t *pk, size_t pk_max,
+    size_t *pk_len)
+{
+  if ((pk == NULL) || (pk_len == NULL))
+    return SGX_ERROR_INVALID_PARAMETER;
+
+  unsigned slot;
+  const struct key_version *k = key_enter(&slot);
+  sgx_status_t r = SGX_SUCCESS;
+  if (k == NULL) {
+    r = SGX_ERROR_INVALID_STATE;
+  } else if (pk_max < k->pkey_len) {
+    r = SGX_ERROR_INVALID_PARAMETER;
+  } else {
+    memcpy(pk, k->pkey, k->pkey_len);
+    *pk_len = k->pkey_len;
+  }
+  key_exit(slot);
+  return r;
+}
+
+/*
+ * Select the Gaussian sampler backend used by later signatures (see
+ * falcon_sampler_set_default()). The enclave has no usable clock, so
+ * the host picks the backend, e.g. with falcon_sampler_autotune(); the
+ * host is not trusted with the choice of a variable-time one, so only
+ * backends with a constant number of PRNG invocations are accepted.
+ */
+sgx_status_t trust_falcon_set_sampler(const char *name)
+{
+  if (name == NULL)
+    return SGX_ERROR_INVALID_PARAMETER;
+  for (unsigned u = 0; falcon_sampler_name(u) != NULL; u++) {
+    if (strcmp(falcon_sampler_name(u), name) == 0) {
+      if (!falcon_sampler_is_ct(u) || !falcon_sampler_set_default(name))
+        return SGX_ERROR_INVALID_PARAMETER;
+      return SGX_SUCCESS;
+    }
   }
+  return SGX_ERROR_INVALID_PARAMETER;
+}
 
-  ocall_print_string("Copied plaintext:\n");
-  ocall_print((char *) pt, pt_len);
-  ocall_print_string("\n");
+/*
+ * Sign several independent messages in one transition. Messages are
+ * concatenated in 'msgs'; signature i goes to sigs + i * MAX_SIG_LEN
+ * and its length to sig_lens[i], 0 if that signature failed. One
+ * signing context serves the whole call, but each message gets its own
+ * read-side section, so that a key change waits for one signature, not
+ * for up to SIGN_MANY_MAX of them; a key published during the call is
+ * used from the next message on.
+ */
+sgx_status_t trust_falcon_sign_many(uint8_t *msgs, size_t msgs_len,
+    uint32_t *msg_lens, size_t count, uint8_t *sigs, size_t sigs_len,
+    uint32_t *sig_lens, uint8_t *nonces, size_t nonces_len)
+{
+  if ((msgs == NULL) || (msg_lens == NULL) || (count == 0)
+      || (count > SIGN_MANY_MAX) || (sigs == NULL)
+      || (sigs_len != count * MAX_SIG_LEN) || (sig_lens == NULL)
+      || (nonces == NULL) || (nonces_len != count * NONCE_LEN)) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+    total += msg_lens[i];
+  if (total != msgs_len) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
 
   falcon_sign *fs = falcon_sign_new();
-  falcon_sign_set_private_key(fs, &skey, skey_len);
+  if (fs == NULL)
+    return SGX_ERROR_OUT_OF_MEMORY;
+  const uint8_t *pt = msgs;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t *nonce = nonces + i * NONCE_LEN;
+    unsigned slot;
+    sig_lens[i] = 0;
+    sgx_status_t r = sign_key(fs, &slot);
+    if (r != SGX_SUCCESS) {
+      falcon_sign_free(fs);
+      return r;
+    }
+    if (falcon_sign_start(fs, nonce)) {
+      falcon_sign_update(fs, pt, msg_lens[i]);
+      sig_lens[i] = (uint32_t) falcon_sign_generate(fs,
+          sigs + i * MAX_SIG_LEN, MAX_SIG_LEN, FALCON_COMP_STATIC);
+    }
+    key_exit(slot);
+    pt += msg_lens[i];
+  }
+  falcon_sign_free(fs);
+  return SGX_SUCCESS;
+}
+
+/*
+ * Sign a batch of messages at once: 'leaves' holds the leaf hashes
+ * (falcon_batch_leaf()), computed by the host, and the enclave signs the
+ * root of their Merkle tree. The root is recomputed here, so the host
+ * cannot get a signature on a root of its choosing that does not match
+ * the leaves; it builds the inclusion proofs itself.
+ */
+sgx_status_t trust_falcon_sign_batch(uint8_t *leaves, size_t leaves_len,
+    uint8_t *root, uint8_t *sig, size_t *sig_len, uint8_t *nonce)
+{
+  if ((leaves == NULL) || (leaves_len == 0)
+      || (leaves_len % FALCON_BATCH_HASH_LEN != 0) || (root == NULL)
+      || (sig == NULL) || (sig_len == NULL) || (nonce == NULL)) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+
+  unsigned slot;
+  sgx_status_t r;
+  falcon_sign *fs = sign_begin(&slot, &r);
+  if (fs == NULL)
+    return r;
+  size_t count = leaves_len / FALCON_BATCH_HASH_LEN;
+  falcon_batch_root(root, leaves, count);
+  size_t size = falcon_batch_sign(fs, nonce, root, count, sig, MAX_SIG_LEN,
+      FALCON_COMP_STATIC);
+  sign_end(fs, slot);
+  if (size == 0)
+    return SGX_ERROR_UNEXPECTED;
 
-  uint8_t r_nonce[40];
-  falcon_sign_start(fs, &r_nonce);
-  falcon_sign_update(fs, pt, pt_len);
-  size_t size = falcon_sign_generate(fs, sig, MAX_SIG_LEN, FALCON_COMP_STATIC);
   *sig_len = size;
-  falcon_sign_free(fs);
+  return SGX_SUCCESS;
+}
+
+/*
+ * Sealed key pair: lengths (32-bit little-endian), private key, public
+ * key. The sealing key is derived from MRENCLAVE, so only instances of
+ * this very enclave build can import the blob; the host uses it to
+ * replicate a key over several enclaves and to restore it into an
+ * enclave it had to restart.
+ */
+#define SEALED_HDR_LEN 8
+#define KEY_PLAIN_MAX (SEALED_HDR_LEN + KEY_SKEY_MAX + MAX_PKEY_LEN)
+
+static void put32(uint8_t *p, uint32_t x)
+{
+  p[0] = (uint8_t) x;
+  p[1] = (uint8_t) (x >> 8);
+  p[2] = (uint8_t) (x >> 16);
+  p[3] = (uint8_t) (x >> 24);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8)
+      | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void wipe(void *p, size_t len)
+{
+  volatile uint8_t *b = (volatile uint8_t *) p;
+  while (len-- > 0)
+    *b++ = 0;
+}
+
+/*
+ * Seal the pair (sk, pk) into 'blob'; 'plain' is scratch space of
+ * SEALED_HDR_LEN + sk_len + pk_len bytes, wiped on return.
+ */
+static sgx_status_t seal_pair(uint8_t *plain, const uint8_t *sk,
+    size_t sk_len, const uint8_t *pk, size_t pk_len, uint8_t *blob,
+    size_t blob_max, size_t *blob_len)
+{
+  uint32_t plain_len = (uint32_t) (SEALED_HDR_LEN + sk_len + pk_len);
+  put32(plain, (uint32_t) sk_len);
+  put32(plain + 4, (uint32_t) pk_len);
+  memcpy(plain + SEALED_HDR_LEN, sk, sk_len);
+  memcpy(plain + SEALED_HDR_LEN + sk_len, pk, pk_len);
+
+  uint32_t size = sgx_calc_sealed_data_size(0, plain_len);
+  if ((size == 0xFFFFFFFF) || (size > blob_max)) {
+    wipe(plain, plain_len);
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+  sgx_attributes_t mask;
+  mask.flags = TSEAL_DEFAULT_FLAGSMASK;
+  mask.xfrm = 0;
+  sgx_status_t r = sgx_seal_data_ex(SGX_KEYPOLICY_MRENCLAVE, mask,
+      TSEAL_DEFAULT_MISCMASK, 0, NULL, plain_len, plain, size,
+      (sgx_sealed_data_t *) blob);
+  wipe(plain, plain_len);
+  if (r != SGX_SUCCESS)
+    return r;
+
+  *blob_len = size;
+  return SGX_SUCCESS;
+}
 
-  // Go ahead and print the pubkey from this context.
-  ocall_print_string("Public key:\n");
-  ocall_print((char *) pkey, pkey_len);
-  ocall_print_string("\n");
+/*
+ * Unseal 'blob' into 'plain' (KEY_PLAIN_MAX bytes); on success, the
+ * private key is at plain + SEALED_HDR_LEN, followed by the public key.
+ * The caller wipes 'plain'.
+ */
+static sgx_status_t unseal_pair(const uint8_t *blob, size_t blob_len,
+    uint8_t *plain, size_t *sk_len, size_t *pk_len)
+{
+  if ((blob == NULL) || (blob_len < sizeof(sgx_sealed_data_t)))
+    return SGX_ERROR_INVALID_PARAMETER;
+  const sgx_sealed_data_t *sealed = (const sgx_sealed_data_t *) blob;
+  uint32_t plain_len = sgx_get_encrypt_txt_len(sealed);
+  if ((plain_len < SEALED_HDR_LEN) || (plain_len > KEY_PLAIN_MAX)
+      || (sgx_get_add_mac_txt_len(sealed) != 0)
+      || (sgx_calc_sealed_data_size(0, plain_len) != blob_len))
+    return SGX_ERROR_INVALID_PARAMETER;
+
+  sgx_status_t r = sgx_unseal_data(sealed, NULL, NULL, plain, &plain_len);
+  if (r != SGX_SUCCESS) {
+    ocall_print_string("Failed: cannot unseal key.\n");
+    return r;
+  }
+  *sk_len = get32(plain);
+  *pk_len = get32(plain + 4);
+  if ((*sk_len == 0) || (*sk_len > KEY_SKEY_MAX) || (*pk_len == 0)
+      || (*pk_len > MAX_PKEY_LEN)
+      || (SEALED_HDR_LEN + *sk_len + *pk_len != plain_len))
+    return SGX_ERROR_INVALID_PARAMETER;
   return SGX_SUCCESS;
 }
 
+sgx_status_t trust_falcon_export_key(uint8_t *blob, size_t blob_max,
+    size_t *blob_len)
+{
+  uint8_t plain[KEY_PLAIN_MAX];
+
+  if ((blob == NULL) || (blob_len == NULL))
+    return SGX_ERROR_INVALID_PARAMETER;
+
+  unsigned slot;
+  const struct key_version *k = key_enter(&slot);
+  sgx_status_t r = SGX_ERROR_INVALID_STATE;
+  if (k != NULL)
+    r = seal_pair(plain, k->skey, k->skey_len, k->pkey, k->pkey_len, blob,
+        blob_max, blob_len);
+  key_exit(slot);
+  return r;
+}
+
+/*
+ * Replace the enclave's key pair with the one sealed in 'blob' by
+ * trust_falcon_export_key(); published like a new key.
+ */
+sgx_status_t trust_falcon_import_key(uint8_t *blob, size_t blob_len)
+{
+  uint8_t plain[KEY_PLAIN_MAX];
+  size_t sk_len, pk_len;
+
+  sgx_status_t r = unseal_pair(blob, blob_len, plain, &sk_len, &pk_len);
+  struct key_version *k = NULL;
+  if (r != SGX_SUCCESS) {
+    // Already reported.
+  } else if ((k = key_version_new()) == NULL) {
+    r = SGX_ERROR_OUT_OF_MEMORY;
+  } else {
+    memcpy(k->skey, plain + SEALED_HDR_LEN, sk_len);
+    memcpy(k->pkey, plain + SEALED_HDR_LEN + sk_len, pk_len);
+    k->skey_len = sk_len;
+    k->pkey_len = pk_len;
+  }
+  wipe(plain, sizeof plain);
+  return k != NULL ? key_publish(k) : r;
+}
+
+/*
+ * Keys held by the host, for many tenants (see app/keystore.h): the
+ * host stores sealed pairs and hands the enclave the one it needs with
+ * each request. trust_falcon_keygen_sealed() generates such a pair
+ * without touching the enclave's own key; trust_falcon_sign_sealed()
+ * unseals one, signs with it and wipes it.
+ */
+sgx_status_t trust_falcon_keygen_sealed(unsigned logn, uint8_t *blob,
+    size_t blob_max, size_t *blob_len, uint8_t *pk, size_t pk_max,
+    size_t *pk_len)
+{
+  uint8_t plain[KEY_PLAIN_MAX];
+  uint8_t sk[KEY_SKEY_MAX];
+  size_t sk_len = sizeof sk;
+
+  if ((logn < 1) || (logn > 10) || (blob == NULL) || (blob_len == NULL)
+      || (pk == NULL) || (pk_len == NULL)) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+
+  *pk_len = pk_max;
+  sgx_status_t r = do_keygen(logn, sk, &sk_len, pk, pk_len);
+  if (r == SGX_SUCCESS)
+    r = seal_pair(plain, sk, sk_len, pk, *pk_len, blob, blob_max, blob_len);
+  wipe(sk, sizeof sk);
+  return r;
+}
+
+sgx_status_t trust_falcon_sign_sealed(uint8_t *blob, size_t blob_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce, uint8_t *pt,
+    size_t pt_len)
+{
+  uint8_t plain[KEY_PLAIN_MAX];
+  size_t sk_len, pk_len;
+
+  if ((sig == NULL) || (sig_len == NULL) || (nonce == NULL) || (pt == NULL)
+      || (pt_len <= 0)) {
+    ocall_print_string("Failed: invalid parameter.\n");
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+
+  sgx_status_t r = unseal_pair(blob, blob_len, plain, &sk_len, &pk_len);
+  if (r == SGX_SUCCESS)
+    r = do_sign(plain + SEALED_HDR_LEN, sk_len, sig, sig_len, nonce, pt,
+        pt_len);
+  wipe(plain, sizeof plain);
+  return r;
+}
+
+/*
+ * Scratch state for trust_falcon_memstats(), kept out of the stack so
+ * that it does not show up in the measurement. 'kv' stands for the
+ * published key version.
+ */
+static struct {
+  struct key_version *kv;
+  uint8_t sig[MAX_SIG_LEN];
+  size_t sig_len;
+  uint8_t nonce[NONCE_LEN];
+  uint8_t msg[32];
+  int result;
+} ms;
+
+/*
+ * The operations as the ECALLs run them: keygen builds a key version
+ * and expands its private key (trust_falcon_keygen() and key_publish(),
+ * without the publication); sign uses a fresh context on that expanded
+ * key (trust_falcon_sign()); sign-sealed is the one-shot dynamic path
+ * of trust_falcon_sign_sealed(), on the encoded private key.
+ */
+static __attribute__((noinline)) sgx_status_t memstats_run(unsigned op,
+    unsigned logn)
+{
+  struct key_version *k = ms.kv;
+  falcon_sign *fs;
+  sgx_status_t r;
+
+  switch (op) {
+  case MEMSTATS_OP_KEYGEN:
+    if ((k = ms.kv = key_version_new()) == NULL)
+      return SGX_ERROR_OUT_OF_MEMORY;
+    k->skey_len = sizeof k->skey;
+    k->pkey_len = sizeof k->pkey;
+    r = do_keygen(logn, k->skey, &k->skey_len, k->pkey, &k->pkey_len);
+    if (r == SGX_SUCCESS
+        && (k->ek = falcon_expanded_key_new(k->skey, k->skey_len)) == NULL)
+      r = SGX_ERROR_UNEXPECTED;
+    return r;
+  case MEMSTATS_OP_SIGN:
+    if ((fs = falcon_sign_new()) == NULL)
+      return SGX_ERROR_OUT_OF_MEMORY;
+    r = falcon_sign_set_expanded_key(fs, k->ek)
+        ? sign_one(fs, ms.sig, &ms.sig_len, ms.nonce, ms.msg, sizeof ms.msg)
+        : SGX_ERROR_UNEXPECTED;
+    falcon_sign_free(fs);
+    return r;
+  case MEMSTATS_OP_VERIFY:
+    return do_verify(k->pkey, k->pkey_len, ms.sig, ms.sig_len, ms.nonce,
+        ms.msg, sizeof ms.msg, &ms.result);
+  case MEMSTATS_OP_SIGN_SEALED:
+    return do_sign(k->skey, k->skey_len, ms.sig, &ms.sig_len, ms.nonce,
+        ms.msg, sizeof ms.msg);
+  }
+  return SGX_ERROR_INVALID_PARAMETER;
+}
+
+/*
+ * Peak heap use and stack depth of one operation at degree 2^logn.
+ * Works on a scratch key; the enclave's key pair is untouched. The
+ * other operations are measured on a fresh key (and, for verify, a
+ * fresh signature) produced beforehand outside the measurement; the
+ * heap figure of sign includes the expanded key it signs with, which
+ * stays resident while the key is published.
+ */
+sgx_status_t trust_falcon_memstats(unsigned op, unsigned logn,
+    size_t *heap_peak, size_t *stack_peak)
+{
+  if (logn < 1 || logn > 10 || op > MEMSTATS_OP_SIGN_SEALED
+      || heap_peak == NULL || stack_peak == NULL)
+    return SGX_ERROR_INVALID_PARAMETER;
+
+  sgx_status_t r = SGX_SUCCESS;
+  size_t resident = 0;
+  if (op != MEMSTATS_OP_KEYGEN) {
+    memstats_heap_reset();
+    r = memstats_run(MEMSTATS_OP_KEYGEN, logn);
+    resident = memstats_heap_live();
+    if (r == SGX_SUCCESS && op == MEMSTATS_OP_VERIFY)
+      r = memstats_run(MEMSTATS_OP_SIGN, logn);
+  }
+
+  if (r == SGX_SUCCESS) {
+    uint8_t *top = (uint8_t *) __builtin_frame_address(0);
+    memstats_stack_paint(top);
+    memstats_heap_reset();
+    r = memstats_run(op, logn);
+    *heap_peak = memstats_heap_peak()
+        + (op == MEMSTATS_OP_SIGN ? resident : 0);
+    *stack_peak = memstats_stack_used(top);
+    if (r == SGX_SUCCESS && op == MEMSTATS_OP_VERIFY && ms.result != 1)
+      r = SGX_ERROR_UNEXPECTED;
+  }
+  key_version_free(ms.kv);
+  ms.kv = NULL;
+  return r;
+}
+
 #if defined(__cplusplus)
 }
 #endif
-
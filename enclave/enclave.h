@@ -3,19 +3,40 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "sgx_error.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
-sgx_status_t trust_falcon_keygen();
-sgx_status_t trust_falcon_sign(uint8_t *sig, size_t *sig_len, uint8_t *pt,
+sgx_status_t trust_falcon_keygen(unsigned logn);
+sgx_status_t trust_falcon_sign(uint8_t *sig, size_t *sig_len, uint8_t *nonce,
+    uint8_t *pt, size_t pt_len);
+sgx_status_t trust_falcon_verify(uint8_t *sig, size_t sig_len, uint8_t *nonce,
+    uint8_t *pt, size_t pt_len, int *result);
+sgx_status_t trust_falcon_get_pubkey(uint8_t *pk, size_t pk_max,
+    size_t *pk_len);
+sgx_status_t trust_falcon_memstats(unsigned op, unsigned logn,
+    size_t *heap_peak, size_t *stack_peak);
+sgx_status_t trust_falcon_set_sampler(const char *name);
+sgx_status_t trust_falcon_sign_many(uint8_t *msgs, size_t msgs_len,
+    uint32_t *msg_lens, size_t count, uint8_t *sigs, size_t sigs_len,
+    uint32_t *sig_lens, uint8_t *nonces, size_t nonces_len);
+sgx_status_t trust_falcon_export_key(uint8_t *blob, size_t blob_max,
+    size_t *blob_len);
+sgx_status_t trust_falcon_import_key(uint8_t *blob, size_t blob_len);
+sgx_status_t trust_falcon_keygen_sealed(unsigned logn, uint8_t *blob,
+    size_t blob_max, size_t *blob_len, uint8_t *pk, size_t pk_max,
+    size_t *pk_len);
+sgx_status_t trust_falcon_sign_sealed(uint8_t *blob, size_t blob_len,
+    uint8_t *sig, size_t *sig_len, uint8_t *nonce, uint8_t *pt,
     size_t pt_len);
+sgx_status_t trust_falcon_sign_batch(uint8_t *leaves, size_t leaves_len,
+    uint8_t *root, uint8_t *sig, size_t *sig_len, uint8_t *nonce);
 
 #if defined(__cplusplus)
 }
 #endif
 
 #endif // _ENCLAVE_H
-
@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "keypub.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+static struct key_version *current;
+// Bumped after each publication; starts at 1 so that 0 marks a free slot.
+static uint64_t epoch = 1;
+static uint64_t readers[KEY_READER_SLOTS];
+static bool publishing;
+
+static inline void cpu_relax(void)
+{
+  __builtin_ia32_pause();
+}
+
+const struct key_version *key_enter(unsigned *slot)
+{
+  uint64_t e = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+
+  for (unsigned i = 0;; i = (i + 1) % KEY_READER_SLOTS) {
+    uint64_t free_slot = 0;
+    if (__atomic_load_n(&readers[i], __ATOMIC_RELAXED) == 0
+        && __atomic_compare_exchange_n(&readers[i], &free_slot, e, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      *slot = i;
+      break;
+    }
+    if (i == KEY_READER_SLOTS - 1)
+      cpu_relax();
+  }
+  // Ordered after the slot claim: a publisher that swaps the pointer
+  // before this load sees the slot in its scan.
+  return __atomic_load_n(&current, __ATOMIC_SEQ_CST);
+}
+
+void key_exit(unsigned slot)
+{
+  __atomic_store_n(&readers[slot], 0, __ATOMIC_RELEASE);
+}
+
+void key_version_free(struct key_version *k)
+{
+  if (k == NULL)
+    return;
+  falcon_expanded_key_free(k->ek);
+  volatile uint8_t *p = (volatile uint8_t *) k->skey;
+  for (size_t i = 0; i < sizeof k->skey; i++)
+    p[i] = 0;
+  free(k);
+}
+
+struct key_version *key_version_new(void)
+{
+  return (struct key_version *) calloc(1, sizeof(struct key_version));
+}
+
+sgx_status_t key_publish(struct key_version *k)
+{
+  if (k == NULL)
+    return SGX_ERROR_OUT_OF_MEMORY;
+  k->ek = falcon_expanded_key_new(k->skey, k->skey_len);
+  if (k->ek == NULL) {
+    key_version_free(k);
+    return SGX_ERROR_UNEXPECTED;
+  }
+
+  while (__atomic_test_and_set(&publishing, __ATOMIC_ACQUIRE))
+    cpu_relax();
+  struct key_version *old = __atomic_exchange_n(&current, k,
+      __ATOMIC_SEQ_CST);
+  uint64_t e = __atomic_add_fetch(&epoch, 1, __ATOMIC_SEQ_CST);
+
+  // Grace period: sections that started before the bump may still
+  // hold 'old'; later ones cannot have seen it.
+  for (unsigned i = 0; i < KEY_READER_SLOTS; i++) {
+    for (;;) {
+      uint64_t r = __atomic_load_n(&readers[i], __ATOMIC_ACQUIRE);
+      if (r == 0 || r >= e)
+        break;
+      cpu_relax();
+    }
+  }
+  __atomic_clear(&publishing, __ATOMIC_RELEASE);
+  key_version_free(old);
+  return SGX_SUCCESS;
+}
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,76 @@
+#ifndef _KEYPUB_H
+#define _KEYPUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sgx_error.h"
+#include "../include/boundary_types.h"
+#include "../sgx-falcon/falcon.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * Key publication, RCU style.
+ *
+ * The enclave's key pair is an immutable key_version reached through
+ * one pointer. Signers read it inside a read-side section, which costs
+ * a compare-and-swap to enter and a store to leave, never a lock, and
+ * never waits on a key change. A new key is built (and its private key
+ * expanded) off to the side, then published by swapping the pointer;
+ * signers already in their section finish with the old version, later
+ * ones see the new one. The publisher then waits for the grace period
+ * (every section that may have seen the old version has ended), wipes
+ * the old version and frees it. Only the publishing ECALL waits, for at
+ * most one signature's time: a section covers one signature, also in
+ * trust_falcon_sign_many(), which takes one per message.
+ *
+ * Read-side sections are tracked in KEY_READER_SLOTS slots, each
+ * holding the publication epoch its reader started in (0: free). TCS
+ * are unbound (TCSPolicy 1), so slots are claimed per section rather
+ * than per thread; there must be at least as many as TCSNum
+ * (ENCLAVE_TCS_NUM).
+ */
+#define KEY_SKEY_MAX 6000
+#define KEY_READER_SLOTS 32
+
+struct key_version {
+  uint8_t skey[KEY_SKEY_MAX];
+  size_t skey_len;
+  uint8_t pkey[MAX_PKEY_LEN];
+  size_t pkey_len;
+  falcon_expanded_key *ek;
+};
+
+typedef char key_reader_slots_check[
+    KEY_READER_SLOTS >= ENCLAVE_TCS_NUM ? 1 : -1];
+// Counted in ENCLAVE_HEAP_BUDGET (boundary_types.h).
+typedef char key_version_size_check[
+    sizeof(struct key_version) <= ENCLAVE_KEY_ENCODED_MAX ? 1 : -1];
+
+/*
+ * Enter a read-side section and return the current version (NULL if no
+ * key was published yet); key_exit(slot) must follow in any case. The
+ * version stays valid until then.
+ */
+const struct key_version *key_enter(unsigned *slot);
+void key_exit(unsigned slot);
+
+/*
+ * Publish 'k' (from key_version_new(), with skey/pkey filled in): expand
+ * its private key, make it current, and reclaim the previous version
+ * after the grace period. Takes ownership of 'k', also on error.
+ * Publishers are serialized.
+ */
+struct key_version *key_version_new(void);
+sgx_status_t key_publish(struct key_version *k);
+
+// Wipe and free a version that was never published.
+void key_version_free(struct key_version *k);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // _KEYPUB_H
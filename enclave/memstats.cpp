@@ -0,0 +1,159 @@
+#include "memstats.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+/*
+ * Each wrapped allocation is prefixed with a header holding its size.
+ * The header keeps the 16-byte alignment of the underlying allocator.
+ * The magic word lets free() recognise blocks that were allocated
+ * without going through the wrappers (allocator-internal callers, which
+ * --wrap does not redirect) and hand them straight to the real free().
+ */
+#define MEMSTATS_MAGIC 0x6d656d73u
+#define MEMSTATS_HDR 16
+
+struct alloc_hdr {
+  size_t size;
+  uint32_t magic;
+};
+
+static volatile size_t heap_cur = 0;
+static volatile size_t heap_peak = 0;
+static size_t heap_base = 0;
+
+static void heap_add(size_t n)
+{
+  size_t cur = __sync_add_and_fetch(&heap_cur, n);
+  size_t peak = heap_peak;
+  while (cur > peak) {
+    size_t old = __sync_val_compare_and_swap(&heap_peak, peak, cur);
+    if (old == peak)
+      break;
+    peak = old;
+  }
+}
+
+static void heap_sub(size_t n)
+{
+  __sync_sub_and_fetch(&heap_cur, n);
+}
+
+static void *hdr_init(void *raw, size_t size)
+{
+  if (raw == NULL)
+    return NULL;
+  struct alloc_hdr *h = (struct alloc_hdr *) raw;
+  h->size = size;
+  h->magic = MEMSTATS_MAGIC;
+  heap_add(size);
+  return (uint8_t *) raw + MEMSTATS_HDR;
+}
+
+static struct alloc_hdr *hdr_of(void *ptr)
+{
+  struct alloc_hdr *h = (struct alloc_hdr *) ((uint8_t *) ptr - MEMSTATS_HDR);
+  return h->magic == MEMSTATS_MAGIC ? h : NULL;
+}
+
+void *__wrap_malloc(size_t size)
+{
+  if (size > (size_t) -1 - MEMSTATS_HDR)
+    return NULL;
+  return hdr_init(__real_malloc(size + MEMSTATS_HDR), size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+  if (size != 0 && nmemb > ((size_t) -1 - MEMSTATS_HDR) / size)
+    return NULL;
+  return hdr_init(__real_calloc(1, nmemb * size + MEMSTATS_HDR), nmemb * size);
+}
+
+void __wrap_free(void *ptr)
+{
+  if (ptr == NULL)
+    return;
+  struct alloc_hdr *h = hdr_of(ptr);
+  if (h == NULL) {
+    __real_free(ptr);
+    return;
+  }
+  heap_sub(h->size);
+  h->magic = 0;
+  __real_free(h);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  if (ptr == NULL)
+    return __wrap_malloc(size);
+  struct alloc_hdr *h = hdr_of(ptr);
+  if (h == NULL)
+    return __real_realloc(ptr, size);
+  if (size > (size_t) -1 - MEMSTATS_HDR)
+    return NULL;
+
+  size_t old = h->size;
+  struct alloc_hdr *n = (struct alloc_hdr *) __real_realloc(h,
+      size + MEMSTATS_HDR);
+  if (n == NULL)
+    return NULL;
+  heap_sub(old);
+  return hdr_init(n, size);
+}
+
+void memstats_heap_reset(void)
+{
+  heap_base = heap_cur;
+  heap_peak = heap_base;
+}
+
+size_t memstats_heap_peak(void)
+{
+  return heap_peak - heap_base;
+}
+
+size_t memstats_heap_live(void)
+{
+  return heap_cur - heap_base;
+}
+
+/*
+ * Painting starts this far below 'top', so that the frames of the
+ * caller and of memstats_stack_paint() itself are left untouched.
+ */
+#define STACK_PAINT_GAP 1024
+#define STACK_PAINT_WORD 0xa5c3e10fu
+
+__attribute__((noinline))
+void memstats_stack_paint(uint8_t *top)
+{
+  volatile uint32_t *p = (volatile uint32_t *) (top - MEMSTATS_STACK_PAINT_LEN);
+  volatile uint32_t *end = (volatile uint32_t *) (top - STACK_PAINT_GAP);
+
+  while (p < end)
+    *p++ = STACK_PAINT_WORD;
+}
+
+size_t memstats_stack_used(const uint8_t *top)
+{
+  const volatile uint32_t *p =
+      (const volatile uint32_t *) (top - MEMSTATS_STACK_PAINT_LEN);
+  const volatile uint32_t *end =
+      (const volatile uint32_t *) (top - STACK_PAINT_GAP);
+
+  while (p < end && *p == STACK_PAINT_WORD)
+    p++;
+  return (size_t) (top - (const uint8_t *) p);
+}
+
+#if defined(__cplusplus)
+}
+#endif
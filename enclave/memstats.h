@@ -0,0 +1,48 @@
+#ifndef _MEMSTATS_H
+#define _MEMSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * Heap accounting. The enclave is linked with --wrap for malloc,
+ * calloc, realloc and free, so every allocation made inside the enclave
+ * (Falcon contexts, EDL marshalling buffers, C++ operator new) goes
+ * through memstats.cpp, which keeps the number of live bytes and its
+ * high-water mark.
+ *
+ * The counters are shared by all TCS; per-operation figures are only
+ * meaningful when the enclave is otherwise idle.
+ */
+/*
+ * memstats_heap_reset() starts a measurement; memstats_heap_peak()
+ * returns the highest number of live bytes since then, over and above
+ * those live at the reset, and memstats_heap_live() the number live
+ * now, over and above the same.
+ */
+void memstats_heap_reset(void);
+size_t memstats_heap_peak(void);
+size_t memstats_heap_live(void);
+
+/*
+ * Stack high-water mark by painting: memstats_stack_paint() fills the
+ * MEMSTATS_STACK_PAINT_LEN bytes below 'top' (minus a small gap for the
+ * painting call itself) with a known pattern, and memstats_stack_used()
+ * returns how deep below 'top' the pattern was overwritten. 'top' is
+ * normally __builtin_frame_address(0) of the caller. A result of
+ * MEMSTATS_STACK_PAINT_LEN means the painted area was exhausted.
+ */
+#define MEMSTATS_STACK_PAINT_LEN (224 * 1024)
+
+void memstats_stack_paint(uint8_t *top);
+size_t memstats_stack_used(const uint8_t *top);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // _MEMSTATS_H
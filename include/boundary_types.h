@@ -1,6 +1,63 @@
 #ifndef BOUNDARY_TYPES_H
 #define BOUNDARY_TYPES_H
 
-#define MAX_SIG_LEN (1024 * 2) + 1
+#define MAX_SIG_LEN ((1024 * 2) + 1)
+#define MAX_PKEY_LEN 3000
+#define NONCE_LEN 40
+
+// Degree used by the enclave when the caller has no preference.
+#define DEFAULT_LOGN 9
+
+// Most messages per trust_falcon_sign_many() call; the signature
+// buffers alone then take SIGN_MANY_MAX * MAX_SIG_LEN bytes of heap.
+#define SIGN_MANY_MAX 64
+
+// Room for a trust_falcon_export_key() blob: both keys, their lengths
+// and the sealing overhead (sizeof(sgx_sealed_data_t) is 560).
+#define SEALED_KEY_MAX 10240
+
+// Operations measured by trust_falcon_memstats().
+#define MEMSTATS_OP_KEYGEN 0
+#define MEMSTATS_OP_SIGN 1
+#define MEMSTATS_OP_VERIFY 2
+#define MEMSTATS_OP_SIGN_SEALED 3
+
+// Must match enclave/enclave.config.xml.
+#define ENCLAVE_HEAP_MAX 0x400000
+#define ENCLAVE_STACK_MAX 0x40000
+#define ENCLAVE_TCS_NUM 10
+
+// Host threads inside the enclave at once: one TCS each.
+#define MAX_THREADS ENCLAVE_TCS_NUM
+
+// Message bytes per ECALL (all of them for trust_falcon_sign_many());
+// [in] buffers are copied onto the enclave heap.
+#define MAX_MSG_LEN (64 * 1024)
+
+/*
+ * Heap budget, at logn 10 (ternary keys stop at logn 9 and need less;
+ * see expanded_key_len() and sign_tmp_len() in falcon-sign.c), in
+ * 8-byte values of 1024-coefficient polynomials:
+ *
+ *  - per ECALL in flight: its copied buffers, at most a sign_many()
+ *    call's messages, signatures, nonces and lengths (the 128 KiB of
+ *    leaves of trust_falcon_sign_batch() fit too), plus a signing
+ *    context on a key it expands itself (trust_falcon_sign_sealed()):
+ *    9 polynomials of scratch and a 4-polynomial expanded key;
+ *  - per published key version, the current one and the one being
+ *    replaced: its LDL tree (15 polynomials) and a struct key_version
+ *    of at most ENCLAVE_KEY_ENCODED_MAX bytes (enclave/keypub.h).
+ */
+#define ENCLAVE_POLY_BYTES (1024 * 8)
+#define ENCLAVE_KEY_ENCODED_MAX (16 * 1024)
+#define ENCLAVE_ECALL_HEAP (MAX_MSG_LEN \
+    + SIGN_MANY_MAX * (MAX_SIG_LEN + NONCE_LEN + 8) \
+    + (9 + 4) * ENCLAVE_POLY_BYTES)
+#define ENCLAVE_KEY_HEAP (15 * ENCLAVE_POLY_BYTES + ENCLAVE_KEY_ENCODED_MAX)
+#define ENCLAVE_HEAP_BUDGET (MAX_THREADS * ENCLAVE_ECALL_HEAP \
+    + 2 * ENCLAVE_KEY_HEAP)
+
+typedef char enclave_heap_budget_check[
+    ENCLAVE_HEAP_BUDGET <= ENCLAVE_HEAP_MAX ? 1 : -1];
 
 #endif // BOUNDARY_TYPES_H
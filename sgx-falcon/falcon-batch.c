@@ -0,0 +1,415 @@
+/*
+ * Batch signing: one Falcon signature over the root of a Merkle tree of
+ * message digests, plus per-message inclusion proofs.
+ *
+ * The tree follows RFC 6962 (Certificate Transparency), with SHAKE-256
+ * truncated to 32 bytes as hash function:
+ *
+ *   leaf:  H(0x00 || message)
+ *   node:  H(0x01 || left || right)
+ *
+ * For n > 1 leaves, the left subtree holds the first k leaves, with k
+ * the largest power of two lower than n. Equivalently, the tree is
+ * built level by level, pairing nodes from the left and promoting an
+ * unpaired last node unchanged; the distinct leaf and node prefixes
+ * prevent a node from being passed off as a leaf.
+ *
+ * The signed message is the string "FALCON-BATCH-V1", then the number
+ * of leaves over 8 bytes (big-endian), then the root. Binding the leaf
+ * count matters: an inclusion proof is only meaningful for a given tree
+ * size.
+ */
+
+#include "internal.h"
+
+static const unsigned char batch_domain[] = "FALCON-BATCH-V1";
+
+/*
+ * Hash the concatenation of a one-byte prefix and two byte strings.
+ */
+static void
+batch_hash(unsigned char *out, unsigned prefix,
+	const void *d1, size_t len1, const void *d2, size_t len2)
+{
+	shake_context sc;
+	unsigned char p;
+
+	p = (unsigned char)prefix;
+	shake_init(&sc, 512);
+	shake_inject(&sc, &p, 1);
+	shake_inject(&sc, d1, len1);
+	shake_inject(&sc, d2, len2);
+	shake_flip(&sc);
+	shake_extract(&sc, out, FALCON_BATCH_HASH_LEN);
+}
+
+static void
+batch_node(unsigned char *out, const unsigned char *left,
+	const unsigned char *right)
+{
+	batch_hash(out, 0x01, left, FALCON_BATCH_HASH_LEN,
+		right, FALCON_BATCH_HASH_LEN);
+}
+
+/*
+ * Encode the signed message for a root.
+ */
+static void
+batch_message(unsigned char *buf, const void *root, uint64_t count)
+{
+	size_t dlen;
+	int i;
+
+	dlen = sizeof batch_domain - 1;
+	memcpy(buf, batch_domain, dlen);
+	for (i = 0; i < 8; i ++) {
+		buf[dlen + i] = (unsigned char)(count >> (56 - (i << 3)));
+	}
+	memcpy(buf + dlen + 8, root, FALCON_BATCH_HASH_LEN);
+}
+
+#define BATCH_MSG_LEN   (sizeof batch_domain - 1 + 8 + FALCON_BATCH_HASH_LEN)
+
+/* see falcon.h */
+void
+falcon_batch_leaf(void *leaf, const void *msg, size_t len)
+{
+	batch_hash(leaf, 0x00, msg, len, NULL, 0);
+}
+
+/* see falcon.h */
+int
+falcon_batch_root(void *root, const void *leaves, size_t count)
+{
+	/*
+	 * Streaming computation: stack[] holds the roots of complete
+	 * subtrees of decreasing sizes (the binary decomposition of
+	 * the number of leaves seen so far). Each new leaf is merged
+	 * with equal-sized subtrees, like a binary counter increment.
+	 * The final root folds the remaining subtrees from the right.
+	 */
+	unsigned char stack[64][FALCON_BATCH_HASH_LEN];
+	const unsigned char *lv;
+	size_t u, v;
+	int depth;
+
+	if (count == 0) {
+		return 0;
+	}
+	lv = leaves;
+	depth = 0;
+	for (u = 0; u < count; u ++) {
+		memcpy(stack[depth], lv + u * FALCON_BATCH_HASH_LEN,
+			FALCON_BATCH_HASH_LEN);
+		depth ++;
+		for (v = u; (v & 1) != 0; v >>= 1) {
+			batch_node(stack[depth - 2],
+				stack[depth - 2], stack[depth - 1]);
+			depth --;
+		}
+	}
+	while (depth > 1) {
+		batch_node(stack[depth - 2], stack[depth - 2], stack[depth - 1]);
+		depth --;
+	}
+	memcpy(root, stack[0], FALCON_BATCH_HASH_LEN);
+	return 1;
+}
+
+/* see falcon.h */
+size_t
+falcon_batch_sign(falcon_sign *fs, void *nonce,
+	const void *root, uint64_t count,
+	void *sig, size_t max_sig_len, int comp)
+{
+	unsigned char msg[BATCH_MSG_LEN];
+
+	if (!falcon_sign_start(fs, nonce)) {
+		return 0;
+	}
+	batch_message(msg, root, count);
+	falcon_sign_update(fs, msg, sizeof msg);
+	return falcon_sign_generate(fs, sig, max_sig_len, comp);
+}
+
+/* ==================================================================== */
+/*
+ * Trees with proofs.
+ *
+ * All levels are kept, leaves first: level j has (n + 2^j - 1) >> j
+ * nodes, so the whole tree holds fewer than 2n + log2(n) hashes.
+ */
+
+struct falcon_batch_tree_ {
+	size_t count;
+	int levels;
+	size_t offset[65];
+	unsigned char *nodes;
+};
+
+/* see falcon.h */
+falcon_batch_tree *
+falcon_batch_tree_new(const void *leaves, size_t count)
+{
+	falcon_batch_tree *ft;
+	size_t total, n;
+	int j;
+
+	if (count == 0) {
+		return NULL;
+	}
+	ft = malloc(sizeof *ft);
+	if (ft == NULL) {
+		return NULL;
+	}
+	total = 0;
+	for (j = 0, n = count;; j ++, n = (n + 1) >> 1) {
+		ft->offset[j] = total;
+		total += n;
+		if (n == 1) {
+			break;
+		}
+	}
+	ft->levels = j + 1;
+	ft->count = count;
+	ft->nodes = malloc(total * FALCON_BATCH_HASH_LEN);
+	if (ft->nodes == NULL) {
+		free(ft);
+		return NULL;
+	}
+	memcpy(ft->nodes, leaves, count * FALCON_BATCH_HASH_LEN);
+	for (j = 1, n = count; j < ft->levels; j ++) {
+		unsigned char *src, *dst;
+		size_t u;
+
+		src = ft->nodes + ft->offset[j - 1] * FALCON_BATCH_HASH_LEN;
+		dst = ft->nodes + ft->offset[j] * FALCON_BATCH_HASH_LEN;
+		for (u = 0; u + 1 < n; u += 2) {
+			batch_node(dst + (u >> 1) * FALCON_BATCH_HASH_LEN,
+				src + u * FALCON_BATCH_HASH_LEN,
+				src + (u + 1) * FALCON_BATCH_HASH_LEN);
+		}
+		if (u < n) {
+			memcpy(dst + (u >> 1) * FALCON_BATCH_HASH_LEN,
+				src + u * FALCON_BATCH_HASH_LEN,
+				FALCON_BATCH_HASH_LEN);
+		}
+		n = (n + 1) >> 1;
+	}
+	return ft;
+}
+
+/* see falcon.h */
+void
+falcon_batch_tree_free(falcon_batch_tree *ft)
+{
+	if (ft != NULL) {
+		free(ft->nodes);
+		free(ft);
+	}
+}
+
+/* see falcon.h */
+void
+falcon_batch_tree_root(const falcon_batch_tree *ft, void *root)
+{
+	memcpy(root, ft->nodes + ft->offset[ft->levels - 1]
+		* FALCON_BATCH_HASH_LEN, FALCON_BATCH_HASH_LEN);
+}
+
+/* see falcon.h */
+int
+falcon_batch_tree_proof(const falcon_batch_tree *ft, size_t index,
+	void *proof, size_t *proof_len)
+{
+	unsigned char *buf;
+	size_t n, len;
+	int j;
+
+	if (index >= ft->count) {
+		return 0;
+	}
+	buf = proof;
+	len = 0;
+	for (j = 0, n = ft->count; j < ft->levels - 1;
+		j ++, index >>= 1, n = (n + 1) >> 1)
+	{
+		size_t sib;
+
+		/*
+		 * A last node without sibling is promoted: nothing to
+		 * add at this level.
+		 */
+		sib = index ^ 1;
+		if (sib >= n) {
+			continue;
+		}
+		if (len + FALCON_BATCH_HASH_LEN > *proof_len) {
+			return 0;
+		}
+		memcpy(buf + len, ft->nodes + (ft->offset[j] + sib)
+			* FALCON_BATCH_HASH_LEN, FALCON_BATCH_HASH_LEN);
+		len += FALCON_BATCH_HASH_LEN;
+	}
+	*proof_len = len;
+	return 1;
+}
+
+/* ==================================================================== */
+/*
+ * Verification.
+ */
+
+/*
+ * Recompute the root from a leaf and its inclusion proof, following
+ * RFC 9162, section 2.1.3.2. Returns 0 if the proof has the wrong
+ * length for this index and tree size.
+ */
+static int
+batch_proof_root(unsigned char *root, const unsigned char *leaf,
+	uint64_t index, uint64_t count, const unsigned char *proof,
+	size_t proof_len)
+{
+	uint64_t fn, sn;
+	size_t u;
+
+	if (index >= count || (proof_len % FALCON_BATCH_HASH_LEN) != 0) {
+		return 0;
+	}
+	fn = index;
+	sn = count - 1;
+	memcpy(root, leaf, FALCON_BATCH_HASH_LEN);
+	for (u = 0; u < proof_len; u += FALCON_BATCH_HASH_LEN) {
+		if (sn == 0) {
+			return 0;
+		}
+		if ((fn & 1) != 0 || fn == sn) {
+			batch_node(root, proof + u, root);
+			while ((fn & 1) == 0 && fn != 0) {
+				fn >>= 1;
+				sn >>= 1;
+			}
+		} else {
+			batch_node(root, root, proof + u);
+		}
+		fn >>= 1;
+		sn >>= 1;
+	}
+	return sn == 0;
+}
+
+#define BATCH_CACHE_SIZE   64
+
+struct falcon_batch_vrfy_ {
+	falcon_vrfy *fv;
+	struct {
+		unsigned char root[FALCON_BATCH_HASH_LEN];
+		uint64_t count;
+	} cache[BATCH_CACHE_SIZE];
+	size_t cache_len, cache_next;
+	uint64_t hits, misses;
+};
+
+/* see falcon.h */
+falcon_batch_vrfy *
+falcon_batch_vrfy_new(void)
+{
+	falcon_batch_vrfy *bv;
+
+	bv = malloc(sizeof *bv);
+	if (bv == NULL) {
+		return NULL;
+	}
+	bv->fv = falcon_vrfy_new();
+	if (bv->fv == NULL) {
+		free(bv);
+		return NULL;
+	}
+	bv->cache_len = 0;
+	bv->cache_next = 0;
+	bv->hits = 0;
+	bv->misses = 0;
+	return bv;
+}
+
+/* see falcon.h */
+void
+falcon_batch_vrfy_free(falcon_batch_vrfy *bv)
+{
+	if (bv != NULL) {
+		falcon_vrfy_free(bv->fv);
+		free(bv);
+	}
+}
+
+/* see falcon.h */
+int
+falcon_batch_vrfy_set_public_key(falcon_batch_vrfy *bv,
+	const void *pkey, size_t len)
+{
+	bv->cache_len = 0;
+	bv->cache_next = 0;
+	return falcon_vrfy_set_public_key(bv->fv, pkey, len);
+}
+
+/* see falcon.h */
+int
+falcon_batch_vrfy_verify(falcon_batch_vrfy *bv,
+	const void *msg, size_t msg_len,
+	uint64_t index, const void *proof, size_t proof_len,
+	const void *root, uint64_t count,
+	const void *nonce, const void *sig, size_t sig_len)
+{
+	unsigned char leaf[FALCON_BATCH_HASH_LEN];
+	unsigned char r[FALCON_BATCH_HASH_LEN];
+	unsigned char bmsg[BATCH_MSG_LEN];
+	size_t u;
+	int z;
+
+	falcon_batch_leaf(leaf, msg, msg_len);
+	if (!batch_proof_root(r, leaf, index, count, proof, proof_len)
+		|| memcmp(r, root, FALCON_BATCH_HASH_LEN) != 0)
+	{
+		return 0;
+	}
+
+	/*
+	 * A root is authentic once any signature on it has verified
+	 * under the current key; further messages of the same batch
+	 * then only need their proof checked.
+	 */
+	for (u = 0; u < bv->cache_len; u ++) {
+		if (bv->cache[u].count == count
+			&& memcmp(bv->cache[u].root, root,
+			FALCON_BATCH_HASH_LEN) == 0)
+		{
+			bv->hits ++;
+			return 1;
+		}
+	}
+	bv->misses ++;
+
+	falcon_vrfy_start(bv->fv, nonce, 40);
+	batch_message(bmsg, root, count);
+	falcon_vrfy_update(bv->fv, bmsg, sizeof bmsg);
+	z = falcon_vrfy_verify(bv->fv, sig, sig_len);
+	if (z == 1) {
+		memcpy(bv->cache[bv->cache_next].root, root,
+			FALCON_BATCH_HASH_LEN);
+		bv->cache[bv->cache_next].count = count;
+		bv->cache_next = (bv->cache_next + 1) % BATCH_CACHE_SIZE;
+		if (bv->cache_len < BATCH_CACHE_SIZE) {
+			bv->cache_len ++;
+		}
+	}
+	return z;
+}
+
+/* see internal.h */
+void
+falcon_batch_vrfy_stats(const falcon_batch_vrfy *bv,
+	uint64_t *hits, uint64_t *misses)
+{
+	*hits = bv->hits;
+	*misses = bv->misses;
+}
@@ -0,0 +1,420 @@
+/*
+ * Runtime CPU feature detection and kernel dispatch.
+ *
+ * The library is built once for a baseline target; faster variants of
+ * the hot kernels are compiled alongside the portable code with
+ * per-function target attributes (see FALCON_KERNELS_X86 in
+ * internal.h). On first use, falcon_isa_init() queries CPUID, applies
+ * the FALCON_ISA override, and for each kernel tries the best variant
+ * the enabled features allow. A variant is only installed if it
+ * reproduces the reference output exactly on a set of known inputs;
+ * otherwise the kernel stays on the portable code and the failure is
+ * counted.
+ */
+
+#include "internal.h"
+
+#if FALCON_KERNELS_X86
+#include <cpuid.h>
+#endif
+
+/* see internal.h */
+falcon_kernel_table falcon_kernels = {
+	falcon_keccak_ref,
+	falcon_chacha20_ref,
+	falcon_FFT_radix4,
+	falcon_iFFT_radix4,
+	falcon_poly_mul_fft_ref,
+	falcon_poly_muladj_fft_ref,
+	falcon_NTT_ref,
+	falcon_iNTT_ref
+};
+
+/*
+ * Feature names, in FALCON_ISA_* bit order.
+ */
+static const char *const isa_names[] = {
+	"sse2", "sse4.1", "avx", "avx2", "fma", "bmi2", "aesni"
+};
+
+#define ISA_NUM   (sizeof isa_names / sizeof isa_names[0])
+
+/*
+ * Kernels, in the order reported by falcon_kernel_name().
+ */
+static const char *const kernel_names[] = {
+	"keccak", "chacha20", "fft", "ntt"
+};
+
+#define KERNEL_NUM   (sizeof kernel_names / sizeof kernel_names[0])
+
+static const char *kernel_variants[KERNEL_NUM] = {
+	"portable", "portable", "portable", "portable"
+};
+
+static unsigned isa_detected;
+static unsigned isa_enabled;
+static unsigned selftest_failures;
+static int isa_once;
+
+#if FALCON_KERNELS_X86
+
+static unsigned
+isa_detect(void)
+{
+	unsigned eax, ebx, ecx, edx, f;
+
+	f = 0;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return 0;
+	}
+	if (edx & bit_SSE2) {
+		f |= FALCON_ISA_SSE2;
+	}
+	if (ecx & bit_SSE4_1) {
+		f |= FALCON_ISA_SSE41;
+	}
+	if (ecx & bit_AES) {
+		f |= FALCON_ISA_AESNI;
+	}
+
+	/*
+	 * AVX registers are usable only if the OS saves them on context
+	 * switches: XCR0 must have both the SSE and AVX state bits.
+	 */
+	if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+		unsigned xcr0_lo, xcr0_hi;
+
+		__asm__ __volatile__ ("xgetbv"
+			: "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+		(void)xcr0_hi;
+		if ((xcr0_lo & 6) == 6) {
+			f |= FALCON_ISA_AVX;
+			if (ecx & bit_FMA) {
+				f |= FALCON_ISA_FMA;
+			}
+		}
+	}
+
+	if (__get_cpuid_max(0, NULL) >= 7) {
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		if ((f & FALCON_ISA_AVX) && (ebx & bit_AVX2)) {
+			f |= FALCON_ISA_AVX2;
+		}
+		if ((ebx & bit_BMI) && (ebx & bit_BMI2)) {
+			f |= FALCON_ISA_BMI2;
+		}
+	}
+	return f;
+}
+
+/*
+ * Simple deterministic generator for the self-test inputs.
+ */
+static uint32_t
+selftest_next(uint64_t *s)
+{
+	*s = *s * 6364136223846793005u + 1442695040888963407u;
+	return (uint32_t)(*s >> 32);
+}
+
+static int
+selftest_chacha20(void (*kernel)(prng *p))
+{
+	prng pa, pb;
+	uint64_t s;
+	size_t u;
+	int i;
+
+	/*
+	 * The counter starts just below 2^32, to check the carry into
+	 * the high word.
+	 */
+	memset(&pa, 0, sizeof pa);
+	s = 2;
+	for (u = 0; u < 48; u ++) {
+		pa.state.d[u] = (unsigned char)selftest_next(&s);
+	}
+	*(uint64_t *)(pa.state.d + 48) = 0xFFFFFFF0;
+	pa.type = PRNG_CHACHA20;
+	pb = pa;
+	for (i = 0; i < 2; i ++) {
+		falcon_chacha20_ref(&pa);
+		kernel(&pb);
+		if (memcmp(pa.buf.d, pb.buf.d, sizeof pa.buf.d) != 0
+			|| memcmp(pa.state.d, pb.state.d, 56) != 0)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int
+selftest_fft(void (*fft)(fpr *f, unsigned logn),
+	void (*ifft)(fpr *f, unsigned logn),
+	void (*mul)(fpr *restrict a, const fpr *restrict b, unsigned logn),
+	void (*muladj)(fpr *restrict a, const fpr *restrict b, unsigned logn))
+{
+	fpr a[1024], b[1024], c[1024];
+	uint64_t s;
+	unsigned logn;
+	size_t u, n;
+
+	s = 3;
+	for (logn = 1; logn <= 10; logn ++) {
+		n = (size_t)1 << logn;
+		for (u = 0; u < n; u ++) {
+			a[u] = fpr_of((int)(selftest_next(&s) % 4097) - 2048);
+			c[u] = fpr_of((int)(selftest_next(&s) % 4097) - 2048);
+		}
+		memcpy(b, a, n * sizeof *a);
+		falcon_FFT_ref(a, logn);
+		fft(b, logn);
+		if (memcmp(a, b, n * sizeof *a) != 0) {
+			return 0;
+		}
+		falcon_FFT_ref(c, logn);
+		falcon_poly_mul_fft_ref(a, c, logn);
+		mul(b, c, logn);
+		if (memcmp(a, b, n * sizeof *a) != 0) {
+			return 0;
+		}
+		falcon_poly_muladj_fft_ref(a, c, logn);
+		muladj(b, c, logn);
+		if (memcmp(a, b, n * sizeof *a) != 0) {
+			return 0;
+		}
+		falcon_iFFT_ref(a, logn);
+		ifft(b, logn);
+		if (memcmp(a, b, n * sizeof *a) != 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int
+selftest_ntt(void (*ntt)(uint16_t *a, unsigned logn),
+	void (*intt)(uint16_t *a, unsigned logn))
+{
+	uint16_t a[1024], b[1024];
+	uint64_t s;
+	unsigned logn;
+	size_t u, n;
+
+	s = 4;
+	for (logn = 1; logn <= 10; logn ++) {
+		n = (size_t)1 << logn;
+		for (u = 0; u < n; u ++) {
+			a[u] = (uint16_t)(selftest_next(&s) % 12289);
+		}
+		a[0] = 0;
+		a[n - 1] = 12288;
+		memcpy(b, a, n * sizeof *a);
+		falcon_NTT_ref(a, logn);
+		ntt(b, logn);
+		if (memcmp(a, b, n * sizeof *a) != 0) {
+			return 0;
+		}
+		falcon_iNTT_ref(a, logn);
+		intt(b, logn);
+		if (memcmp(a, b, n * sizeof *a) != 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+#endif
+
+/*
+ * Build a fresh table for the given features and install it.
+ */
+static void
+isa_select(unsigned isa)
+{
+	falcon_kernel_table kt;
+	const char *var[KERNEL_NUM];
+	size_t u;
+
+	kt.keccak = falcon_keccak_ref;
+	kt.chacha20 = falcon_chacha20_ref;
+	kt.fft = falcon_FFT_radix4;
+	kt.ifft = falcon_iFFT_radix4;
+	kt.poly_mul_fft = falcon_poly_mul_fft_ref;
+	kt.poly_muladj_fft = falcon_poly_muladj_fft_ref;
+	kt.ntt = falcon_NTT_ref;
+	kt.intt = falcon_iNTT_ref;
+	for (u = 0; u < KERNEL_NUM; u ++) {
+		var[u] = "portable";
+	}
+
+#if FALCON_KERNELS_X86
+	if (isa & FALCON_ISA_AVX2) {
+		if (selftest_chacha20(falcon_chacha20_avx2)) {
+			kt.chacha20 = falcon_chacha20_avx2;
+			var[1] = "avx2";
+		} else {
+			selftest_failures ++;
+		}
+	}
+	if ((isa & FALCON_ISA_SSE2) && kt.chacha20 == falcon_chacha20_ref) {
+		if (selftest_chacha20(falcon_chacha20_sse2)) {
+			kt.chacha20 = falcon_chacha20_sse2;
+			var[1] = "sse2";
+		} else {
+			selftest_failures ++;
+		}
+	}
+	if (isa & FALCON_ISA_AVX) {
+		if (selftest_fft(falcon_FFT_avx, falcon_iFFT_avx,
+			falcon_poly_mul_fft_avx, falcon_poly_muladj_fft_avx))
+		{
+			kt.fft = falcon_FFT_avx;
+			kt.ifft = falcon_iFFT_avx;
+			kt.poly_mul_fft = falcon_poly_mul_fft_avx;
+			kt.poly_muladj_fft = falcon_poly_muladj_fft_avx;
+			var[2] = "avx";
+		} else {
+			selftest_failures ++;
+		}
+	}
+	if (isa & FALCON_ISA_AVX2) {
+		if (selftest_ntt(falcon_NTT_avx2, falcon_iNTT_avx2)) {
+			kt.ntt = falcon_NTT_avx2;
+			kt.intt = falcon_iNTT_avx2;
+			var[3] = "avx2";
+		} else {
+			selftest_failures ++;
+		}
+	}
+#endif
+
+	falcon_kernels = kt;
+	for (u = 0; u < KERNEL_NUM; u ++) {
+		kernel_variants[u] = var[u];
+	}
+	isa_enabled = isa;
+}
+
+#ifndef USE_SGX
+/*
+ * Parse FALCON_ISA: "portable", "none", or a comma-separated list of
+ * feature names. Unknown names are ignored.
+ */
+static unsigned
+isa_parse(const char *s)
+{
+	unsigned mask;
+
+	if (strcmp(s, "portable") == 0 || strcmp(s, "none") == 0) {
+		return 0;
+	}
+	mask = 0;
+	while (*s != 0) {
+		size_t len, u;
+
+		len = strcspn(s, ",");
+		for (u = 0; u < ISA_NUM; u ++) {
+			if (strlen(isa_names[u]) == len
+				&& memcmp(isa_names[u], s, len) == 0)
+			{
+				mask |= 1u << u;
+			}
+		}
+		s += len;
+		if (*s == ',') {
+			s ++;
+		}
+	}
+	return mask;
+}
+#endif
+
+/* see internal.h */
+void
+falcon_isa_init(void)
+{
+	unsigned mask;
+
+	/*
+	 * Contexts may be created from several threads at once: one of
+	 * them detects and selects, the others wait for it, so that no
+	 * caller returns before the table is final.
+	 */
+	if (!falcon_once_begin(&isa_once)) {
+		return;
+	}
+#if FALCON_KERNELS_X86
+	isa_detected = isa_detect();
+#endif
+	mask = isa_detected;
+#ifndef USE_SGX
+	{
+		const char *env;
+
+		env = getenv("FALCON_ISA");
+		if (env != NULL) {
+			mask &= isa_parse(env);
+		}
+	}
+#endif
+	isa_select(mask);
+	falcon_once_end(&isa_once);
+}
+
+/* see falcon.h */
+unsigned
+falcon_isa_detected(void)
+{
+	falcon_isa_init();
+	return isa_detected;
+}
+
+/* see falcon.h */
+unsigned
+falcon_isa_enabled(void)
+{
+	falcon_isa_init();
+	return isa_enabled;
+}
+
+/* see falcon.h */
+unsigned
+falcon_isa_set(unsigned mask)
+{
+	falcon_isa_init();
+	isa_select(mask & isa_detected);
+	return isa_enabled;
+}
+
+/* see falcon.h */
+const char *
+falcon_isa_name(unsigned index)
+{
+	return index < ISA_NUM ? isa_names[index] : NULL;
+}
+
+/* see falcon.h */
+const char *
+falcon_kernel_name(unsigned index)
+{
+	return index < KERNEL_NUM ? kernel_names[index] : NULL;
+}
+
+/* see falcon.h */
+const char *
+falcon_kernel_variant(unsigned index)
+{
+	falcon_isa_init();
+	return index < KERNEL_NUM ? kernel_variants[index] : NULL;
+}
+
+/* see falcon.h */
+unsigned
+falcon_isa_selftest_failures(void)
+{
+	falcon_isa_init();
+	return selftest_failures;
+}
@@ -0,0 +1,1947 @@
+/*
+ * Generated by gen-codelets.c; do not edit. Straight-line FFT, inverse
+ * FFT, split and merge for 1 <= logn <= FFT_CODELET_MAX, included by
+ * falcon-fft.c (which provides the FPC_* macros and fpr_gm_tab[]).
+ */
+
+#define FFT_CODELET_MAX   6
+
+static void
+fft_codelet_1(fpr *f)
+{
+	(void)f;
+}
+
+static void
+ifft_codelet_1(fpr *f)
+{
+	fpr r0, r1;
+	fpr ni;
+
+	r0 = f[0];
+	r1 = f[1];
+
+	ni = fpr_scaled(2, -1);
+	f[0] = fpr_mul(r0, ni);
+	f[1] = fpr_mul(r1, ni);
+}
+
+static void
+split_codelet_1(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f)
+{
+	f0[0] = f[0];
+	f1[0] = f[1];
+}
+
+static void
+merge_codelet_1(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1)
+{
+	f[0] = f0[0];
+	f[1] = f1[0];
+}
+
+static void
+fft_codelet_2(fpr *f)
+{
+	fpr r0, r1, r2, r3;
+	fpr y_re, y_im;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+
+	FPC_MUL(y_re, y_im, r1, r3, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r1, r3, r0, r2, y_re, y_im);
+	FPC_ADD(r0, r2, r0, r2, y_re, y_im);
+
+	f[0] = r0;
+	f[1] = r1;
+	f[2] = r2;
+	f[3] = r3;
+}
+
+static void
+ifft_codelet_2(fpr *f)
+{
+	fpr r0, r1, r2, r3;
+	fpr y_re, y_im, ni;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+
+	FPC_SUB(y_re, y_im, r0, r2, r1, r3);
+	FPC_ADD(r0, r2, r0, r2, r1, r3);
+	FPC_MUL(r1, r3, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+
+	ni = fpr_scaled(2, -2);
+	f[0] = fpr_mul(r0, ni);
+	f[1] = fpr_mul(r1, ni);
+	f[2] = fpr_mul(r2, ni);
+	f[3] = fpr_mul(r3, ni);
+}
+
+static void
+split_codelet_2(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f)
+{
+	fpr t_re, t_im;
+
+	FPC_ADD(t_re, t_im, f[0], f[2], f[1], f[3]);
+	f0[0] = fpr_half(t_re);
+	f0[1] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[0], f[2], f[1], f[3]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	f1[0] = fpr_half(t_re);
+	f1[1] = fpr_half(t_im);
+}
+
+static void
+merge_codelet_2(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1)
+{
+	fpr b_re, b_im;
+
+	FPC_MUL(b_re, b_im, f1[0], f1[1], fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_ADD(f[0], f[2], f0[0], f0[1], b_re, b_im);
+	FPC_SUB(f[1], f[3], f0[0], f0[1], b_re, b_im);
+}
+
+static void
+fft_codelet_3(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr y_re, y_im;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+
+	FPC_MUL(y_re, y_im, r2, r6, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r2, r6, r0, r4, y_re, y_im);
+	FPC_ADD(r0, r4, r0, r4, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r7, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r3, r7, r1, r5, y_re, y_im);
+	FPC_ADD(r1, r5, r1, r5, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r1, r5, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r1, r5, r0, r4, y_re, y_im);
+	FPC_ADD(r0, r4, r0, r4, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r7, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r3, r7, r2, r6, y_re, y_im);
+	FPC_ADD(r2, r6, r2, r6, y_re, y_im);
+
+	f[0] = r0;
+	f[1] = r1;
+	f[2] = r2;
+	f[3] = r3;
+	f[4] = r4;
+	f[5] = r5;
+	f[6] = r6;
+	f[7] = r7;
+}
+
+static void
+ifft_codelet_3(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr y_re, y_im, ni;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+
+	FPC_SUB(y_re, y_im, r0, r4, r1, r5);
+	FPC_ADD(r0, r4, r0, r4, r1, r5);
+	FPC_MUL(r1, r5, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r2, r6, r3, r7);
+	FPC_ADD(r2, r6, r2, r6, r3, r7);
+	FPC_MUL(r3, r7, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+
+	FPC_SUB(y_re, y_im, r0, r4, r2, r6);
+	FPC_ADD(r0, r4, r0, r4, r2, r6);
+	FPC_MUL(r2, r6, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r1, r5, r3, r7);
+	FPC_ADD(r1, r5, r1, r5, r3, r7);
+	FPC_MUL(r3, r7, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+
+	ni = fpr_scaled(2, -3);
+	f[0] = fpr_mul(r0, ni);
+	f[1] = fpr_mul(r1, ni);
+	f[2] = fpr_mul(r2, ni);
+	f[3] = fpr_mul(r3, ni);
+	f[4] = fpr_mul(r4, ni);
+	f[5] = fpr_mul(r5, ni);
+	f[6] = fpr_mul(r6, ni);
+	f[7] = fpr_mul(r7, ni);
+}
+
+static void
+split_codelet_3(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f)
+{
+	fpr t_re, t_im;
+
+	FPC_ADD(t_re, t_im, f[0], f[4], f[1], f[5]);
+	f0[0] = fpr_half(t_re);
+	f0[2] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[0], f[4], f[1], f[5]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	f1[0] = fpr_half(t_re);
+	f1[2] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[2], f[6], f[3], f[7]);
+	f0[1] = fpr_half(t_re);
+	f0[3] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[2], f[6], f[3], f[7]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	f1[1] = fpr_half(t_re);
+	f1[3] = fpr_half(t_im);
+}
+
+static void
+merge_codelet_3(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1)
+{
+	fpr b_re, b_im;
+
+	FPC_MUL(b_re, b_im, f1[0], f1[2], fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_ADD(f[0], f[4], f0[0], f0[2], b_re, b_im);
+	FPC_SUB(f[1], f[5], f0[0], f0[2], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[1], f1[3], fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_ADD(f[2], f[6], f0[1], f0[3], b_re, b_im);
+	FPC_SUB(f[3], f[7], f0[1], f0[3], b_re, b_im);
+}
+
+static void
+fft_codelet_4(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr r8, r9, r10, r11, r12, r13, r14, r15;
+	fpr y_re, y_im;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+	r8 = f[8];
+	r9 = f[9];
+	r10 = f[10];
+	r11 = f[11];
+	r12 = f[12];
+	r13 = f[13];
+	r14 = f[14];
+	r15 = f[15];
+
+	FPC_MUL(y_re, y_im, r4, r12, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r4, r12, r0, r8, y_re, y_im);
+	FPC_ADD(r0, r8, r0, r8, y_re, y_im);
+	FPC_MUL(y_re, y_im, r5, r13, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r5, r13, r1, r9, y_re, y_im);
+	FPC_ADD(r1, r9, r1, r9, y_re, y_im);
+	FPC_MUL(y_re, y_im, r6, r14, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r6, r14, r2, r10, y_re, y_im);
+	FPC_ADD(r2, r10, r2, r10, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r15, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r7, r15, r3, r11, y_re, y_im);
+	FPC_ADD(r3, r11, r3, r11, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r2, r10, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r2, r10, r0, r8, y_re, y_im);
+	FPC_ADD(r0, r8, r0, r8, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r11, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r3, r11, r1, r9, y_re, y_im);
+	FPC_ADD(r1, r9, r1, r9, y_re, y_im);
+	FPC_MUL(y_re, y_im, r6, r14, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r6, r14, r4, r12, y_re, y_im);
+	FPC_ADD(r4, r12, r4, r12, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r15, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r7, r15, r5, r13, y_re, y_im);
+	FPC_ADD(r5, r13, r5, r13, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r1, r9, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r1, r9, r0, r8, y_re, y_im);
+	FPC_ADD(r0, r8, r0, r8, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r11, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r3, r11, r2, r10, y_re, y_im);
+	FPC_ADD(r2, r10, r2, r10, y_re, y_im);
+	FPC_MUL(y_re, y_im, r5, r13, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r5, r13, r4, r12, y_re, y_im);
+	FPC_ADD(r4, r12, r4, r12, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r15, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r7, r15, r6, r14, y_re, y_im);
+	FPC_ADD(r6, r14, r6, r14, y_re, y_im);
+
+	f[0] = r0;
+	f[1] = r1;
+	f[2] = r2;
+	f[3] = r3;
+	f[4] = r4;
+	f[5] = r5;
+	f[6] = r6;
+	f[7] = r7;
+	f[8] = r8;
+	f[9] = r9;
+	f[10] = r10;
+	f[11] = r11;
+	f[12] = r12;
+	f[13] = r13;
+	f[14] = r14;
+	f[15] = r15;
+}
+
+static void
+ifft_codelet_4(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr r8, r9, r10, r11, r12, r13, r14, r15;
+	fpr y_re, y_im, ni;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+	r8 = f[8];
+	r9 = f[9];
+	r10 = f[10];
+	r11 = f[11];
+	r12 = f[12];
+	r13 = f[13];
+	r14 = f[14];
+	r15 = f[15];
+
+	FPC_SUB(y_re, y_im, r0, r8, r1, r9);
+	FPC_ADD(r0, r8, r0, r8, r1, r9);
+	FPC_MUL(r1, r9, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r2, r10, r3, r11);
+	FPC_ADD(r2, r10, r2, r10, r3, r11);
+	FPC_MUL(r3, r11, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r4, r12, r5, r13);
+	FPC_ADD(r4, r12, r4, r12, r5, r13);
+	FPC_MUL(r5, r13, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r6, r14, r7, r15);
+	FPC_ADD(r6, r14, r6, r14, r7, r15);
+	FPC_MUL(r7, r15, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+
+	FPC_SUB(y_re, y_im, r0, r8, r2, r10);
+	FPC_ADD(r0, r8, r0, r8, r2, r10);
+	FPC_MUL(r2, r10, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r1, r9, r3, r11);
+	FPC_ADD(r1, r9, r1, r9, r3, r11);
+	FPC_MUL(r3, r11, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r4, r12, r6, r14);
+	FPC_ADD(r4, r12, r4, r12, r6, r14);
+	FPC_MUL(r6, r14, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r5, r13, r7, r15);
+	FPC_ADD(r5, r13, r5, r13, r7, r15);
+	FPC_MUL(r7, r15, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+
+	FPC_SUB(y_re, y_im, r0, r8, r4, r12);
+	FPC_ADD(r0, r8, r0, r8, r4, r12);
+	FPC_MUL(r4, r12, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r1, r9, r5, r13);
+	FPC_ADD(r1, r9, r1, r9, r5, r13);
+	FPC_MUL(r5, r13, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r2, r10, r6, r14);
+	FPC_ADD(r2, r10, r2, r10, r6, r14);
+	FPC_MUL(r6, r14, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r3, r11, r7, r15);
+	FPC_ADD(r3, r11, r3, r11, r7, r15);
+	FPC_MUL(r7, r15, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+
+	ni = fpr_scaled(2, -4);
+	f[0] = fpr_mul(r0, ni);
+	f[1] = fpr_mul(r1, ni);
+	f[2] = fpr_mul(r2, ni);
+	f[3] = fpr_mul(r3, ni);
+	f[4] = fpr_mul(r4, ni);
+	f[5] = fpr_mul(r5, ni);
+	f[6] = fpr_mul(r6, ni);
+	f[7] = fpr_mul(r7, ni);
+	f[8] = fpr_mul(r8, ni);
+	f[9] = fpr_mul(r9, ni);
+	f[10] = fpr_mul(r10, ni);
+	f[11] = fpr_mul(r11, ni);
+	f[12] = fpr_mul(r12, ni);
+	f[13] = fpr_mul(r13, ni);
+	f[14] = fpr_mul(r14, ni);
+	f[15] = fpr_mul(r15, ni);
+}
+
+static void
+split_codelet_4(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f)
+{
+	fpr t_re, t_im;
+
+	FPC_ADD(t_re, t_im, f[0], f[8], f[1], f[9]);
+	f0[0] = fpr_half(t_re);
+	f0[4] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[0], f[8], f[1], f[9]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	f1[0] = fpr_half(t_re);
+	f1[4] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[2], f[10], f[3], f[11]);
+	f0[1] = fpr_half(t_re);
+	f0[5] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[2], f[10], f[3], f[11]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	f1[1] = fpr_half(t_re);
+	f1[5] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[4], f[12], f[5], f[13]);
+	f0[2] = fpr_half(t_re);
+	f0[6] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[4], f[12], f[5], f[13]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	f1[2] = fpr_half(t_re);
+	f1[6] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[6], f[14], f[7], f[15]);
+	f0[3] = fpr_half(t_re);
+	f0[7] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[6], f[14], f[7], f[15]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+	f1[3] = fpr_half(t_re);
+	f1[7] = fpr_half(t_im);
+}
+
+static void
+merge_codelet_4(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1)
+{
+	fpr b_re, b_im;
+
+	FPC_MUL(b_re, b_im, f1[0], f1[4], fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_ADD(f[0], f[8], f0[0], f0[4], b_re, b_im);
+	FPC_SUB(f[1], f[9], f0[0], f0[4], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[1], f1[5], fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_ADD(f[2], f[10], f0[1], f0[5], b_re, b_im);
+	FPC_SUB(f[3], f[11], f0[1], f0[5], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[2], f1[6], fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_ADD(f[4], f[12], f0[2], f0[6], b_re, b_im);
+	FPC_SUB(f[5], f[13], f0[2], f0[6], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[3], f1[7], fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_ADD(f[6], f[14], f0[3], f0[7], b_re, b_im);
+	FPC_SUB(f[7], f[15], f0[3], f0[7], b_re, b_im);
+}
+
+static void
+fft_codelet_5(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr r8, r9, r10, r11, r12, r13, r14, r15;
+	fpr r16, r17, r18, r19, r20, r21, r22, r23;
+	fpr r24, r25, r26, r27, r28, r29, r30, r31;
+	fpr y_re, y_im;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+	r8 = f[8];
+	r9 = f[9];
+	r10 = f[10];
+	r11 = f[11];
+	r12 = f[12];
+	r13 = f[13];
+	r14 = f[14];
+	r15 = f[15];
+	r16 = f[16];
+	r17 = f[17];
+	r18 = f[18];
+	r19 = f[19];
+	r20 = f[20];
+	r21 = f[21];
+	r22 = f[22];
+	r23 = f[23];
+	r24 = f[24];
+	r25 = f[25];
+	r26 = f[26];
+	r27 = f[27];
+	r28 = f[28];
+	r29 = f[29];
+	r30 = f[30];
+	r31 = f[31];
+
+	FPC_MUL(y_re, y_im, r8, r24, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r8, r24, r0, r16, y_re, y_im);
+	FPC_ADD(r0, r16, r0, r16, y_re, y_im);
+	FPC_MUL(y_re, y_im, r9, r25, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r9, r25, r1, r17, y_re, y_im);
+	FPC_ADD(r1, r17, r1, r17, y_re, y_im);
+	FPC_MUL(y_re, y_im, r10, r26, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r10, r26, r2, r18, y_re, y_im);
+	FPC_ADD(r2, r18, r2, r18, y_re, y_im);
+	FPC_MUL(y_re, y_im, r11, r27, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r11, r27, r3, r19, y_re, y_im);
+	FPC_ADD(r3, r19, r3, r19, y_re, y_im);
+	FPC_MUL(y_re, y_im, r12, r28, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r12, r28, r4, r20, y_re, y_im);
+	FPC_ADD(r4, r20, r4, r20, y_re, y_im);
+	FPC_MUL(y_re, y_im, r13, r29, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r13, r29, r5, r21, y_re, y_im);
+	FPC_ADD(r5, r21, r5, r21, y_re, y_im);
+	FPC_MUL(y_re, y_im, r14, r30, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r14, r30, r6, r22, y_re, y_im);
+	FPC_ADD(r6, r22, r6, r22, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r31, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r15, r31, r7, r23, y_re, y_im);
+	FPC_ADD(r7, r23, r7, r23, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r4, r20, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r4, r20, r0, r16, y_re, y_im);
+	FPC_ADD(r0, r16, r0, r16, y_re, y_im);
+	FPC_MUL(y_re, y_im, r5, r21, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r5, r21, r1, r17, y_re, y_im);
+	FPC_ADD(r1, r17, r1, r17, y_re, y_im);
+	FPC_MUL(y_re, y_im, r6, r22, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r6, r22, r2, r18, y_re, y_im);
+	FPC_ADD(r2, r18, r2, r18, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r23, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r7, r23, r3, r19, y_re, y_im);
+	FPC_ADD(r3, r19, r3, r19, y_re, y_im);
+	FPC_MUL(y_re, y_im, r12, r28, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r12, r28, r8, r24, y_re, y_im);
+	FPC_ADD(r8, r24, r8, r24, y_re, y_im);
+	FPC_MUL(y_re, y_im, r13, r29, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r13, r29, r9, r25, y_re, y_im);
+	FPC_ADD(r9, r25, r9, r25, y_re, y_im);
+	FPC_MUL(y_re, y_im, r14, r30, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r14, r30, r10, r26, y_re, y_im);
+	FPC_ADD(r10, r26, r10, r26, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r31, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r15, r31, r11, r27, y_re, y_im);
+	FPC_ADD(r11, r27, r11, r27, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r2, r18, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r2, r18, r0, r16, y_re, y_im);
+	FPC_ADD(r0, r16, r0, r16, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r19, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r3, r19, r1, r17, y_re, y_im);
+	FPC_ADD(r1, r17, r1, r17, y_re, y_im);
+	FPC_MUL(y_re, y_im, r6, r22, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r6, r22, r4, r20, y_re, y_im);
+	FPC_ADD(r4, r20, r4, r20, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r23, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r7, r23, r5, r21, y_re, y_im);
+	FPC_ADD(r5, r21, r5, r21, y_re, y_im);
+	FPC_MUL(y_re, y_im, r10, r26, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r10, r26, r8, r24, y_re, y_im);
+	FPC_ADD(r8, r24, r8, r24, y_re, y_im);
+	FPC_MUL(y_re, y_im, r11, r27, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r11, r27, r9, r25, y_re, y_im);
+	FPC_ADD(r9, r25, r9, r25, y_re, y_im);
+	FPC_MUL(y_re, y_im, r14, r30, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r14, r30, r12, r28, y_re, y_im);
+	FPC_ADD(r12, r28, r12, r28, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r31, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r15, r31, r13, r29, y_re, y_im);
+	FPC_ADD(r13, r29, r13, r29, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r1, r17, fpr_gm_tab[32], fpr_gm_tab[33]);
+	FPC_SUB(r1, r17, r0, r16, y_re, y_im);
+	FPC_ADD(r0, r16, r0, r16, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r19, fpr_gm_tab[34], fpr_gm_tab[35]);
+	FPC_SUB(r3, r19, r2, r18, y_re, y_im);
+	FPC_ADD(r2, r18, r2, r18, y_re, y_im);
+	FPC_MUL(y_re, y_im, r5, r21, fpr_gm_tab[36], fpr_gm_tab[37]);
+	FPC_SUB(r5, r21, r4, r20, y_re, y_im);
+	FPC_ADD(r4, r20, r4, r20, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r23, fpr_gm_tab[38], fpr_gm_tab[39]);
+	FPC_SUB(r7, r23, r6, r22, y_re, y_im);
+	FPC_ADD(r6, r22, r6, r22, y_re, y_im);
+	FPC_MUL(y_re, y_im, r9, r25, fpr_gm_tab[40], fpr_gm_tab[41]);
+	FPC_SUB(r9, r25, r8, r24, y_re, y_im);
+	FPC_ADD(r8, r24, r8, r24, y_re, y_im);
+	FPC_MUL(y_re, y_im, r11, r27, fpr_gm_tab[42], fpr_gm_tab[43]);
+	FPC_SUB(r11, r27, r10, r26, y_re, y_im);
+	FPC_ADD(r10, r26, r10, r26, y_re, y_im);
+	FPC_MUL(y_re, y_im, r13, r29, fpr_gm_tab[44], fpr_gm_tab[45]);
+	FPC_SUB(r13, r29, r12, r28, y_re, y_im);
+	FPC_ADD(r12, r28, r12, r28, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r31, fpr_gm_tab[46], fpr_gm_tab[47]);
+	FPC_SUB(r15, r31, r14, r30, y_re, y_im);
+	FPC_ADD(r14, r30, r14, r30, y_re, y_im);
+
+	f[0] = r0;
+	f[1] = r1;
+	f[2] = r2;
+	f[3] = r3;
+	f[4] = r4;
+	f[5] = r5;
+	f[6] = r6;
+	f[7] = r7;
+	f[8] = r8;
+	f[9] = r9;
+	f[10] = r10;
+	f[11] = r11;
+	f[12] = r12;
+	f[13] = r13;
+	f[14] = r14;
+	f[15] = r15;
+	f[16] = r16;
+	f[17] = r17;
+	f[18] = r18;
+	f[19] = r19;
+	f[20] = r20;
+	f[21] = r21;
+	f[22] = r22;
+	f[23] = r23;
+	f[24] = r24;
+	f[25] = r25;
+	f[26] = r26;
+	f[27] = r27;
+	f[28] = r28;
+	f[29] = r29;
+	f[30] = r30;
+	f[31] = r31;
+}
+
+static void
+ifft_codelet_5(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr r8, r9, r10, r11, r12, r13, r14, r15;
+	fpr r16, r17, r18, r19, r20, r21, r22, r23;
+	fpr r24, r25, r26, r27, r28, r29, r30, r31;
+	fpr y_re, y_im, ni;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+	r8 = f[8];
+	r9 = f[9];
+	r10 = f[10];
+	r11 = f[11];
+	r12 = f[12];
+	r13 = f[13];
+	r14 = f[14];
+	r15 = f[15];
+	r16 = f[16];
+	r17 = f[17];
+	r18 = f[18];
+	r19 = f[19];
+	r20 = f[20];
+	r21 = f[21];
+	r22 = f[22];
+	r23 = f[23];
+	r24 = f[24];
+	r25 = f[25];
+	r26 = f[26];
+	r27 = f[27];
+	r28 = f[28];
+	r29 = f[29];
+	r30 = f[30];
+	r31 = f[31];
+
+	FPC_SUB(y_re, y_im, r0, r16, r1, r17);
+	FPC_ADD(r0, r16, r0, r16, r1, r17);
+	FPC_MUL(r1, r17, y_re, y_im, fpr_gm_tab[32], fpr_neg(fpr_gm_tab[33]));
+	FPC_SUB(y_re, y_im, r2, r18, r3, r19);
+	FPC_ADD(r2, r18, r2, r18, r3, r19);
+	FPC_MUL(r3, r19, y_re, y_im, fpr_gm_tab[34], fpr_neg(fpr_gm_tab[35]));
+	FPC_SUB(y_re, y_im, r4, r20, r5, r21);
+	FPC_ADD(r4, r20, r4, r20, r5, r21);
+	FPC_MUL(r5, r21, y_re, y_im, fpr_gm_tab[36], fpr_neg(fpr_gm_tab[37]));
+	FPC_SUB(y_re, y_im, r6, r22, r7, r23);
+	FPC_ADD(r6, r22, r6, r22, r7, r23);
+	FPC_MUL(r7, r23, y_re, y_im, fpr_gm_tab[38], fpr_neg(fpr_gm_tab[39]));
+	FPC_SUB(y_re, y_im, r8, r24, r9, r25);
+	FPC_ADD(r8, r24, r8, r24, r9, r25);
+	FPC_MUL(r9, r25, y_re, y_im, fpr_gm_tab[40], fpr_neg(fpr_gm_tab[41]));
+	FPC_SUB(y_re, y_im, r10, r26, r11, r27);
+	FPC_ADD(r10, r26, r10, r26, r11, r27);
+	FPC_MUL(r11, r27, y_re, y_im, fpr_gm_tab[42], fpr_neg(fpr_gm_tab[43]));
+	FPC_SUB(y_re, y_im, r12, r28, r13, r29);
+	FPC_ADD(r12, r28, r12, r28, r13, r29);
+	FPC_MUL(r13, r29, y_re, y_im, fpr_gm_tab[44], fpr_neg(fpr_gm_tab[45]));
+	FPC_SUB(y_re, y_im, r14, r30, r15, r31);
+	FPC_ADD(r14, r30, r14, r30, r15, r31);
+	FPC_MUL(r15, r31, y_re, y_im, fpr_gm_tab[46], fpr_neg(fpr_gm_tab[47]));
+
+	FPC_SUB(y_re, y_im, r0, r16, r2, r18);
+	FPC_ADD(r0, r16, r0, r16, r2, r18);
+	FPC_MUL(r2, r18, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r1, r17, r3, r19);
+	FPC_ADD(r1, r17, r1, r17, r3, r19);
+	FPC_MUL(r3, r19, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r4, r20, r6, r22);
+	FPC_ADD(r4, r20, r4, r20, r6, r22);
+	FPC_MUL(r6, r22, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r5, r21, r7, r23);
+	FPC_ADD(r5, r21, r5, r21, r7, r23);
+	FPC_MUL(r7, r23, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r8, r24, r10, r26);
+	FPC_ADD(r8, r24, r8, r24, r10, r26);
+	FPC_MUL(r10, r26, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r9, r25, r11, r27);
+	FPC_ADD(r9, r25, r9, r25, r11, r27);
+	FPC_MUL(r11, r27, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r12, r28, r14, r30);
+	FPC_ADD(r12, r28, r12, r28, r14, r30);
+	FPC_MUL(r14, r30, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+	FPC_SUB(y_re, y_im, r13, r29, r15, r31);
+	FPC_ADD(r13, r29, r13, r29, r15, r31);
+	FPC_MUL(r15, r31, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+
+	FPC_SUB(y_re, y_im, r0, r16, r4, r20);
+	FPC_ADD(r0, r16, r0, r16, r4, r20);
+	FPC_MUL(r4, r20, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r1, r17, r5, r21);
+	FPC_ADD(r1, r17, r1, r17, r5, r21);
+	FPC_MUL(r5, r21, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r2, r18, r6, r22);
+	FPC_ADD(r2, r18, r2, r18, r6, r22);
+	FPC_MUL(r6, r22, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r3, r19, r7, r23);
+	FPC_ADD(r3, r19, r3, r19, r7, r23);
+	FPC_MUL(r7, r23, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r8, r24, r12, r28);
+	FPC_ADD(r8, r24, r8, r24, r12, r28);
+	FPC_MUL(r12, r28, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r9, r25, r13, r29);
+	FPC_ADD(r9, r25, r9, r25, r13, r29);
+	FPC_MUL(r13, r29, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r10, r26, r14, r30);
+	FPC_ADD(r10, r26, r10, r26, r14, r30);
+	FPC_MUL(r14, r30, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r11, r27, r15, r31);
+	FPC_ADD(r11, r27, r11, r27, r15, r31);
+	FPC_MUL(r15, r31, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+
+	FPC_SUB(y_re, y_im, r0, r16, r8, r24);
+	FPC_ADD(r0, r16, r0, r16, r8, r24);
+	FPC_MUL(r8, r24, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r1, r17, r9, r25);
+	FPC_ADD(r1, r17, r1, r17, r9, r25);
+	FPC_MUL(r9, r25, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r2, r18, r10, r26);
+	FPC_ADD(r2, r18, r2, r18, r10, r26);
+	FPC_MUL(r10, r26, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r3, r19, r11, r27);
+	FPC_ADD(r3, r19, r3, r19, r11, r27);
+	FPC_MUL(r11, r27, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r4, r20, r12, r28);
+	FPC_ADD(r4, r20, r4, r20, r12, r28);
+	FPC_MUL(r12, r28, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r5, r21, r13, r29);
+	FPC_ADD(r5, r21, r5, r21, r13, r29);
+	FPC_MUL(r13, r29, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r6, r22, r14, r30);
+	FPC_ADD(r6, r22, r6, r22, r14, r30);
+	FPC_MUL(r14, r30, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r7, r23, r15, r31);
+	FPC_ADD(r7, r23, r7, r23, r15, r31);
+	FPC_MUL(r15, r31, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+
+	ni = fpr_scaled(2, -5);
+	f[0] = fpr_mul(r0, ni);
+	f[1] = fpr_mul(r1, ni);
+	f[2] = fpr_mul(r2, ni);
+	f[3] = fpr_mul(r3, ni);
+	f[4] = fpr_mul(r4, ni);
+	f[5] = fpr_mul(r5, ni);
+	f[6] = fpr_mul(r6, ni);
+	f[7] = fpr_mul(r7, ni);
+	f[8] = fpr_mul(r8, ni);
+	f[9] = fpr_mul(r9, ni);
+	f[10] = fpr_mul(r10, ni);
+	f[11] = fpr_mul(r11, ni);
+	f[12] = fpr_mul(r12, ni);
+	f[13] = fpr_mul(r13, ni);
+	f[14] = fpr_mul(r14, ni);
+	f[15] = fpr_mul(r15, ni);
+	f[16] = fpr_mul(r16, ni);
+	f[17] = fpr_mul(r17, ni);
+	f[18] = fpr_mul(r18, ni);
+	f[19] = fpr_mul(r19, ni);
+	f[20] = fpr_mul(r20, ni);
+	f[21] = fpr_mul(r21, ni);
+	f[22] = fpr_mul(r22, ni);
+	f[23] = fpr_mul(r23, ni);
+	f[24] = fpr_mul(r24, ni);
+	f[25] = fpr_mul(r25, ni);
+	f[26] = fpr_mul(r26, ni);
+	f[27] = fpr_mul(r27, ni);
+	f[28] = fpr_mul(r28, ni);
+	f[29] = fpr_mul(r29, ni);
+	f[30] = fpr_mul(r30, ni);
+	f[31] = fpr_mul(r31, ni);
+}
+
+static void
+split_codelet_5(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f)
+{
+	fpr t_re, t_im;
+
+	FPC_ADD(t_re, t_im, f[0], f[16], f[1], f[17]);
+	f0[0] = fpr_half(t_re);
+	f0[8] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[0], f[16], f[1], f[17]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[32], fpr_neg(fpr_gm_tab[33]));
+	f1[0] = fpr_half(t_re);
+	f1[8] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[2], f[18], f[3], f[19]);
+	f0[1] = fpr_half(t_re);
+	f0[9] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[2], f[18], f[3], f[19]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[34], fpr_neg(fpr_gm_tab[35]));
+	f1[1] = fpr_half(t_re);
+	f1[9] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[4], f[20], f[5], f[21]);
+	f0[2] = fpr_half(t_re);
+	f0[10] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[4], f[20], f[5], f[21]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[36], fpr_neg(fpr_gm_tab[37]));
+	f1[2] = fpr_half(t_re);
+	f1[10] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[6], f[22], f[7], f[23]);
+	f0[3] = fpr_half(t_re);
+	f0[11] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[6], f[22], f[7], f[23]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[38], fpr_neg(fpr_gm_tab[39]));
+	f1[3] = fpr_half(t_re);
+	f1[11] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[8], f[24], f[9], f[25]);
+	f0[4] = fpr_half(t_re);
+	f0[12] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[8], f[24], f[9], f[25]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[40], fpr_neg(fpr_gm_tab[41]));
+	f1[4] = fpr_half(t_re);
+	f1[12] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[10], f[26], f[11], f[27]);
+	f0[5] = fpr_half(t_re);
+	f0[13] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[10], f[26], f[11], f[27]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[42], fpr_neg(fpr_gm_tab[43]));
+	f1[5] = fpr_half(t_re);
+	f1[13] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[12], f[28], f[13], f[29]);
+	f0[6] = fpr_half(t_re);
+	f0[14] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[12], f[28], f[13], f[29]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[44], fpr_neg(fpr_gm_tab[45]));
+	f1[6] = fpr_half(t_re);
+	f1[14] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[14], f[30], f[15], f[31]);
+	f0[7] = fpr_half(t_re);
+	f0[15] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[14], f[30], f[15], f[31]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[46], fpr_neg(fpr_gm_tab[47]));
+	f1[7] = fpr_half(t_re);
+	f1[15] = fpr_half(t_im);
+}
+
+static void
+merge_codelet_5(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1)
+{
+	fpr b_re, b_im;
+
+	FPC_MUL(b_re, b_im, f1[0], f1[8], fpr_gm_tab[32], fpr_gm_tab[33]);
+	FPC_ADD(f[0], f[16], f0[0], f0[8], b_re, b_im);
+	FPC_SUB(f[1], f[17], f0[0], f0[8], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[1], f1[9], fpr_gm_tab[34], fpr_gm_tab[35]);
+	FPC_ADD(f[2], f[18], f0[1], f0[9], b_re, b_im);
+	FPC_SUB(f[3], f[19], f0[1], f0[9], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[2], f1[10], fpr_gm_tab[36], fpr_gm_tab[37]);
+	FPC_ADD(f[4], f[20], f0[2], f0[10], b_re, b_im);
+	FPC_SUB(f[5], f[21], f0[2], f0[10], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[3], f1[11], fpr_gm_tab[38], fpr_gm_tab[39]);
+	FPC_ADD(f[6], f[22], f0[3], f0[11], b_re, b_im);
+	FPC_SUB(f[7], f[23], f0[3], f0[11], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[4], f1[12], fpr_gm_tab[40], fpr_gm_tab[41]);
+	FPC_ADD(f[8], f[24], f0[4], f0[12], b_re, b_im);
+	FPC_SUB(f[9], f[25], f0[4], f0[12], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[5], f1[13], fpr_gm_tab[42], fpr_gm_tab[43]);
+	FPC_ADD(f[10], f[26], f0[5], f0[13], b_re, b_im);
+	FPC_SUB(f[11], f[27], f0[5], f0[13], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[6], f1[14], fpr_gm_tab[44], fpr_gm_tab[45]);
+	FPC_ADD(f[12], f[28], f0[6], f0[14], b_re, b_im);
+	FPC_SUB(f[13], f[29], f0[6], f0[14], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[7], f1[15], fpr_gm_tab[46], fpr_gm_tab[47]);
+	FPC_ADD(f[14], f[30], f0[7], f0[15], b_re, b_im);
+	FPC_SUB(f[15], f[31], f0[7], f0[15], b_re, b_im);
+}
+
+static void
+fft_codelet_6(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr r8, r9, r10, r11, r12, r13, r14, r15;
+	fpr r16, r17, r18, r19, r20, r21, r22, r23;
+	fpr r24, r25, r26, r27, r28, r29, r30, r31;
+	fpr r32, r33, r34, r35, r36, r37, r38, r39;
+	fpr r40, r41, r42, r43, r44, r45, r46, r47;
+	fpr r48, r49, r50, r51, r52, r53, r54, r55;
+	fpr r56, r57, r58, r59, r60, r61, r62, r63;
+	fpr y_re, y_im;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+	r8 = f[8];
+	r9 = f[9];
+	r10 = f[10];
+	r11 = f[11];
+	r12 = f[12];
+	r13 = f[13];
+	r14 = f[14];
+	r15 = f[15];
+	r16 = f[16];
+	r17 = f[17];
+	r18 = f[18];
+	r19 = f[19];
+	r20 = f[20];
+	r21 = f[21];
+	r22 = f[22];
+	r23 = f[23];
+	r24 = f[24];
+	r25 = f[25];
+	r26 = f[26];
+	r27 = f[27];
+	r28 = f[28];
+	r29 = f[29];
+	r30 = f[30];
+	r31 = f[31];
+	r32 = f[32];
+	r33 = f[33];
+	r34 = f[34];
+	r35 = f[35];
+	r36 = f[36];
+	r37 = f[37];
+	r38 = f[38];
+	r39 = f[39];
+	r40 = f[40];
+	r41 = f[41];
+	r42 = f[42];
+	r43 = f[43];
+	r44 = f[44];
+	r45 = f[45];
+	r46 = f[46];
+	r47 = f[47];
+	r48 = f[48];
+	r49 = f[49];
+	r50 = f[50];
+	r51 = f[51];
+	r52 = f[52];
+	r53 = f[53];
+	r54 = f[54];
+	r55 = f[55];
+	r56 = f[56];
+	r57 = f[57];
+	r58 = f[58];
+	r59 = f[59];
+	r60 = f[60];
+	r61 = f[61];
+	r62 = f[62];
+	r63 = f[63];
+
+	FPC_MUL(y_re, y_im, r16, r48, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r16, r48, r0, r32, y_re, y_im);
+	FPC_ADD(r0, r32, r0, r32, y_re, y_im);
+	FPC_MUL(y_re, y_im, r17, r49, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r17, r49, r1, r33, y_re, y_im);
+	FPC_ADD(r1, r33, r1, r33, y_re, y_im);
+	FPC_MUL(y_re, y_im, r18, r50, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r18, r50, r2, r34, y_re, y_im);
+	FPC_ADD(r2, r34, r2, r34, y_re, y_im);
+	FPC_MUL(y_re, y_im, r19, r51, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r19, r51, r3, r35, y_re, y_im);
+	FPC_ADD(r3, r35, r3, r35, y_re, y_im);
+	FPC_MUL(y_re, y_im, r20, r52, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r20, r52, r4, r36, y_re, y_im);
+	FPC_ADD(r4, r36, r4, r36, y_re, y_im);
+	FPC_MUL(y_re, y_im, r21, r53, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r21, r53, r5, r37, y_re, y_im);
+	FPC_ADD(r5, r37, r5, r37, y_re, y_im);
+	FPC_MUL(y_re, y_im, r22, r54, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r22, r54, r6, r38, y_re, y_im);
+	FPC_ADD(r6, r38, r6, r38, y_re, y_im);
+	FPC_MUL(y_re, y_im, r23, r55, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r23, r55, r7, r39, y_re, y_im);
+	FPC_ADD(r7, r39, r7, r39, y_re, y_im);
+	FPC_MUL(y_re, y_im, r24, r56, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r24, r56, r8, r40, y_re, y_im);
+	FPC_ADD(r8, r40, r8, r40, y_re, y_im);
+	FPC_MUL(y_re, y_im, r25, r57, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r25, r57, r9, r41, y_re, y_im);
+	FPC_ADD(r9, r41, r9, r41, y_re, y_im);
+	FPC_MUL(y_re, y_im, r26, r58, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r26, r58, r10, r42, y_re, y_im);
+	FPC_ADD(r10, r42, r10, r42, y_re, y_im);
+	FPC_MUL(y_re, y_im, r27, r59, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r27, r59, r11, r43, y_re, y_im);
+	FPC_ADD(r11, r43, r11, r43, y_re, y_im);
+	FPC_MUL(y_re, y_im, r28, r60, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r28, r60, r12, r44, y_re, y_im);
+	FPC_ADD(r12, r44, r12, r44, y_re, y_im);
+	FPC_MUL(y_re, y_im, r29, r61, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r29, r61, r13, r45, y_re, y_im);
+	FPC_ADD(r13, r45, r13, r45, y_re, y_im);
+	FPC_MUL(y_re, y_im, r30, r62, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r30, r62, r14, r46, y_re, y_im);
+	FPC_ADD(r14, r46, r14, r46, y_re, y_im);
+	FPC_MUL(y_re, y_im, r31, r63, fpr_gm_tab[4], fpr_gm_tab[5]);
+	FPC_SUB(r31, r63, r15, r47, y_re, y_im);
+	FPC_ADD(r15, r47, r15, r47, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r8, r40, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r8, r40, r0, r32, y_re, y_im);
+	FPC_ADD(r0, r32, r0, r32, y_re, y_im);
+	FPC_MUL(y_re, y_im, r9, r41, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r9, r41, r1, r33, y_re, y_im);
+	FPC_ADD(r1, r33, r1, r33, y_re, y_im);
+	FPC_MUL(y_re, y_im, r10, r42, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r10, r42, r2, r34, y_re, y_im);
+	FPC_ADD(r2, r34, r2, r34, y_re, y_im);
+	FPC_MUL(y_re, y_im, r11, r43, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r11, r43, r3, r35, y_re, y_im);
+	FPC_ADD(r3, r35, r3, r35, y_re, y_im);
+	FPC_MUL(y_re, y_im, r12, r44, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r12, r44, r4, r36, y_re, y_im);
+	FPC_ADD(r4, r36, r4, r36, y_re, y_im);
+	FPC_MUL(y_re, y_im, r13, r45, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r13, r45, r5, r37, y_re, y_im);
+	FPC_ADD(r5, r37, r5, r37, y_re, y_im);
+	FPC_MUL(y_re, y_im, r14, r46, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r14, r46, r6, r38, y_re, y_im);
+	FPC_ADD(r6, r38, r6, r38, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r47, fpr_gm_tab[8], fpr_gm_tab[9]);
+	FPC_SUB(r15, r47, r7, r39, y_re, y_im);
+	FPC_ADD(r7, r39, r7, r39, y_re, y_im);
+	FPC_MUL(y_re, y_im, r24, r56, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r24, r56, r16, r48, y_re, y_im);
+	FPC_ADD(r16, r48, r16, r48, y_re, y_im);
+	FPC_MUL(y_re, y_im, r25, r57, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r25, r57, r17, r49, y_re, y_im);
+	FPC_ADD(r17, r49, r17, r49, y_re, y_im);
+	FPC_MUL(y_re, y_im, r26, r58, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r26, r58, r18, r50, y_re, y_im);
+	FPC_ADD(r18, r50, r18, r50, y_re, y_im);
+	FPC_MUL(y_re, y_im, r27, r59, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r27, r59, r19, r51, y_re, y_im);
+	FPC_ADD(r19, r51, r19, r51, y_re, y_im);
+	FPC_MUL(y_re, y_im, r28, r60, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r28, r60, r20, r52, y_re, y_im);
+	FPC_ADD(r20, r52, r20, r52, y_re, y_im);
+	FPC_MUL(y_re, y_im, r29, r61, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r29, r61, r21, r53, y_re, y_im);
+	FPC_ADD(r21, r53, r21, r53, y_re, y_im);
+	FPC_MUL(y_re, y_im, r30, r62, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r30, r62, r22, r54, y_re, y_im);
+	FPC_ADD(r22, r54, r22, r54, y_re, y_im);
+	FPC_MUL(y_re, y_im, r31, r63, fpr_gm_tab[10], fpr_gm_tab[11]);
+	FPC_SUB(r31, r63, r23, r55, y_re, y_im);
+	FPC_ADD(r23, r55, r23, r55, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r4, r36, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r4, r36, r0, r32, y_re, y_im);
+	FPC_ADD(r0, r32, r0, r32, y_re, y_im);
+	FPC_MUL(y_re, y_im, r5, r37, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r5, r37, r1, r33, y_re, y_im);
+	FPC_ADD(r1, r33, r1, r33, y_re, y_im);
+	FPC_MUL(y_re, y_im, r6, r38, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r6, r38, r2, r34, y_re, y_im);
+	FPC_ADD(r2, r34, r2, r34, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r39, fpr_gm_tab[16], fpr_gm_tab[17]);
+	FPC_SUB(r7, r39, r3, r35, y_re, y_im);
+	FPC_ADD(r3, r35, r3, r35, y_re, y_im);
+	FPC_MUL(y_re, y_im, r12, r44, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r12, r44, r8, r40, y_re, y_im);
+	FPC_ADD(r8, r40, r8, r40, y_re, y_im);
+	FPC_MUL(y_re, y_im, r13, r45, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r13, r45, r9, r41, y_re, y_im);
+	FPC_ADD(r9, r41, r9, r41, y_re, y_im);
+	FPC_MUL(y_re, y_im, r14, r46, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r14, r46, r10, r42, y_re, y_im);
+	FPC_ADD(r10, r42, r10, r42, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r47, fpr_gm_tab[18], fpr_gm_tab[19]);
+	FPC_SUB(r15, r47, r11, r43, y_re, y_im);
+	FPC_ADD(r11, r43, r11, r43, y_re, y_im);
+	FPC_MUL(y_re, y_im, r20, r52, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r20, r52, r16, r48, y_re, y_im);
+	FPC_ADD(r16, r48, r16, r48, y_re, y_im);
+	FPC_MUL(y_re, y_im, r21, r53, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r21, r53, r17, r49, y_re, y_im);
+	FPC_ADD(r17, r49, r17, r49, y_re, y_im);
+	FPC_MUL(y_re, y_im, r22, r54, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r22, r54, r18, r50, y_re, y_im);
+	FPC_ADD(r18, r50, r18, r50, y_re, y_im);
+	FPC_MUL(y_re, y_im, r23, r55, fpr_gm_tab[20], fpr_gm_tab[21]);
+	FPC_SUB(r23, r55, r19, r51, y_re, y_im);
+	FPC_ADD(r19, r51, r19, r51, y_re, y_im);
+	FPC_MUL(y_re, y_im, r28, r60, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r28, r60, r24, r56, y_re, y_im);
+	FPC_ADD(r24, r56, r24, r56, y_re, y_im);
+	FPC_MUL(y_re, y_im, r29, r61, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r29, r61, r25, r57, y_re, y_im);
+	FPC_ADD(r25, r57, r25, r57, y_re, y_im);
+	FPC_MUL(y_re, y_im, r30, r62, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r30, r62, r26, r58, y_re, y_im);
+	FPC_ADD(r26, r58, r26, r58, y_re, y_im);
+	FPC_MUL(y_re, y_im, r31, r63, fpr_gm_tab[22], fpr_gm_tab[23]);
+	FPC_SUB(r31, r63, r27, r59, y_re, y_im);
+	FPC_ADD(r27, r59, r27, r59, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r2, r34, fpr_gm_tab[32], fpr_gm_tab[33]);
+	FPC_SUB(r2, r34, r0, r32, y_re, y_im);
+	FPC_ADD(r0, r32, r0, r32, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r35, fpr_gm_tab[32], fpr_gm_tab[33]);
+	FPC_SUB(r3, r35, r1, r33, y_re, y_im);
+	FPC_ADD(r1, r33, r1, r33, y_re, y_im);
+	FPC_MUL(y_re, y_im, r6, r38, fpr_gm_tab[34], fpr_gm_tab[35]);
+	FPC_SUB(r6, r38, r4, r36, y_re, y_im);
+	FPC_ADD(r4, r36, r4, r36, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r39, fpr_gm_tab[34], fpr_gm_tab[35]);
+	FPC_SUB(r7, r39, r5, r37, y_re, y_im);
+	FPC_ADD(r5, r37, r5, r37, y_re, y_im);
+	FPC_MUL(y_re, y_im, r10, r42, fpr_gm_tab[36], fpr_gm_tab[37]);
+	FPC_SUB(r10, r42, r8, r40, y_re, y_im);
+	FPC_ADD(r8, r40, r8, r40, y_re, y_im);
+	FPC_MUL(y_re, y_im, r11, r43, fpr_gm_tab[36], fpr_gm_tab[37]);
+	FPC_SUB(r11, r43, r9, r41, y_re, y_im);
+	FPC_ADD(r9, r41, r9, r41, y_re, y_im);
+	FPC_MUL(y_re, y_im, r14, r46, fpr_gm_tab[38], fpr_gm_tab[39]);
+	FPC_SUB(r14, r46, r12, r44, y_re, y_im);
+	FPC_ADD(r12, r44, r12, r44, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r47, fpr_gm_tab[38], fpr_gm_tab[39]);
+	FPC_SUB(r15, r47, r13, r45, y_re, y_im);
+	FPC_ADD(r13, r45, r13, r45, y_re, y_im);
+	FPC_MUL(y_re, y_im, r18, r50, fpr_gm_tab[40], fpr_gm_tab[41]);
+	FPC_SUB(r18, r50, r16, r48, y_re, y_im);
+	FPC_ADD(r16, r48, r16, r48, y_re, y_im);
+	FPC_MUL(y_re, y_im, r19, r51, fpr_gm_tab[40], fpr_gm_tab[41]);
+	FPC_SUB(r19, r51, r17, r49, y_re, y_im);
+	FPC_ADD(r17, r49, r17, r49, y_re, y_im);
+	FPC_MUL(y_re, y_im, r22, r54, fpr_gm_tab[42], fpr_gm_tab[43]);
+	FPC_SUB(r22, r54, r20, r52, y_re, y_im);
+	FPC_ADD(r20, r52, r20, r52, y_re, y_im);
+	FPC_MUL(y_re, y_im, r23, r55, fpr_gm_tab[42], fpr_gm_tab[43]);
+	FPC_SUB(r23, r55, r21, r53, y_re, y_im);
+	FPC_ADD(r21, r53, r21, r53, y_re, y_im);
+	FPC_MUL(y_re, y_im, r26, r58, fpr_gm_tab[44], fpr_gm_tab[45]);
+	FPC_SUB(r26, r58, r24, r56, y_re, y_im);
+	FPC_ADD(r24, r56, r24, r56, y_re, y_im);
+	FPC_MUL(y_re, y_im, r27, r59, fpr_gm_tab[44], fpr_gm_tab[45]);
+	FPC_SUB(r27, r59, r25, r57, y_re, y_im);
+	FPC_ADD(r25, r57, r25, r57, y_re, y_im);
+	FPC_MUL(y_re, y_im, r30, r62, fpr_gm_tab[46], fpr_gm_tab[47]);
+	FPC_SUB(r30, r62, r28, r60, y_re, y_im);
+	FPC_ADD(r28, r60, r28, r60, y_re, y_im);
+	FPC_MUL(y_re, y_im, r31, r63, fpr_gm_tab[46], fpr_gm_tab[47]);
+	FPC_SUB(r31, r63, r29, r61, y_re, y_im);
+	FPC_ADD(r29, r61, r29, r61, y_re, y_im);
+
+	FPC_MUL(y_re, y_im, r1, r33, fpr_gm_tab[64], fpr_gm_tab[65]);
+	FPC_SUB(r1, r33, r0, r32, y_re, y_im);
+	FPC_ADD(r0, r32, r0, r32, y_re, y_im);
+	FPC_MUL(y_re, y_im, r3, r35, fpr_gm_tab[66], fpr_gm_tab[67]);
+	FPC_SUB(r3, r35, r2, r34, y_re, y_im);
+	FPC_ADD(r2, r34, r2, r34, y_re, y_im);
+	FPC_MUL(y_re, y_im, r5, r37, fpr_gm_tab[68], fpr_gm_tab[69]);
+	FPC_SUB(r5, r37, r4, r36, y_re, y_im);
+	FPC_ADD(r4, r36, r4, r36, y_re, y_im);
+	FPC_MUL(y_re, y_im, r7, r39, fpr_gm_tab[70], fpr_gm_tab[71]);
+	FPC_SUB(r7, r39, r6, r38, y_re, y_im);
+	FPC_ADD(r6, r38, r6, r38, y_re, y_im);
+	FPC_MUL(y_re, y_im, r9, r41, fpr_gm_tab[72], fpr_gm_tab[73]);
+	FPC_SUB(r9, r41, r8, r40, y_re, y_im);
+	FPC_ADD(r8, r40, r8, r40, y_re, y_im);
+	FPC_MUL(y_re, y_im, r11, r43, fpr_gm_tab[74], fpr_gm_tab[75]);
+	FPC_SUB(r11, r43, r10, r42, y_re, y_im);
+	FPC_ADD(r10, r42, r10, r42, y_re, y_im);
+	FPC_MUL(y_re, y_im, r13, r45, fpr_gm_tab[76], fpr_gm_tab[77]);
+	FPC_SUB(r13, r45, r12, r44, y_re, y_im);
+	FPC_ADD(r12, r44, r12, r44, y_re, y_im);
+	FPC_MUL(y_re, y_im, r15, r47, fpr_gm_tab[78], fpr_gm_tab[79]);
+	FPC_SUB(r15, r47, r14, r46, y_re, y_im);
+	FPC_ADD(r14, r46, r14, r46, y_re, y_im);
+	FPC_MUL(y_re, y_im, r17, r49, fpr_gm_tab[80], fpr_gm_tab[81]);
+	FPC_SUB(r17, r49, r16, r48, y_re, y_im);
+	FPC_ADD(r16, r48, r16, r48, y_re, y_im);
+	FPC_MUL(y_re, y_im, r19, r51, fpr_gm_tab[82], fpr_gm_tab[83]);
+	FPC_SUB(r19, r51, r18, r50, y_re, y_im);
+	FPC_ADD(r18, r50, r18, r50, y_re, y_im);
+	FPC_MUL(y_re, y_im, r21, r53, fpr_gm_tab[84], fpr_gm_tab[85]);
+	FPC_SUB(r21, r53, r20, r52, y_re, y_im);
+	FPC_ADD(r20, r52, r20, r52, y_re, y_im);
+	FPC_MUL(y_re, y_im, r23, r55, fpr_gm_tab[86], fpr_gm_tab[87]);
+	FPC_SUB(r23, r55, r22, r54, y_re, y_im);
+	FPC_ADD(r22, r54, r22, r54, y_re, y_im);
+	FPC_MUL(y_re, y_im, r25, r57, fpr_gm_tab[88], fpr_gm_tab[89]);
+	FPC_SUB(r25, r57, r24, r56, y_re, y_im);
+	FPC_ADD(r24, r56, r24, r56, y_re, y_im);
+	FPC_MUL(y_re, y_im, r27, r59, fpr_gm_tab[90], fpr_gm_tab[91]);
+	FPC_SUB(r27, r59, r26, r58, y_re, y_im);
+	FPC_ADD(r26, r58, r26, r58, y_re, y_im);
+	FPC_MUL(y_re, y_im, r29, r61, fpr_gm_tab[92], fpr_gm_tab[93]);
+	FPC_SUB(r29, r61, r28, r60, y_re, y_im);
+	FPC_ADD(r28, r60, r28, r60, y_re, y_im);
+	FPC_MUL(y_re, y_im, r31, r63, fpr_gm_tab[94], fpr_gm_tab[95]);
+	FPC_SUB(r31, r63, r30, r62, y_re, y_im);
+	FPC_ADD(r30, r62, r30, r62, y_re, y_im);
+
+	f[0] = r0;
+	f[1] = r1;
+	f[2] = r2;
+	f[3] = r3;
+	f[4] = r4;
+	f[5] = r5;
+	f[6] = r6;
+	f[7] = r7;
+	f[8] = r8;
+	f[9] = r9;
+	f[10] = r10;
+	f[11] = r11;
+	f[12] = r12;
+	f[13] = r13;
+	f[14] = r14;
+	f[15] = r15;
+	f[16] = r16;
+	f[17] = r17;
+	f[18] = r18;
+	f[19] = r19;
+	f[20] = r20;
+	f[21] = r21;
+	f[22] = r22;
+	f[23] = r23;
+	f[24] = r24;
+	f[25] = r25;
+	f[26] = r26;
+	f[27] = r27;
+	f[28] = r28;
+	f[29] = r29;
+	f[30] = r30;
+	f[31] = r31;
+	f[32] = r32;
+	f[33] = r33;
+	f[34] = r34;
+	f[35] = r35;
+	f[36] = r36;
+	f[37] = r37;
+	f[38] = r38;
+	f[39] = r39;
+	f[40] = r40;
+	f[41] = r41;
+	f[42] = r42;
+	f[43] = r43;
+	f[44] = r44;
+	f[45] = r45;
+	f[46] = r46;
+	f[47] = r47;
+	f[48] = r48;
+	f[49] = r49;
+	f[50] = r50;
+	f[51] = r51;
+	f[52] = r52;
+	f[53] = r53;
+	f[54] = r54;
+	f[55] = r55;
+	f[56] = r56;
+	f[57] = r57;
+	f[58] = r58;
+	f[59] = r59;
+	f[60] = r60;
+	f[61] = r61;
+	f[62] = r62;
+	f[63] = r63;
+}
+
+static void
+ifft_codelet_6(fpr *f)
+{
+	fpr r0, r1, r2, r3, r4, r5, r6, r7;
+	fpr r8, r9, r10, r11, r12, r13, r14, r15;
+	fpr r16, r17, r18, r19, r20, r21, r22, r23;
+	fpr r24, r25, r26, r27, r28, r29, r30, r31;
+	fpr r32, r33, r34, r35, r36, r37, r38, r39;
+	fpr r40, r41, r42, r43, r44, r45, r46, r47;
+	fpr r48, r49, r50, r51, r52, r53, r54, r55;
+	fpr r56, r57, r58, r59, r60, r61, r62, r63;
+	fpr y_re, y_im, ni;
+
+	r0 = f[0];
+	r1 = f[1];
+	r2 = f[2];
+	r3 = f[3];
+	r4 = f[4];
+	r5 = f[5];
+	r6 = f[6];
+	r7 = f[7];
+	r8 = f[8];
+	r9 = f[9];
+	r10 = f[10];
+	r11 = f[11];
+	r12 = f[12];
+	r13 = f[13];
+	r14 = f[14];
+	r15 = f[15];
+	r16 = f[16];
+	r17 = f[17];
+	r18 = f[18];
+	r19 = f[19];
+	r20 = f[20];
+	r21 = f[21];
+	r22 = f[22];
+	r23 = f[23];
+	r24 = f[24];
+	r25 = f[25];
+	r26 = f[26];
+	r27 = f[27];
+	r28 = f[28];
+	r29 = f[29];
+	r30 = f[30];
+	r31 = f[31];
+	r32 = f[32];
+	r33 = f[33];
+	r34 = f[34];
+	r35 = f[35];
+	r36 = f[36];
+	r37 = f[37];
+	r38 = f[38];
+	r39 = f[39];
+	r40 = f[40];
+	r41 = f[41];
+	r42 = f[42];
+	r43 = f[43];
+	r44 = f[44];
+	r45 = f[45];
+	r46 = f[46];
+	r47 = f[47];
+	r48 = f[48];
+	r49 = f[49];
+	r50 = f[50];
+	r51 = f[51];
+	r52 = f[52];
+	r53 = f[53];
+	r54 = f[54];
+	r55 = f[55];
+	r56 = f[56];
+	r57 = f[57];
+	r58 = f[58];
+	r59 = f[59];
+	r60 = f[60];
+	r61 = f[61];
+	r62 = f[62];
+	r63 = f[63];
+
+	FPC_SUB(y_re, y_im, r0, r32, r1, r33);
+	FPC_ADD(r0, r32, r0, r32, r1, r33);
+	FPC_MUL(r1, r33, y_re, y_im, fpr_gm_tab[64], fpr_neg(fpr_gm_tab[65]));
+	FPC_SUB(y_re, y_im, r2, r34, r3, r35);
+	FPC_ADD(r2, r34, r2, r34, r3, r35);
+	FPC_MUL(r3, r35, y_re, y_im, fpr_gm_tab[66], fpr_neg(fpr_gm_tab[67]));
+	FPC_SUB(y_re, y_im, r4, r36, r5, r37);
+	FPC_ADD(r4, r36, r4, r36, r5, r37);
+	FPC_MUL(r5, r37, y_re, y_im, fpr_gm_tab[68], fpr_neg(fpr_gm_tab[69]));
+	FPC_SUB(y_re, y_im, r6, r38, r7, r39);
+	FPC_ADD(r6, r38, r6, r38, r7, r39);
+	FPC_MUL(r7, r39, y_re, y_im, fpr_gm_tab[70], fpr_neg(fpr_gm_tab[71]));
+	FPC_SUB(y_re, y_im, r8, r40, r9, r41);
+	FPC_ADD(r8, r40, r8, r40, r9, r41);
+	FPC_MUL(r9, r41, y_re, y_im, fpr_gm_tab[72], fpr_neg(fpr_gm_tab[73]));
+	FPC_SUB(y_re, y_im, r10, r42, r11, r43);
+	FPC_ADD(r10, r42, r10, r42, r11, r43);
+	FPC_MUL(r11, r43, y_re, y_im, fpr_gm_tab[74], fpr_neg(fpr_gm_tab[75]));
+	FPC_SUB(y_re, y_im, r12, r44, r13, r45);
+	FPC_ADD(r12, r44, r12, r44, r13, r45);
+	FPC_MUL(r13, r45, y_re, y_im, fpr_gm_tab[76], fpr_neg(fpr_gm_tab[77]));
+	FPC_SUB(y_re, y_im, r14, r46, r15, r47);
+	FPC_ADD(r14, r46, r14, r46, r15, r47);
+	FPC_MUL(r15, r47, y_re, y_im, fpr_gm_tab[78], fpr_neg(fpr_gm_tab[79]));
+	FPC_SUB(y_re, y_im, r16, r48, r17, r49);
+	FPC_ADD(r16, r48, r16, r48, r17, r49);
+	FPC_MUL(r17, r49, y_re, y_im, fpr_gm_tab[80], fpr_neg(fpr_gm_tab[81]));
+	FPC_SUB(y_re, y_im, r18, r50, r19, r51);
+	FPC_ADD(r18, r50, r18, r50, r19, r51);
+	FPC_MUL(r19, r51, y_re, y_im, fpr_gm_tab[82], fpr_neg(fpr_gm_tab[83]));
+	FPC_SUB(y_re, y_im, r20, r52, r21, r53);
+	FPC_ADD(r20, r52, r20, r52, r21, r53);
+	FPC_MUL(r21, r53, y_re, y_im, fpr_gm_tab[84], fpr_neg(fpr_gm_tab[85]));
+	FPC_SUB(y_re, y_im, r22, r54, r23, r55);
+	FPC_ADD(r22, r54, r22, r54, r23, r55);
+	FPC_MUL(r23, r55, y_re, y_im, fpr_gm_tab[86], fpr_neg(fpr_gm_tab[87]));
+	FPC_SUB(y_re, y_im, r24, r56, r25, r57);
+	FPC_ADD(r24, r56, r24, r56, r25, r57);
+	FPC_MUL(r25, r57, y_re, y_im, fpr_gm_tab[88], fpr_neg(fpr_gm_tab[89]));
+	FPC_SUB(y_re, y_im, r26, r58, r27, r59);
+	FPC_ADD(r26, r58, r26, r58, r27, r59);
+	FPC_MUL(r27, r59, y_re, y_im, fpr_gm_tab[90], fpr_neg(fpr_gm_tab[91]));
+	FPC_SUB(y_re, y_im, r28, r60, r29, r61);
+	FPC_ADD(r28, r60, r28, r60, r29, r61);
+	FPC_MUL(r29, r61, y_re, y_im, fpr_gm_tab[92], fpr_neg(fpr_gm_tab[93]));
+	FPC_SUB(y_re, y_im, r30, r62, r31, r63);
+	FPC_ADD(r30, r62, r30, r62, r31, r63);
+	FPC_MUL(r31, r63, y_re, y_im, fpr_gm_tab[94], fpr_neg(fpr_gm_tab[95]));
+
+	FPC_SUB(y_re, y_im, r0, r32, r2, r34);
+	FPC_ADD(r0, r32, r0, r32, r2, r34);
+	FPC_MUL(r2, r34, y_re, y_im, fpr_gm_tab[32], fpr_neg(fpr_gm_tab[33]));
+	FPC_SUB(y_re, y_im, r1, r33, r3, r35);
+	FPC_ADD(r1, r33, r1, r33, r3, r35);
+	FPC_MUL(r3, r35, y_re, y_im, fpr_gm_tab[32], fpr_neg(fpr_gm_tab[33]));
+	FPC_SUB(y_re, y_im, r4, r36, r6, r38);
+	FPC_ADD(r4, r36, r4, r36, r6, r38);
+	FPC_MUL(r6, r38, y_re, y_im, fpr_gm_tab[34], fpr_neg(fpr_gm_tab[35]));
+	FPC_SUB(y_re, y_im, r5, r37, r7, r39);
+	FPC_ADD(r5, r37, r5, r37, r7, r39);
+	FPC_MUL(r7, r39, y_re, y_im, fpr_gm_tab[34], fpr_neg(fpr_gm_tab[35]));
+	FPC_SUB(y_re, y_im, r8, r40, r10, r42);
+	FPC_ADD(r8, r40, r8, r40, r10, r42);
+	FPC_MUL(r10, r42, y_re, y_im, fpr_gm_tab[36], fpr_neg(fpr_gm_tab[37]));
+	FPC_SUB(y_re, y_im, r9, r41, r11, r43);
+	FPC_ADD(r9, r41, r9, r41, r11, r43);
+	FPC_MUL(r11, r43, y_re, y_im, fpr_gm_tab[36], fpr_neg(fpr_gm_tab[37]));
+	FPC_SUB(y_re, y_im, r12, r44, r14, r46);
+	FPC_ADD(r12, r44, r12, r44, r14, r46);
+	FPC_MUL(r14, r46, y_re, y_im, fpr_gm_tab[38], fpr_neg(fpr_gm_tab[39]));
+	FPC_SUB(y_re, y_im, r13, r45, r15, r47);
+	FPC_ADD(r13, r45, r13, r45, r15, r47);
+	FPC_MUL(r15, r47, y_re, y_im, fpr_gm_tab[38], fpr_neg(fpr_gm_tab[39]));
+	FPC_SUB(y_re, y_im, r16, r48, r18, r50);
+	FPC_ADD(r16, r48, r16, r48, r18, r50);
+	FPC_MUL(r18, r50, y_re, y_im, fpr_gm_tab[40], fpr_neg(fpr_gm_tab[41]));
+	FPC_SUB(y_re, y_im, r17, r49, r19, r51);
+	FPC_ADD(r17, r49, r17, r49, r19, r51);
+	FPC_MUL(r19, r51, y_re, y_im, fpr_gm_tab[40], fpr_neg(fpr_gm_tab[41]));
+	FPC_SUB(y_re, y_im, r20, r52, r22, r54);
+	FPC_ADD(r20, r52, r20, r52, r22, r54);
+	FPC_MUL(r22, r54, y_re, y_im, fpr_gm_tab[42], fpr_neg(fpr_gm_tab[43]));
+	FPC_SUB(y_re, y_im, r21, r53, r23, r55);
+	FPC_ADD(r21, r53, r21, r53, r23, r55);
+	FPC_MUL(r23, r55, y_re, y_im, fpr_gm_tab[42], fpr_neg(fpr_gm_tab[43]));
+	FPC_SUB(y_re, y_im, r24, r56, r26, r58);
+	FPC_ADD(r24, r56, r24, r56, r26, r58);
+	FPC_MUL(r26, r58, y_re, y_im, fpr_gm_tab[44], fpr_neg(fpr_gm_tab[45]));
+	FPC_SUB(y_re, y_im, r25, r57, r27, r59);
+	FPC_ADD(r25, r57, r25, r57, r27, r59);
+	FPC_MUL(r27, r59, y_re, y_im, fpr_gm_tab[44], fpr_neg(fpr_gm_tab[45]));
+	FPC_SUB(y_re, y_im, r28, r60, r30, r62);
+	FPC_ADD(r28, r60, r28, r60, r30, r62);
+	FPC_MUL(r30, r62, y_re, y_im, fpr_gm_tab[46], fpr_neg(fpr_gm_tab[47]));
+	FPC_SUB(y_re, y_im, r29, r61, r31, r63);
+	FPC_ADD(r29, r61, r29, r61, r31, r63);
+	FPC_MUL(r31, r63, y_re, y_im, fpr_gm_tab[46], fpr_neg(fpr_gm_tab[47]));
+
+	FPC_SUB(y_re, y_im, r0, r32, r4, r36);
+	FPC_ADD(r0, r32, r0, r32, r4, r36);
+	FPC_MUL(r4, r36, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r1, r33, r5, r37);
+	FPC_ADD(r1, r33, r1, r33, r5, r37);
+	FPC_MUL(r5, r37, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r2, r34, r6, r38);
+	FPC_ADD(r2, r34, r2, r34, r6, r38);
+	FPC_MUL(r6, r38, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r3, r35, r7, r39);
+	FPC_ADD(r3, r35, r3, r35, r7, r39);
+	FPC_MUL(r7, r39, y_re, y_im, fpr_gm_tab[16], fpr_neg(fpr_gm_tab[17]));
+	FPC_SUB(y_re, y_im, r8, r40, r12, r44);
+	FPC_ADD(r8, r40, r8, r40, r12, r44);
+	FPC_MUL(r12, r44, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r9, r41, r13, r45);
+	FPC_ADD(r9, r41, r9, r41, r13, r45);
+	FPC_MUL(r13, r45, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r10, r42, r14, r46);
+	FPC_ADD(r10, r42, r10, r42, r14, r46);
+	FPC_MUL(r14, r46, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r11, r43, r15, r47);
+	FPC_ADD(r11, r43, r11, r43, r15, r47);
+	FPC_MUL(r15, r47, y_re, y_im, fpr_gm_tab[18], fpr_neg(fpr_gm_tab[19]));
+	FPC_SUB(y_re, y_im, r16, r48, r20, r52);
+	FPC_ADD(r16, r48, r16, r48, r20, r52);
+	FPC_MUL(r20, r52, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r17, r49, r21, r53);
+	FPC_ADD(r17, r49, r17, r49, r21, r53);
+	FPC_MUL(r21, r53, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r18, r50, r22, r54);
+	FPC_ADD(r18, r50, r18, r50, r22, r54);
+	FPC_MUL(r22, r54, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r19, r51, r23, r55);
+	FPC_ADD(r19, r51, r19, r51, r23, r55);
+	FPC_MUL(r23, r55, y_re, y_im, fpr_gm_tab[20], fpr_neg(fpr_gm_tab[21]));
+	FPC_SUB(y_re, y_im, r24, r56, r28, r60);
+	FPC_ADD(r24, r56, r24, r56, r28, r60);
+	FPC_MUL(r28, r60, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+	FPC_SUB(y_re, y_im, r25, r57, r29, r61);
+	FPC_ADD(r25, r57, r25, r57, r29, r61);
+	FPC_MUL(r29, r61, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+	FPC_SUB(y_re, y_im, r26, r58, r30, r62);
+	FPC_ADD(r26, r58, r26, r58, r30, r62);
+	FPC_MUL(r30, r62, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+	FPC_SUB(y_re, y_im, r27, r59, r31, r63);
+	FPC_ADD(r27, r59, r27, r59, r31, r63);
+	FPC_MUL(r31, r63, y_re, y_im, fpr_gm_tab[22], fpr_neg(fpr_gm_tab[23]));
+
+	FPC_SUB(y_re, y_im, r0, r32, r8, r40);
+	FPC_ADD(r0, r32, r0, r32, r8, r40);
+	FPC_MUL(r8, r40, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r1, r33, r9, r41);
+	FPC_ADD(r1, r33, r1, r33, r9, r41);
+	FPC_MUL(r9, r41, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r2, r34, r10, r42);
+	FPC_ADD(r2, r34, r2, r34, r10, r42);
+	FPC_MUL(r10, r42, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r3, r35, r11, r43);
+	FPC_ADD(r3, r35, r3, r35, r11, r43);
+	FPC_MUL(r11, r43, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r4, r36, r12, r44);
+	FPC_ADD(r4, r36, r4, r36, r12, r44);
+	FPC_MUL(r12, r44, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r5, r37, r13, r45);
+	FPC_ADD(r5, r37, r5, r37, r13, r45);
+	FPC_MUL(r13, r45, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r6, r38, r14, r46);
+	FPC_ADD(r6, r38, r6, r38, r14, r46);
+	FPC_MUL(r14, r46, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r7, r39, r15, r47);
+	FPC_ADD(r7, r39, r7, r39, r15, r47);
+	FPC_MUL(r15, r47, y_re, y_im, fpr_gm_tab[8], fpr_neg(fpr_gm_tab[9]));
+	FPC_SUB(y_re, y_im, r16, r48, r24, r56);
+	FPC_ADD(r16, r48, r16, r48, r24, r56);
+	FPC_MUL(r24, r56, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r17, r49, r25, r57);
+	FPC_ADD(r17, r49, r17, r49, r25, r57);
+	FPC_MUL(r25, r57, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r18, r50, r26, r58);
+	FPC_ADD(r18, r50, r18, r50, r26, r58);
+	FPC_MUL(r26, r58, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r19, r51, r27, r59);
+	FPC_ADD(r19, r51, r19, r51, r27, r59);
+	FPC_MUL(r27, r59, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r20, r52, r28, r60);
+	FPC_ADD(r20, r52, r20, r52, r28, r60);
+	FPC_MUL(r28, r60, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r21, r53, r29, r61);
+	FPC_ADD(r21, r53, r21, r53, r29, r61);
+	FPC_MUL(r29, r61, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r22, r54, r30, r62);
+	FPC_ADD(r22, r54, r22, r54, r30, r62);
+	FPC_MUL(r30, r62, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+	FPC_SUB(y_re, y_im, r23, r55, r31, r63);
+	FPC_ADD(r23, r55, r23, r55, r31, r63);
+	FPC_MUL(r31, r63, y_re, y_im, fpr_gm_tab[10], fpr_neg(fpr_gm_tab[11]));
+
+	FPC_SUB(y_re, y_im, r0, r32, r16, r48);
+	FPC_ADD(r0, r32, r0, r32, r16, r48);
+	FPC_MUL(r16, r48, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r1, r33, r17, r49);
+	FPC_ADD(r1, r33, r1, r33, r17, r49);
+	FPC_MUL(r17, r49, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r2, r34, r18, r50);
+	FPC_ADD(r2, r34, r2, r34, r18, r50);
+	FPC_MUL(r18, r50, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r3, r35, r19, r51);
+	FPC_ADD(r3, r35, r3, r35, r19, r51);
+	FPC_MUL(r19, r51, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r4, r36, r20, r52);
+	FPC_ADD(r4, r36, r4, r36, r20, r52);
+	FPC_MUL(r20, r52, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r5, r37, r21, r53);
+	FPC_ADD(r5, r37, r5, r37, r21, r53);
+	FPC_MUL(r21, r53, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r6, r38, r22, r54);
+	FPC_ADD(r6, r38, r6, r38, r22, r54);
+	FPC_MUL(r22, r54, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r7, r39, r23, r55);
+	FPC_ADD(r7, r39, r7, r39, r23, r55);
+	FPC_MUL(r23, r55, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r8, r40, r24, r56);
+	FPC_ADD(r8, r40, r8, r40, r24, r56);
+	FPC_MUL(r24, r56, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r9, r41, r25, r57);
+	FPC_ADD(r9, r41, r9, r41, r25, r57);
+	FPC_MUL(r25, r57, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r10, r42, r26, r58);
+	FPC_ADD(r10, r42, r10, r42, r26, r58);
+	FPC_MUL(r26, r58, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r11, r43, r27, r59);
+	FPC_ADD(r11, r43, r11, r43, r27, r59);
+	FPC_MUL(r27, r59, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r12, r44, r28, r60);
+	FPC_ADD(r12, r44, r12, r44, r28, r60);
+	FPC_MUL(r28, r60, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r13, r45, r29, r61);
+	FPC_ADD(r13, r45, r13, r45, r29, r61);
+	FPC_MUL(r29, r61, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r14, r46, r30, r62);
+	FPC_ADD(r14, r46, r14, r46, r30, r62);
+	FPC_MUL(r30, r62, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+	FPC_SUB(y_re, y_im, r15, r47, r31, r63);
+	FPC_ADD(r15, r47, r15, r47, r31, r63);
+	FPC_MUL(r31, r63, y_re, y_im, fpr_gm_tab[4], fpr_neg(fpr_gm_tab[5]));
+
+	ni = fpr_scaled(2, -6);
+	f[0] = fpr_mul(r0, ni);
+	f[1] = fpr_mul(r1, ni);
+	f[2] = fpr_mul(r2, ni);
+	f[3] = fpr_mul(r3, ni);
+	f[4] = fpr_mul(r4, ni);
+	f[5] = fpr_mul(r5, ni);
+	f[6] = fpr_mul(r6, ni);
+	f[7] = fpr_mul(r7, ni);
+	f[8] = fpr_mul(r8, ni);
+	f[9] = fpr_mul(r9, ni);
+	f[10] = fpr_mul(r10, ni);
+	f[11] = fpr_mul(r11, ni);
+	f[12] = fpr_mul(r12, ni);
+	f[13] = fpr_mul(r13, ni);
+	f[14] = fpr_mul(r14, ni);
+	f[15] = fpr_mul(r15, ni);
+	f[16] = fpr_mul(r16, ni);
+	f[17] = fpr_mul(r17, ni);
+	f[18] = fpr_mul(r18, ni);
+	f[19] = fpr_mul(r19, ni);
+	f[20] = fpr_mul(r20, ni);
+	f[21] = fpr_mul(r21, ni);
+	f[22] = fpr_mul(r22, ni);
+	f[23] = fpr_mul(r23, ni);
+	f[24] = fpr_mul(r24, ni);
+	f[25] = fpr_mul(r25, ni);
+	f[26] = fpr_mul(r26, ni);
+	f[27] = fpr_mul(r27, ni);
+	f[28] = fpr_mul(r28, ni);
+	f[29] = fpr_mul(r29, ni);
+	f[30] = fpr_mul(r30, ni);
+	f[31] = fpr_mul(r31, ni);
+	f[32] = fpr_mul(r32, ni);
+	f[33] = fpr_mul(r33, ni);
+	f[34] = fpr_mul(r34, ni);
+	f[35] = fpr_mul(r35, ni);
+	f[36] = fpr_mul(r36, ni);
+	f[37] = fpr_mul(r37, ni);
+	f[38] = fpr_mul(r38, ni);
+	f[39] = fpr_mul(r39, ni);
+	f[40] = fpr_mul(r40, ni);
+	f[41] = fpr_mul(r41, ni);
+	f[42] = fpr_mul(r42, ni);
+	f[43] = fpr_mul(r43, ni);
+	f[44] = fpr_mul(r44, ni);
+	f[45] = fpr_mul(r45, ni);
+	f[46] = fpr_mul(r46, ni);
+	f[47] = fpr_mul(r47, ni);
+	f[48] = fpr_mul(r48, ni);
+	f[49] = fpr_mul(r49, ni);
+	f[50] = fpr_mul(r50, ni);
+	f[51] = fpr_mul(r51, ni);
+	f[52] = fpr_mul(r52, ni);
+	f[53] = fpr_mul(r53, ni);
+	f[54] = fpr_mul(r54, ni);
+	f[55] = fpr_mul(r55, ni);
+	f[56] = fpr_mul(r56, ni);
+	f[57] = fpr_mul(r57, ni);
+	f[58] = fpr_mul(r58, ni);
+	f[59] = fpr_mul(r59, ni);
+	f[60] = fpr_mul(r60, ni);
+	f[61] = fpr_mul(r61, ni);
+	f[62] = fpr_mul(r62, ni);
+	f[63] = fpr_mul(r63, ni);
+}
+
+static void
+split_codelet_6(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f)
+{
+	fpr t_re, t_im;
+
+	FPC_ADD(t_re, t_im, f[0], f[32], f[1], f[33]);
+	f0[0] = fpr_half(t_re);
+	f0[16] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[0], f[32], f[1], f[33]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[64], fpr_neg(fpr_gm_tab[65]));
+	f1[0] = fpr_half(t_re);
+	f1[16] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[2], f[34], f[3], f[35]);
+	f0[1] = fpr_half(t_re);
+	f0[17] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[2], f[34], f[3], f[35]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[66], fpr_neg(fpr_gm_tab[67]));
+	f1[1] = fpr_half(t_re);
+	f1[17] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[4], f[36], f[5], f[37]);
+	f0[2] = fpr_half(t_re);
+	f0[18] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[4], f[36], f[5], f[37]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[68], fpr_neg(fpr_gm_tab[69]));
+	f1[2] = fpr_half(t_re);
+	f1[18] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[6], f[38], f[7], f[39]);
+	f0[3] = fpr_half(t_re);
+	f0[19] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[6], f[38], f[7], f[39]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[70], fpr_neg(fpr_gm_tab[71]));
+	f1[3] = fpr_half(t_re);
+	f1[19] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[8], f[40], f[9], f[41]);
+	f0[4] = fpr_half(t_re);
+	f0[20] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[8], f[40], f[9], f[41]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[72], fpr_neg(fpr_gm_tab[73]));
+	f1[4] = fpr_half(t_re);
+	f1[20] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[10], f[42], f[11], f[43]);
+	f0[5] = fpr_half(t_re);
+	f0[21] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[10], f[42], f[11], f[43]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[74], fpr_neg(fpr_gm_tab[75]));
+	f1[5] = fpr_half(t_re);
+	f1[21] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[12], f[44], f[13], f[45]);
+	f0[6] = fpr_half(t_re);
+	f0[22] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[12], f[44], f[13], f[45]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[76], fpr_neg(fpr_gm_tab[77]));
+	f1[6] = fpr_half(t_re);
+	f1[22] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[14], f[46], f[15], f[47]);
+	f0[7] = fpr_half(t_re);
+	f0[23] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[14], f[46], f[15], f[47]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[78], fpr_neg(fpr_gm_tab[79]));
+	f1[7] = fpr_half(t_re);
+	f1[23] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[16], f[48], f[17], f[49]);
+	f0[8] = fpr_half(t_re);
+	f0[24] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[16], f[48], f[17], f[49]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[80], fpr_neg(fpr_gm_tab[81]));
+	f1[8] = fpr_half(t_re);
+	f1[24] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[18], f[50], f[19], f[51]);
+	f0[9] = fpr_half(t_re);
+	f0[25] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[18], f[50], f[19], f[51]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[82], fpr_neg(fpr_gm_tab[83]));
+	f1[9] = fpr_half(t_re);
+	f1[25] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[20], f[52], f[21], f[53]);
+	f0[10] = fpr_half(t_re);
+	f0[26] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[20], f[52], f[21], f[53]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[84], fpr_neg(fpr_gm_tab[85]));
+	f1[10] = fpr_half(t_re);
+	f1[26] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[22], f[54], f[23], f[55]);
+	f0[11] = fpr_half(t_re);
+	f0[27] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[22], f[54], f[23], f[55]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[86], fpr_neg(fpr_gm_tab[87]));
+	f1[11] = fpr_half(t_re);
+	f1[27] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[24], f[56], f[25], f[57]);
+	f0[12] = fpr_half(t_re);
+	f0[28] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[24], f[56], f[25], f[57]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[88], fpr_neg(fpr_gm_tab[89]));
+	f1[12] = fpr_half(t_re);
+	f1[28] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[26], f[58], f[27], f[59]);
+	f0[13] = fpr_half(t_re);
+	f0[29] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[26], f[58], f[27], f[59]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[90], fpr_neg(fpr_gm_tab[91]));
+	f1[13] = fpr_half(t_re);
+	f1[29] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[28], f[60], f[29], f[61]);
+	f0[14] = fpr_half(t_re);
+	f0[30] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[28], f[60], f[29], f[61]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[92], fpr_neg(fpr_gm_tab[93]));
+	f1[14] = fpr_half(t_re);
+	f1[30] = fpr_half(t_im);
+
+	FPC_ADD(t_re, t_im, f[30], f[62], f[31], f[63]);
+	f0[15] = fpr_half(t_re);
+	f0[31] = fpr_half(t_im);
+	FPC_SUB(t_re, t_im, f[30], f[62], f[31], f[63]);
+	FPC_MUL(t_re, t_im, t_re, t_im, fpr_gm_tab[94], fpr_neg(fpr_gm_tab[95]));
+	f1[15] = fpr_half(t_re);
+	f1[31] = fpr_half(t_im);
+}
+
+static void
+merge_codelet_6(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1)
+{
+	fpr b_re, b_im;
+
+	FPC_MUL(b_re, b_im, f1[0], f1[16], fpr_gm_tab[64], fpr_gm_tab[65]);
+	FPC_ADD(f[0], f[32], f0[0], f0[16], b_re, b_im);
+	FPC_SUB(f[1], f[33], f0[0], f0[16], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[1], f1[17], fpr_gm_tab[66], fpr_gm_tab[67]);
+	FPC_ADD(f[2], f[34], f0[1], f0[17], b_re, b_im);
+	FPC_SUB(f[3], f[35], f0[1], f0[17], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[2], f1[18], fpr_gm_tab[68], fpr_gm_tab[69]);
+	FPC_ADD(f[4], f[36], f0[2], f0[18], b_re, b_im);
+	FPC_SUB(f[5], f[37], f0[2], f0[18], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[3], f1[19], fpr_gm_tab[70], fpr_gm_tab[71]);
+	FPC_ADD(f[6], f[38], f0[3], f0[19], b_re, b_im);
+	FPC_SUB(f[7], f[39], f0[3], f0[19], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[4], f1[20], fpr_gm_tab[72], fpr_gm_tab[73]);
+	FPC_ADD(f[8], f[40], f0[4], f0[20], b_re, b_im);
+	FPC_SUB(f[9], f[41], f0[4], f0[20], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[5], f1[21], fpr_gm_tab[74], fpr_gm_tab[75]);
+	FPC_ADD(f[10], f[42], f0[5], f0[21], b_re, b_im);
+	FPC_SUB(f[11], f[43], f0[5], f0[21], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[6], f1[22], fpr_gm_tab[76], fpr_gm_tab[77]);
+	FPC_ADD(f[12], f[44], f0[6], f0[22], b_re, b_im);
+	FPC_SUB(f[13], f[45], f0[6], f0[22], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[7], f1[23], fpr_gm_tab[78], fpr_gm_tab[79]);
+	FPC_ADD(f[14], f[46], f0[7], f0[23], b_re, b_im);
+	FPC_SUB(f[15], f[47], f0[7], f0[23], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[8], f1[24], fpr_gm_tab[80], fpr_gm_tab[81]);
+	FPC_ADD(f[16], f[48], f0[8], f0[24], b_re, b_im);
+	FPC_SUB(f[17], f[49], f0[8], f0[24], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[9], f1[25], fpr_gm_tab[82], fpr_gm_tab[83]);
+	FPC_ADD(f[18], f[50], f0[9], f0[25], b_re, b_im);
+	FPC_SUB(f[19], f[51], f0[9], f0[25], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[10], f1[26], fpr_gm_tab[84], fpr_gm_tab[85]);
+	FPC_ADD(f[20], f[52], f0[10], f0[26], b_re, b_im);
+	FPC_SUB(f[21], f[53], f0[10], f0[26], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[11], f1[27], fpr_gm_tab[86], fpr_gm_tab[87]);
+	FPC_ADD(f[22], f[54], f0[11], f0[27], b_re, b_im);
+	FPC_SUB(f[23], f[55], f0[11], f0[27], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[12], f1[28], fpr_gm_tab[88], fpr_gm_tab[89]);
+	FPC_ADD(f[24], f[56], f0[12], f0[28], b_re, b_im);
+	FPC_SUB(f[25], f[57], f0[12], f0[28], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[13], f1[29], fpr_gm_tab[90], fpr_gm_tab[91]);
+	FPC_ADD(f[26], f[58], f0[13], f0[29], b_re, b_im);
+	FPC_SUB(f[27], f[59], f0[13], f0[29], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[14], f1[30], fpr_gm_tab[92], fpr_gm_tab[93]);
+	FPC_ADD(f[28], f[60], f0[14], f0[30], b_re, b_im);
+	FPC_SUB(f[29], f[61], f0[14], f0[30], b_re, b_im);
+
+	FPC_MUL(b_re, b_im, f1[15], f1[31], fpr_gm_tab[94], fpr_gm_tab[95]);
+	FPC_ADD(f[30], f[62], f0[15], f0[31], b_re, b_im);
+	FPC_SUB(f[31], f[63], f0[15], f0[31], b_re, b_im);
+}
+
+static void (*const fft_codelet[])(
+	fpr *) = {
+	0,
+	fft_codelet_1,
+	fft_codelet_2,
+	fft_codelet_3,
+	fft_codelet_4,
+	fft_codelet_5,
+	fft_codelet_6
+};
+
+static void (*const ifft_codelet[])(
+	fpr *) = {
+	0,
+	ifft_codelet_1,
+	ifft_codelet_2,
+	ifft_codelet_3,
+	ifft_codelet_4,
+	ifft_codelet_5,
+	ifft_codelet_6
+};
+
+static void (*const split_codelet[])(
+	fpr *restrict, fpr *restrict, const fpr *restrict) = {
+	0,
+	split_codelet_1,
+	split_codelet_2,
+	split_codelet_3,
+	split_codelet_4,
+	split_codelet_5,
+	split_codelet_6
+};
+
+static void (*const merge_codelet[])(
+	fpr *restrict, const fpr *restrict, const fpr *restrict) = {
+	0,
+	merge_codelet_1,
+	merge_codelet_2,
+	merge_codelet_3,
+	merge_codelet_4,
+	merge_codelet_5,
+	merge_codelet_6
+};
+
@@ -31,6 +31,10 @@
 
 #include "internal.h"
 
+#if FALCON_KERNELS_X86
+#include <immintrin.h>
+#endif
+
 /*
  * Load the table of constants for FFT.
  */
@@ -38,6 +42,10 @@
 #include FPR_IMPL
 #undef FPC
 
+/* see internal.h */
+const fpr *const falcon_gm_tab = fpr_gm_tab;
+const fpr *const falcon_gm3_square = fpr_gm3_square;
+
 /*
  * Rules for complex number macros:
  * --------------------------------
@@ -147,6 +155,14 @@
 		(d_im) = fpct_d_im; \
 	} while (0)
 
+/*
+ * Straight-line FFT, iFFT, split and merge for small degrees (up to
+ * 2^FFT_CODELET_MAX), generated by gen-codelets.c. The dispatched
+ * entry points below use them; they are bit-for-bit identical to the
+ * generic code.
+ */
+#include "falcon-fft-codelets.h"
+
 /*
  * Let w = exp(i*pi/N); w is a primitive 2N-th root of 1. We define the
  * values w_j = w^(2j+1) for all j from 0 to N-1: these are the roots
@@ -173,7 +189,7 @@
 
 /* see internal.h */
 void
-falcon_FFT(fpr *f, unsigned logn)
+falcon_FFT_ref(fpr *f, unsigned logn)
 {
 	/*
 	 * FFT algorithm in bit-reversal order uses the following
@@ -253,7 +269,7 @@ falcon_FFT(fpr *f, unsigned logn)
 
 /* see internal.h */
 void
-falcon_iFFT(fpr *f, unsigned logn)
+falcon_iFFT_ref(fpr *f, unsigned logn)
 {
 	/*
 	 * Inverse FFT algorithm in bit-reversal order uses the following
@@ -347,6 +363,231 @@ falcon_iFFT(fpr *f, unsigned logn)
 	}
 }
 
+/* see internal.h */
+void
+falcon_FFT_radix4(fpr *f, unsigned logn)
+{
+	/*
+	 * Same butterflies as falcon_FFT_ref(), two levels per pass over
+	 * the data. A block of size t at level m (twiddle GM[m + i1])
+	 * splits at the next level into two blocks of size t/2 (twiddles
+	 * GM[2m + 2i1] and GM[2m + 2i1 + 1]); with qt = t/4, the four
+	 * values j, j+qt, j+t/2 and j+t/2+qt only interact with each
+	 * other over both levels, so they are loaded once, go through
+	 * four butterflies, and are stored once. A last single level is
+	 * done when the number of levels is odd.
+	 *
+	 * The operations and their operands are exactly those of the
+	 * reference code, so the output is bit-for-bit identical (which
+	 * the kernel dispatch and the interchangeability of expanded keys
+	 * rely on); only the memory traffic is halved.
+	 */
+	unsigned u;
+	size_t t, n, hn, m;
+
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	t = hn;
+	for (u = 1, m = 2; u + 1 < logn; u += 2, m <<= 2) {
+		size_t ht, qt, hm, i1, j1;
+
+		ht = t >> 1;
+		qt = ht >> 1;
+		hm = m >> 1;
+		for (i1 = 0, j1 = 0; i1 < hm; i1 ++, j1 += t) {
+			size_t j, k;
+			fpr s_re, s_im, s0_re, s0_im, s1_re, s1_im;
+
+			s_re = fpr_gm_tab[((m + i1) << 1) + 0];
+			s_im = fpr_gm_tab[((m + i1) << 1) + 1];
+			k = ((m + i1) << 1) << 1;
+			s0_re = fpr_gm_tab[k + 0];
+			s0_im = fpr_gm_tab[k + 1];
+			s1_re = fpr_gm_tab[k + 2];
+			s1_im = fpr_gm_tab[k + 3];
+			for (j = j1; j < j1 + qt; j ++) {
+				fpr a_re, a_im, b_re, b_im;
+				fpr c_re, c_im, d_re, d_im;
+				fpr y_re, y_im;
+
+				a_re = f[j];
+				a_im = f[j + hn];
+				b_re = f[j + qt];
+				b_im = f[j + qt + hn];
+				c_re = f[j + ht];
+				c_im = f[j + ht + hn];
+				d_re = f[j + ht + qt];
+				d_im = f[j + ht + qt + hn];
+
+				FPC_MUL(y_re, y_im, c_re, c_im, s_re, s_im);
+				FPC_SUB(c_re, c_im, a_re, a_im, y_re, y_im);
+				FPC_ADD(a_re, a_im, a_re, a_im, y_re, y_im);
+				FPC_MUL(y_re, y_im, d_re, d_im, s_re, s_im);
+				FPC_SUB(d_re, d_im, b_re, b_im, y_re, y_im);
+				FPC_ADD(b_re, b_im, b_re, b_im, y_re, y_im);
+
+				FPC_MUL(y_re, y_im, b_re, b_im, s0_re, s0_im);
+				FPC_SUB(b_re, b_im, a_re, a_im, y_re, y_im);
+				FPC_ADD(a_re, a_im, a_re, a_im, y_re, y_im);
+				FPC_MUL(y_re, y_im, d_re, d_im, s1_re, s1_im);
+				FPC_SUB(d_re, d_im, c_re, c_im, y_re, y_im);
+				FPC_ADD(c_re, c_im, c_re, c_im, y_re, y_im);
+
+				f[j] = a_re;
+				f[j + hn] = a_im;
+				f[j + qt] = b_re;
+				f[j + qt + hn] = b_im;
+				f[j + ht] = c_re;
+				f[j + ht + hn] = c_im;
+				f[j + ht + qt] = d_re;
+				f[j + ht + qt + hn] = d_im;
+			}
+		}
+		t = qt;
+	}
+	if (u < logn) {
+		size_t ht, hm, i1, j1;
+
+		ht = t >> 1;
+		hm = m >> 1;
+		for (i1 = 0, j1 = 0; i1 < hm; i1 ++, j1 += t) {
+			size_t j;
+			fpr s_re, s_im;
+
+			s_re = fpr_gm_tab[((m + i1) << 1) + 0];
+			s_im = fpr_gm_tab[((m + i1) << 1) + 1];
+			for (j = j1; j < j1 + ht; j ++) {
+				fpr x_re, x_im, y_re, y_im;
+
+				x_re = f[j];
+				x_im = f[j + hn];
+				y_re = f[j + ht];
+				y_im = f[j + ht + hn];
+				FPC_MUL(y_re, y_im, y_re, y_im, s_re, s_im);
+				FPC_ADD(f[j], f[j + hn],
+					x_re, x_im, y_re, y_im);
+				FPC_SUB(f[j + ht], f[j + ht + hn],
+					x_re, x_im, y_re, y_im);
+			}
+		}
+	}
+}
+
+/* see internal.h */
+void
+falcon_iFFT_radix4(fpr *f, unsigned logn)
+{
+	/*
+	 * Same butterflies as falcon_iFFT_ref(), two levels per pass
+	 * (see falcon_FFT_radix4()). Going up, two adjacent blocks of
+	 * size 2t at level m (twiddles iGM[m/2 + 2i1] and
+	 * iGM[m/2 + 2i1 + 1]) make one block of size 4t at the next level
+	 * (twiddle iGM[m/4 + i1]); values j, j+t, j+2t and j+3t go
+	 * through both levels together. The final scaling by 2/N stays a
+	 * separate pass, as in the reference code.
+	 */
+	size_t u, n, hn, t, m;
+
+	n = (size_t)1 << logn;
+	t = 1;
+	m = n;
+	hn = n >> 1;
+	for (u = logn; u > 2; u -= 2) {
+		size_t hm, qm, dt, ft, i1, j1;
+
+		hm = m >> 1;
+		qm = hm >> 1;
+		dt = t << 1;
+		ft = t << 2;
+		for (i1 = 0, j1 = 0; j1 < hn; i1 ++, j1 += ft) {
+			size_t j, k;
+			fpr s0_re, s0_im, s1_re, s1_im, s_re, s_im;
+
+			k = ((hm + (i1 << 1)) << 1);
+			s0_re = fpr_gm_tab[k + 0];
+			s0_im = fpr_neg(fpr_gm_tab[k + 1]);
+			s1_re = fpr_gm_tab[k + 2];
+			s1_im = fpr_neg(fpr_gm_tab[k + 3]);
+			s_re = fpr_gm_tab[((qm + i1) << 1) + 0];
+			s_im = fpr_neg(fpr_gm_tab[((qm + i1) << 1) + 1]);
+			for (j = j1; j < j1 + t; j ++) {
+				fpr a_re, a_im, b_re, b_im;
+				fpr c_re, c_im, d_re, d_im;
+				fpr y_re, y_im;
+
+				a_re = f[j];
+				a_im = f[j + hn];
+				b_re = f[j + t];
+				b_im = f[j + t + hn];
+				c_re = f[j + dt];
+				c_im = f[j + dt + hn];
+				d_re = f[j + dt + t];
+				d_im = f[j + dt + t + hn];
+
+				FPC_SUB(y_re, y_im, a_re, a_im, b_re, b_im);
+				FPC_ADD(a_re, a_im, a_re, a_im, b_re, b_im);
+				FPC_MUL(b_re, b_im, y_re, y_im, s0_re, s0_im);
+				FPC_SUB(y_re, y_im, c_re, c_im, d_re, d_im);
+				FPC_ADD(c_re, c_im, c_re, c_im, d_re, d_im);
+				FPC_MUL(d_re, d_im, y_re, y_im, s1_re, s1_im);
+
+				FPC_SUB(y_re, y_im, a_re, a_im, c_re, c_im);
+				FPC_ADD(a_re, a_im, a_re, a_im, c_re, c_im);
+				FPC_MUL(c_re, c_im, y_re, y_im, s_re, s_im);
+				FPC_SUB(y_re, y_im, b_re, b_im, d_re, d_im);
+				FPC_ADD(b_re, b_im, b_re, b_im, d_re, d_im);
+				FPC_MUL(d_re, d_im, y_re, y_im, s_re, s_im);
+
+				f[j] = a_re;
+				f[j + hn] = a_im;
+				f[j + t] = b_re;
+				f[j + t + hn] = b_im;
+				f[j + dt] = c_re;
+				f[j + dt + hn] = c_im;
+				f[j + dt + t] = d_re;
+				f[j + dt + t + hn] = d_im;
+			}
+		}
+		t = ft;
+		m = qm;
+	}
+	if (u > 1) {
+		size_t hm, dt, i1, j1;
+
+		hm = m >> 1;
+		dt = t << 1;
+		for (i1 = 0, j1 = 0; j1 < hn; i1 ++, j1 += dt) {
+			size_t j;
+			fpr s_re, s_im;
+
+			s_re = fpr_gm_tab[((hm + i1) << 1) + 0];
+			s_im = fpr_neg(fpr_gm_tab[((hm + i1) << 1) + 1]);
+			for (j = j1; j < j1 + t; j ++) {
+				fpr x_re, x_im, y_re, y_im;
+
+				x_re = f[j];
+				x_im = f[j + hn];
+				y_re = f[j + t];
+				y_im = f[j + t + hn];
+				FPC_ADD(f[j], f[j + hn],
+					x_re, x_im, y_re, y_im);
+				FPC_SUB(x_re, x_im, x_re, x_im, y_re, y_im);
+				FPC_MUL(f[j + t], f[j + t + hn],
+					x_re, x_im, s_re, s_im);
+			}
+		}
+	}
+
+	if (logn > 0) {
+		fpr ni;
+
+		ni = fpr_scaled(2, -(int)logn);
+		for (u = 0; u < n; u ++) {
+			f[u] = fpr_mul(f[u], ni);
+		}
+	}
+}
+
 /* see internal.h */
 void
 falcon_poly_add(fpr *restrict a, const fpr *restrict b, unsigned logn)
@@ -435,7 +676,7 @@ falcon_poly_adj_fft(fpr *a, unsigned logn)
 
 /* see internal.h */
 void
-falcon_poly_mul_fft(fpr *restrict a, const fpr *restrict b, unsigned logn)
+falcon_poly_mul_fft_ref(fpr *restrict a, const fpr *restrict b, unsigned logn)
 {
 	size_t n, hn, u;
 
@@ -471,7 +712,8 @@ falcon_poly_sqr_fft(fpr *a, unsigned logn)
 
 /* see internal.h */
 void
-falcon_poly_muladj_fft(fpr *restrict a, const fpr *restrict b, unsigned logn)
+falcon_poly_muladj_fft_ref(fpr *restrict a,
+	const fpr *restrict b, unsigned logn)
 {
 	size_t n, hn, u;
 
@@ -488,6 +730,319 @@ falcon_poly_muladj_fft(fpr *restrict a, const fpr *restrict b, unsigned logn)
 	}
 }
 
+/*
+ * Dispatched entry points; falcon_kernels (see falcon-cpu.c) holds
+ * either the reference code above or one of the variants below. Small
+ * transforms go to the codelets instead.
+ */
+
+/* see internal.h */
+void
+falcon_FFT(fpr *f, unsigned logn)
+{
+	if (logn >= 1 && logn <= FFT_CODELET_MAX) {
+		fft_codelet[logn](f);
+		return;
+	}
+	falcon_kernels.fft(f, logn);
+}
+
+/* see internal.h */
+void
+falcon_iFFT(fpr *f, unsigned logn)
+{
+	if (logn >= 1 && logn <= FFT_CODELET_MAX) {
+		ifft_codelet[logn](f);
+		return;
+	}
+	falcon_kernels.ifft(f, logn);
+}
+
+/* see internal.h */
+void
+falcon_poly_mul_fft(fpr *restrict a, const fpr *restrict b, unsigned logn)
+{
+	falcon_kernels.poly_mul_fft(a, b, logn);
+}
+
+/* see internal.h */
+void
+falcon_poly_muladj_fft(fpr *restrict a, const fpr *restrict b, unsigned logn)
+{
+	falcon_kernels.poly_muladj_fft(a, b, logn);
+}
+
+#if FALCON_KERNELS_X86
+
+/*
+ * AVX variants. They process four coefficients at a time wherever the
+ * inner loops are long enough, and fall back to scalar code for the
+ * short ones (last FFT layers, degrees below 8). They perform exactly
+ * the same IEEE-754 operations in the same order as the reference
+ * code (no FMA contraction), so results are bit-for-bit identical;
+ * the dispatcher self-test relies on that.
+ */
+
+/*
+ * Complex multiplication d = a * b on four lanes.
+ */
+#define FPC_MUL_AVX(d_re, d_im, a_re, a_im, b_re, b_im)   do { \
+		__m256d fpct_t_re, fpct_t_im; \
+		fpct_t_re = _mm256_sub_pd( \
+			_mm256_mul_pd(a_re, b_re), \
+			_mm256_mul_pd(a_im, b_im)); \
+		fpct_t_im = _mm256_add_pd( \
+			_mm256_mul_pd(a_re, b_im), \
+			_mm256_mul_pd(a_im, b_re)); \
+		(d_re) = fpct_t_re; \
+		(d_im) = fpct_t_im; \
+	} while (0)
+
+/* see internal.h */
+__attribute__((target("avx")))
+void
+falcon_FFT_avx(fpr *f, unsigned logn)
+{
+	unsigned u;
+	size_t t, n, hn, m;
+	double *d;
+
+	d = (double *)f;
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	t = hn;
+	for (u = 1, m = 2; u < logn; u ++, m <<= 1) {
+		size_t ht, hm, i1, j1;
+
+		ht = t >> 1;
+		hm = m >> 1;
+		for (i1 = 0, j1 = 0; i1 < hm; i1 ++, j1 += t) {
+			size_t j, j2;
+			fpr s_re, s_im;
+
+			s_re = fpr_gm_tab[((m + i1) << 1) + 0];
+			s_im = fpr_gm_tab[((m + i1) << 1) + 1];
+			j2 = j1 + ht;
+			if (ht >= 4) {
+				__m256d vs_re, vs_im;
+
+				vs_re = _mm256_set1_pd(s_re.v);
+				vs_im = _mm256_set1_pd(s_im.v);
+				for (j = j1; j < j2; j += 4) {
+					__m256d x_re, x_im, y_re, y_im;
+
+					x_re = _mm256_loadu_pd(d + j);
+					x_im = _mm256_loadu_pd(d + j + hn);
+					y_re = _mm256_loadu_pd(d + j + ht);
+					y_im = _mm256_loadu_pd(d + j + ht + hn);
+					FPC_MUL_AVX(y_re, y_im,
+						y_re, y_im, vs_re, vs_im);
+					_mm256_storeu_pd(d + j,
+						_mm256_add_pd(x_re, y_re));
+					_mm256_storeu_pd(d + j + hn,
+						_mm256_add_pd(x_im, y_im));
+					_mm256_storeu_pd(d + j + ht,
+						_mm256_sub_pd(x_re, y_re));
+					_mm256_storeu_pd(d + j + ht + hn,
+						_mm256_sub_pd(x_im, y_im));
+				}
+			} else {
+				for (j = j1; j < j2; j ++) {
+					fpr x_re, x_im, y_re, y_im;
+
+					x_re = f[j];
+					x_im = f[j + hn];
+					y_re = f[j + ht];
+					y_im = f[j + ht + hn];
+					FPC_MUL(y_re, y_im,
+						y_re, y_im, s_re, s_im);
+					FPC_ADD(f[j], f[j + hn],
+						x_re, x_im, y_re, y_im);
+					FPC_SUB(f[j + ht], f[j + ht + hn],
+						x_re, x_im, y_re, y_im);
+				}
+			}
+		}
+		t = ht;
+	}
+	_mm256_zeroupper();
+}
+
+/* see internal.h */
+__attribute__((target("avx")))
+void
+falcon_iFFT_avx(fpr *f, unsigned logn)
+{
+	size_t u, n, hn, t, m;
+	double *d;
+
+	d = (double *)f;
+	n = (size_t)1 << logn;
+	t = 1;
+	m = n;
+	hn = n >> 1;
+	for (u = logn; u > 1; u --) {
+		size_t hm, dt, i1, j1;
+
+		hm = m >> 1;
+		dt = t << 1;
+		for (i1 = 0, j1 = 0; j1 < hn; i1 ++, j1 += dt) {
+			size_t j, j2;
+			fpr s_re, s_im;
+
+			j2 = j1 + t;
+			s_re = fpr_gm_tab[((hm + i1) << 1) + 0];
+			s_im = fpr_neg(fpr_gm_tab[((hm + i1) << 1) + 1]);
+			if (t >= 4) {
+				__m256d vs_re, vs_im;
+
+				vs_re = _mm256_set1_pd(s_re.v);
+				vs_im = _mm256_set1_pd(s_im.v);
+				for (j = j1; j < j2; j += 4) {
+					__m256d x_re, x_im, y_re, y_im;
+
+					x_re = _mm256_loadu_pd(d + j);
+					x_im = _mm256_loadu_pd(d + j + hn);
+					y_re = _mm256_loadu_pd(d + j + t);
+					y_im = _mm256_loadu_pd(d + j + t + hn);
+					_mm256_storeu_pd(d + j,
+						_mm256_add_pd(x_re, y_re));
+					_mm256_storeu_pd(d + j + hn,
+						_mm256_add_pd(x_im, y_im));
+					x_re = _mm256_sub_pd(x_re, y_re);
+					x_im = _mm256_sub_pd(x_im, y_im);
+					FPC_MUL_AVX(x_re, x_im,
+						x_re, x_im, vs_re, vs_im);
+					_mm256_storeu_pd(d + j + t, x_re);
+					_mm256_storeu_pd(d + j + t + hn, x_im);
+				}
+			} else {
+				for (j = j1; j < j2; j ++) {
+					fpr x_re, x_im, y_re, y_im;
+
+					x_re = f[j];
+					x_im = f[j + hn];
+					y_re = f[j + t];
+					y_im = f[j + t + hn];
+					FPC_ADD(f[j], f[j + hn],
+						x_re, x_im, y_re, y_im);
+					FPC_SUB(x_re, x_im,
+						x_re, x_im, y_re, y_im);
+					FPC_MUL(f[j + t], f[j + t + hn],
+						x_re, x_im, s_re, s_im);
+				}
+			}
+		}
+		t = dt;
+		m = hm;
+	}
+
+	if (logn > 0) {
+		fpr ni;
+
+		ni = fpr_scaled(2, -(int)logn);
+		u = 0;
+		if (n >= 4) {
+			__m256d vni;
+
+			vni = _mm256_set1_pd(ni.v);
+			for (; u < n; u += 4) {
+				_mm256_storeu_pd(d + u, _mm256_mul_pd(
+					_mm256_loadu_pd(d + u), vni));
+			}
+		}
+		for (; u < n; u ++) {
+			f[u] = fpr_mul(f[u], ni);
+		}
+	}
+	_mm256_zeroupper();
+}
+
+/* see internal.h */
+__attribute__((target("avx")))
+void
+falcon_poly_mul_fft_avx(fpr *restrict a, const fpr *restrict b, unsigned logn)
+{
+	size_t n, hn, u;
+	double *da;
+	const double *db;
+
+	da = (double *)a;
+	db = (const double *)b;
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	u = 0;
+	if (hn >= 4) {
+		for (; u < hn; u += 4) {
+			__m256d a_re, a_im, b_re, b_im;
+
+			a_re = _mm256_loadu_pd(da + u);
+			a_im = _mm256_loadu_pd(da + u + hn);
+			b_re = _mm256_loadu_pd(db + u);
+			b_im = _mm256_loadu_pd(db + u + hn);
+			FPC_MUL_AVX(a_re, a_im, a_re, a_im, b_re, b_im);
+			_mm256_storeu_pd(da + u, a_re);
+			_mm256_storeu_pd(da + u + hn, a_im);
+		}
+	}
+	for (; u < hn; u ++) {
+		fpr a_re, a_im, b_re, b_im;
+
+		a_re = a[u];
+		a_im = a[u + hn];
+		b_re = b[u];
+		b_im = b[u + hn];
+		FPC_MUL(a[u], a[u + hn], a_re, a_im, b_re, b_im);
+	}
+	_mm256_zeroupper();
+}
+
+/* see internal.h */
+__attribute__((target("avx")))
+void
+falcon_poly_muladj_fft_avx(fpr *restrict a,
+	const fpr *restrict b, unsigned logn)
+{
+	size_t n, hn, u;
+	double *da;
+	const double *db;
+
+	da = (double *)a;
+	db = (const double *)b;
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	u = 0;
+	if (hn >= 4) {
+		__m256d sign;
+
+		sign = _mm256_set1_pd(-0.0);
+		for (; u < hn; u += 4) {
+			__m256d a_re, a_im, b_re, b_im;
+
+			a_re = _mm256_loadu_pd(da + u);
+			a_im = _mm256_loadu_pd(da + u + hn);
+			b_re = _mm256_loadu_pd(db + u);
+			b_im = _mm256_xor_pd(
+				_mm256_loadu_pd(db + u + hn), sign);
+			FPC_MUL_AVX(a_re, a_im, a_re, a_im, b_re, b_im);
+			_mm256_storeu_pd(da + u, a_re);
+			_mm256_storeu_pd(da + u + hn, a_im);
+		}
+	}
+	for (; u < hn; u ++) {
+		fpr a_re, a_im, b_re, b_im;
+
+		a_re = a[u];
+		a_im = a[u + hn];
+		b_re = b[u];
+		b_im = fpr_neg(b[u + hn]);
+		FPC_MUL(a[u], a[u + hn], a_re, a_im, b_re, b_im);
+	}
+	_mm256_zeroupper();
+}
+
+#endif
+
 /* see internal.h */
 void
 falcon_poly_mulselfadj_fft(fpr *a, unsigned logn)
@@ -674,6 +1229,10 @@ falcon_poly_split_fft(fpr *restrict f0, fpr *restrict f1,
 	 */
 	size_t n, hn, qn, u;
 
+	if (logn >= 1 && logn <= FFT_CODELET_MAX) {
+		split_codelet[logn](f0, f1, f);
+		return;
+	}
 	n = (size_t)1 << logn;
 	hn = n >> 1;
 	qn = hn >> 1;
@@ -716,6 +1275,10 @@ falcon_poly_merge_fft(fpr *restrict f,
 {
 	size_t n, hn, qn, u;
 
+	if (logn >= 1 && logn <= FFT_CODELET_MAX) {
+		merge_codelet[logn](f, f0, f1);
+		return;
+	}
 	n = (size_t)1 << logn;
 	hn = n >> 1;
 	qn = hn >> 1;
@@ -3944,6 +3944,7 @@ falcon_keygen_new(unsigned logn, int ternary)
 {
 	falcon_keygen *fk;
 
+	falcon_isa_init();
 	if (ternary) {
 		if (logn < 3 || logn > 9) {
 			return NULL;
@@ -4065,7 +4066,7 @@ rng_ready(falcon_keygen *fk)
 	if (!fk->seeded) {
 		unsigned char tmp[32];
 
-		if (!falcon_get_seed(tmp, sizeof tmp)) {
+		if (!falcon_context_seed(tmp, sizeof tmp)) {
 			return 0;
 		}
 		falcon_keygen_set_seed(fk, tmp, sizeof tmp, 0);
@@ -6280,6 +6281,7 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 	 * both odd (the NTRU equation solver requires it).
 	 */
 	for (;;) {
+		FALCON_PROBE1(keygen__attempt, logn);
 		if (ter) {
 			fpr *rt1, *rt2, *rt3;
 			size_t hn;
@@ -6317,10 +6319,11 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 				g[u] = (int16_t)fpr_rint(rt2[u]);
 			}
 
-			if (mod2_res_ternary(f, logn) == 0) {
-				continue;
-			}
-			if (mod2_res_ternary(g, logn) == 0) {
+			if (mod2_res_ternary(f, logn) == 0
+				|| mod2_res_ternary(g, logn) == 0)
+			{
+				FALCON_PROBE2(keygen__reject, logn,
+					FALCON_KG_REJECT_EVEN_RES);
 				continue;
 			}
 
@@ -6347,6 +6350,8 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 			norm = fpr_double(norm);
 
 			if (!fpr_lt(norm, bound)) {
+				FALCON_PROBE2(keygen__reject, logn,
+					FALCON_KG_REJECT_NORM);
 				continue;
 			}
 
@@ -6368,6 +6373,8 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 			norm = fpr_double(norm);
 
 			if (!fpr_lt(norm, bound)) {
+				FALCON_PROBE2(keygen__reject, logn,
+					FALCON_KG_REJECT_GS_NORM);
 				continue;
 			}
 		} else {
@@ -6395,6 +6402,8 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 			normg = poly_small_sqnorm(g, logn, ter);
 			norm = (normf + normg) | -((normf | normg) >> 31);
 			if (norm >= 16823) {
+				FALCON_PROBE2(keygen__reject, logn,
+					FALCON_KG_REJECT_NORM);
 				continue;
 			}
 
@@ -6425,6 +6434,8 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 			if (!fpr_lt(bnorm, fpr_div(
 				fpr_of(168224121), fpr_of(10000))))
 			{
+				FALCON_PROBE2(keygen__reject, logn,
+					FALCON_KG_REJECT_GS_NORM);
 				continue;
 			}
 		}
@@ -6434,6 +6445,8 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 		 * fails, we must restart.
 		 */
 		if (!falcon_compute_public(h, f, g, logn, ter)) {
+			FALCON_PROBE2(keygen__reject, logn,
+				FALCON_KG_REJECT_NOT_INV);
 			continue;
 		}
 
@@ -6441,6 +6454,8 @@ falcon_keygen_make(falcon_keygen *fk, int comp,
 		 * Solve the NTRU equation to get F and G.
 		 */
 		if (!solve_NTRU(fk, F, G, f, g)) {
+			FALCON_PROBE2(keygen__reject, logn,
+				FALCON_KG_REJECT_NTRU);
 			continue;
 		}
 
@@ -29,6 +29,10 @@
  * @author   Thomas Pornin <thomas.pornin@nccgroup.trust>
  */
 
+#ifndef USE_SGX
+#include <time.h>
+#endif
+
 #include "internal.h"
 
 /*
@@ -42,6 +46,10 @@
 #endif
 
 /*
+ * The three macros below select the default sampler backend. All
+ * backends are compiled in, and can also be selected at runtime (see
+ * falcon_sign_set_sampler()).
+ *
  * If SAMPLER_CODF is non-zero, then the discrete Gaussian sampler will
  * use a CoDF table and a variable number of PRNG invocations; use
  * -DSAMPLER_CODF (or -DSAMPLER_CODF=1) to enable this code.
@@ -167,6 +175,28 @@ ffLDL_treesize(unsigned logn)
 	return (logn + 1) << logn;
 }
 
+/*
+ * Trees are laid out in the order ffSampling reads them: for each
+ * node, the subtree for d11 (sampled first), then the node's L
+ * polynomial, then the subtree for d00. A signature thus reads the
+ * whole tree front to back (the ternary sampler rereads each L right
+ * after the d00 subtree), instead of jumping between subtrees that
+ * are up to half the tree apart. ffLDL_node() and ffLDL_sub0() give
+ * the offsets of L and of the d00 subtree; the d11 subtree starts at
+ * the node itself.
+ */
+static inline size_t
+ffLDL_node(unsigned logn)
+{
+	return ffLDL_treesize(logn - 1);
+}
+
+static inline size_t
+ffLDL_sub0(unsigned logn)
+{
+	return ffLDL_treesize(logn - 1) + ((size_t)1 << logn);
+}
+
 /*
  * Inner function for ffLDL_fft(). It expects the matrix to be both
  * auto-adjoint and quasicyclic; also, it uses the source operands
@@ -192,7 +222,7 @@ ffLDL_fft_inner(fpr *restrict tree,
 	 * and the diagonal of D. Since d00 = g0, we just write d11
 	 * into tmp.
 	 */
-	LDLqc_fft(tmp, tree, g0, g1, logn, tmp + n);
+	LDLqc_fft(tmp, tree + ffLDL_node(logn), g0, g1, logn, tmp + n);
 
 	/*
 	 * Split d00 (currently in g0) and d11 (currently in tmp). We
@@ -207,9 +237,9 @@ ffLDL_fft_inner(fpr *restrict tree,
 	 * Each split result is the first row of a new auto-adjoint
 	 * quasicyclic matrix for the next recursive step.
 	 */
-	ffLDL_fft_inner(tree + n,
+	ffLDL_fft_inner(tree + ffLDL_sub0(logn),
 		g1, g1 + hn, logn - 1, tmp);
-	ffLDL_fft_inner(tree + n + ffLDL_treesize(logn - 1),
+	ffLDL_fft_inner(tree,
 		g0, g0 + hn, logn - 1, tmp);
 }
 
@@ -243,14 +273,14 @@ ffLDL_fft(fpr *restrict tree, const fpr *restrict g00,
 	tmp += n << 1;
 
 	memcpy(d00, g00, n * sizeof *g00);
-	LDL_fft(d11, tree, g00, g01, g11, logn, tmp);
+	LDL_fft(d11, tree + ffLDL_node(logn), g00, g01, g11, logn, tmp);
 
 	falcon_poly_split_fft(tmp, tmp + hn, d00, logn);
 	falcon_poly_split_fft(d00, d00 + hn, d11, logn);
 	memcpy(d11, tmp, n * sizeof *tmp);
-	ffLDL_fft_inner(tree + n,
+	ffLDL_fft_inner(tree + ffLDL_sub0(logn),
 		d11, d11 + hn, logn - 1, tmp);
-	ffLDL_fft_inner(tree + n + ffLDL_treesize(logn - 1),
+	ffLDL_fft_inner(tree,
 		d00, d00 + hn, logn - 1, tmp);
 }
 
@@ -270,9 +300,9 @@ ffLDL_binary_normalize(fpr *tree, fpr sigma, unsigned logn)
 	if (n == 1) {
 		tree[0] = fpr_div(sigma, fpr_sqrt(tree[0]));
 	} else {
-		ffLDL_binary_normalize(tree + n,
+		ffLDL_binary_normalize(tree,
 			sigma, logn - 1);
-		ffLDL_binary_normalize(tree + n + ffLDL_treesize(logn - 1),
+		ffLDL_binary_normalize(tree + ffLDL_sub0(logn),
 			sigma, logn - 1);
 	}
 }
@@ -422,11 +452,13 @@ ffLDL_inner_fft3(fpr *restrict tree, const fpr *restrict g00,
 	const fpr *restrict g10, const fpr *restrict g11,
 	unsigned logn, fpr *restrict tmp)
 {
-	size_t n, hn, s;
-	fpr *t0, *t1, *t2;
+	size_t n, hn, sub;
+	fpr *l10, *t0, *t1, *t2;
 
 	n = (size_t)1 << logn;
 	hn = n >> 1;
+	sub = (size_t)logn << (logn - 1);
+	l10 = tree + sub;
 
 	if (logn == 1) {
 		/*
@@ -436,14 +468,14 @@ ffLDL_inner_fft3(fpr *restrict tree, const fpr *restrict g00,
 		 * recursion.
 		 *
 		 * LDL_dim2_fft3() returns d11 (in tmp) and l10
-		 * (two slots, in tree). It will be followed by two
-		 * leaves, corresponding to d00 (which is g00) and d11.
-		 * The two leaves are real numbers (one slot each).
+		 * (two slots). The leaves for d11 and d00 (which is
+		 * g00) are real numbers (one slot each), on either
+		 * side of l10.
 		 */
-		LDL_dim2_fft3(tmp, tree, g00, g10, g11, logn, 0);
+		LDL_dim2_fft3(tmp, l10, g00, g10, g11, logn, 0);
 
-		tree[2] = g00[0];
-		tree[3] = tmp[0];
+		tree[0] = tmp[0];
+		tree[3] = g00[0];
 		return 4;
 	}
 
@@ -452,22 +484,21 @@ ffLDL_inner_fft3(fpr *restrict tree, const fpr *restrict g00,
 	 * Since d00 = g00, we can do the first recursion
 	 * before the LDL.
 	 */
-	s = n;
 	t0 = tmp;
 	t1 = tmp + hn;
 	t2 = t1 + hn;
 
 	falcon_poly_split_deep_fft3(t0, t1, g00, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
-	s += ffLDL_inner_fft3(tree + s, t0, t1, t0, logn - 1, t2);
+	ffLDL_inner_fft3(l10 + n, t0, t1, t0, logn - 1, t2);
 
-	LDL_dim2_fft3(t2, tree, g00, g10, g11, logn, 0);
+	LDL_dim2_fft3(t2, l10, g00, g10, g11, logn, 0);
 
 	falcon_poly_split_deep_fft3(t0, t1, t2, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
-	s += ffLDL_inner_fft3(tree + s, t0, t1, t0, logn - 1, t2);
+	ffLDL_inner_fft3(tree, t0, t1, t0, logn - 1, t2);
 
-	return s;
+	return n + 2 * sub;
 }
 
 static size_t
@@ -481,21 +512,24 @@ ffLDL_depth1_fft3(fpr *restrict tree, const fpr *restrict g00,
 	 * input 3x3 matrix.
 	 */
 
-	size_t n, hn, s;
+	size_t n, hn, sub;
 	fpr *l10, *l20, *l21, *d11, *d22;
 	fpr *t0, *t1, *t2;
 
+	/*
+	 * Layout: d22 subtree, l21, d11 subtree, l10, l20, d00 subtree.
+	 */
 	n = (size_t)1 << logn;
 	hn = n >> 1;
-	l10 = tree;
+	sub = (size_t)logn << (logn - 1);
+	l21 = tree + sub;
+	l10 = l21 + n + sub;
 	l20 = l10 + n;
-	l21 = l20 + n;
 	d11 = tmp;
 	d22 = d11 + n;
 	t0 = d22 + n;
 	t1 = t0 + hn;
 	t2 = t1 + hn;
-	s = 3 * n;
 
 	/*
 	 * LDL decomposition.
@@ -512,17 +546,17 @@ ffLDL_depth1_fft3(fpr *restrict tree, const fpr *restrict g00,
 	 */
 	falcon_poly_split_deep_fft3(t0, t1, g00, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
-	s += ffLDL_inner_fft3(tree + s, t0, t1, t0, logn - 1, t2);
+	ffLDL_inner_fft3(l20 + n, t0, t1, t0, logn - 1, t2);
 
 	falcon_poly_split_deep_fft3(t0, t1, d11, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
-	s += ffLDL_inner_fft3(tree + s, t0, t1, t0, logn - 1, t2);
+	ffLDL_inner_fft3(l21 + n, t0, t1, t0, logn - 1, t2);
 
 	falcon_poly_split_deep_fft3(t0, t1, d22, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
-	s += ffLDL_inner_fft3(tree + s, t0, t1, t0, logn - 1, t2);
+	ffLDL_inner_fft3(tree, t0, t1, t0, logn - 1, t2);
 
-	return s;
+	return 3 * (n + sub);
 }
 
 static size_t
@@ -530,13 +564,13 @@ ffLDL_fft3(fpr *restrict tree, const fpr *restrict g00,
 	const fpr *restrict g10, const fpr *restrict g11,
 	unsigned logn, fpr *restrict tmp)
 {
-	size_t n, tn, s;
+	size_t n, tn, sub;
 	fpr *l10, *d11, *t0, *t1, *t2, *t3;
 
 	n = (size_t)3 << (logn - 1);
 	tn = (size_t)1 << (logn - 1);
-	l10 = tree;
-	s = n;
+	sub = 3 * ((size_t)(logn + 1) << (logn - 2));
+	l10 = tree + sub;
 	t0 = tmp;
 	t1 = t0 + tn;
 	t2 = t1 + tn;
@@ -555,7 +589,7 @@ ffLDL_fft3(fpr *restrict tree, const fpr *restrict g00,
 	falcon_poly_split_top_fft3(t0, t1, t2, g00, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
 	falcon_poly_adj_fft3(t2, logn - 1, 0);
-	s += ffLDL_depth1_fft3(tree + s, t0, t1, t0, t2, t1, t0, logn - 1, t3);
+	ffLDL_depth1_fft3(l10 + n, t0, t1, t0, t2, t1, t0, logn - 1, t3);
 
 	/*
 	 * Compute LDL decomposition of the top matrix.
@@ -569,9 +603,9 @@ ffLDL_fft3(fpr *restrict tree, const fpr *restrict g00,
 	falcon_poly_split_top_fft3(t0, t1, t2, d11, logn);
 	falcon_poly_adj_fft3(t1, logn - 1, 0);
 	falcon_poly_adj_fft3(t2, logn - 1, 0);
-	s += ffLDL_depth1_fft3(tree + s, t0, t1, t0, t2, t1, t0, logn - 1, t3);
+	ffLDL_depth1_fft3(tree, t0, t1, t0, t2, t1, t0, logn - 1, t3);
 
-	return s;
+	return n + 2 * sub;
 }
 
 /*
@@ -595,13 +629,13 @@ ffLDL_ternary_normalize_inner(fpr *tree, fpr sigma, unsigned logn)
 		 * one parent node and two leaves. We normalize the
 		 * leaves.
 		 */
-		tree[2] = fpr_div(sigma, fpr_sqrt(tree[2]));
+		tree[0] = fpr_div(sigma, fpr_sqrt(tree[0]));
 		tree[3] = fpr_div(sigma, fpr_sqrt(tree[3]));
 		return 4;
 	}
 
-	s = (size_t)1 << logn;
-	s += ffLDL_ternary_normalize_inner(tree + s, sigma, logn - 1);
+	s = ffLDL_ternary_normalize_inner(tree, sigma, logn - 1);
+	s += (size_t)1 << logn;
 	s += ffLDL_ternary_normalize_inner(tree + s, sigma, logn - 1);
 	return s;
 }
@@ -611,9 +645,10 @@ ffLDL_ternary_normalize_depth1(fpr *tree, fpr sigma, unsigned logn)
 {
 	size_t s;
 
-	s = (size_t)3 << logn;
-	s += ffLDL_ternary_normalize_inner(tree + s, sigma, logn - 1);
+	s = ffLDL_ternary_normalize_inner(tree, sigma, logn - 1);
+	s += (size_t)1 << logn;
 	s += ffLDL_ternary_normalize_inner(tree + s, sigma, logn - 1);
+	s += (size_t)2 << logn;
 	s += ffLDL_ternary_normalize_inner(tree + s, sigma, logn - 1);
 	return s;
 }
@@ -623,8 +658,8 @@ ffLDL_ternary_normalize(fpr *tree, fpr sigma, unsigned logn)
 {
 	size_t s;
 
-	s = (size_t)3 << (logn - 1);
-	s += ffLDL_ternary_normalize_depth1(tree + s, sigma, logn - 1);
+	s = ffLDL_ternary_normalize_depth1(tree, sigma, logn - 1);
+	s += (size_t)3 << (logn - 1);
 	s += ffLDL_ternary_normalize_depth1(tree + s, sigma, logn - 1);
 	return s;
 }
@@ -685,11 +720,207 @@ skoff_tree(unsigned logn, unsigned ter)
 }
 
 /*
- * Load a private key and perform precomputations for signing.
+ * Complex multiplication d = a * b (see falcon-fft.c).
+ */
+#define FPC_MUL(d_re, d_im, a_re, a_im, b_re, b_im)   do { \
+		fpr fpct_a_re, fpct_a_im; \
+		fpr fpct_b_re, fpct_b_im; \
+		fpr fpct_d_re, fpct_d_im; \
+		fpct_a_re = (a_re); \
+		fpct_a_im = (a_im); \
+		fpct_b_re = (b_re); \
+		fpct_b_im = (b_im); \
+		fpct_d_re = fpr_sub( \
+			fpr_mul(fpct_a_re, fpct_b_re), \
+			fpr_mul(fpct_a_im, fpct_b_im)); \
+		fpct_d_im = fpr_add( \
+			fpr_mul(fpct_a_re, fpct_b_im), \
+			fpr_mul(fpct_a_im, fpct_b_re)); \
+		(d_re) = fpct_d_re; \
+		(d_im) = fpct_d_im; \
+	} while (0)
+
+/*
+ * Gram matrix G = B·B* of the basis B = [[b00, b01], [b10, b11]] (FFT
+ * representation), in one pass over the basis. Binary case; for
+ * historical reasons, this implementation uses g00, g01 and g11 (upper
+ * triangle):
+ *   g00 = b00*adj(b00) + b01*adj(b01)
+ *   g01 = b00*adj(b10) + b01*adj(b11)
+ *   g11 = b10*adj(b10) + b11*adj(b11)
+ * Same operations, in the same order, as the chains of
+ * falcon_poly_mulselfadj_fft(), falcon_poly_muladj_fft() and
+ * falcon_poly_add_fft() this replaces; the LDL tree is unchanged.
+ */
+static void
+gram_fft(fpr *restrict g00, fpr *restrict g01, fpr *restrict g11,
+	const fpr *restrict b00, const fpr *restrict b01,
+	const fpr *restrict b10, const fpr *restrict b11,
+	unsigned logn)
+{
+	size_t hn, u;
+
+	hn = MKN(logn, 0) >> 1;
+	for (u = 0; u < hn; u ++) {
+		fpr b00_re, b00_im, b01_re, b01_im;
+		fpr b10_re, b10_im, b11_re, b11_im;
+		fpr x_re, x_im, y_re, y_im;
+
+		b00_re = b00[u];
+		b00_im = b00[u + hn];
+		b01_re = b01[u];
+		b01_im = b01[u + hn];
+		b10_re = b10[u];
+		b10_im = b10[u + hn];
+		b11_re = b11[u];
+		b11_im = b11[u + hn];
+
+		g00[u] = fpr_add(
+			fpr_add(fpr_sqr(b00_re), fpr_sqr(b00_im)),
+			fpr_add(fpr_sqr(b01_re), fpr_sqr(b01_im)));
+		g00[u + hn] = fpr_of(0);
+
+		FPC_MUL(x_re, x_im, b00_re, b00_im, b10_re, fpr_neg(b10_im));
+		FPC_MUL(y_re, y_im, b01_re, b01_im, b11_re, fpr_neg(b11_im));
+		g01[u] = fpr_add(x_re, y_re);
+		g01[u + hn] = fpr_add(x_im, y_im);
+
+		g11[u] = fpr_add(
+			fpr_add(fpr_sqr(b10_re), fpr_sqr(b10_im)),
+			fpr_add(fpr_sqr(b11_re), fpr_sqr(b11_im)));
+		g11[u + hn] = fpr_of(0);
+	}
+}
+
+/*
+ * Ternary case of gram_fft(): the lower triangle is used, with
+ *   g10 = b10*adj(b00) + b11*adj(b01)
+ * (full-size polynomials).
+ */
+static void
+gram_fft3(fpr *restrict g00, fpr *restrict g10, fpr *restrict g11,
+	const fpr *restrict b00, const fpr *restrict b01,
+	const fpr *restrict b10, const fpr *restrict b11,
+	unsigned logn)
+{
+	size_t hn, u;
+
+	hn = MKN(logn, 1) >> 1;
+	for (u = 0; u < hn; u ++) {
+		fpr b00_re, b00_im, b01_re, b01_im;
+		fpr b10_re, b10_im, b11_re, b11_im;
+		fpr x_re, x_im, y_re, y_im;
+
+		b00_re = b00[u];
+		b00_im = b00[u + hn];
+		b01_re = b01[u];
+		b01_im = b01[u + hn];
+		b10_re = b10[u];
+		b10_im = b10[u + hn];
+		b11_re = b11[u];
+		b11_im = b11[u + hn];
+
+		g00[u] = fpr_add(
+			fpr_add(fpr_sqr(b00_re), fpr_sqr(b00_im)),
+			fpr_add(fpr_sqr(b01_re), fpr_sqr(b01_im)));
+		g00[u + hn] = fpr_of(0);
+
+		FPC_MUL(x_re, x_im, b10_re, b10_im, b00_re, fpr_neg(b00_im));
+		FPC_MUL(y_re, y_im, b11_re, b11_im, b01_re, fpr_neg(b01_im));
+		g10[u] = fpr_add(x_re, y_re);
+		g10[u + hn] = fpr_add(x_im, y_im);
+
+		g11[u] = fpr_add(
+			fpr_add(fpr_sqr(b10_re), fpr_sqr(b10_im)),
+			fpr_add(fpr_sqr(b11_re), fpr_sqr(b11_im)));
+		g11[u + hn] = fpr_of(0);
+	}
+}
+
+/*
+ * Target vector for the hashed message: with h = FFT(hm) in t0[] on
+ * input, set t0 = h*b11/q and t1 = -h*b01/q, i.e. [hm, 0]·B^(-1) (since
+ * det(B) = q). One pass; binary and ternary cases.
+ */
+static void
+target_fft(fpr *restrict t0, fpr *restrict t1,
+	const fpr *restrict b01, const fpr *restrict b11,
+	unsigned q, unsigned logn, unsigned ter)
+{
+	size_t hn, u;
+	fpr ni, mni;
+
+	hn = MKN(logn, ter) >> 1;
+	ni = fpr_inverse_of(q);
+	mni = fpr_neg(ni);
+	for (u = 0; u < hn; u ++) {
+		fpr h_re, h_im, x_re, x_im;
+
+		h_re = t0[u];
+		h_im = t0[u + hn];
+		FPC_MUL(x_re, x_im, h_re, h_im, b01[u], b01[u + hn]);
+		t1[u] = fpr_mul(x_re, mni);
+		t1[u + hn] = fpr_mul(x_im, mni);
+		FPC_MUL(x_re, x_im, h_re, h_im, b11[u], b11[u + hn]);
+		t0[u] = fpr_mul(x_re, ni);
+		t0[u + hn] = fpr_mul(x_im, ni);
+	}
+}
+
+/*
+ * Lattice point for a sampled vector: [z0, z1] = [z0, z1]·B, in place,
+ * in one pass:
+ *   z0 = z0*b00 + z1*b10
+ *   z1 = z1*b11 + z0*b01
+ * Binary and ternary cases.
+ */
+static void
+apply_basis_fft(fpr *restrict z0, fpr *restrict z1,
+	const fpr *restrict b00, const fpr *restrict b01,
+	const fpr *restrict b10, const fpr *restrict b11,
+	unsigned logn, unsigned ter)
+{
+	size_t hn, u;
+
+	hn = MKN(logn, ter) >> 1;
+	for (u = 0; u < hn; u ++) {
+		fpr z0_re, z0_im, z1_re, z1_im;
+		fpr x_re, x_im, y_re, y_im;
+
+		z0_re = z0[u];
+		z0_im = z0[u + hn];
+		z1_re = z1[u];
+		z1_im = z1[u + hn];
+		FPC_MUL(x_re, x_im, z0_re, z0_im, b00[u], b00[u + hn]);
+		FPC_MUL(y_re, y_im, z1_re, z1_im, b10[u], b10[u + hn]);
+		z0[u] = fpr_add(x_re, y_re);
+		z0[u + hn] = fpr_add(x_im, y_im);
+		FPC_MUL(x_re, x_im, z1_re, z1_im, b11[u], b11[u + hn]);
+		FPC_MUL(y_re, y_im, z0_re, z0_im, b01[u], b01[u + hn]);
+		z1[u] = fpr_add(x_re, y_re);
+		z1[u + hn] = fpr_add(x_im, y_im);
+	}
+}
+
+/*
+ * Binary case: sigma = 1.55 * sqrt(q), the standard deviation that
+ * the leaves of the LDL tree are normalized with.
+ */
+static fpr
+binary_sigma(unsigned q)
+{
+	return fpr_mul(fpr_sqrt(fpr_of(q)),
+		fpr_div(fpr_of(155), fpr_of(100)));
+}
+
+/*
+ * Load a private key and perform precomputations for signing. If
+ * 'with_tree' is zero (binary case only), only the basis is computed
+ * (for do_sign_dyn()).
  *
  * Number of elements in sk[]:
  *
- *  - binary case: (logn+5) * 2^logn
+ *  - binary case: (logn+5) * 2^logn, or 4 * 2^logn without the tree
  *
  *  - ternary case: 3*(logn+6) * 2^(logn-1)
  *
@@ -699,7 +930,7 @@ static void
 load_skey(fpr *restrict sk, unsigned q,
 	const int16_t *f_src, const int16_t *g_src,
 	const int16_t *F_src, const int16_t *G_src,
-	unsigned logn, unsigned ter, fpr *restrict tmp)
+	unsigned logn, unsigned ter, int with_tree, fpr *restrict tmp)
 {
 	size_t n;
 	fpr *f, *g, *F, *G;
@@ -745,6 +976,9 @@ load_skey(fpr *restrict sk, unsigned q,
 		falcon_FFT(G, logn);
 		falcon_poly_neg_fft(f, logn);
 		falcon_poly_neg_fft(F, logn);
+		if (!with_tree) {
+			return;
+		}
 	}
 
 	/*
@@ -762,23 +996,7 @@ load_skey(fpr *restrict sk, unsigned q,
 		g11 = g10 + n;
 		gxx = g11 + n;
 
-		memcpy(g00, b00, n * sizeof *b00);
-		falcon_poly_mulselfadj_fft3(g00, logn, 1);
-		memcpy(gxx, b01, n * sizeof *b01);
-		falcon_poly_mulselfadj_fft3(gxx, logn, 1);
-		falcon_poly_add_fft3(g00, gxx, logn, 1);
-
-		memcpy(g10, b10, n * sizeof *b10);
-		falcon_poly_muladj_fft3(g10, b00, logn, 1);
-		memcpy(gxx, b11, n * sizeof *b11);
-		falcon_poly_muladj_fft3(gxx, b01, logn, 1);
-		falcon_poly_add_fft3(g10, gxx, logn, 1);
-
-		memcpy(g11, b10, n * sizeof *b10);
-		falcon_poly_mulselfadj_fft3(g11, logn, 1);
-		memcpy(gxx, b11, n * sizeof *b11);
-		falcon_poly_mulselfadj_fft3(gxx, logn, 1);
-		falcon_poly_add_fft3(g11, gxx, logn, 1);
+		gram_fft3(g00, g10, g11, b00, b01, b10, b11, logn);
 
 		/*
 		 * Compute the Falcon tree.
@@ -798,34 +1016,13 @@ load_skey(fpr *restrict sk, unsigned q,
 		 */
 		ffLDL_ternary_normalize(tree, sigma, logn);
 	} else {
-		/*
-		 * For historical reasons, this implementation uses
-		 * g00, g01 and g11 (upper triangle).
-		 */
 		fpr *g00, *g01, *g11, *gxx;
 
 		g00 = tmp;
 		g01 = g00 + n;
 		g11 = g01 + n;
 		gxx = g11 + n;
-
-		memcpy(g00, b00, n * sizeof *b00);
-		falcon_poly_mulselfadj_fft(g00, logn);
-		memcpy(gxx, b01, n * sizeof *b01);
-		falcon_poly_mulselfadj_fft(gxx, logn);
-		falcon_poly_add_fft(g00, gxx, logn);
-
-		memcpy(g01, b00, n * sizeof *b00);
-		falcon_poly_muladj_fft(g01, b10, logn);
-		memcpy(gxx, b01, n * sizeof *b01);
-		falcon_poly_muladj_fft(gxx, b11, logn);
-		falcon_poly_add_fft(g01, gxx, logn);
-
-		memcpy(g11, b10, n * sizeof *b10);
-		falcon_poly_mulselfadj_fft(g11, logn);
-		memcpy(gxx, b11, n * sizeof *b11);
-		falcon_poly_mulselfadj_fft(gxx, logn);
-		falcon_poly_add_fft(g11, gxx, logn);
+		gram_fft(g00, g01, g11, b00, b01, b10, b11, logn);
 
 		/*
 		 * Compute the Falcon tree.
@@ -833,11 +1030,9 @@ load_skey(fpr *restrict sk, unsigned q,
 		ffLDL_fft(tree, g00, g01, g11, logn, gxx);
 
 		/*
-		 * Tree normalization:
-		 *   sigma = 1.55 * sqrt(q)
+		 * Tree normalization.
 		 */
-		sigma = fpr_mul(fpr_sqrt(fpr_of(q)),
-			fpr_div(fpr_of(155), fpr_of(100)));
+		sigma = binary_sigma(q);
 
 		/*
 		 * Normalize tree with sigma.
@@ -849,140 +1044,393 @@ load_skey(fpr *restrict sk, unsigned q,
 typedef int (*samplerZ)(void *ctx, fpr mu, fpr sigma);
 
 /*
- * Perform Fast Fourier Sampling for target vector t and LDL tree T.
- * tmp[] must have size for at least two polynomials of size 2^logn.
+ * Fast Fourier Sampling, binary case and inner (halving) levels of the
+ * ternary case. The two have the same tree layout at these levels:
+ * for a node of degree 2^logn, the d11 subtree, then L (2^logn
+ * elements) at ffLDL_node(logn), then the d00 subtree at
+ * ffLDL_sub0(logn). They differ in the split/merge twiddles, at the
+ * leaves, and in the target for the d00 side: (t1 - z1) * L + t0 for
+ * binary, t0 + z1 * L for ternary, where z1 * L is also subtracted
+ * from z0 once it is sampled.
+ *
+ * The last levels (logn <= 3) are fused straight-line kernels, with
+ * all intermediate values in locals; the levels above are walked with
+ * an explicit stack. Operations are the same, in the same order, as
+ * in the plain recursive formulation, so signatures do not depend on
+ * where the kernels take over.
  */
-static void
-ffSampling_fft(samplerZ samp, void *samp_ctx,
-	fpr *restrict z0, fpr *restrict z1,
-	const fpr *restrict tree,
-	const fpr *restrict t0, const fpr *restrict t1, unsigned logn,
-	fpr *restrict tmp)
+
+/*
+ * Split and merge for logn >= 2, as falcon_poly_split_fft() and
+ * falcon_poly_merge_fft() (binary, twiddles fpr_gm_tab) or
+ * falcon_poly_split_deep_fft3() and falcon_poly_merge_deep_fft3()
+ * (ternary, twiddles fpr_gm3_square). Inlined with a constant logn,
+ * the loops disappear.
+ */
+static inline void
+ffs_split(fpr *restrict f0, fpr *restrict f1,
+	const fpr *restrict f, unsigned logn, const fpr *tw)
 {
-	size_t n, hn;
-	const fpr *tree0, *tree1;
+	size_t hn, qn, u;
+
+	hn = (size_t)1 << (logn - 1);
+	qn = hn >> 1;
+	for (u = 0; u < qn; u ++) {
+		fpr a_re, a_im, b_re, b_im, t_re, t_im;
+
+		a_re = f[(u << 1) + 0];
+		a_im = f[(u << 1) + 0 + hn];
+		b_re = f[(u << 1) + 1];
+		b_im = f[(u << 1) + 1 + hn];
+		t_re = fpr_add(a_re, b_re);
+		t_im = fpr_add(a_im, b_im);
+		f0[u] = fpr_half(t_re);
+		f0[u + qn] = fpr_half(t_im);
+		t_re = fpr_sub(a_re, b_re);
+		t_im = fpr_sub(a_im, b_im);
+		FPC_MUL(t_re, t_im, t_re, t_im,
+			tw[((u + hn) << 1) + 0], fpr_neg(tw[((u + hn) << 1) + 1]));
+		f1[u] = fpr_half(t_re);
+		f1[u + qn] = fpr_half(t_im);
+	}
+}
 
-	n = (size_t)1 << logn;
-	if (n == 1) {
-		fpr x0, x1, sigma;
+static inline void
+ffs_merge(fpr *restrict f,
+	const fpr *restrict f0, const fpr *restrict f1,
+	unsigned logn, const fpr *tw)
+{
+	size_t hn, qn, u;
+
+	hn = (size_t)1 << (logn - 1);
+	qn = hn >> 1;
+	for (u = 0; u < qn; u ++) {
+		fpr a_re, a_im, b_re, b_im;
+
+		a_re = f0[u];
+		a_im = f0[u + qn];
+		FPC_MUL(b_re, b_im, f1[u], f1[u + qn],
+			tw[((u + hn) << 1) + 0], tw[((u + hn) << 1) + 1]);
+		f[(u << 1) + 0] = fpr_add(a_re, b_re);
+		f[(u << 1) + 0 + hn] = fpr_add(a_im, b_im);
+		f[(u << 1) + 1] = fpr_sub(a_re, b_re);
+		f[(u << 1) + 1 + hn] = fpr_sub(a_im, b_im);
+	}
+}
 
-		x0 = t0[0];
-		x1 = t1[0];
-		sigma = tree[0];
-		z0[0] = fpr_of(samp(samp_ctx, x0, sigma));
-		z1[0] = fpr_of(samp(samp_ctx, x1, sigma));
-		return;
+/*
+ * Target for the d00 side of a node of degree 2^logn, in one pass
+ * (see above); L is the node's polynomial. In the ternary case, z1 * L
+ * is also written to c[] if that is not NULL.
+ */
+static inline void
+ffs_target(fpr *restrict d, fpr *restrict c,
+	const fpr *restrict t0, const fpr *restrict t1,
+	const fpr *restrict z1, const fpr *restrict L,
+	unsigned logn, unsigned ter)
+{
+	size_t hn, u;
+
+	hn = (size_t)1 << (logn - 1);
+	for (u = 0; u < hn; u ++) {
+		fpr a_re, a_im;
+
+		if (ter) {
+			a_re = z1[u];
+			a_im = z1[u + hn];
+		} else {
+			a_re = fpr_sub(t1[u], z1[u]);
+			a_im = fpr_sub(t1[u + hn], z1[u + hn]);
+		}
+		FPC_MUL(a_re, a_im, a_re, a_im, L[u], L[u + hn]);
+		if (c != NULL) {
+			c[u] = a_re;
+			c[u + hn] = a_im;
+		}
+		d[u] = fpr_add(a_re, t0[u]);
+		d[u + hn] = fpr_add(a_im, t0[u + hn]);
 	}
+}
 
-	hn = n >> 1;
-	tree0 = tree + n;
-	tree1 = tree + n + ffLDL_treesize(logn - 1);
+/*
+ * Ternary case: z0 -= z1 * L, in one pass.
+ */
+static inline void
+ffs_sub_prod(fpr *restrict z0, const fpr *restrict z1,
+	const fpr *restrict L, unsigned logn)
+{
+	size_t hn, u;
 
-	/*
-	 * We split t1 into z1 (reused as temporary storage), then do
-	 * the recursive invocation, with output in tmp. We finally
-	 * merge back into z1.
-	 */
-	falcon_poly_split_fft(z1, z1 + hn, t1, logn);
-	ffSampling_fft(samp, samp_ctx, tmp, tmp + hn,
-		tree1, z1, z1 + hn, logn - 1, tmp + n);
-	falcon_poly_merge_fft(z1, tmp, tmp + hn, logn);
+	hn = (size_t)1 << (logn - 1);
+	for (u = 0; u < hn; u ++) {
+		fpr a_re, a_im;
 
-	/*
-	 * Compute tb0 = t0 + (t1 - z1) * L. Value tb0 ends up in tmp[].
-	 */
-	memcpy(tmp, t1, n * sizeof *t1);
-	falcon_poly_sub_fft(tmp, z1, logn);
-	falcon_poly_mul_fft(tmp, tree, logn);
-	falcon_poly_add_fft(tmp, t0, logn);
+		FPC_MUL(a_re, a_im, z1[u], z1[u + hn], L[u], L[u + hn]);
+		z0[u] = fpr_sub(z0[u], a_re);
+		z0[u + hn] = fpr_sub(z0[u + hn], a_im);
+	}
+}
 
-	/*
-	 * Second recursive invocation.
-	 */
-	falcon_poly_split_fft(z0, z0 + hn, tmp, logn);
-	ffSampling_fft(samp, samp_ctx, tmp, tmp + hn,
-		tree0, z0, z0 + hn, logn - 1, tmp + n);
-	falcon_poly_merge_fft(z0, tmp, tmp + hn, logn);
+/*
+ * Ternary leaf (logn = 0): sample one point of the (1, w) lattice.
+ */
+static inline void
+ffs_leaf0_fft3(samplerZ samp, void *samp_ctx,
+	fpr *z0, fpr *z1, fpr sigma, fpr r0, fpr r1)
+{
+	fpr rx;
+
+	r1 = fpr_sub(r1, fpr_of(
+		samp(samp_ctx, r1, fpr_mul(fpr_IW1I, sigma))));
+	rx = fpr_half(r1);
+	r0 = fpr_add(r0, rx);
+	r0 = fpr_sub(r0, fpr_of(
+		samp(samp_ctx, r0, sigma)));
+	r0 = fpr_sub(r0, rx);
+	*z0 = r0;
+	*z1 = r1;
+}
+
+/*
+ * logn = 1: t0 and t1 are one complex value each; tree[0] is the d11
+ * leaf, tree[1..2] is L, tree[3] is the d00 leaf.
+ */
+static inline void
+ffs_leaf1(samplerZ samp, void *samp_ctx,
+	fpr *restrict z0, fpr *restrict z1, const fpr *restrict tree,
+	const fpr *restrict t0, const fpr *restrict t1, unsigned ter)
+{
+	fpr x0, x1, y0, y1, z1_re, z1_im, c_re, c_im, d_re, d_im;
+
+	if (!ter) {
+		z1_re = fpr_of(samp(samp_ctx, t1[0], tree[0]));
+		z1_im = fpr_of(samp(samp_ctx, t1[1], tree[0]));
+		d_re = fpr_sub(t1[0], z1_re);
+		d_im = fpr_sub(t1[1], z1_im);
+		FPC_MUL(d_re, d_im, d_re, d_im, tree[1], tree[2]);
+		d_re = fpr_add(d_re, t0[0]);
+		d_im = fpr_add(d_im, t0[1]);
+		z0[0] = fpr_of(samp(samp_ctx, d_re, tree[3]));
+		z0[1] = fpr_of(samp(samp_ctx, d_im, tree[3]));
+		z1[0] = z1_re;
+		z1[1] = z1_im;
+		return;
+	}
+
+	x1 = fpr_mul(fpr_IW1I, t1[1]);
+	x0 = fpr_sub(t1[0], fpr_half(x1));
+	ffs_leaf0_fft3(samp, samp_ctx, &y0, &y1, tree[0], x0, x1);
+	z1_re = fpr_add(y0, fpr_mul(y1, fpr_W1R));
+	z1_im = fpr_mul(y1, fpr_W1I);
+	FPC_MUL(c_re, c_im, z1_re, z1_im, tree[1], tree[2]);
+	d_re = fpr_add(c_re, t0[0]);
+	d_im = fpr_add(c_im, t0[1]);
+	x1 = fpr_mul(fpr_IW1I, d_im);
+	x0 = fpr_sub(d_re, fpr_half(x1));
+	ffs_leaf0_fft3(samp, samp_ctx, &y0, &y1, tree[3], x0, x1);
+	z0[0] = fpr_sub(fpr_add(y0, fpr_mul(y1, fpr_W1R)), c_re);
+	z0[1] = fpr_sub(fpr_mul(y1, fpr_W1I), c_im);
+	z1[0] = z1_re;
+	z1[1] = z1_im;
+}
+
+static inline void
+ffs_leaf2(samplerZ samp, void *samp_ctx,
+	fpr *restrict z0, fpr *restrict z1, const fpr *restrict tree,
+	const fpr *restrict t0, const fpr *restrict t1, unsigned ter)
+{
+	fpr x0[2], x1[2], y0[2], y1[2], d[4], c[4];
+	const fpr *tw;
+
+	tw = ter ? falcon_gm3_square : falcon_gm_tab;
+	ffs_split(x0, x1, t1, 2, tw);
+	ffs_leaf1(samp, samp_ctx, y0, y1, tree, x0, x1, ter);
+	ffs_merge(z1, y0, y1, 2, tw);
+	ffs_target(d, ter ? c : NULL, t0, t1, z1, tree + 4, 2, ter);
+	ffs_split(x0, x1, d, 2, tw);
+	ffs_leaf1(samp, samp_ctx, y0, y1, tree + 8, x0, x1, ter);
+	ffs_merge(z0, y0, y1, 2, tw);
+	if (ter) {
+		falcon_poly_sub_fft3(z0, c, 2, 0);
+	}
+}
+
+static inline void
+ffs_leaf3(samplerZ samp, void *samp_ctx,
+	fpr *restrict z0, fpr *restrict z1, const fpr *restrict tree,
+	const fpr *restrict t0, const fpr *restrict t1, unsigned ter)
+{
+	fpr x0[4], x1[4], y0[4], y1[4], d[8], c[8];
+	const fpr *tw;
+
+	tw = ter ? falcon_gm3_square : falcon_gm_tab;
+	ffs_split(x0, x1, t1, 3, tw);
+	ffs_leaf2(samp, samp_ctx, y0, y1, tree, x0, x1, ter);
+	ffs_merge(z1, y0, y1, 3, tw);
+	ffs_target(d, ter ? c : NULL, t0, t1, z1, tree + 12, 3, ter);
+	ffs_split(x0, x1, d, 3, tw);
+	ffs_leaf2(samp, samp_ctx, y0, y1, tree + 20, x0, x1, ter);
+	ffs_merge(z0, y0, y1, 3, tw);
+	if (ter) {
+		falcon_poly_sub_fft3(z0, c, 3, 0);
+	}
 }
 
+/*
+ * Walk the levels above the fused kernels. A frame is a node whose
+ * d11 side is being sampled (left = 0) or whose d00 side is (left =
+ * 1); its child writes into tmp[] and works in tmp[] + 2^logn. logn is
+ * at most 10.
+ *
+ * tmp[] must have size for at least two polynomials of size 2^logn.
+ */
+typedef struct {
+	fpr *z0, *z1;
+	const fpr *t0, *t1, *tree;
+	fpr *tmp;
+	int left;
+} ffs_frame;
+
 static void
-ffSampling_inner_fft3(samplerZ samp, void *samp_ctx,
+ffs_walk(samplerZ samp, void *samp_ctx,
 	fpr *restrict z0, fpr *restrict z1,
 	const fpr *restrict tree,
-	const fpr *restrict t0, const fpr *restrict t1,
-	unsigned logn, fpr *restrict tmp)
+	const fpr *restrict t0, const fpr *restrict t1, unsigned logn,
+	fpr *restrict tmp, unsigned ter)
 {
+	ffs_frame st[10], *f, *c;
+	unsigned d, lg;
 	size_t n, hn;
-	fpr *x0, *x1, *y0, *y1;
-	const fpr *tree0, *tree1;
 
-	/*
-	 * For tree construction, recursion stopped at n = 2, but it
-	 * produced a tree which also covers n = 1. For sampling, we use
-	 * the fact that the split() and merge() function
-	 * implementations actually supports logn = 1.
-	 */
-	if (logn == 0) {
-		fpr r0, r1, rx;
-		fpr sigma;
-
-		sigma = tree[0];
-		r1 = *t1;
-		r0 = *t0;
-		r1 = fpr_sub(r1, fpr_of(
-			samp(samp_ctx, r1, fpr_mul(fpr_IW1I, sigma))));
-		rx = fpr_half(r1);
-		r0 = fpr_add(r0, rx);
-		r0 = fpr_sub(r0, fpr_of(
-			samp(samp_ctx, r0, sigma)));
-		r0 = fpr_sub(r0, rx);
-		*z0 = r0;
-		*z1 = r1;
+	switch (logn) {
+	case 1:
+		ffs_leaf1(samp, samp_ctx, z0, z1, tree, t0, t1, ter);
+		return;
+	case 2:
+		ffs_leaf2(samp, samp_ctx, z0, z1, tree, t0, t1, ter);
+		return;
+	case 3:
+		ffs_leaf3(samp, samp_ctx, z0, z1, tree, t0, t1, ter);
 		return;
 	}
 
-	n = (size_t)1 << logn;
-	hn = n >> 1;
-	y0 = tmp;
-	y1 = y0 + hn;
-
-	tree0 = tree + n;
-	tree1 = tree + n + (logn << (logn - 1));
+	f = &st[0];
+	f->z0 = z0;
+	f->z1 = z1;
+	f->t0 = t0;
+	f->t1 = t1;
+	f->tree = tree;
+	f->tmp = tmp;
+	d = 0;
+	for (;;) {
+		/*
+		 * Go down on the d11 side: split t1 into z1 (used as
+		 * temporary), which the child samples into tmp[].
+		 */
+		while ((lg = logn - d) > 3) {
+			f = &st[d];
+			hn = (size_t)1 << (lg - 1);
+			if (ter) {
+				falcon_poly_split_deep_fft3(f->z1, f->z1 + hn,
+					f->t1, lg);
+			} else {
+				falcon_poly_split_fft(f->z1, f->z1 + hn,
+					f->t1, lg);
+			}
+			FALCON_PREFETCH(f->tree + ffLDL_node(lg));
+			FALCON_PREFETCH(f->tree + ffLDL_sub0(lg));
+			f->left = 0;
+			c = f + 1;
+			c->z0 = f->tmp;
+			c->z1 = f->tmp + hn;
+			c->t0 = f->z1;
+			c->t1 = f->z1 + hn;
+			c->tree = f->tree;
+			c->tmp = f->tmp + (hn << 1);
+			d ++;
+		}
+		f = &st[d];
+		ffs_leaf3(samp, samp_ctx,
+			f->z0, f->z1, f->tree, f->t0, f->t1, ter);
 
-	/*
-	 * Split t1, recurse, merge into z1.
-	 */
-	x0 = z1;
-	x1 = x0 + hn;
-	falcon_poly_split_deep_fft3(x0, x1, t1, logn);
-	ffSampling_inner_fft3(samp, samp_ctx,
-		y0, y1, tree1, x0, x1, logn - 1, tmp + n);
-	falcon_poly_merge_deep_fft3(z1, y0, y1, logn);
+		/*
+		 * Go up: finish the nodes whose d00 side is done (merge
+		 * into z0), up to the first one whose d00 side remains.
+		 */
+		for (;;) {
+			if (d == 0) {
+				return;
+			}
+			f = &st[-- d];
+			lg = logn - d;
+			hn = (size_t)1 << (lg - 1);
+			if (!f->left) {
+				break;
+			}
+			if (ter) {
+				falcon_poly_merge_deep_fft3(f->z0,
+					f->tmp, f->tmp + hn, lg);
+				ffs_sub_prod(f->z0, f->z1,
+					f->tree + ffLDL_node(lg), lg);
+			} else {
+				falcon_poly_merge_fft(f->z0,
+					f->tmp, f->tmp + hn, lg);
+			}
+		}
 
-	/*
-	 * Compute t0b = t0 + z1 * l10 (into tmp[]).
-	 * FIXME: save z1 * l10 instead of recomputing it later on.
-	 */
-	memcpy(tmp, z1, n * sizeof *t1);
-	falcon_poly_mul_fft3(tmp, tree, logn, 0);
-	falcon_poly_add_fft3(tmp, t0, logn, 0);
+		/*
+		 * Merge z1, compute the d00 side target into tmp[],
+		 * split it into z0 and go down that side.
+		 */
+		n = hn << 1;
+		if (ter) {
+			falcon_poly_merge_deep_fft3(f->z1,
+				f->tmp, f->tmp + hn, lg);
+		} else {
+			falcon_poly_merge_fft(f->z1, f->tmp, f->tmp + hn, lg);
+		}
+		ffs_target(f->tmp, NULL, f->t0, f->t1, f->z1,
+			f->tree + ffLDL_node(lg), lg, ter);
+		if (ter) {
+			falcon_poly_split_deep_fft3(f->z0, f->z0 + hn,
+				f->tmp, lg);
+		} else {
+			falcon_poly_split_fft(f->z0, f->z0 + hn, f->tmp, lg);
+		}
+		f->left = 1;
+		c = f + 1;
+		c->z0 = f->tmp;
+		c->z1 = f->tmp + hn;
+		c->t0 = f->z0;
+		c->t1 = f->z0 + hn;
+		c->tree = f->tree + ffLDL_sub0(lg);
+		c->tmp = f->tmp + n;
+		d ++;
+	}
+}
 
-	/*
-	 * Split t0b, recurse, merge into z0.
-	 */
-	x0 = z0;
-	x1 = x0 + hn;
-	falcon_poly_split_deep_fft3(x0, x1, tmp, logn);
-	ffSampling_inner_fft3(samp, samp_ctx,
-		y0, y1, tree0, x0, x1, logn - 1, tmp + n);
-	falcon_poly_merge_deep_fft3(z0, y0, y1, logn);
+/*
+ * Perform Fast Fourier Sampling for target vector t and LDL tree T.
+ * tmp[] must have size for at least two polynomials of size 2^logn.
+ */
+static void
+ffSampling_fft(samplerZ samp, void *samp_ctx,
+	fpr *restrict z0, fpr *restrict z1,
+	const fpr *restrict tree,
+	const fpr *restrict t0, const fpr *restrict t1, unsigned logn,
+	fpr *restrict tmp)
+{
+	ffs_walk(samp, samp_ctx, z0, z1, tree, t0, t1, logn, tmp, 0);
+}
 
-	/*
-	 * Subtract z1 * l10 from z0.
-	 */
-	memcpy(tmp, z1, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree, logn, 0);
-	falcon_poly_sub_fft3(z0, tmp, logn, 0);
+static void
+ffSampling_inner_fft3(samplerZ samp, void *samp_ctx,
+	fpr *restrict z0, fpr *restrict z1,
+	const fpr *restrict tree,
+	const fpr *restrict t0, const fpr *restrict t1,
+	unsigned logn, fpr *restrict tmp)
+{
+	ffs_walk(samp, samp_ctx, z0, z1, tree, t0, t1, logn, tmp, 1);
 }
 
 static void
@@ -994,14 +1442,17 @@ ffSampling_depth1_fft3(samplerZ samp, void *samp_ctx,
 {
 	size_t n, hn;
 	fpr *x0, *x1, *y0, *y1;
-	const fpr *tree0, *tree1, *tree2;
+	const fpr *l10, *l20, *l21, *tree0, *tree1, *tree2;
 
 	n = (size_t)1 << logn;
 	hn = n >> 1;
 
-	tree0 = tree + 3 * n;
-	tree1 = tree0 + (logn << (logn - 1));
-	tree2 = tree1 + (logn << (logn - 1));
+	tree2 = tree;
+	l21 = tree2 + ((size_t)logn << (logn - 1));
+	tree1 = l21 + n;
+	l10 = tree1 + ((size_t)logn << (logn - 1));
+	l20 = l10 + n;
+	tree0 = l20 + n;
 	y0 = tmp;
 	y1 = y0 + hn;
 
@@ -1020,7 +1471,7 @@ ffSampling_depth1_fft3(samplerZ samp, void *samp_ctx,
 	 * FIXME: save z2 * l21 instead of recomputing it later on.
 	 */
 	memcpy(tmp, z2, n * sizeof *z2);
-	falcon_poly_mul_fft3(tmp, tree + 2 * n, logn, 0);
+	falcon_poly_mul_fft3(tmp, l21, logn, 0);
 	falcon_poly_add_fft3(tmp, t1, logn, 0);
 
 	/*
@@ -1033,7 +1484,7 @@ ffSampling_depth1_fft3(samplerZ samp, void *samp_ctx,
 		y0, y1, tree1, x0, x1, logn - 1, tmp + n);
 	falcon_poly_merge_deep_fft3(z1, y0, y1, logn);
 	memcpy(tmp, z2, n * sizeof *z2);
-	falcon_poly_mul_fft3(tmp, tree + 2 * n, logn, 0);
+	falcon_poly_mul_fft3(tmp, l21, logn, 0);
 	falcon_poly_sub_fft3(z1, tmp, logn, 0);
 
 	/*
@@ -1043,10 +1494,10 @@ ffSampling_depth1_fft3(samplerZ samp, void *samp_ctx,
 	 */
 	memcpy(z0, t0, n * sizeof *t0);
 	memcpy(tmp, z1, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree, logn, 0);
+	falcon_poly_mul_fft3(tmp, l10, logn, 0);
 	falcon_poly_add_fft3(z0, tmp, logn, 0);
 	memcpy(tmp, z2, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree + n, logn, 0);
+	falcon_poly_mul_fft3(tmp, l20, logn, 0);
 	falcon_poly_add_fft3(z0, tmp, logn, 0);
 
 	/*
@@ -1064,10 +1515,10 @@ ffSampling_depth1_fft3(samplerZ samp, void *samp_ctx,
 	 * Subtract z1 * l10 and z2 * l20 from z0.
 	 */
 	memcpy(tmp, z1, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree, logn, 0);
+	falcon_poly_mul_fft3(tmp, l10, logn, 0);
 	falcon_poly_sub_fft3(z0, tmp, logn, 0);
 	memcpy(tmp, z2, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree + n, logn, 0);
+	falcon_poly_mul_fft3(tmp, l20, logn, 0);
 	falcon_poly_sub_fft3(z0, tmp, logn, 0);
 }
 
@@ -1080,13 +1531,14 @@ ffSampling_fft3(samplerZ samp, void *samp_ctx,
 {
 	size_t n, tn;
 	fpr *x0, *x1, *x2, *y0, *y1, *y2;
-	const fpr *tree0, *tree1;
+	const fpr *l10, *tree0, *tree1;
 
 	n = (size_t)3 << (logn - 1);
 	tn = (size_t)1 << (logn - 1);
 
-	tree0 = tree + n;
-	tree1 = tree0 + 3 * ((logn + 1) << (logn - 2));
+	tree1 = tree;
+	l10 = tree1 + 3 * ((size_t)(logn + 1) << (logn - 2));
+	tree0 = l10 + n;
 	y0 = tmp;
 	y1 = y0 + tn;
 	y2 = y1 + tn;
@@ -1108,7 +1560,7 @@ ffSampling_fft3(samplerZ samp, void *samp_ctx,
 	 * FIXME: save z1 * L instead of recomputing it later on.
 	 */
 	memcpy(tmp, z1, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree, logn, 1);
+	falcon_poly_mul_fft3(tmp, l10, logn, 1);
 	falcon_poly_add_fft3(tmp, t0, logn, 1);
 
 	/*
@@ -1126,7 +1578,7 @@ ffSampling_fft3(samplerZ samp, void *samp_ctx,
 	 * Subtract z1 * L from z0.
 	 */
 	memcpy(tmp, z1, n * sizeof *z1);
-	falcon_poly_mul_fft3(tmp, tree, logn, 1);
+	falcon_poly_mul_fft3(tmp, l10, logn, 1);
 	falcon_poly_sub_fft3(z0, tmp, logn, 1);
 }
 
@@ -1146,7 +1598,6 @@ do_sign(samplerZ samp, void *samp_ctx,
 	size_t n, u;
 	fpr *t0, *t1, *tx, *ty, *tz;
 	const fpr *b00, *b01, *b10, *b11, *tree;
-	fpr ni;
 
 	n = MKN(logn, ter);
 	t0 = tmp;
@@ -1176,12 +1627,7 @@ do_sign(samplerZ samp, void *samp_ctx,
 		 * vector (after normalization with regards to modulus).
 		 */
 		falcon_FFT3(t0, logn, 1);
-		ni = fpr_inverse_of(q);
-		memcpy(t1, t0, n * sizeof *t0);
-		falcon_poly_mul_fft3(t1, b01, logn, 1);
-		falcon_poly_mulconst_fft3(t1, fpr_neg(ni), logn, 1);
-		falcon_poly_mul_fft3(t0, b11, logn, 1);
-		falcon_poly_mulconst_fft3(t0, ni, logn, 1);
+		target_fft(t0, t1, b01, b11, q, logn, 1);
 
 		/*
 		 * Apply sampling. Output is written back in [tx, ty].
@@ -1191,27 +1637,16 @@ do_sign(samplerZ samp, void *samp_ctx,
 		/*
 		 * Get the lattice point corresponding to that tiny vector.
 		 */
-		memcpy(t0, tx, n * sizeof *tx);
-		memcpy(t1, ty, n * sizeof *ty);
-		falcon_poly_mul_fft3(tx, b00, logn, 1);
-		falcon_poly_mul_fft3(ty, b10, logn, 1);
-		falcon_poly_add_fft3(tx, ty, logn, 1);
-		memcpy(ty, t0, n * sizeof *t0);
-		falcon_poly_mul_fft3(ty, b01, logn, 1);
-
-		memcpy(t0, tx, n * sizeof *tx);
-		falcon_poly_mul_fft3(t1, b11, logn, 1);
-		falcon_poly_add_fft3(t1, ty, logn, 1);
-
-		falcon_iFFT3(t0, logn, 1);
-		falcon_iFFT3(t1, logn, 1);
+		apply_basis_fft(tx, ty, b00, b01, b10, b11, logn, 1);
+		falcon_iFFT3(tx, logn, 1);
+		falcon_iFFT3(ty, logn, 1);
 
 		/*
 		 * Compute the signature.
 		 */
 		for (u = 0; u < n; u ++) {
-			s1[u] = (int16_t)fpr_rint(t0[u]);
-			s2[u] = (int16_t)fpr_rint(t1[u]);
+			s1[u] = (int16_t)fpr_rint(tx[u]);
+			s2[u] = (int16_t)fpr_rint(ty[u]);
 		}
 	} else {
 		/*
@@ -1219,12 +1654,7 @@ do_sign(samplerZ samp, void *samp_ctx,
 		 * vector (after normalization with regards to modulus).
 		 */
 		falcon_FFT(t0, logn);
-		ni = fpr_inverse_of(q);
-		memcpy(t1, t0, n * sizeof *t0);
-		falcon_poly_mul_fft(t1, b01, logn);
-		falcon_poly_mulconst_fft(t1, fpr_neg(ni), logn);
-		falcon_poly_mul_fft(t0, b11, logn);
-		falcon_poly_mulconst_fft(t0, ni, logn);
+		target_fft(t0, t1, b01, b11, q, logn, 0);
 
 		/*
 		 * Apply sampling. Output is written back in [tx, ty].
@@ -1234,65 +1664,203 @@ do_sign(samplerZ samp, void *samp_ctx,
 		/*
 		 * Get the lattice point corresponding to that tiny vector.
 		 */
-		memcpy(t0, tx, n * sizeof *tx);
-		memcpy(t1, ty, n * sizeof *ty);
-		falcon_poly_mul_fft(tx, b00, logn);
-		falcon_poly_mul_fft(ty, b10, logn);
-		falcon_poly_add(tx, ty, logn);
-		memcpy(ty, t0, n * sizeof *t0);
-		falcon_poly_mul_fft(ty, b01, logn);
-
-		memcpy(t0, tx, n * sizeof *tx);
-		falcon_poly_mul_fft(t1, b11, logn);
-		falcon_poly_add_fft(t1, ty, logn);
-
-		falcon_iFFT(t0, logn);
-		falcon_iFFT(t1, logn);
+		apply_basis_fft(tx, ty, b00, b01, b10, b11, logn, 0);
+		falcon_iFFT(tx, logn);
+		falcon_iFFT(ty, logn);
 
 		/*
 		 * Compute the signature.
 		 */
 		for (u = 0; u < n; u ++) {
-			s1[u] = (int16_t)(hm[u] - fpr_rint(t0[u]));
-			s2[u] = (int16_t)-fpr_rint(t1[u]);
+			s1[u] = (int16_t)(hm[u] - fpr_rint(tx[u]));
+			s2[u] = (int16_t)-fpr_rint(ty[u]);
 		}
 	}
 }
 
 /*
- * We have here three versions of gaussian0_sampler().
- *
- * The CoDF version maintains the to-be-returned value z as an integer,
- * and makes repeated samplings of 64-bit values; each of them is checked
- * against a tabulated value to decide whether z should be returned as
- * is, or z should be incremented and the process repeated.
- *
- * The CDF version obtains a random 128-bit value and finds it in the
- * tabulated distribution to directly return the sampled value.
- *
- * Since we follow a discrete Gaussian of standard deviation sigma0 = 2,
- * the average number of PRNG invocations in the CoDF variant should be
- * 2. The CDF variant always makes exactly 2 invocations of the PRNG.
- * Thus, the two variants should offer about the same performance.
- * Neither is constant-time, as implemented here, but the CDF variant
- * _could_ be made constant-time relatively easily by reading up the
- * whole table systematically.
+ * Fast Fourier Sampling without a precomputed tree ("dynamic" mode).
+ * The auto-adjoint matrix G = [[g00, g01], [adj(g01), g11]] (FFT
+ * representation) is decomposed level by level, in place, as the
+ * sampling recursion goes: the node's l10 and d11 are computed, the
+ * split halves of d00 and d11 become the quasicyclic Gram matrices of
+ * the two subtrees, and leaves are normalized with 'sigma' when
+ * reached. The operations are those of ffLDL_fft() followed by
+ * ffSampling_fft(), in the same order, so the signature is the same
+ * as with the tree, bit for bit.
  *
- * The third version (which is the default) is a CDF variant with a
- * fast test on the top bytes; this reduces the average number of bytes
- * obtained from the RNG.
+ * The target (t0, t1) is replaced with the sampled vector (z0, z1).
+ * g00, g01 and g11 are consumed. tmp[] must have room for at least
+ * four polynomials of size 2^logn.
  */
+static void
+ffSampling_dyn(samplerZ samp, void *samp_ctx,
+	fpr *restrict t0, fpr *restrict t1,
+	fpr *restrict g00, fpr *restrict g01, fpr *restrict g11,
+	fpr sigma, unsigned logn, fpr *restrict tmp)
+{
+	size_t n, hn;
+	fpr *z0, *z1;
 
-#if SAMPLER_CODF
+	if (logn == 0) {
+		fpr leaf;
 
-/*
- * Precomputed CoDF table, scaled to 2^64.
- *
- * We use distribution D(z) = exp(-(z^2)/(2*sigma0^2)), for integer z >= 0
- * and sigma0 = 2. CoDF is defined as:
- *   CoDF[z] = D(z) / (\sum_{i>=z} D(i))
- * i.e. CoDF[z] is the probability of getting exactly z, conditioned by
- * the probability of getting _at least_ z.
+		leaf = fpr_div(sigma, fpr_sqrt(g00[0]));
+		t0[0] = fpr_of(samp(samp_ctx, t0[0], leaf));
+		t1[0] = fpr_of(samp(samp_ctx, t1[0], leaf));
+		return;
+	}
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+
+	/*
+	 * LDL decomposition, as in LDL_fft(), in place: l10 goes to g01
+	 * and d11 to g11 (d00 is g00).
+	 */
+	memcpy(tmp, g01, n * sizeof *g01);
+	falcon_poly_div_fft(tmp, g00, logn);
+	memcpy(g01, tmp, n * sizeof *tmp);
+	falcon_poly_adj_fft(g01, logn);
+	falcon_poly_mul_fft(tmp, g01, logn);
+	falcon_poly_mul_fft(tmp, g00, logn);
+	falcon_poly_sub_fft(g11, tmp, logn);
+
+	/*
+	 * Split d00 and d11 in place, keep l10 in tmp[], and lay out the
+	 * half-size Gram matrices of the subtrees:
+	 *   left (d00):   g00, g00 + hn, g01
+	 *   right (d11):  g11, g11 + hn, g01 + hn
+	 */
+	falcon_poly_split_fft(tmp, tmp + hn, g00, logn);
+	memcpy(g00, tmp, n * sizeof *tmp);
+	falcon_poly_split_fft(tmp, tmp + hn, g11, logn);
+	memcpy(g11, tmp, n * sizeof *tmp);
+	memcpy(tmp, g01, n * sizeof *g01);
+	memcpy(g01, g00, hn * sizeof *g00);
+	memcpy(g01 + hn, g11, hn * sizeof *g11);
+
+	/*
+	 * First recursive invocation, on the split t1 and the right
+	 * subtree; z1 is merged into tmp + 2n.
+	 */
+	z1 = tmp + n;
+	falcon_poly_split_fft(z1, z1 + hn, t1, logn);
+	ffSampling_dyn(samp, samp_ctx, z1, z1 + hn,
+		g11, g11 + hn, g01 + hn, sigma, logn - 1, z1 + n);
+	falcon_poly_merge_fft(tmp + (n << 1), z1, z1 + hn, logn);
+
+	/*
+	 * tb0 = t0 + (t1 - z1) * l10, into t0; z1 goes to t1.
+	 */
+	memcpy(z1, t1, n * sizeof *t1);
+	falcon_poly_sub_fft(z1, tmp + (n << 1), logn);
+	memcpy(t1, tmp + (n << 1), n * sizeof *tmp);
+	falcon_poly_mul_fft(z1, tmp, logn);
+	falcon_poly_add_fft(z1, t0, logn);
+	memcpy(t0, z1, n * sizeof *z1);
+
+	/*
+	 * Second recursive invocation, on the split tb0 and the left
+	 * subtree.
+	 */
+	z0 = tmp;
+	falcon_poly_split_fft(z0, z0 + hn, t0, logn);
+	ffSampling_dyn(samp, samp_ctx, z0, z0 + hn,
+		g00, g00 + hn, g01, sigma, logn - 1, z0 + n);
+	falcon_poly_merge_fft(t0, z0, z0 + hn, logn);
+}
+
+/*
+ * Same as do_sign(), binary case only, with a private key that holds
+ * only the basis (the first four polynomials of the expanded key): the
+ * Gram matrix is recomputed, then decomposed during sampling.
+ *
+ * tmp[] must have room for at least nine polynomials.
+ */
+static void
+do_sign_dyn(samplerZ samp, void *samp_ctx,
+	int16_t *restrict s1, int16_t *restrict s2,
+	unsigned q, const fpr *restrict sk, const uint16_t *restrict hm,
+	unsigned logn, fpr *restrict tmp)
+{
+	size_t n, u;
+	fpr *t0, *t1, *g00, *g01, *g11, *tx;
+	const fpr *b00, *b01, *b10, *b11;
+
+	n = MKN(logn, 0);
+	t0 = tmp;
+	t1 = t0 + n;
+	g00 = t1 + n;
+	g01 = g00 + n;
+	g11 = g01 + n;
+	tx = g11 + n;
+	b00 = sk + skoff_b00(logn, 0);
+	b01 = sk + skoff_b01(logn, 0);
+	b10 = sk + skoff_b10(logn, 0);
+	b11 = sk + skoff_b11(logn, 0);
+
+	gram_fft(g00, g01, g11, b00, b01, b10, b11, logn);
+
+	/*
+	 * Target vector [hm, 0], through the basis, as in do_sign().
+	 */
+	for (u = 0; u < n; u ++) {
+		t0[u] = fpr_of(hm[u]);
+	}
+	falcon_FFT(t0, logn);
+	target_fft(t0, t1, b01, b11, q, logn, 0);
+
+	ffSampling_dyn(samp, samp_ctx, t0, t1, g00, g01, g11,
+		binary_sigma(q), logn, tx);
+
+	/*
+	 * Lattice point for the sampled vector (now in t0, t1).
+	 */
+	apply_basis_fft(t0, t1, b00, b01, b10, b11, logn, 0);
+	falcon_iFFT(t0, logn);
+	falcon_iFFT(t1, logn);
+
+	for (u = 0; u < n; u ++) {
+		s1[u] = (int16_t)(hm[u] - fpr_rint(t0[u]));
+		s2[u] = (int16_t)-fpr_rint(t1[u]);
+	}
+}
+
+/*
+ * We have here three versions of gaussian0_sampler().
+ *
+ * The CoDF version maintains the to-be-returned value z as an integer,
+ * and makes repeated samplings of 64-bit values; each of them is checked
+ * against a tabulated value to decide whether z should be returned as
+ * is, or z should be incremented and the process repeated.
+ *
+ * The CDF version obtains a random 128-bit value and finds it in the
+ * tabulated distribution to directly return the sampled value.
+ *
+ * Since we follow a discrete Gaussian of standard deviation sigma0 = 2,
+ * the average number of PRNG invocations in the CoDF variant should be
+ * 2. The CDF variant always makes exactly 2 invocations of the PRNG.
+ * Thus, the two variants should offer about the same performance.
+ * Neither is constant-time, as implemented here, but the CDF variant
+ * _could_ be made constant-time relatively easily by reading up the
+ * whole table systematically.
+ *
+ * The third version (which is the default) is a CDF variant with a
+ * fast test on the top bytes; this reduces the average number of bytes
+ * obtained from the RNG.
+ *
+ * All three are compiled in, along with both BerExp() variants; the
+ * combination is chosen at runtime (see "Sampler backends" below).
+ */
+
+/*
+ * Precomputed CoDF table, scaled to 2^64.
+ *
+ * We use distribution D(z) = exp(-(z^2)/(2*sigma0^2)), for integer z >= 0
+ * and sigma0 = 2. CoDF is defined as:
+ *   CoDF[z] = D(z) / (\sum_{i>=z} D(i))
+ * i.e. CoDF[z] is the probability of getting exactly z, conditioned by
+ * the probability of getting _at least_ z.
  *
  * Values below have been computed with 200 bits of precision, then
  * scaled up to 2^64, and rounded to the nearest integer. An extra
@@ -1319,7 +1887,7 @@ static const uint64_t CoDF[] = {
  * D(z) = exp(-(z^2)/(2*sigma0^2)) (with sigma0 = 2).
  */
 static int
-gaussian0_sampler(prng *p)
+gaussian0_sampler_codf(prng *p)
 {
 	int z;
 
@@ -1350,7 +1918,7 @@ static const uint64_t CoDF_large[] = {
 };
 
 static int
-gaussian0_sampler_large(prng *p)
+gaussian0_sampler_codf_large(prng *p)
 {
 	int z;
 
@@ -1361,8 +1929,6 @@ gaussian0_sampler_large(prng *p)
 	}
 }
 
-#elif SAMPLER_CDF
-
 /*
  * Precomputed CDF table, scaled to 2^128.
  *
@@ -1415,7 +1981,7 @@ static const z128 CDF[] = {
  * D(z) = exp(-(z^2)/(2*sigma0^2)) (with sigma0 = 2).
  */
 static int
-gaussian0_sampler(prng *p)
+gaussian0_sampler_cdf(prng *p)
 {
 	uint64_t hi, lo;
 	int z;
@@ -1472,7 +2038,7 @@ static const z128 CDF_large[] = {
 };
 
 static int
-gaussian0_sampler_large(prng *p)
+gaussian0_sampler_cdf_large(prng *p)
 {
 	uint64_t hi, lo;
 	int z;
@@ -1488,7 +2054,50 @@ gaussian0_sampler_large(prng *p)
 	}
 }
 
-#else
+/*
+ * Constant-time variants of gaussian0_sampler_cdf() and
+ * gaussian0_sampler_cdf_large(): same PRNG use and same output, but the
+ * whole table is scanned, with branchless 128-bit comparisons. Since
+ * the table is strictly decreasing (down to a final 0), the first z
+ * with v >= CDF[z] is also the number of entries greater than v.
+ */
+static inline int
+gaussian0_cdt_inner(prng *p, const z128 *tab, size_t num)
+{
+	uint64_t hi, lo;
+	size_t u;
+	int z;
+
+	hi = falcon_prng_get_u64(p);
+	lo = falcon_prng_get_u64(p);
+	z = 0;
+	for (u = 0; u < num - 1; u ++) {
+		uint64_t d, c;
+
+		/*
+		 * Borrow of (hi:lo) - tab[u]: 1 if v < tab[u].
+		 */
+		d = lo - tab[u].lo;
+		c = ((~lo & tab[u].lo) | ((~lo | tab[u].lo) & d)) >> 63;
+		d = hi - tab[u].hi - c;
+		c = ((~hi & tab[u].hi) | ((~hi | tab[u].hi) & d)) >> 63;
+		z += (int)c;
+	}
+	return z;
+}
+
+static int
+gaussian0_sampler_cdt(prng *p)
+{
+	return gaussian0_cdt_inner(p, CDF, sizeof CDF / sizeof CDF[0]);
+}
+
+static int
+gaussian0_sampler_cdt_large(prng *p)
+{
+	return gaussian0_cdt_inner(p, CDF_large,
+		sizeof CDF_large / sizeof CDF_large[0]);
+}
 
 /*
  * Partial precomputed CDF tables:
@@ -1503,10 +2112,6 @@ gaussian0_sampler_large(prng *p)
  * Values below have been computed with 256 bits of precision, then
  * scaled up to 2^136, and rounded to the nearest integer.
  */
-typedef struct {
-	uint64_t hi, lo;
-} z128;
-
 static const uint8_t CDF8[] = {
 	170u, 95u, 44u, 16u, 4u, 1u
 };
@@ -1550,7 +2155,7 @@ static const z128 CDF0[] = {
  * D(z) = exp(-(z^2)/(2*sigma0^2)) (with sigma0 = 2).
  */
 static int
-gaussian0_sampler(prng *p)
+gaussian0_sampler_cdf8(prng *p)
 {
 	uint8_t msb;
 	uint64_t hi, lo;
@@ -1651,7 +2256,7 @@ static const z128 CDF0_large[] = {
 };
 
 static int
-gaussian0_sampler_large(prng *p)
+gaussian0_sampler_cdf8_large(prng *p)
 {
 	uint8_t msb;
 	uint64_t hi, lo;
@@ -1688,15 +2293,12 @@ gaussian0_sampler_large(prng *p)
 	}
 }
 
-#endif
-
-#if CT_BEREXP
-
 /*
- * Sample a bit with probability exp(-x) for some x >= 0.
+ * Sample a bit with probability exp(-x) for some x >= 0. This version
+ * makes a constant number of PRNG invocations.
  */
 static int
-BerExp(prng *p, fpr x)
+BerExp_ct(prng *p, fpr x)
 {
 	int s;
 	fpr r;
@@ -1749,13 +2351,13 @@ BerExp(prng *p, fpr x)
 	return b;
 }
 
-#else
-
 /*
- * Sample a bit with probability exp(-x) for some x >= 0.
+ * Sample a bit with probability exp(-x) for some x >= 0. This version
+ * compares lazily, byte by byte, and thus makes a variable number of
+ * PRNG invocations (usually one).
  */
 static int
-BerExp(prng *p, fpr x)
+BerExp_lazy(prng *p, fpr x)
 {
 	int s, i;
 	fpr r;
@@ -1806,22 +2408,40 @@ BerExp(prng *p, fpr x)
 	return (int)(w >> 63);
 }
 
-#endif
+/*
+ * Context for the samplers: the PRNG, and counters for the rejection
+ * statistics (see falcon_sign_sampler_stats()).
+ */
+typedef struct {
+	prng p;
+	uint64_t draws;
+	uint64_t samples;
+} sampler_context;
 
 /*
  * The sampler produces a random integer that follows a discrete Gaussian
  * distribution, centered on mu, and with standard deviation sigma.
  * The value of sigma MUST lie between 1 and 2 (in Falcon, it should
- * always be between 1.2 and 1.9).
+ * always be between 1.2 and 1.9) for the normal samplers (sigma0 = 2),
+ * and up to sqrt(5) = 2.236... for the "large" ones (sigma0 = sqrt(5)),
+ * which are used in the ternary case.
+ *
+ * 'gauss0' is the half-Gaussian sampler for sigma0, 'berexp' the
+ * rejection bit sampler, and 'sigma0_sq2' is 2*sigma0^2 (8 or 10). This
+ * function is inlined in each backend below, with constant arguments,
+ * so that the calls to gauss0() and berexp() are direct calls.
  */
-static int
-sampler(void *ctx, fpr mu, fpr sigma)
+static inline int
+sampler_inner(void *ctx, fpr mu, fpr sigma,
+	int (*gauss0)(prng *p), int (*berexp)(prng *p, fpr x), int sigma0_sq2)
 {
+	sampler_context *sc;
 	prng *p;
 	int s;
 	fpr r, dss;
 
-	p = ctx;
+	sc = ctx;
+	p = &sc->p;
 
 	/*
 	 * The bimodal Gaussian used for rejection sampling uses
@@ -1860,9 +2480,10 @@ sampler(void *ctx, fpr mu, fpr sigma)
 		 *  - b = 0: z <= 0 and sampled against a Gaussian
 		 *    centered on 0.
 		 */
-		z = gaussian0_sampler(p);
+		z = gauss0(p);
 		b = falcon_prng_get_u8(p) & 1;
 		z = b + ((b << 1) - 1) * z;
+		sc->draws ++;
 
 		/*
 		 * Rejection sampling. We want a Gaussian centered on r;
@@ -1883,57 +2504,204 @@ sampler(void *ctx, fpr mu, fpr sigma)
 		 * where:
 		 *    x = ((z-r)^2)/(2*sigma^2) - ((z-b)^2)/(2*sigma0^2)
 		 *
-		 * Note that z and b are integer, and we set sigma0 = 2.
+		 * Note that z and b are integer.
 		 */
 		x = fpr_mul(fpr_sqr(fpr_sub(fpr_of(z), r)), dss);
-		x = fpr_sub(x, fpr_div(fpr_of((z - b) * (z - b)), fpr_of(8)));
-		if (BerExp(p, x)) {
+		x = fpr_sub(x, fpr_div(fpr_of((z - b) * (z - b)),
+			fpr_of(sigma0_sq2)));
+		if (berexp(p, x)) {
 			/*
 			 * Rejection sampling was centered on r, but the
 			 * actual center is mu = s + r.
 			 */
+			sc->samples ++;
 			return s + z;
 		}
 	}
 }
 
+/* ==================================================================== */
 /*
- * This alternate sampler implementation accepts larger standard
- * deviations, up to sqrt(5) = 2.236...
- * It should be used for the ternary case.
+ * Sampler backends.
+ *
+ * A backend is a combination of a half-Gaussian sampler (CDF8, CDF or
+ * CoDF, see above) and a BerExp() variant (lazy or constant number of
+ * PRNG invocations). Each one comes as a pair of samplerZ functions,
+ * for sigma0 = 2 and sigma0 = sqrt(5).
+ *
+ * The process-wide default is the backend selected at compile time by
+ * SAMPLER_CODF, SAMPLER_CDF and CT_BEREXP; outside of SGX, it can be
+ * replaced at the first falcon_sign_new() through the FALCON_SAMPLER
+ * environment variable (a backend name, or "auto" / "auto-ct" to run
+ * falcon_sampler_autotune()). Individual contexts can then switch with
+ * falcon_sign_set_sampler().
  */
-static int
-sampler_large(void *ctx, fpr mu, fpr sigma)
+
+#define SAMPLER_BACKEND(name, g0, g0_large, berexp) \
+static int \
+sampler_ ## name(void *ctx, fpr mu, fpr sigma) \
+{ \
+	return sampler_inner(ctx, mu, sigma, g0, berexp, 8); \
+} \
+static int \
+sampler_large_ ## name(void *ctx, fpr mu, fpr sigma) \
+{ \
+	return sampler_inner(ctx, mu, sigma, g0_large, berexp, 10); \
+}
+
+SAMPLER_BACKEND(cdf8_lazy, gaussian0_sampler_cdf8,
+	gaussian0_sampler_cdf8_large, BerExp_lazy)
+SAMPLER_BACKEND(cdf8_ct, gaussian0_sampler_cdf8,
+	gaussian0_sampler_cdf8_large, BerExp_ct)
+SAMPLER_BACKEND(cdf_lazy, gaussian0_sampler_cdf,
+	gaussian0_sampler_cdf_large, BerExp_lazy)
+SAMPLER_BACKEND(cdf_ct, gaussian0_sampler_cdf,
+	gaussian0_sampler_cdf_large, BerExp_ct)
+SAMPLER_BACKEND(codf_lazy, gaussian0_sampler_codf,
+	gaussian0_sampler_codf_large, BerExp_lazy)
+SAMPLER_BACKEND(codf_ct, gaussian0_sampler_codf,
+	gaussian0_sampler_codf_large, BerExp_ct)
+SAMPLER_BACKEND(cdt_ct, gaussian0_sampler_cdt,
+	gaussian0_sampler_cdt_large, BerExp_ct)
+
+typedef struct {
+	const char *name;
+	samplerZ samp;
+	samplerZ samp_large;
+	/* Non-zero if the number of PRNG invocations per sampled
+	   candidate is constant; only these backends are autotuned. */
+	int ct;
+} sampler_backend;
+
+/*
+ * Order matters: for the first six, index is 2*table + (BerExp is CT),
+ * see SAMPLER_DEFAULT. cdf-ct and cdt-ct produce the same samples from
+ * the same PRNG stream, and differ only in how the table is scanned.
+ */
+static const sampler_backend sampler_backends[] = {
+	{ "cdf8-lazy", sampler_cdf8_lazy, sampler_large_cdf8_lazy, 0 },
+	{ "cdf8-ct",   sampler_cdf8_ct,   sampler_large_cdf8_ct,   0 },
+	{ "cdf-lazy",  sampler_cdf_lazy,  sampler_large_cdf_lazy,  0 },
+	{ "cdf-ct",    sampler_cdf_ct,    sampler_large_cdf_ct,    1 },
+	{ "codf-lazy", sampler_codf_lazy, sampler_large_codf_lazy, 0 },
+	{ "codf-ct",   sampler_codf_ct,   sampler_large_codf_ct,   0 },
+	{ "cdt-ct",    sampler_cdt_ct,    sampler_large_cdt_ct,    1 }
+};
+
+#define SAMPLER_NUM   (sizeof sampler_backends / sizeof sampler_backends[0])
+
+#define SAMPLER_DEFAULT \
+	((SAMPLER_CODF ? 4 : SAMPLER_CDF ? 2 : 0) + (CT_BEREXP ? 1 : 0))
+
+/*
+ * Process-wide default; NULL until first resolved. It is read and
+ * written atomically, and resolved from the environment only once.
+ */
+static const sampler_backend *default_backend = NULL;
+static int default_backend_once;
+
+static const sampler_backend *
+find_backend(const char *name)
 {
-	/*
-	 * See sampler() for comments.
-	 * The two only changes here are:
-	 *  - gaussian0_sampler_large() instead of gaussian0_sampler()
-	 *  - sigma0 = sqrt(5) instead of 2, so 2*sigma0^2 = 10.
-	 */
-	prng *p;
-	int s;
-	fpr r, dss;
+	size_t u;
 
-	p = ctx;
+	for (u = 0; u < SAMPLER_NUM; u ++) {
+		if (strcmp(sampler_backends[u].name, name) == 0) {
+			return &sampler_backends[u];
+		}
+	}
+	return NULL;
+}
 
-	s = fpr_floor(mu);
-	r = fpr_sub(mu, fpr_of(s));
-	dss = fpr_inv(fpr_mul(fpr_sqr(sigma), fpr_of(2)));
+static void
+set_default_backend(const sampler_backend *b)
+{
+	__atomic_store_n(&default_backend, b, __ATOMIC_RELEASE);
+}
 
-	for (;;) {
-		int z, b;
-		fpr x;
+#ifndef USE_SGX
+static const sampler_backend *autotune(void);
+#endif
 
-		z = gaussian0_sampler_large(p);
-		b = falcon_prng_get_u8(p) & 1;
-		z = b + ((b << 1) - 1) * z;
-		x = fpr_mul(fpr_sqr(fpr_sub(fpr_of(z), r)), dss);
-		x = fpr_sub(x, fpr_div(fpr_of((z - b) * (z - b)), fpr_of(10)));
-		if (BerExp(p, x)) {
-			return s + z;
+static const sampler_backend *
+get_default_backend(void)
+{
+	const sampler_backend *b;
+
+	b = __atomic_load_n(&default_backend, __ATOMIC_ACQUIRE);
+	if (b != NULL) {
+		return b;
+	}
+	if (falcon_once_begin(&default_backend_once)) {
+		const sampler_backend *none;
+
+		b = &sampler_backends[SAMPLER_DEFAULT];
+#ifndef USE_SGX
+		{
+			const char *env;
+
+			env = getenv("FALCON_SAMPLER");
+			if (env != NULL && *env != 0) {
+				const sampler_backend *e;
+
+				if (strcmp(env, "auto") == 0
+					|| strcmp(env, "auto-ct") == 0)
+				{
+					e = autotune();
+				} else {
+					e = find_backend(env);
+				}
+				if (e != NULL) {
+					b = e;
+				}
+			}
 		}
+#endif
+		/*
+		 * An explicit falcon_sampler_set_default() that came
+		 * first wins.
+		 */
+		none = NULL;
+		__atomic_compare_exchange_n(&default_backend, &none, b, 0,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED);
+		falcon_once_end(&default_backend_once);
 	}
+	return __atomic_load_n(&default_backend, __ATOMIC_ACQUIRE);
+}
+
+/* see falcon.h */
+const char *
+falcon_sampler_name(unsigned index)
+{
+	return index < SAMPLER_NUM ? sampler_backends[index].name : NULL;
+}
+
+/* see falcon.h */
+int
+falcon_sampler_is_ct(unsigned index)
+{
+	return index < SAMPLER_NUM && sampler_backends[index].ct;
+}
+
+/* see falcon.h */
+int
+falcon_sampler_set_default(const char *name)
+{
+	const sampler_backend *b;
+
+	b = find_backend(name);
+	if (b == NULL) {
+		return 0;
+	}
+	set_default_backend(b);
+	return 1;
+}
+
+/* see falcon.h */
+const char *
+falcon_sampler_get_default(void)
+{
+	return get_default_backend()->name;
 }
 
 #if CLEANSE
@@ -1952,6 +2720,21 @@ cleanse(void *data, size_t len)
 }
 #endif
 
+/*
+ * Expanded private key: the basis in FFT representation and, unless
+ * 'tree' is zero, the LDL tree, as computed by load_skey(). It is never
+ * modified after expansion, so any number of signing contexts may share
+ * it.
+ */
+struct falcon_expanded_key_ {
+	unsigned q;
+	unsigned logn;
+	unsigned ternary;
+	int tree;
+	fpr *sk;
+	size_t sk_len;
+};
+
 struct falcon_sign_ {
 	/* Context for hashing the nonce + message. */
 	shake_context sc;
@@ -1963,27 +2746,69 @@ struct falcon_sign_ {
 	int seeded;
 	int flipped;
 
-	/* Private key elements. */
-	unsigned q;
-	unsigned logn;
-	unsigned ternary;
-	fpr *sk;
-	size_t sk_len;
+	/* Private key: 'key' is the key in use; 'own' is the same key
+	   when it was loaded with falcon_sign_set_private_key() (and is
+	   thus released with the context), NULL when it is borrowed.
+	   'tmp' is scratch space for signing, kept across key changes
+	   when large enough. */
+	const falcon_expanded_key *key;
+	falcon_expanded_key *own;
 	fpr *tmp;
 	size_t tmp_len;
+
+	/* FALCON_SIGN_TREE or FALCON_SIGN_DYNAMIC. */
+	int mode;
+
+	/* Sampler backend, and statistics since it was set. */
+	const sampler_backend *sampler;
+	uint64_t samp_draws;
+	uint64_t samp_samples;
+	uint64_t sign_attempts;
+	uint64_t sign_count;
 };
 
-static void
-clear_private(falcon_sign *fs)
+/*
+ * Sizes (in bytes) of the expanded key and of the signing scratch
+ * space.
+ */
+static size_t
+expanded_key_len(unsigned logn, unsigned ternary, int tree)
 {
-	if (fs->sk != NULL) {
-#if CLEANSE
-		cleanse(fs->sk, fs->sk_len);
-#endif
-		free(fs->sk);
-		fs->sk = NULL;
-		fs->sk_len = 0;
+	if (ternary) {
+		return ((size_t)(3 * (logn + 6)) << (logn - 1)) * sizeof(fpr);
+	} else if (tree) {
+		return ((size_t)(logn + 5) << logn) * sizeof(fpr);
+	} else {
+		return ((size_t)4 << logn) * sizeof(fpr);
 	}
+}
+
+static size_t
+sign_tmp_len(unsigned logn, unsigned ternary, int dyn)
+{
+	if (ternary) {
+		return ((size_t)21 << (logn - 1)) * sizeof(fpr);
+	} else if (dyn) {
+		return ((size_t)9 << logn) * sizeof(fpr);
+	} else {
+		return ((size_t)7 << logn) * sizeof(fpr);
+	}
+}
+
+/*
+ * Non-zero when signing with key 'ek' in this context goes through
+ * do_sign_dyn(): in dynamic mode, or when the key has no tree. Ternary
+ * keys always have a tree, and always use it.
+ */
+static int
+sign_dynamic(const falcon_sign *fs, const falcon_expanded_key *ek)
+{
+	return !ek->ternary && (fs->mode == FALCON_SIGN_DYNAMIC || !ek->tree);
+}
+
+static void
+clear_tmp(falcon_sign *fs)
+{
 	if (fs->tmp != NULL) {
 #if CLEANSE
 		cleanse(fs->tmp, fs->tmp_len);
@@ -1992,40 +2817,81 @@ clear_private(falcon_sign *fs)
 		fs->tmp = NULL;
 		fs->tmp_len = 0;
 	}
-	fs->q = 0;
-	fs->logn = 0;
-	fs->ternary = 0;
 }
 
-/* see falcon.h */
-falcon_sign *
-falcon_sign_new(void)
+static void
+clear_private(falcon_sign *fs)
+{
+	falcon_expanded_key_free(fs->own);
+	fs->own = NULL;
+	fs->key = NULL;
+}
+
+/*
+ * Make sure the scratch space is large enough for the given
+ * parameters. Returns 0 on allocation failure.
+ */
+static int
+ensure_tmp(falcon_sign *fs, const falcon_expanded_key *ek)
+{
+	size_t len;
+
+	len = sign_tmp_len(ek->logn, ek->ternary, sign_dynamic(fs, ek));
+	if (fs->tmp_len >= len) {
+		return 1;
+	}
+	clear_tmp(fs);
+	fs->tmp = malloc(len);
+	if (fs->tmp == NULL) {
+		return 0;
+	}
+	fs->tmp_len = len;
+	return 1;
+}
+
+/*
+ * Allocate a signing context that uses the given sampler backend.
+ */
+static falcon_sign *
+sign_new(const sampler_backend *sampler)
 {
 	falcon_sign *fs;
 
+	falcon_isa_init();
 	fs = malloc(sizeof *fs);
 	if (fs == NULL) {
 		return NULL;
 	}
 	fs->seeded = 0;
 	fs->flipped = 0;
-	fs->q = 0;
-	fs->logn = 0;
-	fs->ternary = 0;
-	fs->sk = NULL;
-	fs->sk_len = 0;
+	fs->key = NULL;
+	fs->own = NULL;
 	fs->tmp = NULL;
 	fs->tmp_len = 0;
+	fs->mode = FALCON_SIGN_TREE;
+	fs->sampler = sampler;
+	fs->samp_draws = 0;
+	fs->samp_samples = 0;
+	fs->sign_attempts = 0;
+	fs->sign_count = 0;
 	shake_init(&fs->rng, 512);
 	return fs;
 }
 
+/* see falcon.h */
+falcon_sign *
+falcon_sign_new(void)
+{
+	return sign_new(get_default_backend());
+}
+
 /* see falcon.h */
 void
 falcon_sign_free(falcon_sign *fs)
 {
 	if (fs != NULL) {
 		clear_private(fs);
+		clear_tmp(fs);
 		free(fs);
 	}
 }
@@ -2059,7 +2925,7 @@ rng_ready(falcon_sign *fs)
 	if (!fs->seeded) {
 		unsigned char tmp[32];
 
-		if (!falcon_get_seed(tmp, sizeof tmp)) {
+		if (!falcon_context_seed(tmp, sizeof tmp)) {
 			return 0;
 		}
 		falcon_sign_set_seed(fs, tmp, sizeof tmp, 0);
@@ -2072,23 +2938,32 @@ rng_ready(falcon_sign *fs)
 	return 1;
 }
 
-/* see falcon.h */
-int
-falcon_sign_set_private_key(falcon_sign *fs,
-	const void *skey, size_t len)
+/*
+ * Decode and expand a private key; the LDL tree is left out if
+ * 'with_tree' is zero (binary keys only).
+ */
+static falcon_expanded_key *
+expand_key(const void *skey, size_t len, int with_tree)
 {
+	falcon_expanded_key *ek;
 	const unsigned char *skey_buf;
 	int comp;
 	int16_t ske[4][1024];
+	fpr *tmp;
 	int i;
 	int fb, has_G;
 
-	/*
-	 * TODO: when reloading a new private key of the same size as
-	 * the currently allocated one, we could reuse the buffers
-	 * instead of releasing and reallocating them.
-	 */
-	clear_private(fs);
+	falcon_isa_init();
+	if (len < 1) {
+		return NULL;
+	}
+	ek = malloc(sizeof *ek);
+	if (ek == NULL) {
+		return NULL;
+	}
+	ek->sk = NULL;
+	ek->sk_len = 0;
+	tmp = NULL;
 
 	/*
 	 * First byte defines modulus, degree and compression:
@@ -2111,17 +2986,17 @@ falcon_sign_set_private_key(falcon_sign *fs,
 	skey_buf = skey;
 	fb = *skey_buf ++;
 	len --;
-	fs->logn = fb & 0x0F;
+	ek->logn = fb & 0x0F;
 	has_G = !(fb & 0x10);
-	fs->ternary = fb >> 7;
-	if (fs->ternary) {
-		fs->q = 18433;
-		if (fs->logn < 3 || fs->logn > 9) {
+	ek->ternary = fb >> 7;
+	if (ek->ternary) {
+		ek->q = 18433;
+		if (ek->logn < 3 || ek->logn > 9) {
 			goto bad_skey;
 		}
 	} else {
-		fs->q = 12289;
-		if (fs->logn < 1 || fs->logn > 10) {
+		ek->q = 12289;
+		if (ek->logn < 1 || ek->logn > 10) {
 			goto bad_skey;
 		}
 	}
@@ -2134,8 +3009,8 @@ falcon_sign_set_private_key(falcon_sign *fs,
 	for (i = 0; i < 3 + has_G; i ++) {
 		size_t elen;
 
-		elen = falcon_decode_small(ske[i], fs->logn,
-			comp, fs->q, skey_buf, len);
+		elen = falcon_decode_small(ske[i], ek->logn,
+			comp, ek->q, skey_buf, len);
 		if (elen == 0) {
 			goto bad_skey;
 		}
@@ -2151,7 +3026,7 @@ falcon_sign_set_private_key(falcon_sign *fs,
 	 */
 	if (!has_G) {
 		if (!falcon_complete_private(ske[3],
-			ske[0], ske[1], ske[2], fs->logn, fs->ternary))
+			ske[0], ske[1], ske[2], ek->logn, ek->ternary))
 		{
 			goto bad_skey;
 		}
@@ -2160,31 +3035,128 @@ falcon_sign_set_private_key(falcon_sign *fs,
 	/*
 	 * Perform pre-computations on private key.
 	 */
-	if (fs->ternary) {
-		fs->sk_len = ((size_t)(3 * (fs->logn + 6)) << (fs->logn - 1))
-			* sizeof(fpr);
-		fs->tmp_len = ((size_t)21 << (fs->logn - 1)) * sizeof(fpr);
-	} else {
-		fs->sk_len = ((size_t)(fs->logn + 5) << fs->logn)
-			* sizeof(fpr);
-		fs->tmp_len = ((size_t)7 << fs->logn) * sizeof(fpr);
-	}
-	fs->sk = malloc(fs->sk_len);
-	if (fs->sk == NULL) {
+	ek->tree = with_tree || ek->ternary;
+	ek->sk_len = expanded_key_len(ek->logn, ek->ternary, ek->tree);
+	ek->sk = malloc(ek->sk_len);
+	if (ek->sk == NULL) {
 		goto bad_skey;
 	}
-	fs->tmp = malloc(fs->tmp_len);
-	if (fs->tmp == NULL) {
+	tmp = malloc(sign_tmp_len(ek->logn, ek->ternary, 0));
+	if (tmp == NULL) {
 		goto bad_skey;
 	}
 
-	load_skey(fs->sk, fs->q, ske[0], ske[1], ske[2], ske[3],
-		fs->logn, fs->ternary, fs->tmp);
-	return 1;
+	load_skey(ek->sk, ek->q, ske[0], ske[1], ske[2], ske[3],
+		ek->logn, ek->ternary, ek->tree, tmp);
+#if CLEANSE
+	cleanse(tmp, sign_tmp_len(ek->logn, ek->ternary, 0));
+	cleanse(ske, sizeof ske);
+#endif
+	free(tmp);
+	return ek;
 
 bad_skey:
+	free(tmp);
+	falcon_expanded_key_free(ek);
+	return NULL;
+}
+
+/* see falcon.h */
+falcon_expanded_key *
+falcon_expanded_key_new(const void *skey, size_t len)
+{
+	return expand_key(skey, len, 1);
+}
+
+/* see falcon.h */
+falcon_expanded_key *
+falcon_expanded_key_new_dynamic(const void *skey, size_t len)
+{
+	return expand_key(skey, len, 0);
+}
+
+/* see falcon.h */
+void
+falcon_expanded_key_free(falcon_expanded_key *ek)
+{
+	if (ek != NULL) {
+		if (ek->sk != NULL) {
+#if CLEANSE
+			cleanse(ek->sk, ek->sk_len);
+#endif
+			free(ek->sk);
+		}
+		free(ek);
+	}
+}
+
+/* see falcon.h */
+unsigned
+falcon_expanded_key_logn(const falcon_expanded_key *ek)
+{
+	return ek->logn;
+}
+
+/* see falcon.h */
+int
+falcon_expanded_key_ternary(const falcon_expanded_key *ek)
+{
+	return (int)ek->ternary;
+}
+
+/* see falcon.h */
+int
+falcon_sign_set_private_key(falcon_sign *fs,
+	const void *skey, size_t len)
+{
+	falcon_expanded_key *ek;
+
 	clear_private(fs);
-	return 0;
+	ek = expand_key(skey, len, fs->mode != FALCON_SIGN_DYNAMIC);
+	if (ek == NULL) {
+		return 0;
+	}
+	if (!ensure_tmp(fs, ek)) {
+		falcon_expanded_key_free(ek);
+		return 0;
+	}
+	fs->own = ek;
+	fs->key = ek;
+	return 1;
+}
+
+/* see falcon.h */
+int
+falcon_sign_set_expanded_key(falcon_sign *fs, const falcon_expanded_key *ek)
+{
+	clear_private(fs);
+	if (!ensure_tmp(fs, ek)) {
+		return 0;
+	}
+	fs->key = ek;
+	return 1;
+}
+
+/* see falcon.h */
+int
+falcon_sign_set_mode(falcon_sign *fs, int mode)
+{
+	if (mode != FALCON_SIGN_TREE && mode != FALCON_SIGN_DYNAMIC) {
+		return 0;
+	}
+	fs->mode = mode;
+	if (fs->key != NULL && !ensure_tmp(fs, fs->key)) {
+		clear_private(fs);
+		return 0;
+	}
+	return 1;
+}
+
+/* see falcon.h */
+int
+falcon_sign_get_mode(const falcon_sign *fs)
+{
+	return fs->mode;
 }
 
 /* see falcon.h */
@@ -2222,10 +3194,13 @@ falcon_sign_generate(falcon_sign *fs, void *sig, size_t sig_max_len, int comp)
 	int16_t s1[1024], s2[1024];
 	unsigned char *sig_buf;
 	size_t sig_len;
+	const falcon_expanded_key *ek;
 
-	if (fs->sk == NULL) {
+	ek = fs->key;
+	if (ek == NULL) {
 		return 0;
 	}
+	FALCON_PROBE1(sign__start, ek->logn);
 	if (!rng_ready(fs)) {
 		return 0;
 	}
@@ -2233,7 +3208,7 @@ falcon_sign_generate(falcon_sign *fs, void *sig, size_t sig_max_len, int comp)
 		return 0;
 	}
 	shake_flip(&fs->sc);
-	falcon_hash_to_point(&fs->sc, fs->q, hm, fs->logn);
+	falcon_hash_to_point(&fs->sc, ek->q, hm, ek->logn);
 
 	for (;;) {
 		/*
@@ -2246,7 +3221,7 @@ falcon_sign_generate(falcon_sign *fs, void *sig, size_t sig_max_len, int comp)
 		 * (the verifier recomputes s1 from s2, the hashed message,
 		 * and the public key).
 		 */
-		prng p;
+		sampler_context sc;
 		samplerZ samp;
 		void *samp_ctx;
 
@@ -2254,15 +3229,24 @@ falcon_sign_generate(falcon_sign *fs, void *sig, size_t sig_max_len, int comp)
 		 * Normal sampling. We use a fast PRNG seeded from our
 		 * SHAKE context ('rng').
 		 */
-		falcon_prng_init(&p, &fs->rng, 0);
-		samp = fs->ternary ? sampler_large : sampler;
-		samp_ctx = &p;
+		falcon_prng_init(&sc.p, &fs->rng, 0);
+		sc.draws = 0;
+		sc.samples = 0;
+		samp = ek->ternary
+			? fs->sampler->samp_large : fs->sampler->samp;
+		samp_ctx = &sc;
 
 		/*
 		 * Do the actual signature.
 		 */
-		do_sign(samp, samp_ctx, s1, s2,
-			fs->q, fs->sk, hm, fs->logn, fs->ternary, fs->tmp);
+		if (sign_dynamic(fs, ek)) {
+			do_sign_dyn(samp, samp_ctx, s1, s2,
+				ek->q, ek->sk, hm, ek->logn, fs->tmp);
+		} else {
+			do_sign(samp, samp_ctx, s1, s2,
+				ek->q, ek->sk, hm, ek->logn, ek->ternary,
+				fs->tmp);
+		}
 
 		/*
 		 * Check that the norm is correct. With our chosen
@@ -2271,17 +3255,186 @@ falcon_sign_generate(falcon_sign *fs, void *sig, size_t sig_max_len, int comp)
 		 * end up with an invalidly large signature, in which
 		 * case we just loop.
 		 */
-		if (falcon_is_short(s1, s2, fs->logn, fs->ternary)) {
+		fs->samp_draws += sc.draws;
+		fs->samp_samples += sc.samples;
+		fs->sign_attempts ++;
+		if (falcon_is_short(s1, s2, ek->logn, ek->ternary)) {
 			break;
 		}
+		FALCON_PROBE1(sign__retry, ek->logn);
 	}
+	fs->sign_count ++;
 
 	sig_buf = sig;
 	sig_len = falcon_encode_small(sig_buf + 1, sig_max_len - 1,
-		comp, fs->q, s2, fs->logn);
+		comp, ek->q, s2, ek->logn);
 	if (sig_len == 0) {
+		FALCON_PROBE2(sign__done, ek->logn, 0);
 		return 0;
 	}
-	sig_buf[0] = (fs->ternary << 7) | (comp << 5) | fs->logn;
+	sig_buf[0] = (ek->ternary << 7) | (comp << 5) | ek->logn;
+	FALCON_PROBE2(sign__done, ek->logn, sig_len + 1);
 	return sig_len + 1;
 }
+
+/* see falcon.h */
+int
+falcon_sign_set_sampler(falcon_sign *fs, const char *name)
+{
+	const sampler_backend *b;
+
+	b = find_backend(name);
+	if (b == NULL) {
+		return 0;
+	}
+	fs->sampler = b;
+	fs->samp_draws = 0;
+	fs->samp_samples = 0;
+	fs->sign_attempts = 0;
+	fs->sign_count = 0;
+	return 1;
+}
+
+/* see falcon.h */
+const char *
+falcon_sign_get_sampler(const falcon_sign *fs)
+{
+	return fs->sampler->name;
+}
+
+/* see internal.h */
+void
+falcon_sign_sampler_stats(const falcon_sign *fs,
+	uint64_t *draws, uint64_t *samples,
+	uint64_t *attempts, uint64_t *signatures)
+{
+	*draws = fs->samp_draws;
+	*samples = fs->samp_samples;
+	*attempts = fs->sign_attempts;
+	*signatures = fs->sign_count;
+}
+
+/*
+ * Number of signatures per backend and per round in
+ * falcon_sampler_autotune(); each backend is timed over
+ * AUTOTUNE_ROUNDS rounds, interleaved, and its best round is kept.
+ */
+#define AUTOTUNE_SIGS     16
+#define AUTOTUNE_ROUNDS    3
+
+#ifndef USE_SGX
+
+/*
+ * Time signature generation with each backend that makes a constant
+ * number of PRNG invocations, and return the fastest one (NULL on
+ * error). The process-wide default is not used or changed, so that
+ * this can run while it is being resolved.
+ */
+static const sampler_backend *
+autotune(void)
+{
+	falcon_keygen *fk;
+	falcon_sign *fs;
+	unsigned char skey[6000], pkey[3000], sig[2049], nonce[40];
+	size_t skey_len, pkey_len;
+	double best[SAMPLER_NUM];
+	const sampler_backend *chosen;
+	size_t u;
+	int round, i;
+
+	/*
+	 * Time signatures with a throw-away degree-512 key. Seeds are
+	 * fixed, so that all backends sign the same messages with the
+	 * same PRNG streams.
+	 */
+	fk = falcon_keygen_new(9, 0);
+	if (fk == NULL) {
+		return NULL;
+	}
+	falcon_keygen_set_seed(fk, "autotune", 8, 1);
+	skey_len = sizeof skey;
+	pkey_len = sizeof pkey;
+	if (!falcon_keygen_make(fk, FALCON_COMP_STATIC,
+		skey, &skey_len, pkey, &pkey_len))
+	{
+		falcon_keygen_free(fk);
+		return NULL;
+	}
+	falcon_keygen_free(fk);
+
+	fs = sign_new(&sampler_backends[0]);
+	if (fs == NULL) {
+		return NULL;
+	}
+	if (!falcon_sign_set_private_key(fs, skey, skey_len)) {
+		falcon_sign_free(fs);
+		return NULL;
+	}
+
+	for (u = 0; u < SAMPLER_NUM; u ++) {
+		best[u] = -1.0;
+	}
+	for (round = 0; round < AUTOTUNE_ROUNDS; round ++) {
+		for (u = 0; u < SAMPLER_NUM; u ++) {
+			clock_t begin, end;
+			double tt;
+
+			if (!sampler_backends[u].ct) {
+				continue;
+			}
+			fs->sampler = &sampler_backends[u];
+			falcon_sign_set_seed(fs, "autotune", 8, 1);
+			begin = clock();
+			for (i = 0; i < AUTOTUNE_SIGS; i ++) {
+				falcon_sign_start(fs, nonce);
+				falcon_sign_update(fs, &i, sizeof i);
+				if (falcon_sign_generate(fs, sig, sizeof sig,
+					FALCON_COMP_STATIC) == 0)
+				{
+					falcon_sign_free(fs);
+					return NULL;
+				}
+			}
+			end = clock();
+			tt = (double)(end - begin);
+			if (best[u] < 0 || tt < best[u]) {
+				best[u] = tt;
+			}
+		}
+	}
+	falcon_sign_free(fs);
+
+	chosen = NULL;
+	for (u = 0; u < SAMPLER_NUM; u ++) {
+		if (best[u] >= 0 && (chosen == NULL
+			|| best[u] < best[chosen - sampler_backends]))
+		{
+			chosen = &sampler_backends[u];
+		}
+	}
+	return chosen;
+}
+
+#endif
+
+/* see falcon.h */
+const char *
+falcon_sampler_autotune(void)
+{
+#ifdef USE_SGX
+	/*
+	 * No usable clock inside an enclave: autotune on the host, and
+	 * pass the result to falcon_sampler_set_default().
+	 */
+	return NULL;
+#else
+	const sampler_backend *b;
+
+	b = autotune();
+	if (b == NULL) {
+		return NULL;
+	}
+	set_default_backend(b);
+	return b->name;
+#endif
+}
@@ -31,6 +31,10 @@
 
 #include "internal.h"
 
+#if FALCON_KERNELS_X86
+#include <immintrin.h>
+#endif
+
 /* ===================================================================== */
 /*
  * Constants for NTT.
@@ -796,11 +800,9 @@ mq_div_18433(uint32_t x, uint32_t y)
 	return mq_montymul(y18, x, Qt, Q0It);
 }
 
-/*
- * Compute NTT on a ring element, binary case.
- */
-static void
-mq_NTT_binary(uint16_t *a, unsigned logn)
+/* see internal.h */
+void
+falcon_NTT_ref(uint16_t *a, unsigned logn)
 {
 	size_t n, t, m;
 
@@ -829,11 +831,9 @@ mq_NTT_binary(uint16_t *a, unsigned logn)
 	}
 }
 
-/*
- * Compute the inverse NTT on a ring element, binary case.
- */
-static void
-mq_iNTT_binary(uint16_t *a, unsigned logn)
+/* see internal.h */
+void
+falcon_iNTT_ref(uint16_t *a, unsigned logn)
 {
 	size_t n, t, m;
 	uint32_t ni;
@@ -885,6 +885,195 @@ mq_iNTT_binary(uint16_t *a, unsigned logn)
 	}
 }
 
+#if FALCON_KERNELS_X86
+
+/*
+ * AVX2 variants of the binary NTT. Coefficients stay on 16 bits and
+ * 16 of them are processed at once in the layers where the butterfly
+ * span is at least 16; shorter layers use the scalar code. Montgomery
+ * multiplication splits x*y and k*q into low and high halves: the low
+ * halves add up to 0 modulo 2^16, with a carry exactly when the low
+ * half of x*y is non-zero. Results are identical to the reference.
+ */
+
+__attribute__((target("avx2")))
+static inline __m256i
+mq_montymul_avx2(__m256i x, __m256i y)
+{
+	__m256i lo, hi, m, q, z;
+
+	q = _mm256_set1_epi16(Qb);
+	lo = _mm256_mullo_epi16(x, y);
+	hi = _mm256_mulhi_epu16(x, y);
+	m = _mm256_mullo_epi16(lo, _mm256_set1_epi16((int16_t)Q0Ib));
+	z = _mm256_add_epi16(hi, _mm256_mulhi_epu16(m, q));
+	z = _mm256_add_epi16(z, _mm256_set1_epi16(1));
+	z = _mm256_add_epi16(z,
+		_mm256_cmpeq_epi16(lo, _mm256_setzero_si256()));
+	z = _mm256_sub_epi16(z, q);
+	return _mm256_add_epi16(z,
+		_mm256_and_si256(q, _mm256_srai_epi16(z, 15)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i
+mq_add_avx2(__m256i x, __m256i y)
+{
+	__m256i q, d;
+
+	q = _mm256_set1_epi16(Qb);
+	d = _mm256_sub_epi16(_mm256_add_epi16(x, y), q);
+	return _mm256_add_epi16(d,
+		_mm256_and_si256(q, _mm256_srai_epi16(d, 15)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i
+mq_sub_avx2(__m256i x, __m256i y)
+{
+	__m256i q, d;
+
+	q = _mm256_set1_epi16(Qb);
+	d = _mm256_sub_epi16(x, y);
+	return _mm256_add_epi16(d,
+		_mm256_and_si256(q, _mm256_srai_epi16(d, 15)));
+}
+
+/* see internal.h */
+__attribute__((target("avx2")))
+void
+falcon_NTT_avx2(uint16_t *a, unsigned logn)
+{
+	size_t n, t, m;
+
+	n = (size_t)1 << logn;
+	t = n;
+	for (m = 1; m < n; m <<= 1) {
+		size_t ht, i, j1;
+
+		ht = t >> 1;
+		for (i = 0, j1 = 0; i < m; i ++, j1 += t) {
+			size_t j, j2;
+			uint32_t s;
+
+			s = GMb[m + i];
+			j2 = j1 + ht;
+			if (ht >= 16) {
+				__m256i vs;
+
+				vs = _mm256_set1_epi16((int16_t)s);
+				for (j = j1; j < j2; j += 16) {
+					__m256i u, v;
+
+					u = _mm256_loadu_si256(
+						(const __m256i *)(a + j));
+					v = _mm256_loadu_si256(
+						(const __m256i *)(a + j + ht));
+					v = mq_montymul_avx2(v, vs);
+					_mm256_storeu_si256((__m256i *)(a + j),
+						mq_add_avx2(u, v));
+					_mm256_storeu_si256(
+						(__m256i *)(a + j + ht),
+						mq_sub_avx2(u, v));
+				}
+			} else {
+				for (j = j1; j < j2; j ++) {
+					uint32_t u, v;
+
+					u = a[j];
+					v = mq_montymul(a[j + ht],
+						s, Qb, Q0Ib);
+					a[j] = (uint16_t)mq_add(u, v, Qb);
+					a[j + ht] = (uint16_t)
+						mq_sub(u, v, Qb);
+				}
+			}
+		}
+		t = ht;
+	}
+	_mm256_zeroupper();
+}
+
+/* see internal.h */
+__attribute__((target("avx2")))
+void
+falcon_iNTT_avx2(uint16_t *a, unsigned logn)
+{
+	size_t n, t, m;
+	uint32_t ni;
+
+	n = (size_t)1 << logn;
+	t = 1;
+	m = n;
+	while (m > 1) {
+		size_t hm, dt, i, j1;
+
+		hm = m >> 1;
+		dt = t << 1;
+		for (i = 0, j1 = 0; i < hm; i ++, j1 += dt) {
+			size_t j, j2;
+			uint32_t s;
+
+			j2 = j1 + t;
+			s = iGMb[hm + i];
+			if (t >= 16) {
+				__m256i vs;
+
+				vs = _mm256_set1_epi16((int16_t)s);
+				for (j = j1; j < j2; j += 16) {
+					__m256i u, v;
+
+					u = _mm256_loadu_si256(
+						(const __m256i *)(a + j));
+					v = _mm256_loadu_si256(
+						(const __m256i *)(a + j + t));
+					_mm256_storeu_si256((__m256i *)(a + j),
+						mq_add_avx2(u, v));
+					_mm256_storeu_si256(
+						(__m256i *)(a + j + t),
+						mq_montymul_avx2(
+						mq_sub_avx2(u, v), vs));
+				}
+			} else {
+				for (j = j1; j < j2; j ++) {
+					uint32_t u, v, w;
+
+					u = a[j];
+					v = a[j + t];
+					a[j] = (uint16_t)mq_add(u, v, Qb);
+					w = mq_sub(u, v, Qb);
+					a[j + t] = (uint16_t)
+						mq_montymul(w, s, Qb, Q0Ib);
+				}
+			}
+		}
+		t = dt;
+		m = hm;
+	}
+
+	ni = Rb;
+	for (m = n; m > 1; m >>= 1) {
+		ni = mq_rshift1(ni, Qb);
+	}
+	m = 0;
+	if (n >= 16) {
+		__m256i vni;
+
+		vni = _mm256_set1_epi16((int16_t)ni);
+		for (; m < n; m += 16) {
+			_mm256_storeu_si256((__m256i *)(a + m),
+				mq_montymul_avx2(_mm256_loadu_si256(
+				(const __m256i *)(a + m)), vni));
+		}
+	}
+	for (; m < n; m ++) {
+		a[m] = (uint16_t)mq_montymul(a[m], ni, Qb, Q0Ib);
+	}
+	_mm256_zeroupper();
+}
+
+#endif
+
 /*
  * Compute NTT on a ring element, ternary case.
  */
@@ -1056,7 +1245,7 @@ mq_NTT(uint16_t *a, unsigned logn, int ternary)
 	if (ternary) {
 		mq_NTT_ternary(a, logn);
 	} else {
-		mq_NTT_binary(a, logn);
+		falcon_kernels.ntt(a, logn);
 	}
 }
 
@@ -1066,7 +1255,7 @@ mq_iNTT(uint16_t *a, unsigned logn, int ternary)
 	if (ternary) {
 		mq_iNTT_ternary(a, logn);
 	} else {
-		mq_iNTT_binary(a, logn);
+		falcon_kernels.intt(a, logn);
 	}
 }
 
@@ -1153,6 +1342,7 @@ falcon_vrfy_new(void)
 {
 	falcon_vrfy *fv;
 
+	falcon_isa_init();
 	fv = malloc(sizeof *fv);
 	if (fv == NULL) {
 		return NULL;
@@ -1316,9 +1506,8 @@ falcon_vrfy_verify_raw(const uint16_t *c0, const int16_t *s2,
 	return falcon_is_short((int16_t *)x, s2, logn, ternary);
 }
 
-/* see falcon.h */
-int
-falcon_vrfy_verify(falcon_vrfy *fv, const void *sig, size_t len)
+static int
+vrfy_verify_inner(falcon_vrfy *fv, const void *sig, size_t len)
 {
 	const unsigned char *sig_buf;
 	unsigned q;
@@ -1392,6 +1581,17 @@ falcon_vrfy_verify(falcon_vrfy *fv, const void *sig, size_t len)
 		c0, s2, fv->h, fv->logn, fv->ternary);
 }
 
+/* see falcon.h */
+int
+falcon_vrfy_verify(falcon_vrfy *fv, const void *sig, size_t len)
+{
+	int r;
+
+	r = vrfy_verify_inner(fv, sig, len);
+	FALCON_PROBE1(verify__result, r);
+	return r;
+}
+
 /* see internal.h */
 int
 falcon_compute_public(uint16_t *h,
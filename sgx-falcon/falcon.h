@@ -220,6 +220,74 @@ void falcon_sign_set_seed(falcon_sign *fs,
 int falcon_sign_set_private_key(falcon_sign *fs,
 	const void *skey, size_t len);
 
+/*
+ * Expanded private key.
+ *
+ * Loading a private key decodes it and precomputes the LDL tree, which
+ * is far more expensive than a signature for large degrees. An
+ * expanded key holds the result. It is read-only once created, so a
+ * single expanded key may be used by any number of signing contexts,
+ * including concurrently from several threads (each thread with its
+ * own falcon_sign context).
+ *
+ * falcon_expanded_key_new() returns NULL on invalid encoding or memory
+ * allocation failure. falcon_expanded_key_free() does nothing if 'ek'
+ * is NULL; the key must not be in use by any signing context.
+ */
+typedef struct falcon_expanded_key_ falcon_expanded_key;
+
+falcon_expanded_key *falcon_expanded_key_new(const void *skey, size_t len);
+void falcon_expanded_key_free(falcon_expanded_key *ek);
+
+/*
+ * Degree (log) and type (1 for ternary) of an expanded key.
+ */
+unsigned falcon_expanded_key_logn(const falcon_expanded_key *ek);
+int falcon_expanded_key_ternary(const falcon_expanded_key *ek);
+
+/*
+ * Use an expanded key for signature generation. The context does not
+ * take ownership: the key must stay alive as long as the context uses
+ * it. The context keeps its scratch buffer across key changes when it
+ * is large enough, so switching between keys of the same degree
+ * allocates nothing. Returned value is 1 on success, 0 on memory
+ * allocation failure.
+ */
+int falcon_sign_set_expanded_key(falcon_sign *fs,
+	const falcon_expanded_key *ek);
+
+/*
+ * Signing modes.
+ *
+ * FALCON_SIGN_TREE (the default) signs with the LDL tree precomputed in
+ * the expanded key: (logn+5)*2^logn floating-point values per key
+ * (120 kB for logn = 10), plus 7*2^logn in each context.
+ *
+ * FALCON_SIGN_DYNAMIC recomputes the LDL decomposition level by level
+ * during each signature, from the basis alone: 4*2^logn values per key
+ * (32 kB for logn = 10), plus 9*2^logn in each context, for a somewhat
+ * slower signature. Signatures are the same in both modes. Keys loaded
+ * with falcon_sign_set_private_key() in dynamic mode, and keys from
+ * falcon_expanded_key_new_dynamic(), have no tree; a context always
+ * signs dynamically with them. Dynamic mode applies to binary keys
+ * only; ternary keys always carry and use their tree.
+ *
+ * falcon_sign_set_mode() returns 1 on success, 0 on an unknown mode or
+ * on memory allocation failure (the context then has no key).
+ */
+#define FALCON_SIGN_TREE      0
+#define FALCON_SIGN_DYNAMIC   1
+
+int falcon_sign_set_mode(falcon_sign *fs, int mode);
+int falcon_sign_get_mode(const falcon_sign *fs);
+
+/*
+ * Expand a private key without its LDL tree, for dynamic signing.
+ * Same as falcon_expanded_key_new() for ternary keys.
+ */
+falcon_expanded_key *falcon_expanded_key_new_dynamic(const void *skey,
+	size_t len);
+
 /*
  * Reset the hashing mechanism for a new message. The "r" value shall
  * point to a 40-byte buffer, which is filled with a newly-generated
@@ -273,6 +341,70 @@ void falcon_sign_update(falcon_sign *fs, const void *data, size_t len);
 size_t falcon_sign_generate(falcon_sign *fs,
 	void *sig, size_t sig_max_len, int comp);
 
+/*
+ * Sampler backends.
+ *
+ * Signature generation samples discrete Gaussians with one of several
+ * interchangeable backends; all produce the same distribution, and
+ * differ in speed and in how regular their PRNG consumption is:
+ *
+ *   "cdf8-lazy"   CDF table with a fast test on the top byte, lazy
+ *                 rejection (default)
+ *   "cdf8-ct"     same table, constant PRNG use in the rejection step
+ *   "cdf-lazy"    full 128-bit CDF table, lazy rejection
+ *   "cdf-ct"      full 128-bit CDF table, constant PRNG use in the
+ *                 rejection step: constant number of PRNG invocations
+ *                 per sampled candidate
+ *   "codf-lazy"   CoDF table, lazy rejection
+ *   "codf-ct"     CoDF table, constant PRNG use in the rejection step
+ *   "cdt-ct"      as "cdf-ct" (same samples), but the table is always
+ *                 scanned in full, without data-dependent branches
+ *
+ * (The compile-time default can be changed with SAMPLER_CODF,
+ * SAMPLER_CDF and CT_BEREXP, see falcon-sign.c.)
+ *
+ * New contexts use the process-wide default backend. Outside of SGX,
+ * the first falcon_sign_new() reads the FALCON_SAMPLER environment
+ * variable: a backend name, or "auto" (also accepted as "auto-ct") to
+ * run falcon_sampler_autotune().
+ */
+
+/*
+ * Select the backend for this context, by name. Returned value is 1 on
+ * success, 0 if the name is unknown (the context is then unchanged).
+ */
+int falcon_sign_set_sampler(falcon_sign *fs, const char *name);
+
+/*
+ * Get the name of the backend used by this context.
+ */
+const char *falcon_sign_get_sampler(const falcon_sign *fs);
+
+/*
+ * Enumerate backends: name of backend 'index', or NULL if 'index' is out
+ * of range; and whether it makes a constant number of PRNG invocations.
+ */
+const char *falcon_sampler_name(unsigned index);
+int falcon_sampler_is_ct(unsigned index);
+
+/*
+ * Set or get the process-wide default backend, used by contexts created
+ * afterwards. falcon_sampler_set_default() returns 0 if the name is
+ * unknown. Contexts created concurrently with a change get either the
+ * old or the new default.
+ */
+int falcon_sampler_set_default(const char *name);
+const char *falcon_sampler_get_default(void);
+
+/*
+ * Time signature generation with each backend that makes a constant
+ * number of PRNG invocations (see falcon_sampler_is_ct(); others are
+ * never picked), make the fastest one the process-wide default, and
+ * return its name. This takes a few tens of milliseconds. Returns NULL
+ * on error, and always in an SGX enclave, which has no usable clock.
+ */
+const char *falcon_sampler_autotune(void);
+
 /* ==================================================================== */
 /*
  * Key generator.
@@ -377,6 +509,173 @@ int falcon_keygen_make(falcon_keygen *fk, int comp,
 	void *privkey, size_t *privkey_len,
 	void *pubkey, size_t *pubkey_len);
 
+/* ==================================================================== */
+/*
+ * Batch signing.
+ *
+ * A batch of N messages is signed with a single Falcon signature: each
+ * message is hashed into a leaf, the leaves form a Merkle tree (RFC 6962
+ * layout, SHAKE-256 truncated to 32 bytes), and only the root and the
+ * leaf count are signed. Each message then comes with an inclusion
+ * proof (at most ceil(log2 N) hashes) linking it to the signed root.
+ *
+ * Computing the leaves and the tree needs no secret, so it can be done
+ * outside the signer; the signer only needs the leaves (to compute the
+ * root itself) or the root.
+ */
+
+#define FALCON_BATCH_HASH_LEN   32
+
+/*
+ * Compute the leaf hash (FALCON_BATCH_HASH_LEN bytes) of a message.
+ */
+void falcon_batch_leaf(void *leaf, const void *msg, size_t len);
+
+/*
+ * Compute the root of the tree over 'count' leaves (concatenated in
+ * 'leaves'). This function uses no dynamic allocation. Returned value
+ * is 1 on success, 0 if 'count' is 0.
+ */
+int falcon_batch_root(void *root, const void *leaves, size_t count);
+
+/*
+ * Sign a batch root for a tree of 'count' leaves. The nonce (40 bytes)
+ * is generated as with falcon_sign_start(), and written in 'nonce'.
+ * Returned value is the signature length, or 0 on error (as with
+ * falcon_sign_generate()).
+ */
+size_t falcon_batch_sign(falcon_sign *fs, void *nonce,
+	const void *root, uint64_t count,
+	void *sig, size_t max_sig_len, int comp);
+
+/*
+ * Merkle tree with all its levels, for producing inclusion proofs.
+ */
+typedef struct falcon_batch_tree_ falcon_batch_tree;
+
+/*
+ * Build the tree over 'count' leaves. Returned value is NULL if 'count'
+ * is 0 or on allocation failure.
+ */
+falcon_batch_tree *falcon_batch_tree_new(const void *leaves, size_t count);
+
+/*
+ * Release a tree. If 'ft' is NULL then this function does nothing.
+ */
+void falcon_batch_tree_free(falcon_batch_tree *ft);
+
+/*
+ * Get the tree root (FALCON_BATCH_HASH_LEN bytes).
+ */
+void falcon_batch_tree_root(const falcon_batch_tree *ft, void *root);
+
+/*
+ * Write the inclusion proof of leaf 'index' in 'proof'. '*proof_len'
+ * must initially be set to the buffer size (64 * FALCON_BATCH_HASH_LEN
+ * bytes are always enough); on output, it is set to the proof length.
+ * Returned value is 1 on success, 0 if 'index' is out of range or the
+ * buffer is too small.
+ */
+int falcon_batch_tree_proof(const falcon_batch_tree *ft, size_t index,
+	void *proof, size_t *proof_len);
+
+/*
+ * Batch verification context. It remembers the last few roots whose
+ * signature verified under the current public key: checking another
+ * message of an already seen batch costs only its inclusion proof.
+ */
+typedef struct falcon_batch_vrfy_ falcon_batch_vrfy;
+
+/*
+ * Create and release a batch verification context. falcon_batch_vrfy_new()
+ * returns NULL on allocation failure; falcon_batch_vrfy_free() does
+ * nothing if 'bv' is NULL.
+ */
+falcon_batch_vrfy *falcon_batch_vrfy_new(void);
+void falcon_batch_vrfy_free(falcon_batch_vrfy *bv);
+
+/*
+ * Set the public key (as with falcon_vrfy_set_public_key()). This also
+ * forgets all verified roots.
+ */
+int falcon_batch_vrfy_set_public_key(falcon_batch_vrfy *bv,
+	const void *pkey, size_t len);
+
+/*
+ * Verify message 'msg' as element 'index' of a batch of 'count'
+ * messages, with its inclusion proof, and the batch root, nonce (40
+ * bytes) and signature. Returned value is 1 on success, 0 if the proof
+ * or the signature is invalid, or a negative value if the signature
+ * could not be decoded (as with falcon_vrfy_verify()). The signature
+ * is only checked if the root was not already verified.
+ */
+int falcon_batch_vrfy_verify(falcon_batch_vrfy *bv,
+	const void *msg, size_t msg_len,
+	uint64_t index, const void *proof, size_t proof_len,
+	const void *root, uint64_t count,
+	const void *nonce, const void *sig, size_t sig_len);
+
+/* ==================================================================== */
+/*
+ * CPU feature dispatch.
+ *
+ * On x86, native builds detect the CPU features once and pick, for each
+ * hot kernel (Keccak, ChaCha20, FFT, NTT), the fastest variant the CPU
+ * supports. Before a variant is used, it is run on known inputs and its
+ * output compared with the portable reference code; a variant that does
+ * not match exactly is discarded. All variants produce the same results
+ * as the portable code, so keys and signatures do not depend on the
+ * host. SGX enclaves always use the portable code.
+ *
+ * The FALCON_ISA environment variable restricts the features in use:
+ * "portable" (or "none"), or a comma-separated list of feature names
+ * (sse2, sse4.1, avx, avx2, fma, bmi2, aesni). Features the CPU lacks
+ * are never used.
+ */
+
+#define FALCON_ISA_SSE2     0x0001
+#define FALCON_ISA_SSE41    0x0002
+#define FALCON_ISA_AVX      0x0004
+#define FALCON_ISA_AVX2     0x0008
+#define FALCON_ISA_FMA      0x0010
+#define FALCON_ISA_BMI2     0x0020   /* BMI1 and BMI2 */
+#define FALCON_ISA_AESNI    0x0040
+
+/*
+ * Features supported by the CPU, and features that kernel selection
+ * may currently use.
+ */
+unsigned falcon_isa_detected(void);
+unsigned falcon_isa_enabled(void);
+
+/*
+ * Reselect all kernels using only the features in 'mask' (intersected
+ * with the detected ones), and return the resulting enabled set. This
+ * function is not thread-safe: call it at startup.
+ */
+unsigned falcon_isa_set(unsigned mask);
+
+/*
+ * Name of feature bit 'index' (0 for FALCON_ISA_SSE2...), or NULL if
+ * out of range.
+ */
+const char *falcon_isa_name(unsigned index);
+
+/*
+ * Enumerate kernels: name of kernel 'index', or NULL if 'index' is out
+ * of range; and name of the variant currently selected for it
+ * ("portable", "sse2", "avx2"...).
+ */
+const char *falcon_kernel_name(unsigned index);
+const char *falcon_kernel_variant(unsigned index);
+
+/*
+ * Number of kernel variants discarded by the self-test since startup.
+ * This should always be 0; anything else points at a compiler or CPU
+ * defect.
+ */
+unsigned falcon_isa_selftest_failures(void);
+
 /* ==================================================================== */
 
 #ifdef __cplusplus
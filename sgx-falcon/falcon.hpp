@@ -0,0 +1,381 @@
+#ifndef FALCON_HPP__
+#define FALCON_HPP__
+
+/*
+ * C++17 interface to the Falcon library (header-only).
+ *
+ * Thin, move-only owners of the C contexts in falcon.h, with the
+ * degree fixed at compile time: template parameter LogN (1 to 10 for
+ * binary Falcon, degree 2^LogN; 9 and 10 are the standard parameters)
+ * and Ternary (default false; if true, degree 1.5*2^LogN with LogN 2
+ * to 9, e.g. 9 for degree 768). All buffer sizes are then compile-time
+ * constants (falcon::params<LogN, Ternary>), and
+ * keys, signatures and nonces live in std::array members: once the
+ * objects are created, no operation allocates.
+ *
+ * Byte strings are passed as falcon::bytes, a non-owning (pointer,
+ * length) view implicitly built from arrays and contiguous containers,
+ * in the manner of std::span.
+ *
+ * Errors are reported as in the C API: factories return an empty
+ * std::optional, operations return false (or 0). Nothing throws.
+ *
+ * Typical use:
+ *
+ *   auto kg = falcon::KeyGenerator<9>::create();
+ *   falcon::KeyPair<9> kp;
+ *   kg->generate(kp);
+ *
+ *   auto ek = falcon::ExpandedKey<9>::load(kp.private_key());
+ *   auto signer = falcon::Signer<9>::create(*ek);  // one per thread
+ *   falcon::Signature<9> sig;
+ *   signer->sign(msg, sig);
+ *
+ *   auto vrfy = falcon::Verifier<9>::create(kp.public_key());
+ *   bool ok = vrfy->verify(msg, sig);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "falcon.h"
+
+namespace falcon {
+
+/*
+ * Non-owning view over bytes. Read-only views (bytes) convert from any
+ * contiguous container of byte-sized elements (std::vector,
+ * std::array, std::string...); writable views (mutable_bytes) from
+ * non-const ones.
+ */
+template <class T>
+class basic_bytes {
+ public:
+  constexpr basic_bytes() noexcept : ptr_(nullptr), len_(0) {}
+  constexpr basic_bytes(T *ptr, size_t len) noexcept : ptr_(ptr), len_(len)
+  {}
+  template <size_t N>
+  constexpr basic_bytes(T (&a)[N]) noexcept : ptr_(a), len_(N) {}
+  template <class C, class = std::enable_if_t<
+      sizeof(*std::declval<C &>().data()) == 1
+      && std::is_convertible<decltype(std::declval<C &>().data()),
+      const void *>::value
+      && (std::is_const<T>::value
+      || !std::is_const<std::remove_pointer_t<
+      decltype(std::declval<C &>().data())>>::value)>>
+  constexpr basic_bytes(C &c) noexcept
+      : ptr_(reinterpret_cast<T *>(c.data())), len_(c.size()) {}
+
+  constexpr T *data() const noexcept { return ptr_; }
+  constexpr size_t size() const noexcept { return len_; }
+  constexpr bool empty() const noexcept { return len_ == 0; }
+  constexpr basic_bytes first(size_t n) const noexcept
+  {
+    return basic_bytes(ptr_, n);
+  }
+
+ private:
+  T *ptr_;
+  size_t len_;
+};
+
+typedef basic_bytes<const uint8_t> bytes;
+typedef basic_bytes<uint8_t> mutable_bytes;
+
+/*
+ * Sizes for Falcon of degree 2^LogN (binary) or 1.5*2^LogN (ternary).
+ * Private keys and signatures are given for FALCON_COMP_NONE, which is
+ * the largest encoding; the default FALCON_COMP_STATIC output is
+ * shorter. 'header' is the first byte of a public key.
+ */
+template <unsigned LogN, bool Ternary = false>
+struct params {
+  static_assert(Ternary || (LogN >= 1 && LogN <= 10),
+      "binary logn must be between 1 and 10");
+  static_assert(!Ternary || (LogN >= 2 && LogN <= 9),
+      "ternary logn must be between 2 and 9");
+  static constexpr unsigned logn = LogN;
+  static constexpr bool ternary = Ternary;
+  static constexpr size_t degree = Ternary
+      ? size_t(3) << (LogN - 1) : size_t(1) << LogN;
+  static constexpr size_t private_key_size = 1 + (degree << 3);
+  // 14 bits per coefficient of h modulo 12289, 15 modulo 18433.
+  static constexpr size_t public_key_size = 1
+      + (((Ternary ? 15 : 14) * degree + 7) >> 3);
+  static constexpr size_t signature_size = 1 + 2 * degree;
+  static constexpr size_t nonce_size = 40;
+  static constexpr uint8_t header = uint8_t(LogN | (Ternary ? 0x80 : 0));
+};
+
+namespace detail {
+
+struct keygen_deleter {
+  void operator()(falcon_keygen *p) const noexcept { falcon_keygen_free(p); }
+};
+struct sign_deleter {
+  void operator()(falcon_sign *p) const noexcept { falcon_sign_free(p); }
+};
+struct vrfy_deleter {
+  void operator()(falcon_vrfy *p) const noexcept { falcon_vrfy_free(p); }
+};
+struct expanded_key_deleter {
+  void operator()(falcon_expanded_key *p) const noexcept
+  {
+    falcon_expanded_key_free(p);
+  }
+};
+
+} // namespace detail
+
+/*
+ * An encoded key pair, in fixed-size storage.
+ */
+template <unsigned LogN, bool Ternary = false>
+struct KeyPair {
+  typedef params<LogN, Ternary> P;
+
+  std::array<uint8_t, P::private_key_size> private_storage;
+  std::array<uint8_t, P::public_key_size> public_storage;
+  size_t private_size = 0;
+  size_t public_size = 0;
+
+  bytes private_key() const noexcept
+  {
+    return bytes(private_storage.data(), private_size);
+  }
+  bytes public_key() const noexcept
+  {
+    return bytes(public_storage.data(), public_size);
+  }
+};
+
+/*
+ * A signature and its nonce, in fixed-size storage.
+ */
+template <unsigned LogN, bool Ternary = false>
+struct Signature {
+  typedef params<LogN, Ternary> P;
+
+  std::array<uint8_t, P::signature_size> storage;
+  std::array<uint8_t, P::nonce_size> nonce;
+  size_t size = 0;
+
+  bytes value() const noexcept { return bytes(storage.data(), size); }
+};
+
+template <unsigned LogN, bool Ternary = false>
+class KeyGenerator {
+ public:
+  static std::optional<KeyGenerator> create()
+  {
+    falcon_keygen *fk = falcon_keygen_new(LogN, Ternary);
+    if (fk == nullptr)
+      return std::nullopt;
+    return KeyGenerator(fk);
+  }
+
+  // See falcon_keygen_set_seed().
+  void seed(bytes s, bool replace)
+  {
+    falcon_keygen_set_seed(fk_.get(), s.data(), s.size(), replace);
+  }
+
+  bool generate(KeyPair<LogN, Ternary> &kp, int comp = FALCON_COMP_STATIC)
+  {
+    kp.private_size = kp.private_storage.size();
+    kp.public_size = kp.public_storage.size();
+    if (falcon_keygen_make(fk_.get(), comp, kp.private_storage.data(),
+        &kp.private_size, kp.public_storage.data(), &kp.public_size) != 1) {
+      kp.private_size = kp.public_size = 0;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  explicit KeyGenerator(falcon_keygen *fk) : fk_(fk) {}
+  std::unique_ptr<falcon_keygen, detail::keygen_deleter> fk_;
+};
+
+/*
+ * Expanded private key (see falcon_expanded_key in falcon.h). Load it
+ * once, then share it, by const reference, between the Signers of all
+ * threads; it must outlive them.
+ */
+template <unsigned LogN, bool Ternary = false>
+class ExpandedKey {
+ public:
+  // Empty if the encoding is invalid or is not for this degree.
+  static std::optional<ExpandedKey> load(bytes private_key)
+  {
+    return wrap(falcon_expanded_key_new(private_key.data(),
+        private_key.size()));
+  }
+
+  // Same, without the LDL tree: 4/(LogN+5) of the size, for somewhat
+  // slower signatures (see FALCON_SIGN_DYNAMIC). Ternary keys keep
+  // their tree.
+  static std::optional<ExpandedKey> load_dynamic(bytes private_key)
+  {
+    return wrap(falcon_expanded_key_new_dynamic(private_key.data(),
+        private_key.size()));
+  }
+
+  const falcon_expanded_key *get() const noexcept { return ek_.get(); }
+
+ private:
+  static std::optional<ExpandedKey> wrap(falcon_expanded_key *ek)
+  {
+    if (ek == nullptr)
+      return std::nullopt;
+    if (falcon_expanded_key_logn(ek) != LogN
+        || (falcon_expanded_key_ternary(ek) != 0) != Ternary) {
+      falcon_expanded_key_free(ek);
+      return std::nullopt;
+    }
+    return ExpandedKey(ek);
+  }
+
+  explicit ExpandedKey(falcon_expanded_key *ek) : ek_(ek) {}
+  std::unique_ptr<falcon_expanded_key, detail::expanded_key_deleter> ek_;
+};
+
+/*
+ * Signing context: one per thread. It keeps its own RNG, hashing state
+ * and scratch space, and borrows an ExpandedKey.
+ */
+template <unsigned LogN, bool Ternary = false>
+class Signer {
+ public:
+  static std::optional<Signer> create(
+      const ExpandedKey<LogN, Ternary> &key)
+  {
+    falcon_sign *fs = falcon_sign_new();
+    if (fs == nullptr)
+      return std::nullopt;
+    Signer s(fs);
+    if (!s.set_key(key))
+      return std::nullopt;
+    return std::optional<Signer>(std::move(s));
+  }
+
+  // Switch keys; allocates nothing, unless going from keys with a
+  // tree to keys without (larger scratch space).
+  bool set_key(const ExpandedKey<LogN, Ternary> &key)
+  {
+    return falcon_sign_set_expanded_key(fs_.get(), key.get()) == 1;
+  }
+
+  // See falcon_sign_set_seed().
+  void seed(bytes s, bool replace)
+  {
+    falcon_sign_set_seed(fs_.get(), s.data(), s.size(), replace);
+  }
+
+  // See falcon_sign_set_sampler().
+  bool set_sampler(const char *name)
+  {
+    return falcon_sign_set_sampler(fs_.get(), name) == 1;
+  }
+
+  /*
+   * Sign a message given in one or more pieces (hashed in order).
+   */
+  template <class... Pieces>
+  bool sign(Signature<LogN, Ternary> &sig, int comp, bytes msg,
+      Pieces... more)
+  {
+    if (!falcon_sign_start(fs_.get(), sig.nonce.data()))
+      return false;
+    update(msg, more...);
+    sig.size = falcon_sign_generate(fs_.get(), sig.storage.data(),
+        sig.storage.size(), comp);
+    return sig.size != 0;
+  }
+
+  bool sign(bytes msg, Signature<LogN, Ternary> &sig)
+  {
+    return sign(sig, FALCON_COMP_STATIC, msg);
+  }
+
+  // Raw handle, for C functions such as falcon_batch_sign().
+  falcon_sign *get() noexcept { return fs_.get(); }
+
+ private:
+  explicit Signer(falcon_sign *fs) : fs_(fs) {}
+
+  void update() {}
+  template <class... Pieces>
+  void update(bytes piece, Pieces... more)
+  {
+    falcon_sign_update(fs_.get(), piece.data(), piece.size());
+    update(more...);
+  }
+
+  std::unique_ptr<falcon_sign, detail::sign_deleter> fs_;
+};
+
+/*
+ * Verification context, holding a decoded public key. Not thread-safe;
+ * use one per thread.
+ */
+template <unsigned LogN, bool Ternary = false>
+class Verifier {
+ public:
+  // Empty if the encoding is invalid or is not for this degree.
+  static std::optional<Verifier> create(bytes public_key)
+  {
+    if (public_key.size() != params<LogN, Ternary>::public_key_size
+        || public_key.data()[0] != params<LogN, Ternary>::header)
+      return std::nullopt;
+    falcon_vrfy *fv = falcon_vrfy_new();
+    if (fv == nullptr)
+      return std::nullopt;
+    Verifier v(fv);
+    if (falcon_vrfy_set_public_key(fv, public_key.data(),
+        public_key.size()) != 1)
+      return std::nullopt;
+    return std::optional<Verifier>(std::move(v));
+  }
+
+  /*
+   * Check a signature; the message may be given in pieces. See
+   * falcon_vrfy_verify() for the raw result codes.
+   */
+  template <class... Pieces>
+  int verify_raw(bytes nonce, bytes sig, bytes msg, Pieces... more)
+  {
+    falcon_vrfy_start(fv_.get(), nonce.data(), nonce.size());
+    update(msg, more...);
+    return falcon_vrfy_verify(fv_.get(), sig.data(), sig.size());
+  }
+
+  bool verify(bytes msg, const Signature<LogN, Ternary> &sig)
+  {
+    return verify_raw(bytes(sig.nonce), sig.value(), msg) == 1;
+  }
+
+  falcon_vrfy *get() noexcept { return fv_.get(); }
+
+ private:
+  explicit Verifier(falcon_vrfy *fv) : fv_(fv) {}
+
+  void update() {}
+  template <class... Pieces>
+  void update(bytes piece, Pieces... more)
+  {
+    falcon_vrfy_update(fv_.get(), piece.data(), piece.size());
+    update(more...);
+  }
+
+  std::unique_ptr<falcon_vrfy, detail::vrfy_deleter> fv_;
+};
+
+} // namespace falcon
+
+#endif
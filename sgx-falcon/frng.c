@@ -36,6 +36,10 @@
 
 #include "internal.h"
 
+#if FALCON_KERNELS_X86
+#include <immintrin.h>
+#endif
+
 /*
  * PRNG
  * ----
@@ -43,8 +47,9 @@
  * The Falcon implementation uses an architecture-specific PRNG for the
  * sampling (the PRNG is seeded from a SHAKE-256 instance, itself seeded
  * with hardware/OS bytes and/or user-provided seeds). This file contains
- * a single, portable PRNG based on ChaCha20. Other PRNG implementations,
- * e.g. using SSE2 or AES-NI intrinsics, could provide a speed-up.
+ * a PRNG based on ChaCha20, with a portable implementation and SSE2 and
+ * AVX2 implementations that compute 4 or 8 blocks in parallel and yield
+ * the same stream.
  *
  * (NIST_API_REMOVE_BEGIN)
  *
@@ -213,6 +218,158 @@ falcon_get_seed(void *seed, size_t len)
 	return 0;
 }
 
+/*
+ * Seed DRBG
+ * ---------
+ *
+ * Each signing or key generation context without an explicit seed used
+ * to read 32 bytes from the system RNG; in an enclave, that is one
+ * sgx_read_rand() call per context. Contexts now draw from a DRBG
+ * (see falcon_drbg_seed() in internal.h):
+ *
+ *   root (64 bytes)   --SHAKE-256-->   root', child key (32 bytes)
+ *   child key, len    --SHAKE-256-->   child key', output (len bytes)
+ *
+ * The root is mixed with a fresh system seed every DRBG_ROOT_RESEED
+ * child rekeys, and a child is rekeyed every DRBG_CHILD_RESEED draws.
+ * Children are claimed per draw with an atomic exchange on 'busy',
+ * starting from a rotating hint; thread-local storage is not an option,
+ * since enclave threads are not bound to a TCS. DRBG_SLOTS must exceed
+ * the number of concurrent callers for draws to never spin.
+ */
+
+#define DRBG_SLOTS           32
+#define DRBG_CHILD_RESEED    4096
+#define DRBG_ROOT_RESEED     256
+
+typedef struct {
+	int busy;
+	uint32_t draws;
+	unsigned char key[32];
+	unsigned char pad[24];
+} drbg_child;
+
+static drbg_child drbg_children[DRBG_SLOTS]
+	__attribute__((aligned(64)));
+static unsigned char drbg_root[64];
+static unsigned drbg_root_uses;
+static int drbg_root_lock;
+static unsigned drbg_hint;
+static uint64_t drbg_system_seeds;
+static uint64_t drbg_draws;
+
+static inline void
+drbg_relax(void)
+{
+#if __x86_64__ || __i386__
+	__builtin_ia32_pause();
+#endif
+}
+
+/*
+ * Derive a fresh child key from the root. Returned value is 1 on
+ * success, 0 on error.
+ */
+static int
+drbg_child_key(unsigned char *key)
+{
+	shake_context sc;
+	unsigned char tmp[64];
+	int ok;
+
+	while (__atomic_exchange_n(&drbg_root_lock, 1, __ATOMIC_ACQUIRE)) {
+		drbg_relax();
+	}
+	ok = 1;
+	shake_init(&sc, 512);
+	shake_inject(&sc, drbg_root, sizeof drbg_root);
+	if (drbg_root_uses == 0) {
+		if (falcon_get_seed(tmp, sizeof tmp)) {
+			shake_inject(&sc, tmp, sizeof tmp);
+			__atomic_add_fetch(&drbg_system_seeds, 1,
+				__ATOMIC_RELAXED);
+		} else {
+			ok = 0;
+		}
+	}
+	if (ok) {
+		tmp[0] = 0x01;
+		shake_inject(&sc, tmp, 1);
+		shake_flip(&sc);
+		shake_extract(&sc, drbg_root, sizeof drbg_root);
+		shake_extract(&sc, key, 32);
+		drbg_root_uses = (drbg_root_uses + 1) % DRBG_ROOT_RESEED;
+	}
+	__atomic_store_n(&drbg_root_lock, 0, __ATOMIC_RELEASE);
+	return ok;
+}
+
+/* see internal.h */
+int
+falcon_drbg_seed(void *seed, size_t len)
+{
+	shake_context sc;
+	drbg_child *c;
+	unsigned char tmp[4];
+	unsigned u;
+
+	u = __atomic_fetch_add(&drbg_hint, 1, __ATOMIC_RELAXED);
+	for (;; u ++) {
+		c = &drbg_children[u % DRBG_SLOTS];
+		if (!__atomic_load_n(&c->busy, __ATOMIC_RELAXED)
+			&& !__atomic_exchange_n(&c->busy, 1, __ATOMIC_ACQUIRE))
+		{
+			break;
+		}
+		if (u % DRBG_SLOTS == DRBG_SLOTS - 1) {
+			drbg_relax();
+		}
+	}
+
+	if (c->draws == 0 && !drbg_child_key(c->key)) {
+		__atomic_store_n(&c->busy, 0, __ATOMIC_RELEASE);
+		return 0;
+	}
+	tmp[0] = (unsigned char)len;
+	tmp[1] = (unsigned char)(len >> 8);
+	tmp[2] = (unsigned char)(len >> 16);
+	tmp[3] = (unsigned char)(len >> 24);
+	shake_init(&sc, 512);
+	shake_inject(&sc, c->key, sizeof c->key);
+	shake_inject(&sc, tmp, sizeof tmp);
+	shake_flip(&sc);
+	shake_extract(&sc, c->key, sizeof c->key);
+	shake_extract(&sc, seed, len);
+	c->draws = (c->draws + 1) % DRBG_CHILD_RESEED;
+	__atomic_store_n(&c->busy, 0, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&drbg_draws, 1, __ATOMIC_RELAXED);
+	return 1;
+}
+
+/* see internal.h */
+int
+falcon_context_seed(void *seed, size_t len)
+{
+#if FALCON_DRBG
+	return falcon_drbg_seed(seed, len);
+#else
+	return falcon_get_seed(seed, len);
+#endif
+}
+
+/* see internal.h */
+void
+falcon_drbg_stats(uint64_t *system_seeds, uint64_t *draws)
+{
+	if (system_seeds != NULL) {
+		*system_seeds = __atomic_load_n(&drbg_system_seeds,
+			__ATOMIC_RELAXED);
+	}
+	if (draws != NULL) {
+		*draws = __atomic_load_n(&drbg_draws, __ATOMIC_RELAXED);
+	}
+}
+
 /*
  * PRNG based on ChaCha20.
  *
@@ -224,8 +381,9 @@ falcon_get_seed(void *seed, size_t len)
  *
  * The block counter is XORed into the first 8 bytes of the IV.
  */
-static void
-refill_chacha20(prng *p)
+/* see internal.h */
+void
+falcon_chacha20_ref(prng *p)
 {
 	static const uint32_t CW[] = {
 		0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
@@ -304,14 +462,212 @@ refill_chacha20(prng *p)
 	*(uint64_t *)(p->state.d + 48) = cc;
 }
 
+#if FALCON_KERNELS_X86
+
+/*
+ * ChaCha20 quarter-round on vectors of 32-bit words. ROTL8/ROTL16 are
+ * the rotations by 8 and 16 bits, which AVX2 does with byte shuffles.
+ */
+#define CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, a, b, c, d) do { \
+		x[a] = add(x[a], x[b]); \
+		x[d] = rotl16(xor(x[d], x[a])); \
+		x[c] = add(x[c], x[d]); \
+		x[b] = rotl(xor(x[b], x[c]), 12); \
+		x[a] = add(x[a], x[b]); \
+		x[d] = rotl8(xor(x[d], x[a])); \
+		x[c] = add(x[c], x[d]); \
+		x[b] = rotl(xor(x[b], x[c]), 7); \
+	} while (0)
+
+#define CHACHA_DOUBLE_ROUND(add, xor, rotl, rotl8, rotl16)   do { \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 0, 4,  8, 12); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 1, 5,  9, 13); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 2, 6, 10, 14); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 3, 7, 11, 15); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 0, 5, 10, 15); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 1, 6, 11, 12); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 2, 7,  8, 13); \
+		CHACHA_QROUND(add, xor, rotl, rotl8, rotl16, 3, 4,  9, 14); \
+	} while (0)
+
+#define ROTL_SSE2(x, n) \
+	_mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+#define ROTL8_SSE2(x)    ROTL_SSE2(x, 8)
+#define ROTL16_SSE2(x)   ROTL_SSE2(x, 16)
+
+/* see internal.h */
+__attribute__((target("sse2")))
+void
+falcon_chacha20_sse2(prng *p)
+{
+	static const uint32_t CW[] = {
+		0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
+	};
+
+	const uint32_t *sw;
+	uint64_t cc;
+	size_t u;
+
+	/*
+	 * Lane k of x[i] is word i of block k; four consecutive blocks
+	 * (counter values cc to cc+3) are computed together.
+	 */
+	sw = (const uint32_t *)p->state.d;
+	cc = *(uint64_t *)(p->state.d + 48);
+	for (u = 0; u < sizeof p->buf.d; u += 256) {
+		__m128i x[16], y[16];
+		uint32_t c_lo[4], c_hi[4];
+		int i, k;
+
+		for (k = 0; k < 4; k ++) {
+			c_lo[k] = sw[10] ^ (uint32_t)(cc + (uint64_t)k);
+			c_hi[k] = sw[11] ^ (uint32_t)((cc + (uint64_t)k) >> 32);
+		}
+		for (i = 0; i < 4; i ++) {
+			y[i] = _mm_set1_epi32((int32_t)CW[i]);
+		}
+		for (i = 4; i < 14; i ++) {
+			y[i] = _mm_set1_epi32((int32_t)sw[i - 4]);
+		}
+		y[14] = _mm_loadu_si128((const __m128i *)c_lo);
+		y[15] = _mm_loadu_si128((const __m128i *)c_hi);
+		memcpy(x, y, sizeof x);
+		for (i = 0; i < 10; i ++) {
+			CHACHA_DOUBLE_ROUND(_mm_add_epi32, _mm_xor_si128,
+				ROTL_SSE2, ROTL8_SSE2, ROTL16_SSE2);
+		}
+		for (i = 0; i < 16; i ++) {
+			x[i] = _mm_add_epi32(x[i], y[i]);
+		}
+
+		/*
+		 * Transpose 4x4 groups of words back into blocks.
+		 */
+		for (i = 0; i < 16; i += 4) {
+			__m128i t0, t1, t2, t3;
+			unsigned char *dst;
+
+			t0 = _mm_unpacklo_epi32(x[i + 0], x[i + 1]);
+			t1 = _mm_unpacklo_epi32(x[i + 2], x[i + 3]);
+			t2 = _mm_unpackhi_epi32(x[i + 0], x[i + 1]);
+			t3 = _mm_unpackhi_epi32(x[i + 2], x[i + 3]);
+			dst = p->buf.d + u + (i << 2);
+			_mm_storeu_si128((__m128i *)(dst + 0),
+				_mm_unpacklo_epi64(t0, t1));
+			_mm_storeu_si128((__m128i *)(dst + 64),
+				_mm_unpackhi_epi64(t0, t1));
+			_mm_storeu_si128((__m128i *)(dst + 128),
+				_mm_unpacklo_epi64(t2, t3));
+			_mm_storeu_si128((__m128i *)(dst + 192),
+				_mm_unpackhi_epi64(t2, t3));
+		}
+		cc += 4;
+	}
+	*(uint64_t *)(p->state.d + 48) = cc;
+}
+
+#define ROTL_AVX2(x, n) \
+	_mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+#define ROTL8_AVX2(x)    _mm256_shuffle_epi8(x, r8)
+#define ROTL16_AVX2(x)   _mm256_shuffle_epi8(x, r16)
+
+/* see internal.h */
+__attribute__((target("avx2")))
+void
+falcon_chacha20_avx2(prng *p)
+{
+	static const uint32_t CW[] = {
+		0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
+	};
+
+	const uint32_t *sw;
+	uint64_t cc;
+	size_t u;
+	__m256i r8, r16;
+
+	r8 = _mm256_setr_epi8(
+		3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+		3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+	r16 = _mm256_setr_epi8(
+		2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+		2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+
+	/*
+	 * Same as the SSE2 code, with eight blocks. The unpack
+	 * instructions work within 128-bit halves, so the transposition
+	 * yields blocks k (low half) and k+4 (high half) together.
+	 */
+	sw = (const uint32_t *)p->state.d;
+	cc = *(uint64_t *)(p->state.d + 48);
+	for (u = 0; u < sizeof p->buf.d; u += 512) {
+		__m256i x[16], y[16];
+		uint32_t c_lo[8], c_hi[8];
+		int i, k;
+
+		for (k = 0; k < 8; k ++) {
+			c_lo[k] = sw[10] ^ (uint32_t)(cc + (uint64_t)k);
+			c_hi[k] = sw[11] ^ (uint32_t)((cc + (uint64_t)k) >> 32);
+		}
+		for (i = 0; i < 4; i ++) {
+			y[i] = _mm256_set1_epi32((int32_t)CW[i]);
+		}
+		for (i = 4; i < 14; i ++) {
+			y[i] = _mm256_set1_epi32((int32_t)sw[i - 4]);
+		}
+		y[14] = _mm256_loadu_si256((const __m256i *)c_lo);
+		y[15] = _mm256_loadu_si256((const __m256i *)c_hi);
+		memcpy(x, y, sizeof x);
+		for (i = 0; i < 10; i ++) {
+			CHACHA_DOUBLE_ROUND(_mm256_add_epi32, _mm256_xor_si256,
+				ROTL_AVX2, ROTL8_AVX2, ROTL16_AVX2);
+		}
+		for (i = 0; i < 16; i ++) {
+			x[i] = _mm256_add_epi32(x[i], y[i]);
+		}
+
+		for (i = 0; i < 16; i += 4) {
+			__m256i t0, t1, t2, t3, o[4];
+			unsigned char *dst;
+
+			t0 = _mm256_unpacklo_epi32(x[i + 0], x[i + 1]);
+			t1 = _mm256_unpacklo_epi32(x[i + 2], x[i + 3]);
+			t2 = _mm256_unpackhi_epi32(x[i + 0], x[i + 1]);
+			t3 = _mm256_unpackhi_epi32(x[i + 2], x[i + 3]);
+			o[0] = _mm256_unpacklo_epi64(t0, t1);
+			o[1] = _mm256_unpackhi_epi64(t0, t1);
+			o[2] = _mm256_unpacklo_epi64(t2, t3);
+			o[3] = _mm256_unpackhi_epi64(t2, t3);
+			dst = p->buf.d + u + (i << 2);
+			for (k = 0; k < 4; k ++) {
+				_mm_storeu_si128((__m128i *)(dst + (k << 6)),
+					_mm256_castsi256_si128(o[k]));
+				_mm_storeu_si128(
+					(__m128i *)(dst + ((k + 4) << 6)),
+					_mm256_extracti128_si256(o[k], 1));
+			}
+		}
+		cc += 8;
+	}
+	*(uint64_t *)(p->state.d + 48) = cc;
+	_mm256_zeroupper();
+}
+
+#endif
+
 /* see internal.h */
 int
 falcon_prng_init(prng *p, shake_context *src, int type)
 {
+	falcon_isa_init();
 	if (type == 0) {
 		type = PRNG_CHACHA20;
 	}
 	switch (type) {
+	case PRNG_CHACHA20_SSE2:
+		if (!(falcon_isa_enabled() & FALCON_ISA_SSE2)) {
+			return 0;
+		}
+		/* fall through */
 	case PRNG_CHACHA20:
 #if FALCON_LE_U
 		shake_extract(src, p->state.d, 56);
@@ -356,8 +712,13 @@ falcon_prng_refill(prng *p)
 {
 	switch (p->type) {
 	case PRNG_CHACHA20:
-		refill_chacha20(p);
+		falcon_kernels.chacha20(p);
+		break;
+#if FALCON_KERNELS_X86
+	case PRNG_CHACHA20_SSE2:
+		falcon_chacha20_sse2(p);
 		break;
+#endif
 	default:
 #ifndef USE_SGX
 		assert(0);
@@ -365,6 +726,7 @@ falcon_prng_refill(prng *p)
 		break;
 	}
 	p->ptr = 0;
+	FALCON_PROBE1(prng__refill, p->type);
 }
 
 /* see internal.h */
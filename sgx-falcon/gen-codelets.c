@@ -0,0 +1,313 @@
+/*
+ * Generator for falcon-fft-codelets.h: straight-line FFT, inverse FFT,
+ * split and merge for degrees 2 to 2^CODELET_MAX (binary case).
+ *
+ * Each codelet performs exactly the operations of the generic loops in
+ * falcon-fft.c (falcon_FFT_ref(), falcon_iFFT_ref(),
+ * falcon_poly_split_fft(), falcon_poly_merge_fft()) on the same
+ * operands, with all indexes and twiddle table positions resolved at
+ * generation time; results are bit-for-bit identical. Regenerate with:
+ *
+ *   make codelets
+ *
+ * ==========================(LICENSE BEGIN)============================
+ *
+ * Copyright (c) 2017  Falcon Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ===========================(LICENSE END)=============================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Largest degree (log) with codelets. Code size grows as
+ * logn * 2^logn; beyond 64 coefficients, loop overhead is small next
+ * to the work and the generic (or AVX) code takes over.
+ */
+#define CODELET_MAX   6
+
+/*
+ * Declare n locals r0..r(n-1) and the 'extra' ones, and load the
+ * former from f[].
+ */
+static void
+load_locals(size_t n, const char *extra)
+{
+	size_t u;
+
+	for (u = 0; u < n; u ++) {
+		printf("%s%s r%lu", u % 8 == 0 ? "\tfpr" : "",
+			u % 8 == 0 ? "" : ",", (unsigned long)u);
+		if (u % 8 == 7 || u == n - 1) {
+			printf(";\n");
+		}
+	}
+	if (extra != NULL) {
+		printf("\tfpr %s;\n", extra);
+	}
+	printf("\n");
+	for (u = 0; u < n; u ++) {
+		printf("\tr%lu = f[%lu];\n", (unsigned long)u, (unsigned long)u);
+	}
+}
+
+static void
+store_locals(size_t n, const char *scale)
+{
+	size_t u;
+
+	for (u = 0; u < n; u ++) {
+		if (scale == NULL) {
+			printf("\tf[%lu] = r%lu;\n",
+				(unsigned long)u, (unsigned long)u);
+		} else {
+			printf("\tf[%lu] = fpr_mul(r%lu, %s);\n",
+				(unsigned long)u, (unsigned long)u, scale);
+		}
+	}
+}
+
+/*
+ * Same loop nest as falcon_FFT_ref().
+ */
+static void
+gen_fft(unsigned logn)
+{
+	size_t n, hn, t, m, u;
+
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	printf("static void\nfft_codelet_%u(fpr *f)\n{\n", logn);
+	if (logn == 1) {
+		printf("\t(void)f;\n}\n\n");
+		return;
+	}
+	load_locals(n, "y_re, y_im");
+	t = hn;
+	for (u = 1, m = 2; u < logn; u ++, m <<= 1) {
+		size_t ht, hm, i1, j1, j;
+
+		ht = t >> 1;
+		hm = m >> 1;
+		printf("\n");
+		for (i1 = 0, j1 = 0; i1 < hm; i1 ++, j1 += t) {
+			size_t k;
+
+			k = (m + i1) << 1;
+			for (j = j1; j < j1 + ht; j ++) {
+				unsigned long a, b, c, d;
+
+				a = j;
+				b = j + hn;
+				c = j + ht;
+				d = j + ht + hn;
+				printf("\tFPC_MUL(y_re, y_im, r%lu, r%lu,"
+					" fpr_gm_tab[%lu], fpr_gm_tab[%lu]);\n",
+					c, d, (unsigned long)k,
+					(unsigned long)k + 1);
+				printf("\tFPC_SUB(r%lu, r%lu, r%lu, r%lu,"
+					" y_re, y_im);\n", c, d, a, b);
+				printf("\tFPC_ADD(r%lu, r%lu, r%lu, r%lu,"
+					" y_re, y_im);\n", a, b, a, b);
+			}
+		}
+		t = ht;
+	}
+	printf("\n");
+	store_locals(n, NULL);
+	printf("}\n\n");
+}
+
+/*
+ * Same loop nest as falcon_iFFT_ref().
+ */
+static void
+gen_ifft(unsigned logn)
+{
+	size_t n, hn, t, m, u;
+
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	printf("static void\nifft_codelet_%u(fpr *f)\n{\n", logn);
+	load_locals(n, logn > 1 ? "y_re, y_im, ni" : "ni");
+	t = 1;
+	m = n;
+	for (u = logn; u > 1; u --) {
+		size_t hm, dt, i1, j1, j;
+
+		hm = m >> 1;
+		dt = t << 1;
+		printf("\n");
+		for (i1 = 0, j1 = 0; j1 < hn; i1 ++, j1 += dt) {
+			size_t k;
+
+			k = (hm + i1) << 1;
+			for (j = j1; j < j1 + t; j ++) {
+				unsigned long a, b, c, d;
+
+				a = j;
+				b = j + hn;
+				c = j + t;
+				d = j + t + hn;
+				printf("\tFPC_SUB(y_re, y_im, r%lu, r%lu,"
+					" r%lu, r%lu);\n", a, b, c, d);
+				printf("\tFPC_ADD(r%lu, r%lu, r%lu, r%lu,"
+					" r%lu, r%lu);\n", a, b, a, b, c, d);
+				printf("\tFPC_MUL(r%lu, r%lu, y_re, y_im,"
+					" fpr_gm_tab[%lu],"
+					" fpr_neg(fpr_gm_tab[%lu]));\n",
+					c, d, (unsigned long)k,
+					(unsigned long)k + 1);
+			}
+		}
+		t = dt;
+		m = hm;
+	}
+	printf("\n\tni = fpr_scaled(2, -%u);\n", logn);
+	store_locals(n, "ni");
+	printf("}\n\n");
+}
+
+/*
+ * Same as falcon_poly_split_fft().
+ */
+static void
+gen_split(unsigned logn)
+{
+	size_t n, hn, qn, u;
+
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	qn = hn >> 1;
+	printf("static void\nsplit_codelet_%u(fpr *restrict f0,"
+		" fpr *restrict f1,\n\tconst fpr *restrict f)\n{\n", logn);
+	if (logn == 1) {
+		printf("\tf0[0] = f[0];\n\tf1[0] = f[1];\n}\n\n");
+		return;
+	}
+	printf("\tfpr t_re, t_im;\n");
+	for (u = 0; u < qn; u ++) {
+		unsigned long a, b, c, d, k;
+
+		a = u << 1;
+		b = a + hn;
+		c = a + 1;
+		d = c + hn;
+		k = (u + hn) << 1;
+		printf("\n");
+		printf("\tFPC_ADD(t_re, t_im, f[%lu], f[%lu], f[%lu], f[%lu]);\n",
+			a, b, c, d);
+		printf("\tf0[%lu] = fpr_half(t_re);\n", (unsigned long)u);
+		printf("\tf0[%lu] = fpr_half(t_im);\n", (unsigned long)(u + qn));
+		printf("\tFPC_SUB(t_re, t_im, f[%lu], f[%lu], f[%lu], f[%lu]);\n",
+			a, b, c, d);
+		printf("\tFPC_MUL(t_re, t_im, t_re, t_im,"
+			" fpr_gm_tab[%lu], fpr_neg(fpr_gm_tab[%lu]));\n",
+			k, k + 1);
+		printf("\tf1[%lu] = fpr_half(t_re);\n", (unsigned long)u);
+		printf("\tf1[%lu] = fpr_half(t_im);\n", (unsigned long)(u + qn));
+	}
+	printf("}\n\n");
+}
+
+/*
+ * Same as falcon_poly_merge_fft().
+ */
+static void
+gen_merge(unsigned logn)
+{
+	size_t n, hn, qn, u;
+
+	n = (size_t)1 << logn;
+	hn = n >> 1;
+	qn = hn >> 1;
+	printf("static void\nmerge_codelet_%u(fpr *restrict f,"
+		"\n\tconst fpr *restrict f0, const fpr *restrict f1)\n{\n",
+		logn);
+	if (logn == 1) {
+		printf("\tf[0] = f0[0];\n\tf[1] = f1[0];\n}\n\n");
+		return;
+	}
+	printf("\tfpr b_re, b_im;\n");
+	for (u = 0; u < qn; u ++) {
+		unsigned long a, c, k;
+
+		a = u << 1;
+		c = a + 1;
+		k = (u + hn) << 1;
+		printf("\n");
+		printf("\tFPC_MUL(b_re, b_im, f1[%lu], f1[%lu],"
+			" fpr_gm_tab[%lu], fpr_gm_tab[%lu]);\n",
+			(unsigned long)u, (unsigned long)(u + qn), k, k + 1);
+		printf("\tFPC_ADD(f[%lu], f[%lu], f0[%lu], f0[%lu],"
+			" b_re, b_im);\n", a, a + hn,
+			(unsigned long)u, (unsigned long)(u + qn));
+		printf("\tFPC_SUB(f[%lu], f[%lu], f0[%lu], f0[%lu],"
+			" b_re, b_im);\n", c, c + hn,
+			(unsigned long)u, (unsigned long)(u + qn));
+	}
+	printf("}\n\n");
+}
+
+/*
+ * Table of the codelets of one kind, indexed by logn (no entry for 0).
+ */
+static void
+gen_table(const char *name, const char *params)
+{
+	unsigned logn;
+
+	printf("static void (*const %s_codelet[])(\n\t%s) = {\n\t0",
+		name, params);
+	for (logn = 1; logn <= CODELET_MAX; logn ++) {
+		printf(",\n\t%s_codelet_%u", name, logn);
+	}
+	printf("\n};\n\n");
+}
+
+int
+main(void)
+{
+	unsigned logn;
+
+	printf("/*\n"
+		" * Generated by gen-codelets.c; do not edit. Straight-line"
+		" FFT, inverse\n"
+		" * FFT, split and merge for 1 <= logn <= FFT_CODELET_MAX,"
+		" included by\n"
+		" * falcon-fft.c (which provides the FPC_* macros and"
+		" fpr_gm_tab[]).\n"
+		" */\n\n");
+	printf("#define FFT_CODELET_MAX   %u\n\n", CODELET_MAX);
+	for (logn = 1; logn <= CODELET_MAX; logn ++) {
+		gen_fft(logn);
+		gen_ifft(logn);
+		gen_split(logn);
+		gen_merge(logn);
+	}
+	gen_table("fft", "fpr *");
+	gen_table("ifft", "fpr *");
+	gen_table("split", "fpr *restrict, fpr *restrict, const fpr *restrict");
+	gen_table("merge", "fpr *restrict, const fpr *restrict, const fpr *restrict");
+	return 0;
+}
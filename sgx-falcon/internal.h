@@ -66,6 +66,153 @@ extern "C" {
 #endif
 #endif
 
+/*
+ * x86 kernel variants (SSE2, AVX, AVX2), selected at runtime by
+ * falcon-cpu.c. They are compiled with per-function target attributes,
+ * so the rest of the code needs no special compiler flags. AVX kernels
+ * end with an explicit vzeroupper (compilers insert it only at higher
+ * optimization levels), since a dirty upper register state makes the
+ * surrounding SSE2 code pay transition penalties. The variants are
+ * left out of SGX enclaves, where CPUID is not available to pick them
+ * safely. Define FALCON_KERNELS_X86 to 0 or 1 to override.
+ */
+#ifndef FALCON_KERNELS_X86
+#if (__x86_64__ || __i386__) && (__GNUC__ >= 5 || __clang__) \
+	&& !defined USE_SGX
+#define FALCON_KERNELS_X86   1
+#else
+#define FALCON_KERNELS_X86   0
+#endif
+#endif
+
+/*
+ * Context seeding through the in-library DRBG (see falcon_drbg_seed()).
+ * On by default in SGX enclaves, where each system seed is an
+ * sgx_read_rand() call (RDRAND loop, with retries); off natively, where
+ * /dev/urandom is cheap and a process-wide DRBG would be duplicated by
+ * fork(). Define FALCON_DRBG to 0 or 1 to override.
+ */
+#ifndef FALCON_DRBG
+#if defined USE_SGX
+#define FALCON_DRBG   1
+#else
+#define FALCON_DRBG   0
+#endif
+#endif
+
+/*
+ * USDT static tracepoints (sys/sdt.h). Each probe compiles to a single
+ * nop plus a note in the ELF file; it costs nothing until a tracer
+ * (bpftrace, perf, SystemTap) attaches to it on the running process.
+ * The provider name is "falcon":
+ *
+ *   sign__start(logn)             falcon_sign_generate() entry
+ *   sign__retry(logn)             candidate signature was too long
+ *   sign__done(logn, len)         signature produced (len = 0 on error)
+ *   keygen__attempt(logn)         new (f,g) candidate
+ *   keygen__reject(logn, reason)  candidate rejected (FALCON_KG_REJECT_*)
+ *   verify__result(result)        falcon_vrfy_verify() return value
+ *   prng__refill(type)            PRNG output buffer refilled
+ *
+ * Probes are enabled when sys/sdt.h is available, except in an SGX
+ * enclave, where no tracer can reach the code. Define FALCON_USDT to 0
+ * or 1 to override the detection.
+ */
+#ifndef FALCON_USDT
+#if defined USE_SGX
+#define FALCON_USDT   0
+#elif defined __has_include
+#if __has_include(<sys/sdt.h>)
+#define FALCON_USDT   1
+#else
+#define FALCON_USDT   0
+#endif
+#else
+#define FALCON_USDT   0
+#endif
+#endif
+
+#if FALCON_USDT
+#include <sys/sdt.h>
+#define FALCON_PROBE1(name, a)      DTRACE_PROBE1(falcon, name, a)
+#define FALCON_PROBE2(name, a, b)   DTRACE_PROBE2(falcon, name, a, b)
+#else
+#define FALCON_PROBE1(name, a)      ((void)0)
+#define FALCON_PROBE2(name, a, b)   ((void)0)
+#endif
+
+/*
+ * Read prefetch hint for data needed soon (a no-op where the compiler
+ * has no builtin for it).
+ */
+#if defined __GNUC__ || defined __clang__
+#define FALCON_PREFETCH(p)   __builtin_prefetch((p), 0, 3)
+#else
+#define FALCON_PREFETCH(p)   ((void)0)
+#endif
+
+/*
+ * One-time initialization guard, for a static int that starts at 0:
+ * falcon_once_begin() returns 1 to exactly one caller, which must run
+ * the initialization and then call falcon_once_end(); every other
+ * caller waits until that is done and gets 0. The initialization must
+ * not use the same guard again.
+ */
+static inline int
+falcon_once_begin(int *state)
+{
+	int expected;
+
+	if (__atomic_load_n(state, __ATOMIC_ACQUIRE) == 2) {
+		return 0;
+	}
+	expected = 0;
+	if (__atomic_compare_exchange_n(state, &expected, 1, 0,
+		__ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+	{
+		return 1;
+	}
+	while (__atomic_load_n(state, __ATOMIC_ACQUIRE) != 2) {
+#if __x86_64__ || __i386__
+		__builtin_ia32_pause();
+#endif
+	}
+	return 0;
+}
+
+static inline void
+falcon_once_end(int *state)
+{
+	__atomic_store_n(state, 2, __ATOMIC_RELEASE);
+}
+
+/*
+ * Reasons reported by the keygen__reject probe.
+ */
+#define FALCON_KG_REJECT_EVEN_RES   1   /* Res(f,phi) or Res(g,phi) even */
+#define FALCON_KG_REJECT_NORM       2   /* ||(g,-f)|| too large */
+#define FALCON_KG_REJECT_GS_NORM    3   /* orthogonalized norm too large */
+#define FALCON_KG_REJECT_NOT_INV    4   /* f not invertible mod q */
+#define FALCON_KG_REJECT_NTRU       5   /* NTRU equation not solvable */
+
+/*
+ * Sampler statistics of a signature context, since its backend was
+ * last set: Gaussian candidates drawn and accepted (the difference is
+ * the number of rejections), and signature attempts and signatures
+ * produced (attempts beyond one per signature were retried because the
+ * vector was too long).
+ */
+void falcon_sign_sampler_stats(const falcon_sign *fs,
+	uint64_t *draws, uint64_t *samples,
+	uint64_t *attempts, uint64_t *signatures);
+
+/*
+ * Root cache statistics of a batch verification context: verifications
+ * answered from the cache, and verifications that checked a signature.
+ */
+void falcon_batch_vrfy_stats(const falcon_batch_vrfy *bv,
+	uint64_t *hits, uint64_t *misses);
+
 /* ==================================================================== */
 /*
  * Encoding/decoding functions (falcon-enc.c).
@@ -732,6 +879,14 @@ void falcon_poly_merge_top_fft3(fpr *restrict f,
 void falcon_poly_merge_deep_fft3(fpr *restrict f,
 	const fpr *restrict f0, const fpr *restrict f1, unsigned logn);
 
+/*
+ * Twiddle tables of falcon_poly_split_fft() / falcon_poly_merge_fft()
+ * and of the deep FFT3 split/merge, for code that inlines those steps
+ * (entries 2k and 2k+1 are the real and imaginary parts of twiddle k).
+ */
+extern const fpr *const falcon_gm_tab;
+extern const fpr *const falcon_gm3_square;
+
 /* ==================================================================== */
 /*
  * RNG stuff. This is a generic API to get a random seed from the
@@ -747,6 +902,33 @@ void falcon_poly_merge_deep_fft3(fpr *restrict f,
  */
 int falcon_get_seed(void *seed, size_t seed_len);
 
+/*
+ * Obtain a seed from the library-wide DRBG. The DRBG root is seeded
+ * from falcon_get_seed() on first use, and mixed with a fresh system
+ * seed again every few hundred child rekeys. Callers draw through one of
+ * a few child streams (a SHAKE-256 ratchet each: every draw replaces the
+ * child key, so past outputs cannot be recomputed from its state), which
+ * are claimed per call with an atomic exchange, not per thread; a child
+ * is rekeyed from the root every few thousand draws. Thread-safe, and
+ * lock-free except for the (rare) root access.
+ *
+ * Returned value is 1 on success, 0 on error (system RNG failure).
+ */
+int falcon_drbg_seed(void *seed, size_t seed_len);
+
+/*
+ * Seed source for signing and key generation contexts that were given
+ * no explicit seed: falcon_drbg_seed() if FALCON_DRBG, falcon_get_seed()
+ * otherwise.
+ */
+int falcon_context_seed(void *seed, size_t seed_len);
+
+/*
+ * DRBG counters since startup: system seeds read and seeds drawn.
+ * Either pointer may be NULL.
+ */
+void falcon_drbg_stats(uint64_t *system_seeds, uint64_t *draws);
+
 /*
  * Structure for a PRNG. This includes a large buffer so that values
  * get generated in advance. The 'state' is used to keep the current
@@ -769,7 +951,10 @@ typedef struct {
 } prng;
 
 /*
- * PRNG types. Only PRNG_CHACHA20 is currently implemented.
+ * PRNG types. PRNG_CHACHA20 uses the best ChaCha20 kernel selected by
+ * falcon_isa_init(); PRNG_CHACHA20_SSE2 forces the SSE2 kernel, and is
+ * available only when SSE2 is enabled. Both yield the same stream.
+ * PRNG_AES_X86NI is not implemented.
  */
 #define PRNG_CHACHA20        1
 #define PRNG_CHACHA20_SSE2   2
@@ -852,6 +1037,95 @@ falcon_prng_get_u8(prng *p)
 	return v;
 }
 
+/* ==================================================================== */
+/*
+ * Runtime kernel dispatch (falcon-cpu.c).
+ *
+ * The hot kernels are called through falcon_kernels. The table starts
+ * out with the portable code (the *_ref functions, and the two-level
+ * FFT passes of falcon_FFT_radix4() and falcon_iFFT_radix4()), and
+ * falcon_isa_init() upgrades entries to the best variants allowed by
+ * the CPU features and the FALCON_ISA environment variable, after
+ * checking each of them against the reference code on known inputs.
+ * Each entry is always a valid kernel, so a thread that races with
+ * the initialization merely runs the reference code.
+ */
+
+typedef struct {
+	void (*keccak)(uint64_t *A);
+	void (*chacha20)(prng *p);
+	void (*fft)(fpr *f, unsigned logn);
+	void (*ifft)(fpr *f, unsigned logn);
+	void (*poly_mul_fft)(fpr *restrict a,
+		const fpr *restrict b, unsigned logn);
+	void (*poly_muladj_fft)(fpr *restrict a,
+		const fpr *restrict b, unsigned logn);
+	void (*ntt)(uint16_t *a, unsigned logn);
+	void (*intt)(uint16_t *a, unsigned logn);
+} falcon_kernel_table;
+
+extern falcon_kernel_table falcon_kernels;
+
+/*
+ * Select the kernels, on the first call only; thread-safe (concurrent
+ * first callers wait for the selection to complete). This is invoked
+ * by the context constructors and by shake_init() and
+ * falcon_prng_init().
+ */
+void falcon_isa_init(void);
+
+/*
+ * Keccak-f[1600] permutation (shake.c). There is no x86 variant: the
+ * same code built for BMI1/BMI2 (ANDN, RORX) was not measurably faster.
+ */
+void falcon_keccak_ref(uint64_t *A);
+
+/*
+ * ChaCha20 PRNG refill (frng.c). All variants produce the same output
+ * stream.
+ */
+void falcon_chacha20_ref(prng *p);
+
+/*
+ * Binary-case NTT and inverse NTT modulo q = 12289, with values in
+ * Montgomery representation (falcon-vrfy.c).
+ */
+void falcon_NTT_ref(uint16_t *a, unsigned logn);
+void falcon_iNTT_ref(uint16_t *a, unsigned logn);
+
+/*
+ * FFT kernels (falcon-fft.c); see falcon_FFT() and the other
+ * dispatched functions for their contracts.
+ */
+void falcon_FFT_ref(fpr *f, unsigned logn);
+void falcon_iFFT_ref(fpr *f, unsigned logn);
+
+void falcon_poly_mul_fft_ref(fpr *restrict a,
+	const fpr *restrict b, unsigned logn);
+void falcon_poly_muladj_fft_ref(fpr *restrict a,
+	const fpr *restrict b, unsigned logn);
+
+/*
+ * Portable FFT kernels installed by default: the butterflies of the
+ * reference code done two levels per pass, with bit-for-bit identical
+ * output.
+ */
+void falcon_FFT_radix4(fpr *f, unsigned logn);
+void falcon_iFFT_radix4(fpr *f, unsigned logn);
+
+#if FALCON_KERNELS_X86
+void falcon_chacha20_sse2(prng *p);
+void falcon_chacha20_avx2(prng *p);
+void falcon_NTT_avx2(uint16_t *a, unsigned logn);
+void falcon_iNTT_avx2(uint16_t *a, unsigned logn);
+void falcon_FFT_avx(fpr *f, unsigned logn);
+void falcon_iFFT_avx(fpr *f, unsigned logn);
+void falcon_poly_mul_fft_avx(fpr *restrict a,
+	const fpr *restrict b, unsigned logn);
+void falcon_poly_muladj_fft_avx(fpr *restrict a,
+	const fpr *restrict b, unsigned logn);
+#endif
+
 /* ==================================================================== */
 
 #ifdef __cplusplus
@@ -31,7 +31,7 @@
 
 #include <string.h>
 
-#include "shake.h"
+#include "internal.h"
 
 /*
  * Round constants.
@@ -103,12 +103,9 @@ xor_block(uint64_t *A, const void *data, size_t rate)
 	}
 }
 
-/*
- * Process a block with the provided data. The data length must be a
- * multiple of 8 (in bytes); normally, this is the "rate".
- */
-static void
-process_block(uint64_t *A)
+/* see internal.h */
+void
+falcon_keccak_ref(uint64_t *A)
 {
 	uint64_t t0, t1, t2, t3, t4;
 	uint64_t tt0, tt1, tt2, tt3;
@@ -512,10 +509,21 @@ process_block(uint64_t *A)
 	}
 }
 
+/*
+ * Process a block with the provided data. The data length must be a
+ * multiple of 8 (in bytes); normally, this is the "rate".
+ */
+static void
+process_block(uint64_t *A)
+{
+	falcon_kernels.keccak(A);
+}
+
 /* see falcon.h */
 void
 shake_init(shake_context *sc, int capacity)
 {
+	falcon_isa_init();
 	sc->rate = 200 - (size_t)(capacity >> 3);
 	sc->dptr = 0;
 	memset(sc->A, 0, sizeof sc->A);
@@ -1424,6 +1424,45 @@ test_key_codec_comp(const char *name, int comp)
 	fflush(stdout);
 }
 
+static void
+test_drbg(void)
+{
+	static unsigned char seeds[2000][32];
+	uint64_t sys0, draws0, sys1, draws1;
+	size_t u, v;
+
+	printf("Test seed DRBG: ");
+	fflush(stdout);
+
+	falcon_drbg_stats(&sys0, &draws0);
+	for (u = 0; u < 2000; u ++) {
+		if (!falcon_drbg_seed(seeds[u], sizeof seeds[u])) {
+			fprintf(stderr, "DRBG failure\n");
+			exit(EXIT_FAILURE);
+		}
+		for (v = 0; v < u; v ++) {
+			if (memcmp(seeds[v], seeds[u], 32) == 0) {
+				fprintf(stderr, "DRBG stutter\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (u % 200 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+	falcon_drbg_stats(&sys1, &draws1);
+	if (draws1 - draws0 != 2000 || sys1 - sys0 > 1) {
+		fprintf(stderr, "DRBG: %lu draws, %lu system seeds\n",
+			(unsigned long)(draws1 - draws0),
+			(unsigned long)(sys1 - sys0));
+		exit(EXIT_FAILURE);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static void
 test_key_codec(void)
 {
@@ -1585,6 +1624,39 @@ test_poly_inner(unsigned logn)
 			}
 		}
 
+		/*
+		 * Codelets and kernels must match the reference code
+		 * bit for bit.
+		 */
+		memcpy(g, f, n * sizeof *f);
+		memcpy(h, f, n * sizeof *f);
+		falcon_FFT(g, logn);
+		falcon_FFT_ref(h, logn);
+		if (memcmp(g, h, n * sizeof *g) != 0) {
+			fprintf(stderr, "FFT differs from reference\n");
+			exit(EXIT_FAILURE);
+		}
+		falcon_iFFT(g, logn);
+		falcon_iFFT_ref(h, logn);
+		if (memcmp(g, h, n * sizeof *g) != 0) {
+			fprintf(stderr, "iFFT differs from reference\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(g, f, n * sizeof *f);
+		memcpy(h, f, n * sizeof *f);
+		falcon_FFT_radix4(g, logn);
+		falcon_FFT_ref(h, logn);
+		if (memcmp(g, h, n * sizeof *g) != 0) {
+			fprintf(stderr, "radix-4 FFT differs from reference\n");
+			exit(EXIT_FAILURE);
+		}
+		falcon_iFFT_radix4(g, logn);
+		falcon_iFFT_ref(h, logn);
+		if (memcmp(g, h, n * sizeof *g) != 0) {
+			fprintf(stderr, "radix-4 iFFT differs from reference\n");
+			exit(EXIT_FAILURE);
+		}
+
 		mk_rand_poly(&p, g, logn);
 		for (u = 0; u < n; u ++) {
 			h[u] = fpr_of(0);
@@ -1974,6 +2046,684 @@ test_falcon_sign(void)
 	fflush(stdout);
 }
 
+/*
+ * Signing with a shared expanded key must give the same output as with
+ * a private key loaded into the context, and switching keys in a
+ * context must work both ways.
+ */
+static void
+test_falcon_expanded_key(void)
+{
+	static const unsigned logn_tab[] = { 4, 9, 10 };
+	unsigned char *skey[3];
+	size_t skey_len[3];
+	falcon_expanded_key *ek[3];
+	falcon_sign *fs1, *fs2;
+	int i, j;
+
+	printf("Test expanded keys: ");
+	fflush(stdout);
+
+	skey[0] = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_16, ntru_g_16, ntru_F_16, ntru_G_16, 4, &skey_len[0]);
+	skey[1] = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_512, ntru_g_512, ntru_F_512, ntru_G_512,
+		9, &skey_len[1]);
+	skey[2] = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_1024, ntru_g_1024, ntru_F_1024, ntru_G_1024,
+		10, &skey_len[2]);
+	if (falcon_expanded_key_new(skey[1], skey_len[1] - 1) != NULL) {
+		fprintf(stderr, "truncated private key accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < 3; i ++) {
+		ek[i] = falcon_expanded_key_new(skey[i], skey_len[i]);
+		if (ek[i] == NULL
+			|| falcon_expanded_key_logn(ek[i]) != logn_tab[i]
+			|| falcon_expanded_key_ternary(ek[i]) != 0)
+		{
+			fprintf(stderr, "error expanding private key\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	fs1 = falcon_sign_new();
+	fs2 = falcon_sign_new();
+	if (fs1 == NULL || fs2 == NULL) {
+		fprintf(stderr, "context creation error\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/*
+	 * Go through the keys in both directions, so that the scratch
+	 * buffer is both reused and grown.
+	 */
+	for (j = 0; j < 6; j ++) {
+		unsigned char sig1[2049], sig2[2049], r1[40], r2[40];
+		size_t len1, len2;
+
+		i = j < 3 ? j : 5 - j;
+		if (!falcon_sign_set_private_key(fs1, skey[i], skey_len[i])
+			|| !falcon_sign_set_expanded_key(fs2, ek[i]))
+		{
+			fprintf(stderr, "error loading private key\n");
+			exit(EXIT_FAILURE);
+		}
+		falcon_sign_set_seed(fs1, "ek", 2, 1);
+		falcon_sign_set_seed(fs2, "ek", 2, 1);
+		falcon_sign_start(fs1, r1);
+		falcon_sign_start(fs2, r2);
+		falcon_sign_update(fs1, "test", 4);
+		falcon_sign_update(fs2, "test", 4);
+		len1 = falcon_sign_generate(fs1, sig1, sizeof sig1,
+			FALCON_COMP_STATIC);
+		len2 = falcon_sign_generate(fs2, sig2, sizeof sig2,
+			FALCON_COMP_STATIC);
+		if (len1 == 0 || len1 != len2
+			|| memcmp(r1, r2, sizeof r1) != 0
+			|| memcmp(sig1, sig2, len1) != 0)
+		{
+			fprintf(stderr, "expanded key signature mismatch"
+				" (logn=%u)\n", logn_tab[i]);
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * A context that borrowed a key does not release it.
+	 */
+	falcon_sign_free(fs2);
+	fs2 = falcon_sign_new();
+	falcon_sign_set_expanded_key(fs2, ek[1]);
+	falcon_sign_free(fs2);
+	falcon_sign_free(fs1);
+	for (i = 0; i < 3; i ++) {
+		falcon_expanded_key_free(ek[i]);
+		xfree(skey[i]);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_falcon_sign_dynamic(void)
+{
+	static const unsigned logn_tab[] = { 4, 9, 10 };
+	unsigned char *skey[3];
+	size_t skey_len[3];
+	falcon_expanded_key *ek;
+	falcon_sign *fs1, *fs2, *fs3;
+	int i, j;
+
+	printf("Test dynamic signing: ");
+	fflush(stdout);
+
+	skey[0] = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_16, ntru_g_16, ntru_F_16, ntru_G_16, 4, &skey_len[0]);
+	skey[1] = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_512, ntru_g_512, ntru_F_512, ntru_G_512,
+		9, &skey_len[1]);
+	skey[2] = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_1024, ntru_g_1024, ntru_F_1024, ntru_G_1024,
+		10, &skey_len[2]);
+
+	fs1 = falcon_sign_new();
+	fs2 = falcon_sign_new();
+	fs3 = falcon_sign_new();
+	if (fs1 == NULL || fs2 == NULL || fs3 == NULL) {
+		fprintf(stderr, "context creation error\n");
+		exit(EXIT_FAILURE);
+	}
+	if (falcon_sign_set_mode(fs2, 2)
+		|| falcon_sign_get_mode(fs2) != FALCON_SIGN_TREE
+		|| !falcon_sign_set_mode(fs2, FALCON_SIGN_DYNAMIC)
+		|| falcon_sign_get_mode(fs2) != FALCON_SIGN_DYNAMIC)
+	{
+		fprintf(stderr, "signing mode not set\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/*
+	 * The tree (fs1), a tree-less key loaded in dynamic mode (fs2),
+	 * and a shared tree-less expanded key in a tree mode context
+	 * (fs3) must yield the same signatures.
+	 */
+	for (i = 0; i < 3; i ++) {
+		ek = falcon_expanded_key_new_dynamic(skey[i], skey_len[i]);
+		if (ek == NULL
+			|| falcon_expanded_key_logn(ek) != logn_tab[i]
+			|| !falcon_sign_set_private_key(fs1, skey[i], skey_len[i])
+			|| !falcon_sign_set_private_key(fs2, skey[i], skey_len[i])
+			|| !falcon_sign_set_expanded_key(fs3, ek))
+		{
+			fprintf(stderr, "error loading private key\n");
+			exit(EXIT_FAILURE);
+		}
+		for (j = 0; j < 10; j ++) {
+			unsigned char sig1[2049], sig2[2049], sig3[2049];
+			unsigned char r[40], seed[2];
+			size_t len1, len2, len3;
+
+			seed[0] = (unsigned char)i;
+			seed[1] = (unsigned char)j;
+			memset(r, j, sizeof r);
+			falcon_sign_set_seed(fs1, seed, 2, 1);
+			falcon_sign_set_seed(fs2, seed, 2, 1);
+			falcon_sign_set_seed(fs3, seed, 2, 1);
+			falcon_sign_start_external_nonce(fs1, r, sizeof r);
+			falcon_sign_start_external_nonce(fs2, r, sizeof r);
+			falcon_sign_start_external_nonce(fs3, r, sizeof r);
+			falcon_sign_update(fs1, "test", 4);
+			falcon_sign_update(fs2, "test", 4);
+			falcon_sign_update(fs3, "test", 4);
+			len1 = falcon_sign_generate(fs1, sig1, sizeof sig1,
+				FALCON_COMP_STATIC);
+			len2 = falcon_sign_generate(fs2, sig2, sizeof sig2,
+				FALCON_COMP_STATIC);
+			len3 = falcon_sign_generate(fs3, sig3, sizeof sig3,
+				FALCON_COMP_STATIC);
+			if (len1 == 0 || len1 != len2 || len1 != len3
+				|| memcmp(sig1, sig2, len1) != 0
+				|| memcmp(sig1, sig3, len1) != 0)
+			{
+				fprintf(stderr, "dynamic signature mismatch"
+					" (logn=%u)\n", logn_tab[i]);
+				exit(EXIT_FAILURE);
+			}
+		}
+		falcon_expanded_key_free(ek);
+		printf(".");
+		fflush(stdout);
+	}
+
+	falcon_sign_free(fs1);
+	falcon_sign_free(fs2);
+	falcon_sign_free(fs3);
+	for (i = 0; i < 3; i ++) {
+		xfree(skey[i]);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/*
+ * Sign and verify with every sampler backend, for a key of degree n
+ * (the ternary case goes through the "large" samplers). Backends with
+ * the same samples from the same PRNG stream (cdf-ct and cdt-ct) must
+ * produce the same signatures.
+ */
+static void
+test_sampler_backends_key(const unsigned char *skey, size_t skey_len,
+	const unsigned char *pkey, size_t pkey_len, uint64_t n)
+{
+	static unsigned char ref_sig[10][2049];
+	static size_t ref_len[10];
+	unsigned u;
+
+	for (u = 0; falcon_sampler_name(u) != NULL; u ++) {
+		falcon_sign *fs;
+		falcon_vrfy *fv;
+		int i, same_as_ref;
+		uint64_t draws, samples, attempts, sigs;
+
+		fs = falcon_sign_new();
+		fv = falcon_vrfy_new();
+		if (fs == NULL || fv == NULL) {
+			fprintf(stderr, "context creation error\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!falcon_sign_set_sampler(fs, falcon_sampler_name(u))
+			|| strcmp(falcon_sign_get_sampler(fs),
+			falcon_sampler_name(u)) != 0)
+		{
+			fprintf(stderr, "cannot select sampler %s\n",
+				falcon_sampler_name(u));
+			exit(EXIT_FAILURE);
+		}
+		if (!falcon_sign_set_private_key(fs, skey, skey_len)
+			|| !falcon_vrfy_set_public_key(fv, pkey, pkey_len))
+		{
+			fprintf(stderr, "error loading keys\n");
+			exit(EXIT_FAILURE);
+		}
+		same_as_ref = strcmp(falcon_sampler_name(u), "cdt-ct") == 0;
+		falcon_sign_set_seed(fs, "sampler", 7, 1);
+		for (i = 0; i < 100; i ++) {
+			unsigned char r[40], sig[2049];
+			size_t sig_len;
+
+			falcon_sign_start(fs, r);
+			falcon_sign_update(fs, &i, sizeof i);
+			sig_len = falcon_sign_generate(fs,
+				sig, sizeof sig, FALCON_COMP_STATIC);
+			falcon_vrfy_start(fv, r, sizeof r);
+			falcon_vrfy_update(fv, &i, sizeof i);
+			if (sig_len == 0
+				|| falcon_vrfy_verify(fv, sig, sig_len) != 1)
+			{
+				fprintf(stderr, "sampler %s: bad signature\n",
+					falcon_sampler_name(u));
+				exit(EXIT_FAILURE);
+			}
+			if (i >= 10) {
+				continue;
+			}
+			if (strcmp(falcon_sampler_name(u), "cdf-ct") == 0) {
+				memcpy(ref_sig[i], sig, sig_len);
+				ref_len[i] = sig_len;
+			} else if (same_as_ref && (sig_len != ref_len[i]
+				|| memcmp(sig, ref_sig[i], sig_len) != 0))
+			{
+				fprintf(stderr, "sampler %s: signatures differ"
+					" from cdf-ct\n", falcon_sampler_name(u));
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		/*
+		 * Every signature samples 2*N candidates; about a third
+		 * of the candidates are rejected.
+		 */
+		falcon_sign_sampler_stats(fs, &draws, &samples,
+			&attempts, &sigs);
+		if (sigs != 100 || attempts < sigs
+			|| samples != attempts * 2 * n
+			|| draws < samples || draws > 2 * samples)
+		{
+			fprintf(stderr, "sampler %s: bad statistics\n",
+				falcon_sampler_name(u));
+			exit(EXIT_FAILURE);
+		}
+		falcon_sign_free(fs);
+		falcon_vrfy_free(fv);
+		printf(".");
+		fflush(stdout);
+	}
+}
+
+static void
+test_falcon_sampler_backends(void)
+{
+	unsigned char pkey[3000], tskey[6000];
+	unsigned char *skey;
+	size_t pkey_len, skey_len;
+	falcon_sign *fs;
+	falcon_keygen *fk;
+	unsigned u;
+	int ct;
+
+	printf("Test sampler backends: ");
+	fflush(stdout);
+
+	fs = falcon_sign_new();
+	if (fs == NULL) {
+		fprintf(stderr, "context creation error\n");
+		exit(EXIT_FAILURE);
+	}
+	if (falcon_sign_set_sampler(fs, "no-such-sampler")) {
+		fprintf(stderr, "unknown sampler accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	if (strcmp(falcon_sign_get_sampler(fs),
+		falcon_sampler_get_default()) != 0)
+	{
+		fprintf(stderr, "new context does not use default sampler\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_sign_free(fs);
+	for (u = 0, ct = 0; falcon_sampler_name(u) != NULL; u ++) {
+		ct += falcon_sampler_is_ct(u);
+	}
+	if (ct < 2) {
+		fprintf(stderr, "fewer than two constant-PRNG samplers\n");
+		exit(EXIT_FAILURE);
+	}
+
+	pkey_len = hextobin(pkey, sizeof pkey, ntru_pkey_512);
+	skey = encode_skey(FALCON_COMP_STATIC, 12289,
+		ntru_f_512, ntru_g_512, ntru_F_512, ntru_G_512, 9, &skey_len);
+	test_sampler_backends_key(skey, skey_len, pkey, pkey_len, 512);
+	xfree(skey);
+
+	/*
+	 * Ternary, degree 768.
+	 */
+	fk = falcon_keygen_new(9, 1);
+	if (fk == NULL) {
+		fprintf(stderr, "keygen alloc failed\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_keygen_set_seed(fk, "sampler", 7, 1);
+	pkey_len = sizeof pkey;
+	skey_len = sizeof tskey;
+	if (!falcon_keygen_make(fk, FALCON_COMP_STATIC,
+		tskey, &skey_len, pkey, &pkey_len))
+	{
+		fprintf(stderr, "keygen failed\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_keygen_free(fk);
+	test_sampler_backends_key(tskey, skey_len, pkey, pkey_len, 768);
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/*
+ * Generate a key pair and a signature from fixed seeds; the output
+ * (public key then signature) depends only on the seeds.
+ */
+static size_t
+isa_seeded_sign(unsigned logn, unsigned char *out, size_t max_len)
+{
+	falcon_keygen *fk;
+	falcon_sign *fs;
+	unsigned char skey[6000], nonce[40];
+	size_t skey_len, pkey_len, sig_len;
+
+	fk = falcon_keygen_new(logn, 0);
+	fs = falcon_sign_new();
+	if (fk == NULL || fs == NULL) {
+		fprintf(stderr, "context creation error\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_keygen_set_seed(fk, "isa", 3, 1);
+	skey_len = sizeof skey;
+	pkey_len = max_len;
+	if (!falcon_keygen_make(fk, FALCON_COMP_STATIC,
+		skey, &skey_len, out, &pkey_len))
+	{
+		fprintf(stderr, "keygen error\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_sign_set_seed(fs, "isa", 3, 1);
+	if (!falcon_sign_set_private_key(fs, skey, skey_len)
+		|| !falcon_sign_start(fs, nonce))
+	{
+		fprintf(stderr, "error loading private key\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_sign_update(fs, "test", 4);
+	sig_len = falcon_sign_generate(fs, out + pkey_len,
+		max_len - pkey_len, FALCON_COMP_STATIC);
+	if (sig_len == 0) {
+		fprintf(stderr, "signature failure\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_keygen_free(fk);
+	falcon_sign_free(fs);
+	return pkey_len + sig_len;
+}
+
+static void
+test_isa_dispatch(void)
+{
+	unsigned char ref[6000], opt[6000];
+	unsigned isa, logn, u;
+
+	printf("Test ISA dispatch: ");
+	fflush(stdout);
+
+	isa = falcon_isa_enabled();
+	if ((isa & ~falcon_isa_detected()) != 0) {
+		fprintf(stderr, "undetected features enabled\n");
+		exit(EXIT_FAILURE);
+	}
+	if (falcon_isa_selftest_failures() != 0) {
+		fprintf(stderr, "kernel self-test failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/*
+	 * Seeded keys and signatures must not depend on the kernels
+	 * in use.
+	 */
+	for (logn = 1; logn <= 10; logn ++) {
+		size_t ref_len, opt_len;
+
+		falcon_isa_set(0);
+		ref_len = isa_seeded_sign(logn, ref, sizeof ref);
+		falcon_isa_set(isa);
+		opt_len = isa_seeded_sign(logn, opt, sizeof opt);
+		if (ref_len != opt_len || memcmp(ref, opt, ref_len) != 0) {
+			fprintf(stderr, "kernels disagree (logn=%u)\n", logn);
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	printf("CPU features:");
+	for (u = 0; falcon_isa_name(u) != NULL; u ++) {
+		if (isa & (1u << u)) {
+			printf(" %s", falcon_isa_name(u));
+		}
+	}
+	printf("\nKernels:");
+	for (u = 0; falcon_kernel_name(u) != NULL; u ++) {
+		printf(" %s=%s", falcon_kernel_name(u),
+			falcon_kernel_variant(u));
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+/*
+ * Reference Merkle tree hash (RFC 6962, section 2.1), recursive.
+ */
+static void
+batch_ref_hash(unsigned char *out, const unsigned char *leaves, size_t n)
+{
+	unsigned char lr[2 * FALCON_BATCH_HASH_LEN];
+	shake_context sc;
+	size_t k;
+
+	if (n == 1) {
+		memcpy(out, leaves, FALCON_BATCH_HASH_LEN);
+		return;
+	}
+	for (k = 1; (k << 1) < n; k <<= 1);
+	batch_ref_hash(lr, leaves, k);
+	batch_ref_hash(lr + FALCON_BATCH_HASH_LEN,
+		leaves + k * FALCON_BATCH_HASH_LEN, n - k);
+	shake_init(&sc, 512);
+	shake_inject(&sc, "\x01", 1);
+	shake_inject(&sc, lr, sizeof lr);
+	shake_flip(&sc);
+	shake_extract(&sc, out, FALCON_BATCH_HASH_LEN);
+}
+
+static void
+test_falcon_batch(void)
+{
+	static unsigned char leaves[300 * FALCON_BATCH_HASH_LEN];
+	unsigned char root[FALCON_BATCH_HASH_LEN], ref[FALCON_BATCH_HASH_LEN];
+	unsigned char proof[64 * FALCON_BATCH_HASH_LEN];
+	unsigned char skey[6000], pkey[3000], sig[3000], nonce[40];
+	size_t skey_len, pkey_len, sig_len, proof_len;
+	uint64_t hits, misses;
+	falcon_keygen *fk;
+	falcon_sign *fs;
+	falcon_batch_vrfy *bv;
+	falcon_batch_tree *ft;
+	size_t n, u, v;
+	uint32_t msg;
+
+	printf("Test batch signing: ");
+	fflush(stdout);
+
+	for (u = 0; u < 300; u ++) {
+		msg = (uint32_t)u;
+		falcon_batch_leaf(leaves + u * FALCON_BATCH_HASH_LEN,
+			&msg, sizeof msg);
+	}
+	if (falcon_batch_root(root, leaves, 0)
+		|| falcon_batch_tree_new(leaves, 0) != NULL)
+	{
+		fprintf(stderr, "empty batch accepted\n");
+		exit(EXIT_FAILURE);
+	}
+
+	fk = falcon_keygen_new(9, 0);
+	fs = falcon_sign_new();
+	bv = falcon_batch_vrfy_new();
+	if (fk == NULL || fs == NULL || bv == NULL) {
+		fprintf(stderr, "context creation error\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_keygen_set_seed(fk, "batch", 5, 1);
+	skey_len = sizeof skey;
+	pkey_len = sizeof pkey;
+	if (!falcon_keygen_make(fk, FALCON_COMP_STATIC,
+		skey, &skey_len, pkey, &pkey_len)
+		|| !falcon_sign_set_private_key(fs, skey, skey_len)
+		|| !falcon_batch_vrfy_set_public_key(bv, pkey, pkey_len))
+	{
+		fprintf(stderr, "key setup error\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (n = 1; n <= 300; n = n < 70 ? n + 1 : n + 115) {
+		int z;
+
+		/*
+		 * Streaming root, tree root and reference must agree.
+		 */
+		batch_ref_hash(ref, leaves, n);
+		if (!falcon_batch_root(root, leaves, n)
+			|| memcmp(root, ref, sizeof ref) != 0)
+		{
+			fprintf(stderr, "bad streaming root (n=%u)\n",
+				(unsigned)n);
+			exit(EXIT_FAILURE);
+		}
+		ft = falcon_batch_tree_new(leaves, n);
+		if (ft == NULL) {
+			fprintf(stderr, "tree creation error\n");
+			exit(EXIT_FAILURE);
+		}
+		falcon_batch_tree_root(ft, root);
+		if (memcmp(root, ref, sizeof ref) != 0) {
+			fprintf(stderr, "bad tree root (n=%u)\n",
+				(unsigned)n);
+			exit(EXIT_FAILURE);
+		}
+
+		sig_len = falcon_batch_sign(fs, nonce, root, n,
+			sig, sizeof sig, FALCON_COMP_STATIC);
+		if (sig_len == 0) {
+			fprintf(stderr, "batch signature failure\n");
+			exit(EXIT_FAILURE);
+		}
+
+		for (u = 0; u < n; u ++) {
+			msg = (uint32_t)u;
+			proof_len = sizeof proof;
+			if (!falcon_batch_tree_proof(ft, u, proof, &proof_len)) {
+				fprintf(stderr, "proof error\n");
+				exit(EXIT_FAILURE);
+			}
+			z = falcon_batch_vrfy_verify(bv, &msg, sizeof msg,
+				u, proof, proof_len, root, n,
+				nonce, sig, sig_len);
+			if (z != 1) {
+				fprintf(stderr, "batch verify failed"
+					" (n=%u, index=%u): %d\n",
+					(unsigned)n, (unsigned)u, z);
+				exit(EXIT_FAILURE);
+			}
+
+			/*
+			 * Wrong message, index, tree size or proof.
+			 */
+			msg ^= 1;
+			z = falcon_batch_vrfy_verify(bv, &msg, sizeof msg,
+				u, proof, proof_len, root, n,
+				nonce, sig, sig_len);
+			msg ^= 1;
+			if (n > 1) {
+				z |= falcon_batch_vrfy_verify(bv,
+					&msg, sizeof msg, (u + 1) % n,
+					proof, proof_len, root, n,
+					nonce, sig, sig_len);
+				proof[proof_len - 1] ^= 0x80;
+				z |= falcon_batch_vrfy_verify(bv,
+					&msg, sizeof msg, u,
+					proof, proof_len, root, n,
+					nonce, sig, sig_len);
+				proof[proof_len - 1] ^= 0x80;
+				z |= falcon_batch_vrfy_verify(bv,
+					&msg, sizeof msg, u,
+					proof, proof_len - FALCON_BATCH_HASH_LEN,
+					root, n, nonce, sig, sig_len);
+			}
+			z |= falcon_batch_vrfy_verify(bv, &msg, sizeof msg,
+				u, proof, proof_len, root, n + 1,
+				nonce, sig, sig_len);
+			if (z != 0) {
+				fprintf(stderr, "forged batch element accepted"
+					" (n=%u, index=%u)\n",
+					(unsigned)n, (unsigned)u);
+				exit(EXIT_FAILURE);
+			}
+		}
+		falcon_batch_tree_free(ft);
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * Every batch signature was checked once (on its first element),
+	 * and all other valid elements hit the cache. Forgeries never hit
+	 * the cache; those with the wrong tree size may reach (and fail)
+	 * the signature check, when the proof happens to fit both sizes.
+	 */
+	falcon_batch_vrfy_stats(bv, &hits, &misses);
+	for (n = 1, v = 0, u = 0; n <= 300;
+		n = n < 70 ? n + 1 : n + 115)
+	{
+		v ++;
+		u += n;
+	}
+	if (misses < v || hits != u - v) {
+		fprintf(stderr, "unexpected root cache statistics:"
+			" %lu hits, %lu misses\n",
+			(unsigned long)hits, (unsigned long)misses);
+		exit(EXIT_FAILURE);
+	}
+
+	/*
+	 * A new key forgets verified roots; a bad signature is not cached.
+	 */
+	falcon_batch_vrfy_set_public_key(bv, pkey, pkey_len);
+	ft = falcon_batch_tree_new(leaves, 5);
+	falcon_batch_tree_root(ft, root);
+	proof_len = sizeof proof;
+	falcon_batch_tree_proof(ft, 2, proof, &proof_len);
+	msg = 2;
+	sig[sig_len - 1] ^= 0x01;
+	if (falcon_batch_vrfy_verify(bv, &msg, sizeof msg, 2,
+		proof, proof_len, root, 5, nonce, sig, sig_len) == 1
+		|| falcon_batch_vrfy_verify(bv, &msg, sizeof msg, 2,
+		proof, proof_len, root, 5, nonce, sig, sig_len) == 1)
+	{
+		fprintf(stderr, "forged batch signature accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_batch_tree_free(ft);
+
+	falcon_keygen_free(fk);
+	falcon_sign_free(fs);
+	falcon_batch_vrfy_free(bv);
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static void
 test_falcon_keygen_binary(void)
 {
@@ -2147,7 +2897,7 @@ test_falcon_keygen_ternary(void)
 }
 
 static void
-speed_falcon(unsigned logn, unsigned ter)
+speed_falcon(unsigned logn, unsigned ter, int mode)
 {
 	falcon_keygen *fk;
 	falcon_sign *fs;
@@ -2185,7 +2935,9 @@ speed_falcon(unsigned logn, unsigned ter)
 		fprintf(stderr, "sign context creation error\n");
 		exit(EXIT_FAILURE);
 	}
-	if (!falcon_sign_set_private_key(fs, skey, skey_len)) {
+	if (!falcon_sign_set_mode(fs, mode)
+		|| !falcon_sign_set_private_key(fs, skey, skey_len))
+	{
 		fprintf(stderr, "error loading private key\n");
 		exit(EXIT_FAILURE);
 	}
@@ -2272,6 +3024,90 @@ speed_falcon(unsigned logn, unsigned ter)
 	fflush(stdout);
 }
 
+static void
+speed_sampler(unsigned logn, unsigned ter)
+{
+	falcon_keygen *fk;
+	unsigned char skey[6000], pkey[3000], sig[3000];
+	unsigned char nonce[40];
+	size_t skey_len, pkey_len;
+	unsigned u;
+
+	fk = falcon_keygen_new(logn, ter);
+	if (fk == NULL) {
+		fprintf(stderr, "keygen context creation error\n");
+		exit(EXIT_FAILURE);
+	}
+	skey_len = sizeof skey;
+	pkey_len = sizeof pkey;
+	if (!falcon_keygen_make(fk, FALCON_COMP_STATIC,
+		skey, &skey_len, pkey, &pkey_len))
+	{
+		fprintf(stderr, "keygen error\n");
+		exit(EXIT_FAILURE);
+	}
+	falcon_keygen_free(fk);
+
+	for (u = 0; falcon_sampler_name(u) != NULL; u ++) {
+		falcon_sign *fs;
+		long num;
+		uint64_t draws, samples, attempts, sigs;
+
+		printf("N=%u %-10s%s: ", (1 + (ter << 1)) << (logn - ter),
+			falcon_sampler_name(u), logn < 10 ? " " : "");
+		fflush(stdout);
+
+		fs = falcon_sign_new();
+		if (fs == NULL) {
+			fprintf(stderr, "sign context creation error\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!falcon_sign_set_private_key(fs, skey, skey_len)) {
+			fprintf(stderr, "error loading private key\n");
+			exit(EXIT_FAILURE);
+		}
+		num = 1;
+		for (;;) {
+			long j;
+			clock_t begin, end;
+			double tt;
+
+			falcon_sign_set_sampler(fs, falcon_sampler_name(u));
+			begin = clock();
+			for (j = 0; j < num; j ++) {
+				falcon_sign_start(fs, nonce);
+				falcon_sign_update(fs, "test", 4);
+				if (falcon_sign_generate(fs, sig, sizeof sig,
+					FALCON_COMP_STATIC) == 0)
+				{
+					fprintf(stderr, "signature failure\n");
+					exit(EXIT_FAILURE);
+				}
+			}
+			end = clock();
+			tt = (double)(end - begin) / CLOCKS_PER_SEC;
+			if (tt < 1.0) {
+				num <<= 1;
+				continue;
+			}
+			falcon_sign_sampler_stats(fs, &draws, &samples,
+				&attempts, &sigs);
+			printf(" %11.3f sig/s  (sampler rejects %5.2f%%,"
+				" sign retries %5.2f%%)",
+				(double)num / tt,
+				100.0 * (double)(draws - samples)
+				/ (double)draws,
+				100.0 * (double)(attempts - sigs)
+				/ (double)sigs);
+			break;
+		}
+		falcon_sign_free(fs);
+
+		printf("\n");
+		fflush(stdout);
+	}
+}
+
 static void
 speed_falcon_keygen(unsigned logn, unsigned ter)
 {
@@ -2332,15 +3168,23 @@ speed_falcon_keygen(unsigned logn, unsigned ter)
 int
 main(void)
 {
+	unsigned isa;
+
 	test_SHAKE128();
 	test_SHAKE256();
 	test_RNG();
+	test_drbg();
 	test_key_codec();
 	test_falcon_vrfy();
 
 	test_poly3();
 	test_poly();
 	test_falcon_sign();
+	test_falcon_expanded_key();
+	test_falcon_sign_dynamic();
+	test_falcon_sampler_backends();
+	test_isa_dispatch();
+	test_falcon_batch();
 
 	test_falcon_keygen_binary();
 	test_falcon_keygen_ternary();
@@ -2351,11 +3195,27 @@ main(void)
 	speed_falcon_keygen(9, 1);
 	speed_falcon_keygen(10, 0);
 
-	speed_falcon(8, 0);
-	speed_falcon(8, 1);
-	speed_falcon(9, 0);
-	speed_falcon(9, 1);
-	speed_falcon(10, 0);
+	speed_falcon(8, 0, FALCON_SIGN_TREE);
+	speed_falcon(8, 1, FALCON_SIGN_TREE);
+	speed_falcon(9, 0, FALCON_SIGN_TREE);
+	speed_falcon(9, 1, FALCON_SIGN_TREE);
+	speed_falcon(10, 0, FALCON_SIGN_TREE);
+
+	isa = falcon_isa_enabled();
+	falcon_isa_set(0);
+	printf("portable kernels:\n");
+	speed_falcon(9, 0, FALCON_SIGN_TREE);
+	speed_falcon(10, 0, FALCON_SIGN_TREE);
+	falcon_isa_set(isa);
+
+	printf("dynamic signing (no LDL tree):\n");
+	speed_falcon(9, 0, FALCON_SIGN_DYNAMIC);
+	speed_falcon(10, 0, FALCON_SIGN_DYNAMIC);
+
+	speed_sampler(9, 0);
+	speed_sampler(9, 1);
+	speed_sampler(10, 0);
+	printf("autotuned sampler: %s\n", falcon_sampler_autotune());
 
 	return 0;
 }
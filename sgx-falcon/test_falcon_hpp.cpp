@@ -0,0 +1,135 @@
+/*
+ * Tests for the C++17 interface (falcon.hpp): key generation, signing
+ * and verification through the wrapper classes, with an ExpandedKey
+ * shared by the Signers of several threads, for binary and ternary
+ * degrees.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "falcon.hpp"
+
+#define THREADS 4
+#define SIGS_PER_THREAD 8
+
+static void fail(const char *what, unsigned logn, bool ternary)
+{
+  fprintf(stderr, "falcon.hpp (logn=%u%s): %s\n", logn,
+      ternary ? " ternary" : "", what);
+  exit(EXIT_FAILURE);
+}
+
+template <unsigned LogN, bool Ternary>
+static void test_degree()
+{
+  typedef falcon::params<LogN, Ternary> P;
+
+  printf("[%zu%s]", P::degree, Ternary ? "t" : "");
+  fflush(stdout);
+
+  auto kg = falcon::KeyGenerator<LogN, Ternary>::create();
+  if (!kg)
+    fail("keygen context", LogN, Ternary);
+  const std::string kg_seed = "falcon.hpp";
+  kg->seed(kg_seed, true);
+  falcon::KeyPair<LogN, Ternary> kp, kp_raw;
+  if (!kg->generate(kp) || !kg->generate(kp_raw, FALCON_COMP_NONE))
+    fail("keygen", LogN, Ternary);
+  if (kp.public_size != P::public_key_size
+      || kp_raw.private_size != P::private_key_size
+      || kp.private_size > P::private_key_size
+      || kp.public_key().data()[0] != P::header)
+    fail("key sizes", LogN, Ternary);
+
+  // Wrong degree or kind is refused.
+  if (falcon::ExpandedKey<LogN, !Ternary>::load(kp.private_key())
+      || falcon::Verifier<LogN, !Ternary>::create(kp.public_key()))
+    fail("key of the wrong kind accepted", LogN, Ternary);
+
+  auto ek = falcon::ExpandedKey<LogN, Ternary>::load(kp.private_key());
+  auto ek_raw = falcon::ExpandedKey<LogN, Ternary>::load(
+      kp_raw.private_key());
+  auto ek_dyn = falcon::ExpandedKey<LogN, Ternary>::load_dynamic(
+      kp.private_key());
+  if (!ek || !ek_raw || !ek_dyn)
+    fail("expanded key", LogN, Ternary);
+
+  // Same seed, same message: the same signature with or without the
+  // LDL tree.
+  {
+    const std::string seed = "seeded", msg = "message";
+    falcon::Signature<LogN, Ternary> sig[2];
+    const falcon::ExpandedKey<LogN, Ternary> *keys[2] = { &*ek, &*ek_dyn };
+    for (int i = 0; i < 2; i++) {
+      auto s = falcon::Signer<LogN, Ternary>::create(*keys[i]);
+      if (!s)
+        fail("signer", LogN, Ternary);
+      s->seed(seed, true);
+      if (!s->sign(msg, sig[i]))
+        fail("seeded signature", LogN, Ternary);
+    }
+    for (int i = 1; i < 2; i++)
+      if (sig[i].size != sig[0].size
+          || memcmp(sig[i].storage.data(), sig[0].storage.data(),
+          sig[0].size) != 0
+          || sig[i].nonce != sig[0].nonce)
+        fail("signatures depend on the expanded key", LogN, Ternary);
+  }
+
+  // One shared ExpandedKey, one Signer and Verifier per thread.
+  std::vector<std::thread> threads;
+  int errors[THREADS] = { 0 };
+  for (int t = 0; t < THREADS; t++) {
+    threads.emplace_back([&, t] {
+      auto signer = falcon::Signer<LogN, Ternary>::create(*ek);
+      auto vrfy = falcon::Verifier<LogN, Ternary>::create(
+          kp.public_key());
+      if (!signer || !vrfy) {
+        errors[t]++;
+        return;
+      }
+      // Move-only handles stay usable after a move.
+      auto moved = std::move(*signer);
+      for (int i = 0; i < SIGS_PER_THREAD; i++) {
+        std::string msg = "thread " + std::to_string(t)
+            + " message " + std::to_string(i);
+        falcon::Signature<LogN, Ternary> sig;
+        if (i & 1) {
+          // In two pieces, uncompressed.
+          std::string head(msg, 0, 7), tail(msg, 7);
+          if (!moved.sign(sig, FALCON_COMP_NONE, head, tail))
+            errors[t]++;
+        } else if (!moved.sign(msg, sig)) {
+          errors[t]++;
+        }
+        if (sig.size > P::signature_size || !vrfy->verify(msg, sig))
+          errors[t]++;
+        msg[0] ^= 1;
+        if (vrfy->verify(msg, sig))
+          errors[t]++;
+      }
+    });
+  }
+  for (auto &th : threads)
+    th.join();
+  for (int t = 0; t < THREADS; t++)
+    if (errors[t] != 0)
+      fail("sign/verify in threads", LogN, Ternary);
+}
+
+int main()
+{
+  printf("Test falcon.hpp: ");
+  fflush(stdout);
+  test_degree<4, false>();
+  test_degree<9, false>();
+  test_degree<3, true>();
+  test_degree<9, true>();
+  printf(" done.\n");
+  return 0;
+}
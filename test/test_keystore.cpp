@@ -0,0 +1,162 @@
+/*
+ * Crash recovery of the key store (app/keystore.h): a replacement of
+ * one key is cut short at each point of its write sequence (record,
+ * index entry, header), by putting the file back in the state a crash
+ * there would leave, and the store must reopen with every key readable
+ * and either the old or the new value of the replaced one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "keystore.h"
+
+#define KEYS 10
+#define REPLACED 3
+#define LOGN 9
+// Header page of the store file.
+#define PAGE 4096
+
+static std::string path;
+
+static void fail(const char *what, const char *stage)
+{
+  fprintf(stderr, "keystore (%s): %s\n", stage, what);
+  exit(EXIT_FAILURE);
+}
+
+static std::vector<uint8_t> read_file(void)
+{
+  std::vector<uint8_t> buf;
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == NULL)
+    fail("cannot read the store file", "setup");
+  int c;
+  while ((c = getc(f)) != EOF)
+    buf.push_back((uint8_t) c);
+  fclose(f);
+  return buf;
+}
+
+static void write_file(const std::vector<uint8_t> &buf)
+{
+  FILE *f = fopen(path.c_str(), "wb");
+  if (f == NULL || fwrite(&buf[0], 1, buf.size(), f) != buf.size()
+      || fclose(f) != 0)
+    fail("cannot write the store file", "setup");
+}
+
+// Distinct sealed blob and public key for (id, version).
+static void key_material(uint64_t id, int version, uint8_t *sealed,
+    uint8_t *pkey)
+{
+  for (int i = 0; i < 1500; i++)
+    sealed[i] = (uint8_t) (id * 31 + version * 7 + i);
+  for (int i = 0; i < 897; i++)
+    pkey[i] = (uint8_t) (id * 17 + version * 5 + i);
+}
+
+static void put(uint64_t id, int version, const char *stage)
+{
+  uint8_t sealed[1500], pkey[897];
+  key_material(id, version, sealed, pkey);
+  if (keystore_put(id, LOGN, sealed, sizeof sealed, pkey, sizeof pkey) != 0)
+    fail("put failed", stage);
+}
+
+static void check(uint64_t id, int version, const char *stage)
+{
+  uint8_t sealed[1500], pkey[897], got[4096];
+  size_t len;
+  unsigned logn;
+  key_material(id, version, sealed, pkey);
+  if (!keystore_get_sealed(id, got, sizeof got, &len) || len != sizeof sealed
+      || memcmp(got, sealed, len) != 0)
+    fail("wrong sealed key after reopening", stage);
+  if (!keystore_get_pubkey(id, got, sizeof got, &len, &logn)
+      || logn != LOGN || len != sizeof pkey || memcmp(got, pkey, len) != 0)
+    fail("wrong public key after reopening", stage);
+}
+
+/*
+ * 'before' is the file with KEYS keys, 'after' the file once key
+ * REPLACED was rewritten; 'crashed' is what a crash left on disk.
+ */
+static void reopen(const std::vector<uint8_t> &crashed, int expect,
+    const char *stage)
+{
+  uint64_t keys, dead, bytes;
+
+  printf("[%s]", stage);
+  fflush(stdout);
+  write_file(crashed);
+  if (keystore_open(path.c_str()) != 0)
+    fail("cannot reopen", stage);
+  keystore_stats(&keys, &dead, &bytes);
+  if (keys != KEYS)
+    fail("wrong key count", stage);
+  for (uint64_t id = 0; id < KEYS; id++)
+    check(id, id == REPLACED ? expect : 0, stage);
+
+  // The recovered store takes writes and reopens without recovery.
+  put(KEYS, 0, stage);
+  keystore_close();
+  if (keystore_open(path.c_str()) != 0)
+    fail("cannot reopen after a write", stage);
+  keystore_stats(&keys, &dead, &bytes);
+  if (keys != KEYS + 1)
+    fail("wrong key count after a write", stage);
+  check(KEYS, 0, stage);
+  keystore_close();
+}
+
+int main()
+{
+  char dir[] = "/tmp/test_keystore.XXXXXX";
+  if (mkdtemp(dir) == NULL)
+    fail("cannot create a directory", "setup");
+  path = std::string(dir) + "/store";
+
+  printf("Test keystore: ");
+  fflush(stdout);
+  if (keystore_open(path.c_str()) != 0)
+    fail("cannot create", "setup");
+  for (uint64_t id = 0; id < KEYS; id++)
+    put(id, 0, "setup");
+  keystore_close();
+  std::vector<uint8_t> before = read_file();
+
+  if (keystore_open(path.c_str()) != 0)
+    fail("cannot reopen", "setup");
+  put(REPLACED, 1, "setup");
+  keystore_close();
+  std::vector<uint8_t> after = read_file();
+  if (after.size() <= before.size())
+    fail("replacement did not append", "setup");
+
+  // Record half written: dropped, the old value stays.
+  std::vector<uint8_t> crashed(before);
+  crashed.insert(crashed.end(), after.begin() + before.size(),
+      after.begin() + before.size() + (after.size() - before.size()) / 2);
+  reopen(crashed, 0, "torn");
+
+  // Record synced, index entry not written: the record is found.
+  crashed = before;
+  crashed.insert(crashed.end(), after.begin() + before.size(), after.end());
+  reopen(crashed, 1, "no-index");
+
+  // Record and index entry synced, header not written: the index entry
+  // points past the tail.
+  crashed = after;
+  memcpy(&crashed[0], &before[0], PAGE);
+  reopen(crashed, 1, "no-header");
+
+  unlink(path.c_str());
+  rmdir(dir);
+  printf(" done.\n");
+  return 0;
+}